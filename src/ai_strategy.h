@@ -4,12 +4,52 @@
 #include <QPoint>
 #include <vector>
 #include <QString>
+#include <atomic>
 #include "game_types.h"
 
 // 前向声明
-class Board;
+class Position;
 struct Move;
 
+/**
+ * @brief 一次搜索的统计信息
+ */
+struct SearchStats {
+    long long nodes = 0;       ///< 搜索的节点数
+    long long elapsedUs = 0;   ///< 用时（微秒）
+    QString evaluator;         ///< 使用的评估函数名称
+    long long ttProbes = 0;    ///< 置换表查询次数
+    long long ttHits = 0;      ///< 置换表命中次数
+    bool cached = false;       ///< 直接取自缓存的根节点结果，没有搜索
+
+    /**
+     * @brief 每秒搜索节点数
+     */
+    long long nps() const {
+        return elapsedUs > 0 ? nodes * 1000000 / elapsedUs : 0;
+    }
+
+    /**
+     * @brief 置换表命中率（0到1）
+     */
+    double ttHitRate() const {
+        return ttProbes > 0 ? static_cast<double>(ttHits) / ttProbes : 0.0;
+    }
+};
+
+/**
+ * @brief 一步棋的思考时间
+ *
+ * 搜索类AI在软时限之后不再开始新的一轮加深（主变不稳定时可适当延长），
+ * 到达硬时限立即停止并返回已有的最佳着法。两者都为0表示按策略自己的默认时间。
+ */
+struct TimeBudget {
+    int softMs = 0;   ///< 软时限（毫秒）
+    int hardMs = 0;   ///< 硬时限（毫秒）
+
+    bool isSet() const { return hardMs > 0; }
+};
+
 class AIStrategy {
 public:
     virtual ~AIStrategy() = default;
@@ -21,16 +61,53 @@ public:
     virtual int getDifficulty() const { return difficulty; }
     
     // 计算下一步移动
-    virtual Move getNextMove(const Board& board, PieceType currentPlayer) = 0;
+    virtual Move getNextMove(const Position& position, PieceType currentPlayer) = 0;
     
     // 检查该策略是否支持难度调整
     virtual bool supportsDifficulty() const { return true; }
 
     // 获取策略名称
     virtual QString getName() const = 0;
+
+    // 设置评估函数（"Pattern"/"NNUE"），不支持或加载失败时返回false并保持原评估函数
+    virtual bool setEvaluator(const QString& name) { (void)name; return false; }
+
+    // 获取当前评估函数名称，不使用可替换评估函数的策略返回空字符串
+    virtual QString getEvaluatorName() const { return QString(); }
+
+    // 获取最近一次getNextMove的搜索统计
+    virtual SearchStats getLastSearchStats() const { return SearchStats(); }
+
+    // 是否支持分步计算（startMove/stepMove/bestMoveSoFar），不支持的策略只能用getNextMove一次算完
+    virtual bool supportsStepping() const { return false; }
+
+    // 开始分步计算下一步：之后反复调用stepMove直到返回true，再用bestMoveSoFar取着法；
+    // 两次stepMove之间调用方可以处理别的事情（如界面事件），但不能修改局面
+    virtual void startMove(const Position& position, PieceType currentPlayer) { (void)position; (void)currentPlayer; }
+
+    // 最多再搜索约maxNodes个节点，返回这一步是否已经算完
+    virtual bool stepMove(long long maxNodes) { (void)maxNodes; return true; }
+
+    // 目前为止的最佳着法，还没有结果时为无效着法
+    virtual Move bestMoveSoFar() const { return Move(); }
+
+    // 清空跨着法保留的搜索状态（置换表、历史启发、杀手着法、搜索树等）；
+    // 同一对象在各步之间、各局之间都沿用这些状态，需要从头开始时调用
+    virtual void clearSearchState() {}
+
+    // 设置之后各步的思考时间（由对局时钟分配），空预算表示按难度使用默认时间
+    void setTimeBudget(const TimeBudget& budget) { timeBudget = budget; }
+
+    // 设置外部停止标志，搜索过程中定期检查，置位后尽快返回已有的最佳着法
+    void setStopFlag(const std::atomic<bool>* stop) { stopFlag = stop; }
     
 protected:
     int difficulty = 1;  // 默认难度级别
+    TimeBudget timeBudget;                        // 思考时间
+    const std::atomic<bool>* stopFlag = nullptr;  // 外部停止标志
+
+    // 外部停止标志是否已置位
+    bool stopRequested() const { return stopFlag && stopFlag->load(std::memory_order_relaxed); }
 };
 
 #endif // AI_STRATEGY_H 
\ No newline at end of file
@@ -0,0 +1,90 @@
+#include "alpha_beta_ai.h"
+#include "profiler.h"
+#include <algorithm>
+
+AlphaBetaAI::AlphaBetaAI()
+    : table_(TABLE_MEGABYTES)
+    , searcher_(table_)
+    , maxDepth_(0)
+    , thinkTimeMs_(0)
+    , rootToMove_(PieceType::BLACK)
+    , retried_(false)
+    , nodes_(0)
+{
+    setDifficulty(1);
+}
+
+void AlphaBetaAI::setDifficulty(int level)
+{
+    difficulty = std::clamp(level, 1, 5);
+    maxDepth_ = 2 + 2 * difficulty;            // 难度1-5对应深度4-12
+    thinkTimeMs_ = 1000 + difficulty * 500;    // 基础1秒 + 每难度等级0.5秒
+}
+
+bool AlphaBetaAI::setEvaluator(const QString& name)
+{
+    if (!searcher_.setEvaluator(name)) {
+        return false;
+    }
+    clearSearchState();  // 分数随评估函数变化
+    return true;
+}
+
+void AlphaBetaAI::clearSearchState()
+{
+    table_.clear();
+    searcher_.clearHistory();
+}
+
+Move AlphaBetaAI::getNextMove(const Position& position, PieceType currentPlayer)
+{
+    PROFILE_ZONE("AlphaBeta::getNextMove");
+    startMove(position, currentPlayer);
+    while (!stepMove(0)) {
+    }
+    return bestMoveSoFar();
+}
+
+void AlphaBetaAI::startMove(const Position& position, PieceType currentPlayer)
+{
+    root_ = position;
+    rootToMove_ = currentPlayer;
+    retried_ = false;
+    nodes_ = 0;
+    lastStats_ = SearchStats();
+    lastStats_.evaluator = searcher_.getEvaluatorName();
+
+    // 有时间预算时按硬时限停止，返回最后完成的一层的着法
+    Searcher::Limits limits;
+    limits.maxDepth = maxDepth_;
+    limits.maxTimeMs = timeBudget.isSet() ? timeBudget.hardMs : thinkTimeMs_;
+    searcher_.setStopFlag(stopFlag);
+    searcher_.start(root_, rootToMove_, limits);
+}
+
+bool AlphaBetaAI::stepMove(long long maxNodes)
+{
+    PROFILE_ZONE("AlphaBeta::stepMove");
+    if (!searcher_.step(maxNodes)) {
+        return false;
+    }
+    const Searcher::Result& result = searcher_.bestSoFar();
+    if (result.lineCount == 0 && !retried_ && !stopRequested()) {
+        // 时限短到第一层都没搜完时，不限时补搜一层
+        nodes_ += result.nodes;
+        lastStats_.elapsedUs += result.elapsedUs;
+        retried_ = true;
+        Searcher::Limits limits;
+        limits.maxDepth = 1;
+        searcher_.start(root_, rootToMove_, limits);
+        return false;
+    }
+    lastStats_.nodes = nodes_ + result.nodes;
+    lastStats_.elapsedUs += result.elapsedUs;
+    return true;
+}
+
+Move AlphaBetaAI::bestMoveSoFar() const
+{
+    return searcher_.bestSoFar().lineCount > 0 ? searcher_.bestSoFar().lines[0].move() : Move();
+}
@@ -0,0 +1,48 @@
+#ifndef ALPHA_BETA_AI_H
+#define ALPHA_BETA_AI_H
+
+#include "ai_strategy.h"
+#include "game_types.h"
+#include "position.h"
+#include "searcher.h"
+#include "transposition_table.h"
+
+/**
+ * @brief 分步迭代加深搜索AI
+ *
+ * 直接使用分析和引擎服务所用的Searcher，支持分步计算：界面用定时器每次推进一小片，
+ * 思考期间事件循环照常运行（重绘、时钟、悔棋和新局都能及时响应）。
+ * 置换表和历史启发分数在各步之间沿用。
+ */
+class AlphaBetaAI : public AIStrategy {
+public:
+    AlphaBetaAI();
+
+    void setDifficulty(int level) override;
+    Move getNextMove(const Position& position, PieceType currentPlayer) override;
+    QString getName() const override { return "AlphaBeta"; }
+    bool setEvaluator(const QString& name) override;
+    QString getEvaluatorName() const override { return searcher_.getEvaluatorName(); }
+    SearchStats getLastSearchStats() const override { return lastStats_; }
+    void clearSearchState() override;
+
+    bool supportsStepping() const override { return true; }
+    void startMove(const Position& position, PieceType currentPlayer) override;
+    bool stepMove(long long maxNodes) override;
+    Move bestMoveSoFar() const override;
+
+private:
+    static constexpr int TABLE_MEGABYTES = 16;
+
+    TranspositionTable table_;   ///< 置换表（跨着法沿用）
+    Searcher searcher_;
+    int maxDepth_;
+    int thinkTimeMs_;            ///< 没有时间预算时的每步思考时间
+    Position root_;              ///< 当前这一步的局面（补搜时用）
+    PieceType rootToMove_;
+    bool retried_;               ///< 已不限时补搜过第一层
+    long long nodes_;            ///< 这一步已搜的节点数
+    SearchStats lastStats_;
+};
+
+#endif // ALPHA_BETA_AI_H
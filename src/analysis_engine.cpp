@@ -0,0 +1,105 @@
+#include "analysis_engine.h"
+#include <algorithm>
+#include <chrono>
+
+AnalysisEngine::AnalysisEngine(size_t tableMegabytes)
+    : table_(tableMegabytes)
+    , abort_(false)
+    , generation_(0)
+{
+    thread_ = std::thread(&AnalysisEngine::run, this);
+}
+
+AnalysisEngine::~AnalysisEngine()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        quit_ = true;
+        abort_.store(true, std::memory_order_relaxed);
+    }
+    wake_.notify_one();
+    thread_.join();
+}
+
+void AnalysisEngine::setMultiPv(int lines)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    multiPv_ = std::clamp(lines, 1, Searcher::MAX_LINES);
+}
+
+void AnalysisEngine::setEvaluator(const QString& name)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    evaluator_ = name;
+}
+
+uint32_t AnalysisEngine::analyze(const Position& position, PieceType toMove)
+{
+    uint32_t generation;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        generation = generation_.load(std::memory_order_relaxed) + 1;
+        generation_.store(generation, std::memory_order_release);
+        job_.position = position;
+        job_.toMove = toMove;
+        job_.generation = generation;
+        job_.multiPv = multiPv_;
+        job_.evaluator = evaluator_;
+        hasJob_ = true;
+        abort_.store(true, std::memory_order_relaxed);
+    }
+    wake_.notify_one();
+    return generation;
+}
+
+void AnalysisEngine::stop()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    generation_.store(generation_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    hasJob_ = false;
+    abort_.store(true, std::memory_order_relaxed);
+}
+
+void AnalysisEngine::run()
+{
+    Searcher searcher(table_);
+    searcher.setStopFlag(&abort_);
+    Job job;
+
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [this]() { return quit_ || hasJob_; });
+            if (quit_) {
+                return;
+            }
+            job = job_;
+            hasJob_ = false;
+            // 在锁内复位，之后再来的analyze()/stop()一定能打断本次搜索
+            abort_.store(false, std::memory_order_relaxed);
+        }
+
+        if (job.evaluator != searcher.getEvaluatorName()) {
+            searcher.setEvaluator(job.evaluator);
+        }
+
+        Searcher::Limits limits;
+        limits.multiPv = job.multiPv;
+        Update update;
+        update.generation = job.generation;
+        searcher.search(job.position, job.toMove, limits, [&](const Searcher::Result& result) {
+            update.result = result;
+            publish(update, result.finished);
+        });
+    }
+}
+
+void AnalysisEngine::publish(const Update& update, bool force)
+{
+    while (!queue_.push(update)) {
+        if (!force || abort_.load(std::memory_order_relaxed)) {
+            return;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+}
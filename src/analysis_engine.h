@@ -0,0 +1,112 @@
+#ifndef ANALYSIS_ENGINE_H
+#define ANALYSIS_ENGINE_H
+
+#include <QString>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include "position.h"
+#include "searcher.h"
+#include "spsc_queue.h"
+#include "transposition_table.h"
+
+/**
+ * @brief 后台持续分析
+ *
+ * 在后台线程上对给定局面做不限时的多主变迭代加深搜索，进度通过无锁
+ * 单生产者单消费者队列发给界面线程（界面按自己的节奏poll，不阻塞搜索）。
+ * 局面变化时调用analyze()：正在进行的搜索在1024个节点内停止，随即从新局面
+ * 重新开始；置换表不清空，新局面在旧搜索树中出现过的子局面可以直接命中。
+ *
+ * 每次analyze()分配一个新的代号，队列中代号不符的结果属于旧局面，应丢弃。
+ */
+class AnalysisEngine {
+public:
+    /**
+     * @brief 发给界面的一次进度
+     */
+    struct Update {
+        uint32_t generation = 0;      ///< 对应analyze()返回的代号
+        Searcher::Result result;      ///< 搜索结果
+    };
+
+    /**
+     * @param tableMegabytes 置换表大小（MB）
+     */
+    explicit AnalysisEngine(size_t tableMegabytes = 64);
+    ~AnalysisEngine();
+
+    AnalysisEngine(const AnalysisEngine&) = delete;
+    AnalysisEngine& operator=(const AnalysisEngine&) = delete;
+
+    /**
+     * @brief 设置主变数（下次analyze()生效）
+     */
+    void setMultiPv(int lines);
+
+    /**
+     * @brief 设置评估函数名称（下次analyze()生效）
+     */
+    void setEvaluator(const QString& name);
+
+    /**
+     * @brief 开始分析局面，正在分析其他局面时立即切换
+     * @return 本次分析的代号
+     */
+    uint32_t analyze(const Position& position, PieceType toMove);
+
+    /**
+     * @brief 停止分析（后台线程保持空闲）
+     */
+    void stop();
+
+    /**
+     * @brief 取出一条进度（仅界面线程调用）
+     * @return 队列为空时返回false
+     */
+    bool poll(Update& update) { return queue_.pop(update); }
+
+    /**
+     * @brief 当前分析的代号
+     */
+    uint32_t generation() const { return generation_.load(std::memory_order_acquire); }
+
+private:
+    static constexpr size_t QUEUE_CAPACITY = 32;
+
+    /**
+     * @brief 待分析的局面
+     */
+    struct Job {
+        Position position;
+        PieceType toMove = PieceType::BLACK;
+        uint32_t generation = 0;
+        int multiPv = 3;
+        QString evaluator = "Pattern";
+    };
+
+    TranspositionTable table_;
+    SpscQueue<Update, QUEUE_CAPACITY> queue_;
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    Job job_;                         ///< 受mutex_保护
+    bool hasJob_ = false;             ///< 受mutex_保护
+    bool quit_ = false;               ///< 受mutex_保护
+    int multiPv_ = 3;                 ///< 受mutex_保护
+    QString evaluator_ = "Pattern";   ///< 受mutex_保护
+    std::atomic<bool> abort_;         ///< 让搜索线程尽快停止当前搜索
+    std::atomic<uint32_t> generation_;
+    std::thread thread_;
+
+    // 后台线程主循环
+    void run();
+
+    // 把进度放入队列；队列已满时丢弃（后续进度包含更新的结果），
+    // 最终结果则等待界面腾出空位，直到被新局面打断
+    void publish(const Update& update, bool force);
+};
+
+#endif // ANALYSIS_ENGINE_H
@@ -0,0 +1,85 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include "memory_budget.h"
+
+/**
+ * @brief 定长对象池（竞技场分配器）
+ *
+ * 一次性分配固定容量的连续存储，之后通过原子递增的游标无锁地分配
+ * 连续的元素块，不支持单独释放，只能整体clear()。
+ * 元素以下标引用，便于在节点中用32位整数保存指针。
+ *
+ * 存储计入MemoryBudget的节点池额度，实际容量可能小于请求；元素在allocate时才构造，
+ * 物理内存也随分配逐步占用。
+ */
+template <typename T>
+class Arena {
+    static_assert(std::is_trivially_destructible<T>::value, "Arena never runs destructors");
+
+public:
+    static constexpr int32_t INVALID = -1;  ///< 无效下标
+
+    explicit Arena(size_t capacity = 0, size_t minimumCapacity = 0) { reserve(capacity, minimumCapacity); }
+
+    /**
+     * @brief 重新分配存储（会丢弃所有已分配元素，不可与allocate并发调用）
+     * @param capacity 希望的容量
+     * @param minimumCapacity 节点池额度不足时至少保证的容量
+     */
+    void reserve(size_t capacity, size_t minimumCapacity = 0) {
+        block_ = MemoryBlock();
+        block_ = MemoryBlock(MemoryBudget::NODE_POOLS, capacity * sizeof(T),
+                             std::min(capacity, minimumCapacity) * sizeof(T));
+        storage_ = static_cast<T*>(block_.data());
+        capacity_ = block_.size() / sizeof(T);
+        used_.store(0, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief 分配count个连续元素（线程安全）
+     * @return 首元素下标；空间不足时返回INVALID
+     */
+    int32_t allocate(size_t count) {
+        size_t begin = used_.fetch_add(count, std::memory_order_relaxed);
+        if (begin + count > capacity_) {
+            return INVALID;
+        }
+        for (size_t i = begin; i < begin + count; ++i) {
+            new (storage_ + i) T();
+        }
+        return static_cast<int32_t>(begin);
+    }
+
+    /**
+     * @brief 释放全部元素（不可与allocate并发调用）
+     */
+    void clear() { used_.store(0, std::memory_order_relaxed); }
+
+    T& operator[](int32_t index) { return storage_[index]; }
+    const T& operator[](int32_t index) const { return storage_[index]; }
+
+    /**
+     * @brief 已分配的元素数量
+     */
+    size_t size() const {
+        size_t used = used_.load(std::memory_order_relaxed);
+        return used < capacity_ ? used : capacity_;
+    }
+
+    size_t capacity() const { return capacity_; }
+
+private:
+    MemoryBlock block_;
+    T* storage_ = nullptr;
+    size_t capacity_ = 0;
+    std::atomic<size_t> used_{0};
+};
+
+#endif // ARENA_H
@@ -1,120 +1,339 @@
 #include "astar_ai.h"
+#include "pattern_evaluator.h"
+#include "zobrist.h"
+#include "profiler.h"
 #include <algorithm>
 #include <cmath>
+#include <cstring>
 #include <limits>
 #include <chrono>
 #include <random>
+#include <thread>
 
-AStarAI::AStarAI(int difficulty) : difficulty_(difficulty) {
+AStarAI::AStarAI(int difficulty)
+    : difficulty_(difficulty)
+    , evaluator_(std::make_unique<PatternEvaluator>())
+    , table_(TABLE_MEGABYTES)
+    , key_(0) {
     // 根据难度设置搜索深度
     maxDepth_ = std::min(1 + difficulty, 4);  // 难度1-5对应深度2-5
+    std::memset(killers_, 0xFF, sizeof(killers_));
+    std::memset(history_, 0, sizeof(history_));
+}
+
+AStarAI::~AStarAI() {
+    clearRootResults();
 }
 
 void AStarAI::setDifficulty(int difficulty) {
+    // 候选范围随难度变化，同一局面的搜索结果不再通用
+    if (difficulty != difficulty_) {
+        clearSearchState();
+    }
     difficulty_ = difficulty;
     maxDepth_ = std::min(1 + difficulty, 4);
 }
 
-Move AStarAI::getNextMove(const Board& board, PieceType currentPlayer) {
+void AStarAI::setSymmetryPlies(int plies) {
+    // 规范哈希等于规范局面本身的普通哈希，两种键的条目可以混用，切换时不必清空置换表
+    symmetryPlies_ = std::clamp(plies, 0, static_cast<int>(Position::CELLS));
+}
+
+bool AStarAI::setEvaluator(const QString& name) {
+    auto evaluator = Evaluator::create(name);
+    if (!evaluator) {
+        return false;
+    }
+    evaluator_ = std::move(evaluator);
+    clearSearchState();  // 分数随评估函数变化
+    return true;
+}
+
+Move AStarAI::getNextMove(const Position& position, PieceType currentPlayer) {
+    PROFILE_ZONE("AStar::getNextMove");
     auto startTime = std::chrono::steady_clock::now();
+    nodeCount_ = 0;
+    ttProbes_ = 0;
+    ttHits_ = 0;
+    lastStats_ = SearchStats();
+    lastStats_.evaluator = evaluator_->getName();
     const int MAX_THINK_TIME = 1000 + difficulty_ * 500;  // 基础1秒 + 每难度等级0.5秒
 
-    std::vector<Move> validMoves = getValidMovesInRange(board);
+    std::vector<Move> validMoves = getValidMovesInRange(position);
     if (validMoves.empty()) {
         return Move{-1, -1};
     }
 
     // 如果是第一步，选择靠近中心的位置
-    if (validMoves.size() == board.getSize() * board.getSize()) {
-        int center = board.getSize() / 2;
+    if (position.getStoneCount() == 0) {
+        int center = position.getSize() / 2;
         return Move{center, center};
     }
 
-    // 对每个可能的移动进行初步评估
-    std::vector<std::pair<Move, int>> scoredMoves;
-    scoredMoves.reserve(validMoves.size());
-    
     PieceType opponent = (currentPlayer == PieceType::BLACK ? PieceType::WHITE : PieceType::BLACK);
-    
-    for (const auto& move : validMoves) {
-        auto tempBoardState = board.getBoardState();
-        
-        // 评估进攻价值
-        tempBoardState[move.row][move.col] = currentPlayer;
-        int attackScore = quickEvaluate(board, tempBoardState, move, currentPlayer);
-        
-        // 评估防守价值
-        tempBoardState[move.row][move.col] = opponent;
-        int defenseScore = quickEvaluate(board, tempBoardState, move, opponent);
-        
-        // 综合评分：进攻价值 + 防守价值的加权
-        int finalScore = attackScore;
-        
-        // 当对手有高威胁时，提高防守权重
-        if (defenseScore >= 3000) {  // 对手有活三或以上威胁
-            finalScore = std::max(finalScore, defenseScore);  // 取较大值
-        } else if (defenseScore >= 800) {  // 对手有活二或以上威胁
-            finalScore = std::max(finalScore, attackScore + (defenseScore * 2 / 3));
-        } else {
-            finalScore = attackScore + (defenseScore / 3);  // 普通情况
-        }
 
-        scoredMoves.push_back({move, finalScore});
+    // 对所有可能的移动进行批量初步评估
+    std::vector<RootCandidate> candidates = scoreRootCandidates(position, validMoves, currentPlayer);
+    lastRootCandidates_ = candidates;
 
-        // 如果发现必胜着法或必防着法，立即返回
-        if (attackScore >= 90000 || defenseScore >= 90000) {
-            return move;
+    // 能连五则直接获胜，其次堵住对手的连五点（常数时间查询）
+    for (const auto& candidate : candidates) {
+        if (position.makesFive(candidate.move.row, candidate.move.col, currentPlayer)) {
+            return candidate.move;
+        }
+    }
+    for (const auto& candidate : candidates) {
+        if (position.makesFive(candidate.move.row, candidate.move.col, opponent)) {
+            return candidate.move;
         }
     }
 
     // 随机打乱相同分数的移动
     std::random_device rd;
     std::mt19937 gen(rd());
-    std::stable_sort(scoredMoves.begin(), scoredMoves.end(),
-              [](const auto& a, const auto& b) { return a.second > b.second; });
-    
+    {
+        PROFILE_ZONE("AStar::sortCandidates");
+        std::stable_sort(candidates.begin(), candidates.end(),
+                  [](const auto& a, const auto& b) { return a.finalScore > b.finalScore; });
+        lastRootCandidates_ = candidates;
+    }
+
     // 根据难度保留不同数量的候选移动
-    int keepMoves = std::min(6 + difficulty_, static_cast<int>(scoredMoves.size()));
-    scoredMoves.resize(keepMoves);
-
-    Move bestMove = scoredMoves[0].first;
-    int bestScore = std::numeric_limits<int>::min();
-    int alpha = std::numeric_limits<int>::min();
-    int beta = std::numeric_limits<int>::max();
-
-    // 对筛选后的移动进行深入搜索
-    for (const auto& [move, _] : scoredMoves) {
-        auto tempBoardState = board.getBoardState();
-        tempBoardState[move.row][move.col] = currentPlayer;
-        
-        int score = alphaBetaSearch(board, tempBoardState, maxDepth_ - 1, alpha, beta, 
-                                  opponent, false);
-
-        if (score > bestScore) {
-            bestScore = score;
-            bestMove = move;
+    int keepMoves = std::min(6 + difficulty_, static_cast<int>(candidates.size()));
+    candidates.resize(keepMoves);
+
+    // 思考时间：有预算时按对局时钟分配，否则按难度；到达硬时限时搜索中途停止
+    const int hardMs = timeBudget.isSet() ? timeBudget.hardMs : MAX_THINK_TIME;
+    const int softMs = timeBudget.isSet() ? timeBudget.softMs : MAX_THINK_TIME;
+    deadline_ = startTime + std::chrono::milliseconds(hardMs);
+    aborted_ = false;
+
+    // 开局阶段维护8个对称哈希；对称的局面已经完整搜索过时，把当时的着法映射过来直接返回
+    symmetric_ = symmetryPlies_ > 0 && position.getStoneCount() <= symmetryPlies_;
+    uint64_t rootKey = 0;
+    int rootSym = 0;
+    if (symmetric_) {
+        symmetricHash_.clear();
+        for (int cell = 0; cell < Position::CELLS; ++cell) {
+            const PieceType piece = position.getPiece(cell / Position::SIZE, cell % Position::SIZE);
+            if (piece != PieceType::NONE) {
+                symmetricHash_.toggle(cell / Position::SIZE, cell % Position::SIZE, piece);
+            }
+        }
+        rootKey = symmetricHash_.canonical(&rootSym) ^
+                  (currentPlayer == PieceType::WHITE ? WHITE_TO_MOVE_KEY : 0);
+        auto cached = rootResults_.find(rootKey);
+        if (cached != rootResults_.end() && cached->second.depth >= maxDepth_) {
+            const int cell = Symmetry::transform(Symmetry::inverse(rootSym), cached->second.move);
+            const Move move{cell / Position::SIZE, cell % Position::SIZE};
+            if (position.getPiece(move.row, move.col) == PieceType::NONE) {
+                lastStats_.cached = true;
+                lastStats_.elapsedUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - startTime).count();
+                return move;
+            }
+        }
+    }
+    const bool trackSymmetry = symmetric_ && position.getStoneCount() < symmetryPlies_;
+
+    // 置换表、杀手着法和历史分数沿用之前各步的结果；历史分数减半，使近期的截断更有分量
+    table_.newSearch();
+    for (auto& color : history_) {
+        for (int& value : color) {
+            value /= 2;
+        }
+    }
+
+    // 对筛选后的移动进行深入搜索，所有候选共用一份局面，搜索后还原
+    Position searchPosition = position;
+    evaluator_->reset(searchPosition.getBoardState());
+    key_ = 0;
+    for (int cell = 0; cell < Position::CELLS; ++cell) {
+        const PieceType piece = searchPosition.getPiece(cell / Position::SIZE, cell % Position::SIZE);
+        if (piece != PieceType::NONE) {
+            key_ ^= Zobrist::key(piece, cell);
+        }
+    }
+
+    // 迭代加深，深度与maxDepth_同奇偶（叶节点评估的视角不变），上一轮的最佳着法最先搜索
+    Move bestMove = candidates[0].move;
+    int completedDepth = 0;
+    const int firstDepth = 2 - maxDepth_ % 2;
+    for (int depth = firstDepth; depth <= maxDepth_; depth += 2) {
+        PROFILE_ZONE("AStar::iteration");
+        Move iterationBest = bestMove;
+        int bestScore = std::numeric_limits<int>::min();
+        int alpha = std::numeric_limits<int>::min();
+        int beta = std::numeric_limits<int>::max();
+        size_t completed = 0;
+        for (const auto& candidate : candidates) {
+            const Move& move = candidate.move;
+            const int cell = move.row * Position::SIZE + move.col;
+            key_ ^= Zobrist::key(currentPlayer, cell);
+            if (trackSymmetry) {
+                symmetricHash_.toggle(move.row, move.col, currentPlayer);
+            }
+            searchPosition.placePiece(move.row, move.col, currentPlayer);
+            evaluator_->makeMove(move.row, move.col, currentPlayer);
+
+            int score = alphaBetaSearch(searchPosition, depth - 1, alpha, beta,
+                                        opponent, false);
+
+            evaluator_->unmakeMove(move.row, move.col, currentPlayer);
+            searchPosition.removePiece(move.row, move.col);
+            if (trackSymmetry) {
+                symmetricHash_.toggle(move.row, move.col, currentPlayer);
+            }
+            key_ ^= Zobrist::key(currentPlayer, cell);
+            if (aborted_) {
+                break;
+            }
+            ++completed;
+
+            if (score > bestScore) {
+                bestScore = score;
+                iterationBest = move;
+            }
+            alpha = std::max(alpha, bestScore);
         }
-        alpha = std::max(alpha, bestScore);
 
-        // 检查时间限制
-        auto currentTime = std::chrono::steady_clock::now();
-        auto elapsedTime = std::chrono::duration_cast<std::chrono::milliseconds>(currentTime - startTime).count();
-        if (elapsedTime > MAX_THINK_TIME) {
+        // 中途停止时，只有上一轮的最佳着法已在本轮搜完，本轮的结果才可比较
+        if (completed == 0) {
+            break;
+        }
+        const bool unstable = depth > firstDepth &&
+            (iterationBest.row != bestMove.row || iterationBest.col != bestMove.col);
+        bestMove = iterationBest;
+        if (aborted_) {
             break;
         }
+        completedDepth = depth;
+        auto best = std::find_if(candidates.begin(), candidates.end(), [&](const RootCandidate& c) {
+            return c.move.row == bestMove.row && c.move.col == bestMove.col;
+        });
+        std::rotate(candidates.begin(), best, best + 1);
+
+        // 下一轮通常要花数倍时间：用掉软时限的一半后不再开始，最佳着法刚变过时多给一半时间
+        if (timeBudget.isSet()) {
+            const auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - startTime).count();
+            if (elapsedMs * 2 > (unstable ? softMs * 3 / 2 : softMs)) {
+                break;
+            }
+        }
+    }
+
+    // 完整搜到最大深度的开局结果按规范局面缓存，着法转换到规范局面上保存
+    if (symmetric_ && completedDepth >= maxDepth_) {
+        // 新条目向缓存额度申请，额度用完时先清空缓存；仍然申请不到就不缓存
+        bool store = rootResults_.count(rootKey) > 0
+            || MemoryBudget::tryAcquire(MemoryBudget::CACHES, ROOT_CACHE_ENTRY_BYTES);
+        if (!store) {
+            clearRootResults();
+            store = MemoryBudget::tryAcquire(MemoryBudget::CACHES, ROOT_CACHE_ENTRY_BYTES);
+        }
+        if (store) {
+            const int cell = Symmetry::transform(rootSym, bestMove.row * Position::SIZE + bestMove.col);
+            rootResults_[rootKey] = RootResult{static_cast<uint8_t>(cell), static_cast<uint8_t>(completedDepth)};
+        }
     }
 
+    lastStats_.nodes = nodeCount_;
+    lastStats_.ttProbes = ttProbes_;
+    lastStats_.ttHits = ttHits_;
+    lastStats_.elapsedUs = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - startTime).count();
     return bestMove;
 }
 
-int AStarAI::quickEvaluate(const Board& board, const std::vector<std::vector<PieceType>>& boardState,
+std::vector<AStarAI::RootCandidate> AStarAI::scoreRootCandidates(const Position& position,
+                                                                const std::vector<Move>& candidates,
+                                                                PieceType currentPlayer,
+                                                                int threadCount) {
+    PROFILE_ZONE("AStar::scoreRootCandidates");
+    std::vector<RootCandidate> results(candidates.size());
+    if (candidates.empty()) {
+        return results;
+    }
+
+    // 每个线程至少处理一批候选，避免线程创建开销超过评估本身
+    const size_t MIN_BATCH = 16;
+    if (threadCount <= 0) {
+        threadCount = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    }
+    size_t workers = std::min(static_cast<size_t>(threadCount),
+                              (candidates.size() + MIN_BATCH - 1) / MIN_BATCH);
+
+    auto sharedState = position.getBoardState();
+    if (workers <= 1) {
+        scoreCandidateRange(sharedState, candidates, currentPlayer, results, 0, candidates.size());
+        return results;
+    }
+
+    // 每个线程一份棋盘副本，按连续区间切分候选
+    std::vector<std::thread> threads;
+    threads.reserve(workers - 1);
+    size_t batch = (candidates.size() + workers - 1) / workers;
+    for (size_t w = 1; w < workers; ++w) {
+        size_t begin = w * batch;
+        size_t end = std::min(candidates.size(), begin + batch);
+        if (begin >= end) break;
+        threads.emplace_back([&, begin, end, state = sharedState]() mutable {
+            scoreCandidateRange(state, candidates, currentPlayer, results, begin, end);
+        });
+    }
+    scoreCandidateRange(sharedState, candidates, currentPlayer, results, 0,
+                        std::min(batch, candidates.size()));
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    return results;
+}
+
+void AStarAI::scoreCandidateRange(std::vector<std::vector<PieceType>>& boardState,
+                                  const std::vector<Move>& candidates, PieceType currentPlayer,
+                                  std::vector<RootCandidate>& results, size_t begin, size_t end) {
+    PieceType opponent = (currentPlayer == PieceType::BLACK ? PieceType::WHITE : PieceType::BLACK);
+
+    for (size_t i = begin; i < end; ++i) {
+        const Move& move = candidates[i];
+        auto originalPiece = boardState[move.row][move.col];
+
+        // 评估进攻价值
+        boardState[move.row][move.col] = currentPlayer;
+        int attackScore = quickEvaluate(boardState, move, currentPlayer);
+
+        // 评估防守价值
+        boardState[move.row][move.col] = opponent;
+        int defenseScore = quickEvaluate(boardState, move, opponent);
+
+        boardState[move.row][move.col] = originalPiece;
+
+        // 综合评分：进攻价值 + 防守价值的加权
+        int finalScore = attackScore;
+
+        // 当对手有高威胁时，提高防守权重
+        if (defenseScore >= 3000) {  // 对手有活三或以上威胁
+            finalScore = std::max(finalScore, defenseScore);  // 取较大值
+        } else if (defenseScore >= 800) {  // 对手有活二或以上威胁
+            finalScore = std::max(finalScore, attackScore + (defenseScore * 2 / 3));
+        } else {
+            finalScore = attackScore + (defenseScore / 3);  // 普通情况
+        }
+
+        results[i] = RootCandidate{move, attackScore, defenseScore, finalScore};
+    }
+}
+
+int AStarAI::quickEvaluate(const std::vector<std::vector<PieceType>>& boardState,
                           const Move& lastMove, PieceType currentPlayer) {
+    PROFILE_ZONE("AStar::quickEvaluate");
     int score = 0;
     const int directions[4][2] = {{1, 0}, {0, 1}, {1, 1}, {1, -1}};
 
     // 评估最后一步棋的影响
     for (const auto& dir : directions) {
-        int lineScore = checkLine(boardState, lastMove.row, lastMove.col, dir[0], dir[1], currentPlayer);
+        int lineScore = PatternEvaluator::checkLine(boardState, lastMove.row, lastMove.col, dir[0], dir[1], currentPlayer);
         if (lineScore >= 90000) {
             return 100000;  // 必胜局面
         }
@@ -124,6 +343,7 @@ int AStarAI::quickEvaluate(const Board& board, const std::vector<std::vector<Pie
     // 评估周围潜在威胁
     int threatScore = 0;
     const int threatRange = 2;
+    const int size = static_cast<int>(boardState.size());
     for (int dr = -threatRange; dr <= threatRange; ++dr) {
         for (int dc = -threatRange; dc <= threatRange; ++dc) {
             if (dr == 0 && dc == 0) continue;
@@ -131,12 +351,12 @@ int AStarAI::quickEvaluate(const Board& board, const std::vector<std::vector<Pie
             int newRow = lastMove.row + dr;
             int newCol = lastMove.col + dc;
             
-            if (newRow >= 0 && newRow < board.getSize() && 
-                newCol >= 0 && newCol < board.getSize()) {
+            if (newRow >= 0 && newRow < size &&
+                newCol >= 0 && newCol < size) {
                 if (boardState[newRow][newCol] == currentPlayer) {
                     // 检查这个方向上的潜在连线
                     for (const auto& dir : directions) {
-                        threatScore += checkLine(boardState, newRow, newCol, dir[0], dir[1], currentPlayer) / 4;
+                        threatScore += PatternEvaluator::checkLine(boardState, newRow, newCol, dir[0], dir[1], currentPlayer) / 4;
                     }
                 }
             }
@@ -147,15 +367,16 @@ int AStarAI::quickEvaluate(const Board& board, const std::vector<std::vector<Pie
     return score;
 }
 
-std::vector<Move> AStarAI::getValidMovesInRange(const Board& board) {
+std::vector<Move> AStarAI::getValidMovesInRange(const Position& position) {
+    PROFILE_ZONE("AStar::getValidMovesInRange");
     std::vector<Move> moves;
-    int size = board.getSize();
+    int size = position.getSize();
     int searchRange = std::min(1 + difficulty_, 3);  // 限制最大搜索范围为3
 
     // 遍历所有已放置的棋子
     for (int i = 0; i < size; ++i) {
         for (int j = 0; j < size; ++j) {
-            if (board.getPiece(i, j) != PieceType::NONE) {
+            if (position.getPiece(i, j) != PieceType::NONE) {
                 // 在该棋子周围搜索空位
                 for (int di = -searchRange; di <= searchRange; ++di) {
                     for (int dj = -searchRange; dj <= searchRange; ++dj) {
@@ -166,7 +387,7 @@ std::vector<Move> AStarAI::getValidMovesInRange(const Board& board) {
                         int newCol = j + dj;
                         
                         if (newRow >= 0 && newRow < size && newCol >= 0 && newCol < size &&
-                            board.getPiece(newRow, newCol) == PieceType::NONE) {
+                            position.getPiece(newRow, newCol) == PieceType::NONE) {
                             Move newMove{newRow, newCol};
                             if (std::find_if(moves.begin(), moves.end(),
                                 [&](const Move& m) { 
@@ -188,245 +409,194 @@ std::vector<Move> AStarAI::getValidMovesInRange(const Board& board) {
     return moves;
 }
 
-int AStarAI::evaluateBoard(const Board& board, const std::vector<std::vector<PieceType>>& boardState,
-                          PieceType currentPlayer) {
-    int score = 0;
-    int size = board.getSize();
-    PieceType opponent = (currentPlayer == PieceType::BLACK ? PieceType::WHITE : PieceType::BLACK);
-    const int directions[4][2] = {{1, 0}, {0, 1}, {1, 1}, {1, -1}};
-    
-    // 评估所有位置
-    for (int i = 0; i < size; ++i) {
-        for (int j = 0; j < size; ++j) {
-            if (boardState[i][j] != PieceType::NONE) {
-                PieceType piece = boardState[i][j];
-                int multiplier = (piece == currentPlayer) ? 1 : -1;
-                
-                // 连子价值
-                int lineScoreSum = 0;
-                for (const auto& dir : directions) {
-                    int lineScore = checkLine(boardState, i, j, dir[0], dir[1], piece);
-                    // 如果发现必胜局面，立即返回
-                    if (lineScore >= 90000) {
-                        return multiplier * 100000;
-                    }
-                    lineScoreSum += lineScore;
-                }
-                score += multiplier * lineScoreSum;
-
-                // 位置价值（根据局势动态调整权重）
-                if (std::abs(lineScoreSum) < 2000) {
-                    int positionScore = calculatePositionScore(board, i, j, piece);
-                    score += multiplier * positionScore;
-                }
-            }
-        }
+int AStarAI::alphaBetaSearch(Position& position, int depth, int alpha, int beta,
+                             PieceType currentPlayer, bool isMaximizing) {
+    // 定期检查硬时限和外部停止标志，停止后逐层返回，结果不再使用
+    if ((++nodeCount_ & (STOP_CHECK_INTERVAL - 1)) == 0 &&
+        (stopRequested() || std::chrono::steady_clock::now() >= deadline_)) {
+        aborted_ = true;
+    }
+    if (aborted_) {
+        return 0;
     }
 
-    return score;
-}
+    // 到达叶子节点或游戏结束
+    if (depth == 0) {
+        PROFILE_ZONE("AStar::evaluate");
+        return evaluator_->evaluate(position.getBoardState(), currentPlayer);
+    }
 
-int AStarAI::checkLine(const std::vector<std::vector<PieceType>>& boardState, int startRow, int startCol, 
-                       int dRow, int dCol, PieceType player) {
-    int count = 1;
-    int empty = 0;
-    int size = boardState.size();
-    bool blocked = false;
-    bool hasGap = false;
-    
-    // 向一个方向检查
-    for (int i = 1; i < 5; ++i) {
-        int newRow = startRow + dRow * i;
-        int newCol = startCol + dCol * i;
-        
-        if (newRow < 0 || newRow >= size || newCol < 0 || newCol >= size) {
-            blocked = true;
-            break;
-        }
-        
-        PieceType piece = boardState[newRow][newCol];
-        if (piece == player) {
-            if (empty > 0) hasGap = true;
-            count++;
-        } else if (piece == PieceType::NONE) {
-            if (empty == 0 && i <= 4) {
-                empty++;
-                continue;
-            }
-            break;
-        } else {
-            blocked = true;
-            break;
-        }
+    // 候选着法按当前搜索局面生成
+    std::vector<Move> validMoves = getValidMovesInRange(position);
+    if (validMoves.empty() || position.isFull()) {
+        PROFILE_ZONE("AStar::evaluate");
+        return evaluator_->evaluate(position.getBoardState(), currentPlayer);
     }
-    
-    int backEmpty = 0;
-    bool backBlocked = false;
-    
-    // 向相反方向检查
-    for (int i = 1; i < 5; ++i) {
-        int newRow = startRow - dRow * i;
-        int newCol = startCol - dCol * i;
-        
-        if (newRow < 0 || newRow >= size || newCol < 0 || newCol >= size) {
-            backBlocked = true;
-            break;
+
+    // 分数总是站在极大方一边，因此键里要区分轮到谁和本节点是极大还是极小；
+    // 开局阶段用规范哈希，条目中的着法是规范局面上的格子
+    const int ply = position.getStoneCount();
+    const bool canonical = symmetric_ && ply <= symmetryPlies_;
+    int sym = 0;
+    const uint64_t boardKey = canonical ? symmetricHash_.canonical(&sym) : key_;
+    const uint64_t key = boardKey ^ (currentPlayer == PieceType::WHITE ? WHITE_TO_MOVE_KEY : 0)
+                                  ^ (isMaximizing ? MAXIMIZING_KEY : 0);
+    int ttMove = -1;
+    TranspositionTable::Entry entry;
+    ++ttProbes_;
+    // 之前搜索的条目只取着法，其分数按别的根局面评估
+    if (table_.probe(key, entry)) {
+        ++ttHits_;
+        if (entry.move != TranspositionTable::NO_MOVE) {
+            ttMove = canonical ? Symmetry::transform(Symmetry::inverse(sym), entry.move) : entry.move;
         }
-        
-        PieceType piece = boardState[newRow][newCol];
-        if (piece == player) {
-            if (backEmpty > 0) hasGap = true;
-            count++;
-        } else if (piece == PieceType::NONE) {
-            if (backEmpty == 0 && i <= 4) {
-                backEmpty++;
-                continue;
+        if (entry.depth >= depth && table_.isCurrent(entry)) {
+            if (entry.bound == TranspositionTable::BOUND_EXACT ||
+                (entry.bound == TranspositionTable::BOUND_LOWER && entry.score >= beta) ||
+                (entry.bound == TranspositionTable::BOUND_UPPER && entry.score <= alpha)) {
+                return entry.score;
             }
-            break;
-        } else {
-            backBlocked = true;
-            break;
         }
     }
-    
-    empty += backEmpty;
-    blocked = blocked && backBlocked;
-    
-    // 根据连子数和空位数计算分数
-    if (count >= 5) return 100000;  // 胜利
-    
-    // 基础分数
-    int baseScore;
-    if (blocked) {
-        if (count == 4) return 3000;  // 死四
-        if (count == 3) return 300;   // 死三
-        if (count == 2) return 30;    // 死二
-        baseScore = count * 8;
-    } else {
-        if (count == 4) {
-            if (empty >= 2) return 20000;  // 活四
-            baseScore = 8000;              // 单活四
-        } else if (count == 3) {
-            if (empty >= 2) return 3000;   // 活三
-            baseScore = 800;               // 单活三
-        } else if (count == 2) {
-            if (empty >= 2) return 200;    // 活二
-            baseScore = 50;                // 单活二
-        } else {
-            baseScore = count * 15;
-        }
-    }
-    
-    // 有间断的情况分数降低
-    if (hasGap) {
-        baseScore = baseScore * 2 / 3;
-    }
-    
-    return baseScore;
-}
-
-int AStarAI::alphaBetaSearch(const Board& board, std::vector<std::vector<PieceType>>& boardState,
-                            int depth, int alpha, int beta, PieceType currentPlayer, bool isMaximizing) {
-    // 创建临时Board对象来检查胜负
-    Board tempBoard;
-    tempBoard.setBoardState(boardState);
 
-    // 到达叶子节点或游戏结束
-    if (depth == 0) {
-        return evaluateBoard(board, boardState, currentPlayer);
-    }
+    orderMoves(validMoves, ttMove, ply, currentPlayer);
+    const bool trackSymmetry = symmetric_ && ply < symmetryPlies_;
 
-    std::vector<Move> validMoves = getValidMovesInRange(board);
-    if (validMoves.empty()) {
-        return evaluateBoard(board, boardState, currentPlayer);
-    }
+    PieceType opponent = (currentPlayer == PieceType::BLACK ? PieceType::WHITE : PieceType::BLACK);
+    const int alphaOrig = alpha;
+    const int betaOrig = beta;
+    int bestCell = -1;
 
     if (isMaximizing) {
         int maxScore = std::numeric_limits<int>::min();
         for (const auto& move : validMoves) {
-            // 保存原始状态
-            auto originalPiece = boardState[move.row][move.col];
-            
-            // 尝试移动
-            boardState[move.row][move.col] = currentPlayer;
-            
-            int score = alphaBetaSearch(board, boardState, depth - 1, alpha, beta,
-                                      (currentPlayer == PieceType::BLACK ? PieceType::WHITE : PieceType::BLACK),
-                                      false);
+            const int cell = move.row * position.getSize() + move.col;
+            // 尝试移动；连五即终局，越早获胜分数越高
+            int score;
+            key_ ^= Zobrist::key(currentPlayer, cell);
+            if (trackSymmetry) {
+                symmetricHash_.toggle(move.row, move.col, currentPlayer);
+            }
+            if (position.placePiece(move.row, move.col, currentPlayer)) {
+                score = MAX_SCORE + depth;
+            } else {
+                evaluator_->makeMove(move.row, move.col, currentPlayer);
+                score = alphaBetaSearch(position, depth - 1, alpha, beta, opponent, false);
+                evaluator_->unmakeMove(move.row, move.col, currentPlayer);
+            }
             
             // 恢复原始状态
-            boardState[move.row][move.col] = originalPiece;
+            position.removePiece(move.row, move.col);
+            if (trackSymmetry) {
+                symmetricHash_.toggle(move.row, move.col, currentPlayer);
+            }
+            key_ ^= Zobrist::key(currentPlayer, cell);
+            if (aborted_) {
+                return 0;
+            }
             
-            maxScore = std::max(maxScore, score);
+            if (score > maxScore) {
+                maxScore = score;
+                bestCell = cell;
+            }
             alpha = std::max(alpha, score);
             if (beta <= alpha) {
+                recordCutoff(cell, ply, currentPlayer, depth);
                 break;  // Beta剪枝
             }
         }
+        const auto bound = maxScore <= alphaOrig ? TranspositionTable::BOUND_UPPER
+                         : maxScore >= betaOrig ? TranspositionTable::BOUND_LOWER
+                         : TranspositionTable::BOUND_EXACT;
+        table_.store(key, depth, maxScore, bound,
+                     canonical && bestCell >= 0 ? Symmetry::transform(sym, bestCell) : bestCell);
         return maxScore;
     } else {
         int minScore = std::numeric_limits<int>::max();
         for (const auto& move : validMoves) {
-            // 保存原始状态
-            auto originalPiece = boardState[move.row][move.col];
-            
-            // 尝试移动
-            boardState[move.row][move.col] = currentPlayer;
-            
-            int score = alphaBetaSearch(board, boardState, depth - 1, alpha, beta,
-                                      (currentPlayer == PieceType::BLACK ? PieceType::WHITE : PieceType::BLACK),
-                                      true);
+            const int cell = move.row * position.getSize() + move.col;
+            // 尝试移动；对手连五即终局
+            int score;
+            key_ ^= Zobrist::key(currentPlayer, cell);
+            if (trackSymmetry) {
+                symmetricHash_.toggle(move.row, move.col, currentPlayer);
+            }
+            if (position.placePiece(move.row, move.col, currentPlayer)) {
+                score = -(MAX_SCORE + depth);
+            } else {
+                evaluator_->makeMove(move.row, move.col, currentPlayer);
+                score = alphaBetaSearch(position, depth - 1, alpha, beta, opponent, true);
+                evaluator_->unmakeMove(move.row, move.col, currentPlayer);
+            }
             
             // 恢复原始状态
-            boardState[move.row][move.col] = originalPiece;
+            position.removePiece(move.row, move.col);
+            if (trackSymmetry) {
+                symmetricHash_.toggle(move.row, move.col, currentPlayer);
+            }
+            key_ ^= Zobrist::key(currentPlayer, cell);
+            if (aborted_) {
+                return 0;
+            }
             
-            minScore = std::min(minScore, score);
+            if (score < minScore) {
+                minScore = score;
+                bestCell = cell;
+            }
             beta = std::min(beta, score);
             if (beta <= alpha) {
+                recordCutoff(cell, ply, currentPlayer, depth);
                 break;  // Alpha剪枝
             }
         }
+        const auto bound = minScore <= alphaOrig ? TranspositionTable::BOUND_UPPER
+                         : minScore >= betaOrig ? TranspositionTable::BOUND_LOWER
+                         : TranspositionTable::BOUND_EXACT;
+        table_.store(key, depth, minScore, bound,
+                     canonical && bestCell >= 0 ? Symmetry::transform(sym, bestCell) : bestCell);
         return minScore;
     }
 }
 
-int AStarAI::calculatePositionScore(const Board& board, int row, int col, PieceType player) {
-    int size = board.getSize();
-    int centerValue = size / 2;
-    
-    // 使用曼哈顿距离计算到中心的距离
-    int distanceToCenter = std::abs(row - centerValue) + std::abs(col - centerValue);
-    
-    // 基础分数：越靠近中心分数越高
-    int baseScore = 120 - (distanceToCenter * 8);
-    
-    // 根据周围棋子情况调整分数
-    int neighborScore = 0;
-    const int searchRange = 2;
-    
-    for (int dr = -searchRange; dr <= searchRange; ++dr) {
-        for (int dc = -searchRange; dc <= searchRange; ++dc) {
-            if (dr == 0 && dc == 0) continue;
-            
-            int newRow = row + dr;
-            int newCol = col + dc;
-            
-            if (newRow >= 0 && newRow < size && newCol >= 0 && newCol < size) {
-                PieceType piece = board.getPiece(newRow, newCol);
-                if (piece != PieceType::NONE) {
-                    // 相邻位置的己方子分数高一些
-                    if (std::abs(dr) + std::abs(dc) == 1) {
-                        neighborScore += (piece == player) ? 15 : 10;
-                    }
-                    // 次相邻位置分数较低
-                    else if (std::abs(dr) + std::abs(dc) == 2) {
-                        neighborScore += (piece == player) ? 8 : 5;
-                    }
-                }
-            }
+void AStarAI::orderMoves(std::vector<Move>& moves, int ttMove, int ply, PieceType player) const {
+    // 置换表着法最先，其次是同一步数上引起过截断的杀手着法，其余按历史分数
+    const int color = player == PieceType::BLACK ? 0 : 1;
+    std::vector<std::pair<int, Move>> ranked;
+    ranked.reserve(moves.size());
+    for (const Move& move : moves) {
+        const int cell = move.row * Position::SIZE + move.col;
+        int priority = history_[color][cell];
+        if (cell == ttMove) {
+            priority = 1 << 30;
+        } else if (cell == killers_[ply][0] || cell == killers_[ply][1]) {
+            priority = 1 << 28;
         }
+        ranked.emplace_back(priority, move);
     }
-    
-    // 最终分数为基础分数和邻近分数的加权和
-    return std::max(0, baseScore + (neighborScore / 2));
-} 
\ No newline at end of file
+    std::stable_sort(ranked.begin(), ranked.end(),
+                     [](const auto& a, const auto& b) { return a.first > b.first; });
+    for (size_t i = 0; i < moves.size(); ++i) {
+        moves[i] = ranked[i].second;
+    }
+}
+
+void AStarAI::recordCutoff(int cell, int ply, PieceType player, int depth) {
+    if (killers_[ply][0] != cell) {
+        killers_[ply][1] = killers_[ply][0];
+        killers_[ply][0] = static_cast<uint8_t>(cell);
+    }
+    int& score = history_[player == PieceType::BLACK ? 0 : 1][cell];
+    score = std::min(score + depth * depth, HISTORY_LIMIT);
+}
+
+void AStarAI::clearSearchState() {
+    table_.clear();
+    clearRootResults();
+    std::memset(killers_, 0xFF, sizeof(killers_));
+    std::memset(history_, 0, sizeof(history_));
+}
+
+void AStarAI::clearRootResults() {
+    MemoryBudget::release(MemoryBudget::CACHES, rootResults_.size() * ROOT_CACHE_ENTRY_BYTES);
+    rootResults_.clear();
+}
@@ -3,16 +3,73 @@
 
 #include "ai_strategy.h"
 #include "game_types.h"
-#include "board.h"
+#include "position.h"
+#include "evaluator.h"
+#include "transposition_table.h"
+#include "zobrist.h"
+#include <chrono>
+#include <cstdint>
 #include <vector>
 #include <utility>
+#include <cstddef>
+#include <memory>
+#include <unordered_map>
 
 class AStarAI : public AIStrategy {
 public:
     AStarAI(int difficulty = 1);
+    ~AStarAI() override;
     void setDifficulty(int level) override;
-    Move getNextMove(const Board& board, PieceType currentPlayer) override;
+    Move getNextMove(const Position& position, PieceType currentPlayer) override;
     QString getName() const override { return "AStar"; }
+    bool setEvaluator(const QString& name) override;
+    QString getEvaluatorName() const override { return evaluator_->getName(); }
+    SearchStats getLastSearchStats() const override { return lastStats_; }
+    void clearSearchState() override;
+
+    /**
+     * @brief 根节点候选着法的评分明细
+     */
+    struct RootCandidate {
+        Move move;          ///< 候选着法
+        int attackScore;    ///< 己方落子后的进攻价值
+        int defenseScore;   ///< 对手落子后的防守价值（即堵住该点的价值）
+        int finalScore;     ///< 用于排序的综合评分
+    };
+
+    /**
+     * @brief 批量评估根节点候选着法
+     *
+     * 所有候选在同一个局面上就地落子、评估、还原，每个工作线程只复制一次棋盘。
+     * 候选数量足够多时按线程数切分批次并行评估。
+     *
+     * @param position 当前局面
+     * @param candidates 候选着法
+     * @param currentPlayer 当前玩家
+     * @param threadCount 线程数，0表示使用硬件并发数
+     * @return 与candidates顺序一致的评分明细
+     */
+    std::vector<RootCandidate> scoreRootCandidates(const Position& position,
+                                                   const std::vector<Move>& candidates,
+                                                   PieceType currentPlayer,
+                                                   int threadCount = 0);
+
+    /**
+     * @brief 获取最近一次getNextMove的根节点评分明细（已按综合评分排序）
+     */
+    const std::vector<RootCandidate>& getLastRootCandidates() const { return lastRootCandidates_; }
+
+    static constexpr int DEFAULT_SYMMETRY_PLIES = 8;  ///< 默认按对称规范化的开局步数
+
+    /**
+     * @brief 设置按8种对称变换规范化哈希的开局步数
+     *
+     * 盘面棋子数不超过plies的局面以规范哈希查询置换表，置换表中的着法保存为规范局面上的格子，
+     * 取出时经逆变换映射回当前局面，互为对称的局面共用一个条目。根局面也在此范围内时，
+     * 完整搜索的结果按规范哈希缓存，之后遇到对称的局面直接映射得到着法。0表示关闭。
+     */
+    void setSymmetryPlies(int plies);
+    int getSymmetryPlies() const { return symmetryPlies_; }
 
 private:
     struct SearchNode {
@@ -27,34 +84,69 @@ private:
     int difficulty_;
     int maxDepth_;
     const int MAX_SCORE = 1000000;
+    std::vector<RootCandidate> lastRootCandidates_;  ///< 最近一次的根节点评分明细
+    std::unique_ptr<Evaluator> evaluator_;           ///< 叶节点评估函数
+    long long nodeCount_ = 0;                        ///< 当前搜索的节点计数
+    SearchStats lastStats_;                          ///< 最近一次搜索的统计
+    static constexpr int STOP_CHECK_INTERVAL = 256;  ///< 每隔多少节点检查一次时限（约1毫秒）
+    std::chrono::steady_clock::time_point deadline_; ///< 本次搜索的硬时限
+    bool aborted_ = false;                           ///< 已到时限或被要求停止
 
-    // 核心搜索函数
-    int alphaBetaSearch(const Board& board, std::vector<std::vector<PieceType>>& boardState,
-                       int depth, int alpha, int beta, PieceType currentPlayer, bool isMaximizing);
-    
-    // 估价函数
-    int evaluateBoard(const Board& board, const std::vector<std::vector<PieceType>>& boardState,
-                     PieceType currentPlayer);
+    // 跨着法保留的搜索状态（见clearSearchState）
+    static constexpr int TABLE_MEGABYTES = 16;
+    static constexpr int HISTORY_LIMIT = 1 << 20;
+    static constexpr uint64_t WHITE_TO_MOVE_KEY = 0x9E3779B97F4A7C15ULL;  ///< 轮到白方时异或到哈希上
+    static constexpr uint64_t MAXIMIZING_KEY = 0xC2B2AE3D27D4EB4FULL;     ///< 极大节点异或到哈希上
+    TranspositionTable table_;                       ///< 置换表（分数为极大方视角）
+    uint64_t key_;                                   ///< 搜索局面的Zobrist哈希
+    uint8_t killers_[Position::CELLS + 1][2];        ///< 按盘面棋子数索引的杀手着法，跨着法有效
+    int history_[2][Position::CELLS];                ///< 历史启发分数（按颜色）
+
+    // 开局的对称规范化（见setSymmetryPlies）
+    static constexpr size_t ROOT_CACHE_ENTRY_BYTES = 48;  ///< 根节点结果缓存每个条目计入缓存额度的字节数（含哈希表开销）
+    /**
+     * @brief 缓存的根节点结果
+     */
+    struct RootResult {
+        uint8_t move;    ///< 规范局面上的最佳着法（行 * 15 + 列）
+        uint8_t depth;   ///< 完成的搜索深度
+    };
+    int symmetryPlies_ = DEFAULT_SYMMETRY_PLIES;
+    bool symmetric_ = false;                         ///< 本次搜索是否维护对称哈希
+    SymmetricHash symmetricHash_;                    ///< 搜索局面的8个对称哈希
+    std::unordered_map<uint64_t, RootResult> rootResults_;  ///< 规范哈希（含轮走方）到根节点结果，缓存额度用完时清空
+    long long ttProbes_ = 0;                         ///< 当前搜索的置换表查询次数
+    long long ttHits_ = 0;                           ///< 当前搜索的置换表命中次数
+
+    // 清空根节点结果缓存并归还其缓存额度
+    void clearRootResults();
+
+    // 在共享的棋盘副本上评估[begin, end)范围内的候选
+    void scoreCandidateRange(std::vector<std::vector<PieceType>>& boardState,
+                             const std::vector<Move>& candidates, PieceType currentPlayer,
+                             std::vector<RootCandidate>& results, size_t begin, size_t end);
+
+    // 核心搜索函数，在position上就地落子和撤销；连五的着法直接按终局计分
+    int alphaBetaSearch(Position& position, int depth, int alpha, int beta,
+                        PieceType currentPlayer, bool isMaximizing);
     
+    // 按置换表着法、杀手着法、历史分数排序候选
+    void orderMoves(std::vector<Move>& moves, int ttMove, int ply, PieceType player) const;
+
+    // 记录引起截断的着法
+    void recordCutoff(int cell, int ply, PieceType player, int depth);
+
     // 获取搜索范围内的所有可能移动
-    std::vector<Move> getValidMovesInRange(const Board& board);
-    
-    // 计算位置分数
-    int calculatePositionScore(const Board& board, int row, int col, PieceType player);
-    
-    // 检查连子情况
-    int checkLine(const std::vector<std::vector<PieceType>>& boardState, int startRow, int startCol, 
-                 int dRow, int dCol, PieceType player);
+    std::vector<Move> getValidMovesInRange(const Position& position);
 
     /**
      * @brief 快速评估一个移动的价值
-     * @param board 棋盘对象
      * @param boardState 当前棋盘状态
      * @param lastMove 最后一步移动
      * @param currentPlayer 当前玩家
      * @return 评分
      */
-    int quickEvaluate(const Board& board, const std::vector<std::vector<PieceType>>& boardState,
+    int quickEvaluate(const std::vector<std::vector<PieceType>>& boardState,
                       const Move& lastMove, PieceType currentPlayer);
 };
 
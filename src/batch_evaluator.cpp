@@ -0,0 +1,145 @@
+#include "batch_evaluator.h"
+#include "evaluator.h"
+#include "position.h"
+#include "searcher.h"
+#include "transposition_table.h"
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <thread>
+
+namespace {
+
+constexpr size_t CHUNK = 16;  ///< 线程每次领取的局面数
+
+} // namespace
+
+/**
+ * @brief 一个线程的评估状态，构造后在各局面之间复用
+ */
+struct BatchEvaluator::Worker {
+    explicit Worker(size_t tableMB) : table(tableMB), searcher(table) {}
+
+    TranspositionTable table;
+    Searcher searcher;
+    std::unique_ptr<Evaluator> evaluator;
+    Position position;
+};
+
+PackedPosition PackedPosition::pack(const Position& position, PieceType toMove)
+{
+    PackedPosition packed;
+    for (int cell = 0; cell < Position::CELLS; ++cell) {
+        packed.setPiece(cell, position.getPiece(cell / Position::SIZE, cell % Position::SIZE));
+    }
+    packed.toMove = static_cast<uint8_t>(toMove);
+    return packed;
+}
+
+BatchEvaluator::BatchEvaluator(const Options& options)
+    : options_(options)
+{
+    int threads = options.threads;
+    if (threads <= 0) {
+        threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    }
+    for (int i = 0; i < threads; ++i) {
+        auto worker = std::make_unique<Worker>(static_cast<size_t>(std::max(1, options.tableMB)));
+        worker->evaluator = Evaluator::create(options.evaluator);
+        if (!worker->evaluator || !worker->searcher.setEvaluator(options.evaluator)) {
+            error_ = QString("无法创建评估函数 %1").arg(options.evaluator);
+            workers_.clear();
+            return;
+        }
+        workers_.push_back(std::move(worker));
+    }
+}
+
+BatchEvaluator::~BatchEvaluator() = default;
+
+void BatchEvaluator::evaluate(const PackedPosition* positions, size_t count, BatchResult* results)
+{
+    if (count == 0 || workers_.empty()) {
+        return;
+    }
+    std::atomic<size_t> next(0);
+    auto work = [&](Worker& worker) {
+        for (;;) {
+            const size_t begin = next.fetch_add(CHUNK, std::memory_order_relaxed);
+            if (begin >= count) {
+                break;
+            }
+            const size_t end = std::min(count, begin + CHUNK);
+            for (size_t i = begin; i < end; ++i) {
+                evaluateOne(worker, positions[i], results[i]);
+            }
+        }
+    };
+
+    // 局面少时不必启动全部线程
+    const size_t threads = std::min(workers_.size(), (count + CHUNK - 1) / CHUNK);
+    std::vector<std::thread> pool;
+    pool.reserve(threads - 1);
+    for (size_t t = 1; t < threads; ++t) {
+        pool.emplace_back(work, std::ref(*workers_[t]));
+    }
+    work(*workers_[0]);
+    for (auto& thread : pool) {
+        thread.join();
+    }
+}
+
+void BatchEvaluator::evaluateOne(Worker& worker, const PackedPosition& packed, BatchResult& result) const
+{
+    result = BatchResult();
+    const PieceType toMove = packed.sideToMove();
+    if (toMove != PieceType::BLACK && toMove != PieceType::WHITE) {
+        result.flags = BatchResult::INVALID;
+        return;
+    }
+
+    Position& position = worker.position;
+    position.clear();
+    PieceType fiveOwner = PieceType::NONE;
+    for (int cell = 0; cell < Position::CELLS; ++cell) {
+        const PieceType piece = packed.piece(cell);
+        if (piece == PieceType::NONE) {
+            continue;
+        }
+        if (piece != PieceType::BLACK && piece != PieceType::WHITE) {
+            result.flags = BatchResult::INVALID;
+            return;
+        }
+        if (position.placePiece(cell / Position::SIZE, cell % Position::SIZE, piece)) {
+            fiveOwner = piece;
+        }
+    }
+
+    const auto& board = position.getBoardState();
+    worker.evaluator->reset(board);
+    result.staticEval = worker.evaluator->evaluate(board, toMove);
+    result.score = result.staticEval;
+    if (fiveOwner != PieceType::NONE || position.isFull()) {
+        result.flags = BatchResult::TERMINAL;
+        result.score = fiveOwner == PieceType::NONE ? 0
+            : (fiveOwner == toMove ? Searcher::WIN_SCORE : -Searcher::WIN_SCORE);
+        return;
+    }
+    if (options_.depth <= 0) {
+        return;
+    }
+
+    worker.table.clear();
+    worker.searcher.clearHistory();
+    Searcher::Limits limits;
+    limits.maxDepth = options_.depth;
+    limits.maxNodes = options_.maxNodes;
+    const Searcher::Result search = worker.searcher.search(position, toMove, limits);
+    // 节点上限在第一层内就用完时没有结果，保留静态评估
+    if (search.lineCount > 0) {
+        result.score = search.lines[0].score;
+        result.bestMove = search.lines[0].pv[0];
+    }
+    result.depth = static_cast<uint8_t>(search.depth);
+    result.nodes = static_cast<uint32_t>(std::min<long long>(search.nodes, std::numeric_limits<uint32_t>::max()));
+}
@@ -0,0 +1,124 @@
+#ifndef BATCH_EVALUATOR_H
+#define BATCH_EVALUATOR_H
+
+#include <QString>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "game_types.h"
+
+class Position;
+
+/**
+ * @brief 紧凑局面：每格2位，加上轮到的一方，共64字节
+ *
+ * 可以直接作为数组读写文件（各字段都是字节，与字节序无关）：
+ * @code
+ *   cells[57]   第i格（行 * 15 + 列）在cells[i / 4]的第(i % 4) * 2位起的2位：0空、1黑、2白
+ *   toMove      轮到的一方：1黑、2白
+ *   reserved[6] 保留，写0
+ * @endcode
+ */
+struct PackedPosition {
+    static constexpr int CELL_BYTES = 57;
+
+    uint8_t cells[CELL_BYTES] = {};
+    uint8_t toMove = 1;
+    uint8_t reserved[6] = {};
+
+    PieceType piece(int cell) const {
+        return static_cast<PieceType>((cells[cell >> 2] >> ((cell & 3) * 2)) & 3);
+    }
+
+    void setPiece(int cell, PieceType piece) {
+        const int shift = (cell & 3) * 2;
+        cells[cell >> 2] = static_cast<uint8_t>((cells[cell >> 2] & ~(3 << shift)) |
+                                                (static_cast<int>(piece) << shift));
+    }
+
+    PieceType sideToMove() const { return static_cast<PieceType>(toMove); }
+
+    /**
+     * @brief 从局面打包
+     */
+    static PackedPosition pack(const Position& position, PieceType toMove);
+};
+
+static_assert(sizeof(PackedPosition) == 64, "PackedPosition must stay 64 bytes");
+
+/**
+ * @brief 一个局面的评估结果（16字节）
+ */
+struct BatchResult {
+    enum Flags : uint8_t {
+        INVALID = 1,    ///< 局面无法解析（格子编码为3或轮到的一方无效），其余字段无意义
+        TERMINAL = 2,   ///< 局面上已有连五或棋盘已满，不搜索
+    };
+
+    int32_t staticEval = 0;  ///< 轮到一方视角的静态评估
+    int32_t score = 0;       ///< 搜索分数（轮到一方视角）；不搜索时等于静态评估，终局为±Searcher::WIN_SCORE或0
+    int16_t bestMove = -1;   ///< 最佳着法（行 * 15 + 列），没有时为-1
+    uint8_t depth = 0;       ///< 完成的搜索深度
+    uint8_t flags = 0;       ///< Flags的组合
+    uint32_t nodes = 0;      ///< 搜索节点数
+};
+
+static_assert(sizeof(BatchResult) == 16, "BatchResult must stay 16 bytes");
+
+/**
+ * @brief 批量局面评估
+ *
+ * 对一段连续的PackedPosition数组并行计算静态评估，以及可选的定深（或定节点数）搜索分数和最佳着法，
+ * 结果写入等长的BatchResult数组。每个线程在构造时建好自己的局面、评估函数、置换表和搜索器，
+ * 之后评估每个局面都只复用这些对象，不做堆分配；线程按小块领取局面，负载不均时自动平衡。
+ *
+ * 每个局面搜索前清空该线程的置换表和历史分数，结果只取决于局面本身，与线程数和局面顺序无关。
+ */
+class BatchEvaluator {
+public:
+    /**
+     * @brief 评估参数
+     */
+    struct Options {
+        QString evaluator = "Pattern";  ///< 评估函数名称
+        int depth = 0;                  ///< 搜索深度，0表示只做静态评估
+        long long maxNodes = 0;         ///< 每个局面的节点上限，0表示不限
+        int tableMB = 1;                ///< 每个线程的置换表大小（MB）
+        int threads = 0;                ///< 线程数，0表示使用硬件并发数
+    };
+
+    explicit BatchEvaluator(const Options& options);
+    ~BatchEvaluator();
+
+    BatchEvaluator(const BatchEvaluator&) = delete;
+    BatchEvaluator& operator=(const BatchEvaluator&) = delete;
+
+    /**
+     * @brief 评估函数是否创建成功（如NNUE权重文件缺失时失败）
+     */
+    bool isValid() const { return error_.isEmpty(); }
+
+    QString errorString() const { return error_; }
+
+    int threadCount() const { return static_cast<int>(workers_.size()); }
+
+    /**
+     * @brief 评估count个局面
+     * @param positions 输入局面
+     * @param results 输出结果，至少count个
+     */
+    void evaluate(const PackedPosition* positions, size_t count, BatchResult* results);
+
+private:
+    struct Worker;
+
+    // 在worker上评估一个局面
+    void evaluateOne(Worker& worker, const PackedPosition& packed, BatchResult& result) const;
+
+    Options options_;
+    std::vector<std::unique_ptr<Worker>> workers_;
+    QString error_;
+};
+
+#endif // BATCH_EVALUATOR_H
@@ -0,0 +1,53 @@
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include <cstdint>
+#include <cstring>
+#include "game_types.h"
+
+/**
+ * @brief 位平面棋盘
+ *
+ * 每种颜色用16个16位行掩码表示：第r个元素的第c位表示(r, c)处有子。
+ * 第15行和第15位始终为0，作为填充，使整块棋盘正好是一个256位向量，
+ * 便于SIMD内核按行/对角线平移整块棋盘。
+ */
+struct BitBoard {
+    static constexpr int SIZE = 15;            ///< 棋盘大小
+    static constexpr int LANES = 16;           ///< 行数（含填充行）
+    static constexpr uint16_t ROW_MASK = 0x7FFF;  ///< 有效列掩码
+
+    alignas(32) uint16_t black[LANES];  ///< 黑子位平面
+    alignas(32) uint16_t white[LANES];  ///< 白子位平面
+
+    BitBoard() { clear(); }
+
+    void clear() {
+        std::memset(black, 0, sizeof(black));
+        std::memset(white, 0, sizeof(white));
+    }
+
+    void set(int row, int col, PieceType piece) {
+        const uint16_t bit = static_cast<uint16_t>(1u << col);
+        black[row] &= static_cast<uint16_t>(~bit);
+        white[row] &= static_cast<uint16_t>(~bit);
+        if (piece == PieceType::BLACK) {
+            black[row] |= bit;
+        } else if (piece == PieceType::WHITE) {
+            white[row] |= bit;
+        }
+    }
+
+    /**
+     * @brief 获取指定颜色的位平面
+     */
+    const uint16_t* plane(PieceType piece) const {
+        return piece == PieceType::BLACK ? black : white;
+    }
+
+    bool isEmpty(int row, int col) const {
+        return ((black[row] | white[row]) >> col & 1u) == 0;
+    }
+};
+
+#endif // BITBOARD_H
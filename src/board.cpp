@@ -1,43 +1,81 @@
 #include "board.h"
 #include <QPainter>
 #include <QMouseEvent>
+#include <QKeyEvent>
 #include <QMessageBox>
 #include <QTimer>
 #include <chrono>
+#include <algorithm>
+#include <cstdlib>
+#include <QDebug>
 #include "rule_based_ai.h"
 #include "astar_ai.h"
+#include "mcts_ai.h"
+#include "alpha_beta_ai.h"
+#include "profiler.h"
 
 Board::Board(QWidget *parent)
     : QWidget(parent)
-    , board(BOARD_SIZE, std::vector<PieceType>(BOARD_SIZE, PieceType::NONE))
     , currentPlayer(PieceType::BLACK)
     , gameOver(false)
     , aiEnabled(false)
     , aiStrategy(nullptr)
+    , keepSearchState(true)
     , playerPieceType(PieceType::BLACK)
+    , undoLimit(3)
     , remainingUndos(3)
+    , livePly(0)
     , lastMove(QPoint(-1, -1))
     , winLine()
+    , heatmap(new HeatmapOverlay(MARGIN, CELL_SIZE, BOARD_SIZE, this))
+    , heatmapVisible(false)
+    , heatmapKey(0)
+    , clockTimer(new QTimer(this))
+    , aiStepTimer(new QTimer(this))
 {
     setFixedSize(BOARD_SIZE * CELL_SIZE + 2 * MARGIN,
                  BOARD_SIZE * CELL_SIZE + 2 * MARGIN);
     setContextMenuPolicy(Qt::PreventContextMenu);
+    setFocusPolicy(Qt::StrongFocus);  // 接收复盘用的方向键
+
+    connect(heatmap, &HeatmapOverlay::ready, this, [this]() { update(); });
+    connect(this, &Board::positionChanged, this, &Board::requestHeatmap);
+
+    clockTimer->setInterval(CLOCK_TICK_MS);
+    connect(clockTimer, &QTimer::timeout, this, &Board::checkClock);
+
+    // 间隔为0：处理完已有的事件后立即再推进一片
+    aiStepTimer->setInterval(0);
+    connect(aiStepTimer, &QTimer::timeout, this, &Board::stepAIMove);
 }
 
 void Board::resetGame(bool enableAI, const QString& aiStrategy, int difficulty, 
-                     int undoLimit, PieceType playerPieceType)
+                     int undoLimit, PieceType playerPieceType, const QString& evaluator)
 {
-    board = std::vector<std::vector<PieceType>>(
-        BOARD_SIZE, std::vector<PieceType>(BOARD_SIZE, PieceType::NONE));
+    cancelAIMove();
+    finishJournal();
+
+    position.clear();
     currentPlayer = PieceType::BLACK;
     gameOver = false;
     aiEnabled = enableAI;
+    this->undoLimit = undoLimit;
     remainingUndos = undoLimit;
     this->playerPieceType = playerPieceType;
     
     if (enableAI) {
         setAIStrategy(aiStrategy);
+        if (!keepSearchState) {
+            this->aiStrategy->clearSearchState();
+        }
         this->aiStrategy->setDifficulty(difficulty);
+        // 只有使用可替换评估函数的策略才需要切换
+        QString currentEvaluator = this->aiStrategy->getEvaluatorName();
+        if (!currentEvaluator.isEmpty() && currentEvaluator != evaluator &&
+            !this->aiStrategy->setEvaluator(evaluator)) {
+            QMessageBox::warning(this, "评估函数",
+                                 QString("无法使用评估函数 %1，将使用默认评估函数。").arg(evaluator));
+        }
         
         // 如果玩家选择执白，AI先手
         if (playerPieceType == PieceType::WHITE) {
@@ -47,27 +85,120 @@ void Board::resetGame(bool enableAI, const QString& aiStrategy, int difficulty,
         this->aiStrategy.reset();
     }
     
-    while (!moveHistory.empty()) {
-        moveHistory.pop();
-    }
-    
+    history.clear();
+    livePly = 0;
     lastMove = QPoint(-1, -1);
     winLine = WinLine();
+    startJournal();
+
+    // 黑方先走，从现在开始计时
+    clock.reset(timeControl);
+    if (!timeControl.isUnlimited()) {
+        clock.start(PieceType::BLACK);
+        clockTimer->start();
+    } else {
+        clockTimer->stop();
+    }
     
     update();
+    emit positionChanged();
+    emit clockChanged();
+}
+
+void Board::restoreGame(const GameJournal::Recovered& game)
+{
+    const GameJournal::Settings& settings = game.settings;
+    resetGame(settings.aiEnabled, settings.aiStrategy, settings.aiDifficulty,
+              settings.undoLimit, settings.playerPieceType, settings.evaluator);
+
+    // 按日志重放，新日志同步写入相同的着法
+    remainingUndos = game.remainingUndos;
+    for (const auto& move : game.moves) {
+        position.placePiece(move.row, move.col, move.player);
+        recordMove(move.row, move.col, move.player);
+        currentPlayer = (move.player == PieceType::BLACK) ? PieceType::WHITE : PieceType::BLACK;
+    }
+    journal.sync();
+
+    // 崩溃发生在分出胜负之后、压缩之前
+    if (!game.moves.empty() && checkWin(lastMove.x(), lastMove.y())) {
+        gameOver = true;
+        finishJournal();
+    } else if (isAITurn()) {
+        QTimer::singleShot(100, this, &Board::makeAIMove);
+    }
+    // 日志不记录用时，恢复的对局双方从完整的时间重新开始
+    clock.reset(timeControl);
+    if (!gameOver && !timeControl.isUnlimited()) {
+        clock.start(currentPlayer);
+    }
+    update();
+    emit positionChanged();
+    emit clockChanged();
+}
+
+void Board::startJournal()
+{
+    GameJournal::Settings settings;
+    settings.aiEnabled = aiEnabled;
+    if (aiStrategy) {
+        settings.aiStrategy = aiStrategy->getName();
+        settings.aiDifficulty = aiStrategy->getDifficulty();
+        if (!aiStrategy->getEvaluatorName().isEmpty()) {
+            settings.evaluator = aiStrategy->getEvaluatorName();
+        }
+    }
+    settings.undoLimit = undoLimit;
+    settings.remainingUndos = remainingUndos;
+    settings.playerPieceType = playerPieceType;
+    settings.startTime = QDateTime::currentMSecsSinceEpoch();
+    if (!journal.begin(GameJournal::defaultPath(), settings)) {
+        qWarning() << "无法创建自动保存日志" << GameJournal::defaultPath();
+    }
+}
+
+void Board::finishJournal()
+{
+    if (!journal.isOpen()) {
+        return;
+    }
+    if (journal.moves().empty()) {
+        journal.discard();
+        return;
+    }
+
+    const QString filename = GameJournal::archivePath(journal.settings().startTime);
+    if (!journal.compact(filename)) {
+        // 压缩失败时保留日志，下次启动仍可恢复
+        qWarning() << "无法保存对局" << filename;
+    }
 }
 
 void Board::setAIStrategy(const QString& strategyName)
 {
+    // 同一策略沿用已有对象，保留其置换表等搜索状态
+    if (aiStrategy && aiStrategy->getName() == strategyName) {
+        return;
+    }
+    cancelAIMove();
     aiStrategy = createAIStrategy(strategyName);
 }
 
+void Board::setKeepSearchState(bool keep)
+{
+    keepSearchState = keep;
+}
+
 std::unique_ptr<AIStrategy> Board::createAIStrategy(const QString& strategyName)
 {
     if (strategyName == "RuleBased") {
         return std::make_unique<RuleBasedAI>();
     } else if (strategyName == "AStar") {
         return std::make_unique<AStarAI>();
+    } else if (strategyName == "MCTS") {
+        return std::make_unique<MctsAI>();
+    } else if (strategyName == "AlphaBeta") {
+        return std::make_unique<AlphaBetaAI>();
     }
     // 在这里添加其他AI策略的创建
     return std::make_unique<RuleBasedAI>();  // 默认使用规则基础AI
@@ -75,12 +206,30 @@ std::unique_ptr<AIStrategy> Board::createAIStrategy(const QString& strategyName)
 
 void Board::paintEvent(QPaintEvent *event)
 {
+    PROFILE_ZONE("Board::paintEvent");
+    ensureRenderCache();
+    const QRect dirty = event->rect();
+    // 重绘区域在图层中的位置（图层按设备像素存储）
+    auto source = [&dirty](const QPixmap& pixmap) {
+        const qreal dpr = pixmap.devicePixelRatio();
+        return QRectF(dirty.x() * dpr, dirty.y() * dpr, dirty.width() * dpr, dirty.height() * dpr);
+    };
+
     QPainter painter(this);
-    painter.setRenderHint(QPainter::Antialiasing);  // 启用抗锯齿
+    // 网格和热度图都已预先画好，只贴出需要重绘的部分
+    painter.drawPixmap(QRectF(dirty), gridCache, source(gridCache));
+    if (heatmapVisible) {
+        // 尚未算好时不显示
+        if (const QPixmap* layer = heatmap->layer(heatmapKey)) {
+            painter.drawPixmap(QRectF(dirty), *layer, source(*layer));
+        }
+    }
+    drawPieces(painter, dirty);
 
-    drawBoard(painter);
-    drawPieces(painter);
+    painter.setRenderHint(QPainter::Antialiasing);  // 标记和连线启用抗锯齿
     drawLastMove(painter);
+    drawVariations(painter);
+    drawAnalysis(painter);
     if (gameOver && winLine.valid) {
         drawWinLine(painter);
     }
@@ -108,33 +257,108 @@ void Board::drawBoard(QPainter &painter)
     }
 }
 
-void Board::drawPieces(QPainter &painter)
+void Board::drawPieces(QPainter &painter, const QRect& area)
 {
-    // 遍历棋盘，绘制所有棋子
-    for (int row = 0; row < BOARD_SIZE; ++row) {
-        for (int col = 0; col < BOARD_SIZE; ++col) {
-            if (board[row][col] != PieceType::NONE) {
-                // 计算棋子位置
+    // 只遍历与重绘区域相交的格子
+    const int reach = CELL_SIZE / 2;
+    const int rowFrom = std::clamp((area.top() - MARGIN - reach) / CELL_SIZE, 0, BOARD_SIZE - 1);
+    const int rowTo = std::clamp((area.bottom() - MARGIN + reach) / CELL_SIZE, 0, BOARD_SIZE - 1);
+    const int colFrom = std::clamp((area.left() - MARGIN - reach) / CELL_SIZE, 0, BOARD_SIZE - 1);
+    const int colTo = std::clamp((area.right() - MARGIN + reach) / CELL_SIZE, 0, BOARD_SIZE - 1);
+    const int half = STONE_EXTENT / 2;
+    for (int row = rowFrom; row <= rowTo; ++row) {
+        for (int col = colFrom; col <= colTo; ++col) {
+            const PieceType piece = position.getPiece(row, col);
+            if (piece != PieceType::NONE) {
+                // 贴上预先画好的棋子
                 QPoint pos = boardToPixel(row, col);
-                // 设置棋子颜色
-                QColor color = (board[row][col] == PieceType::BLACK) ? Qt::black : Qt::white;
-                painter.setPen(Qt::black);
-                painter.setBrush(color);
-                // 绘制棋子（圆形）
-                painter.drawEllipse(pos, CELL_SIZE / 2 - 2, CELL_SIZE / 2 - 2);
+                const QPixmap& sprite = stoneSprites[piece == PieceType::BLACK ? 0 : 1];
+                painter.drawPixmap(pos.x() - half, pos.y() - half, sprite);
             }
         }
     }
 }
 
+void Board::ensureRenderCache()
+{
+    const qreal dpr = devicePixelRatioF();
+    if (!gridCache.isNull() && gridCache.devicePixelRatio() == dpr) {
+        return;
+    }
+
+    // 背景和网格按设备像素比画一次，屏幕缩放变化时重建
+    gridCache = QPixmap(size() * dpr);
+    gridCache.setDevicePixelRatio(dpr);
+    {
+        QPainter painter(&gridCache);
+        drawBoard(painter);
+    }
+
+    // 两种颜色的棋子各画一个抗锯齿的精灵图
+    const int radius = CELL_SIZE / 2 - 2;
+    const QColor colors[2] = {Qt::black, Qt::white};
+    for (int i = 0; i < 2; ++i) {
+        QPixmap sprite(QSize(STONE_EXTENT, STONE_EXTENT) * dpr);
+        sprite.setDevicePixelRatio(dpr);
+        sprite.fill(Qt::transparent);
+        QPainter painter(&sprite);
+        painter.setRenderHint(QPainter::Antialiasing);
+        painter.setPen(Qt::black);
+        painter.setBrush(colors[i]);
+        painter.drawEllipse(QPointF(STONE_EXTENT / 2.0, STONE_EXTENT / 2.0), radius, radius);
+        painter.end();
+        stoneSprites[i] = sprite;
+    }
+}
+
+QRect Board::cellRect(int row, int col) const
+{
+    // 覆盖棋子、落子标记和分析标记
+    const QPoint center = boardToPixel(row, col);
+    const int half = CELL_SIZE / 2 + 1;
+    return QRect(center.x() - half, center.y() - half, 2 * half, 2 * half);
+}
+
+QRegion Board::decorationRegion() const
+{
+    QRegion region;
+    if (lastMove.x() >= 0) {
+        region |= cellRect(lastMove.x(), lastMove.y());
+    }
+    for (const Move& move : history.variations()) {
+        region |= cellRect(move.row, move.col);
+    }
+    for (const Move& move : analysisMoves) {
+        region |= cellRect(move.row, move.col);
+    }
+    if (gameOver && winLine.valid) {
+        const QRect line = QRect(boardToPixel(winLine.start.x(), winLine.start.y()),
+                                 boardToPixel(winLine.end.x(), winLine.end.y())).normalized();
+        region |= line.adjusted(-3, -3, 3, 3);
+    }
+    return region;
+}
+
 void Board::mousePressEvent(QMouseEvent *event)
 {
     if (gameOver) return;
 
+    // 只重绘变化的格子和前后的标记
+    QRegion dirty = decorationRegion();
+
     if (event->button() == Qt::RightButton) {
-        // 右键悔棋
+        // 右键悔棋；撤销的着法仍留在线路上，可据此找到被提走的格子
+        const int before = history.ply();
         if (undoMove()) {
-            update();
+            for (int i = history.ply(); i < before; ++i) {
+                dirty |= cellRect(history.moveAt(i).row, history.moveAt(i).col);
+            }
+            if (clock.isRunning()) {
+                // 悔棋的用时仍算在原来走的一方，不加增量
+                clock.start(currentPlayer);
+            }
+            update(dirty | decorationRegion());
+            emit positionChanged();
         }
         return;
     }
@@ -150,152 +374,324 @@ void Board::mousePressEvent(QMouseEvent *event)
 
     // 检查是否在有效范围内且该位置为空
     if (row >= 0 && row < BOARD_SIZE && col >= 0 && col < BOARD_SIZE &&
-        board[row][col] == PieceType::NONE) {
+        position.getPiece(row, col) == PieceType::NONE) {
+        // 复盘离开实际进度后再落子相当于悔棋：计一次悔棋次数，用完时不允许（终局后的复盘除外）
+        if (livePly >= 0 && history.ply() != livePly) {
+            if (remainingUndos <= 0) {
+                return;
+            }
+            remainingUndos--;
+        }
+
         // 记录移动
-        moveHistory.push(Move(row, col, currentPlayer));
-        board[row][col] = currentPlayer;
-        lastMove = QPoint(row, col);  // 记录最后落子位置
+        position.placePiece(row, col, currentPlayer);
+        recordMove(row, col, currentPlayer);
+
+        dirty |= cellRect(row, col);
 
         // 检查是否获胜
         if (checkWin(row, col)) {
             gameOver = true;
+            finishJournal();
+            advanceClock();
+            update(dirty | decorationRegion());
+            emit positionChanged();
             showGameOver(currentPlayer);
-            update();
             return;
         }
 
         // 切换玩家
         currentPlayer = (currentPlayer == PieceType::BLACK) ? PieceType::WHITE : PieceType::BLACK;
+        advanceClock();
 
         // 如果启用AI且当前是AI的回合
         if (isAITurn()) {
-            update();
             QTimer::singleShot(100, this, &Board::makeAIMove);
         }
 
-        update();
+        update(dirty | decorationRegion());
+        emit positionChanged();
     }
 }
 
 bool Board::undoMove()
 {
-    if (moveHistory.empty() || gameOver || remainingUndos <= 0) {
+    if (history.ply() == 0 || gameOver || remainingUndos <= 0) {
         return false;
     }
 
-    // 在AI模式下，需要撤销两步（玩家和AI的移动）
+    // 在AI模式下，需要撤销两步（玩家和AI的移动）；撤销的着法作为变化保留在历史中。
+    // AI还在分步思考时只撤回玩家刚走的一步，回到玩家走棋，不计悔棋次数
+    const bool thinking = aiStepTimer->isActive();
+    cancelAIMove();
+    const int steps = (aiEnabled && !thinking) ? 2 : 1;
+    if (!thinking) {
+        remainingUndos--;
+    }
+    for (int i = 0; i < steps && history.ply() > 0; ++i) {
+        currentPlayer = history.lastMove().player;
+        history.back(position);
+        journal.appendUndo(remainingUndos);
+    }
+    livePly = history.ply();
+
+    // 更新最后落子位置
+    const Move last = history.lastMove();
+    lastMove = QPoint(last.row, last.col);
+
+    return true;
+}
+
+void Board::recordMove(int row, int col, PieceType player)
+{
+    history.play(Move(row, col, player), position);
+    livePly = history.ply();
+    journal.appendMove(row, col, player, remainingUndos);
+    lastMove = QPoint(row, col);  // 记录最后落子位置
+}
+
+void Board::navigateTo(int ply)
+{
+    const int from = history.ply();
+    ply = std::clamp(ply, 0, history.length());
+    if (ply == from) {
+        return;
+    }
+    history.seek(position, ply);
+
+    const Move last = history.lastMove();
+    lastMove = QPoint(last.row, last.col);
+    currentPlayer = (ply == 0) ? PieceType::BLACK
+                  : (last.player == PieceType::BLACK) ? PieceType::WHITE : PieceType::BLACK;
+    winLine = WinLine();
+    const bool wins = ply > 0 && checkWin(last.row, last.col);
     if (aiEnabled) {
-        // 先撤销AI的移动
-        if (!moveHistory.empty()) {
-            Move lastMove = moveHistory.top();
-            moveHistory.pop();
-            board[lastMove.row][lastMove.col] = PieceType::NONE;
+        // 人机对战只在终局后复盘，保持只读
+        return;
+    }
+
+    gameOver = wins;
+    // 时钟跟随轮到的一方；已有一方超时则保持停止
+    if (gameOver) {
+        clock.pause();
+    } else if (!clock.control().isUnlimited() && !clock.isFlagged(PieceType::BLACK) &&
+               !clock.isFlagged(PieceType::WHITE)) {
+        clock.start(currentPlayer);
+        clockTimer->start();
+    }
+    emit clockChanged();
+    if (!gameOver && !journal.isOpen()) {
+        // 从终局退回后继续对弈：为新的变化开始日志，下一步落子之前的导航不计悔棋
+        livePly = -1;
+        startJournal();
+        for (const Move& move : history.moves()) {
+            journal.appendMove(move.row, move.col, move.player, remainingUndos);
         }
-        // 再撤销玩家的移动
-        if (!moveHistory.empty()) {
-            Move playerMove = moveHistory.top();
-            moveHistory.pop();
-            board[playerMove.row][playerMove.col] = PieceType::NONE;
-            currentPlayer = playerMove.player;
+    } else if (ply < from) {
+        for (int i = ply; i < from; ++i) {
+            journal.appendUndo(remainingUndos);
         }
-        remainingUndos--;
     } else {
-        // 双人模式下只需撤销一步
-        Move lastMove = moveHistory.top();
-        moveHistory.pop();
-        board[lastMove.row][lastMove.col] = PieceType::NONE;
-        currentPlayer = lastMove.player;
-        remainingUndos--;
+        for (int i = from; i < ply; ++i) {
+            const Move& move = history.moveAt(i);
+            journal.appendMove(move.row, move.col, move.player, remainingUndos);
+        }
     }
+    journal.sync();
+}
 
-    // 更新最后落子位置
-    if (!moveHistory.empty()) {
-        Move lastMove = moveHistory.top();
-        this->lastMove = QPoint(lastMove.row, lastMove.col);
-    } else {
-        this->lastMove = QPoint(-1, -1);
+void Board::keyPressEvent(QKeyEvent *event)
+{
+    if (!canNavigate()) {
+        QWidget::keyPressEvent(event);
+        return;
     }
 
-    return true;
+    QRegion dirty = decorationRegion();
+    const int from = history.ply();
+    switch (event->key()) {
+    case Qt::Key_Left:
+        navigateTo(history.ply() - 1);
+        break;
+    case Qt::Key_Right:
+        navigateTo(history.ply() + 1);
+        break;
+    case Qt::Key_Home:
+        navigateTo(0);
+        break;
+    case Qt::Key_End:
+        navigateTo(history.length());
+        break;
+    case Qt::Key_Up:
+    case Qt::Key_Down: {
+        // 在下一步的各个分支之间循环切换
+        const int count = static_cast<int>(history.variations().size());
+        if (count > 1) {
+            const int step = (event->key() == Qt::Key_Down) ? 1 : count - 1;
+            history.selectVariation((std::max(0, history.currentVariation()) + step) % count);
+        }
+        break;
+    }
+    default:
+        QWidget::keyPressEvent(event);
+        return;
+    }
+
+    // 跨度不大时只重绘落下或提走的格子（快速复盘时每步只重绘几格）
+    const int to = history.ply();
+    if (std::abs(to - from) > REPAINT_CELL_LIMIT) {
+        update();
+    } else {
+        for (int i = std::min(from, to); i < std::max(from, to); ++i) {
+            dirty |= cellRect(history.moveAt(i).row, history.moveAt(i).col);
+        }
+        update(dirty | decorationRegion());
+    }
+    emit positionChanged();
 }
 
 void Board::makeAIMove()
 {
-    if (gameOver || !aiEnabled || !aiStrategy || currentPlayer != PieceType::WHITE) {
+    PROFILE_ZONE("Board::makeAIMove");
+    if (gameOver || !aiStrategy || !isAITurn()) {
+        return;
+    }
+
+    // 按剩余时间和局面复杂度分配思考时间；不限时为空预算，使用难度对应的默认时间
+    aiStrategy->setTimeBudget(clock.allocate(currentPlayer, position));
+    if (aiStrategy->supportsStepping()) {
+        // 分步搜索：每次定时器触发推进一片，其间照常处理重绘、时钟和输入
+        aiStrategy->startMove(position, currentPlayer);
+        aiStepTimer->start();
+        return;
+    }
+    applyAIMove(aiStrategy->getNextMove(position, currentPlayer));
+}
+
+void Board::stepAIMove()
+{
+    // 超时判负等情况下对局已经结束
+    if (gameOver || !aiStrategy || !isAITurn()) {
+        aiStepTimer->stop();
+        return;
+    }
+    if (!aiStrategy->stepMove(AI_STEP_NODES)) {
+        return;
+    }
+    aiStepTimer->stop();
+    applyAIMove(aiStrategy->bestMoveSoFar());
+}
+
+void Board::cancelAIMove()
+{
+    aiStepTimer->stop();
+}
+
+void Board::applyAIMove(const Move& move)
+{
+    if (clock.isFlagged(currentPlayer)) {
+        // 搜索用完了全部时间（硬时限之外的余量也不够），不落子直接判负
+        checkClock();
         return;
     }
 
-    Move move = aiStrategy->getNextMove(*this, currentPlayer);
+    // 输出搜索统计，便于比较不同评估函数的速度
+    SearchStats stats = aiStrategy->getLastSearchStats();
+    if (stats.nodes > 0) {
+        QString line = QString("%1/%2: %3 节点, %4 ms, %5 NPS")
+            .arg(aiStrategy->getName(), stats.evaluator)
+            .arg(stats.nodes)
+            .arg(stats.elapsedUs / 1000)
+            .arg(stats.nps());
+        if (stats.ttProbes > 0) {
+            line += QString(", 置换表命中 %1%").arg(stats.ttHitRate() * 100.0, 0, 'f', 1);
+        }
+        qInfo().noquote() << line;
+    } else if (stats.cached) {
+        qInfo().noquote() << QString("%1: 对称局面已搜索过，直接取用缓存的着法").arg(aiStrategy->getName());
+    }
     if (move.row >= 0 && move.row < BOARD_SIZE && 
         move.col >= 0 && move.col < BOARD_SIZE) {
         
-        moveHistory.push(Move(move.row, move.col, currentPlayer));
-        board[move.row][move.col] = currentPlayer;
-        lastMove = QPoint(move.row, move.col);
+        QRegion dirty = decorationRegion() | cellRect(move.row, move.col);
+        position.placePiece(move.row, move.col, currentPlayer);
+        recordMove(move.row, move.col, currentPlayer);
         
         if (checkWin(move.row, move.col)) {
             gameOver = true;
+            finishJournal();
+            advanceClock();
+            update(dirty | decorationRegion());
+            emit positionChanged();
             showGameOver(currentPlayer);
-        } else {
-            currentPlayer = PieceType::BLACK;
+            return;
         }
+        currentPlayer = (currentPlayer == PieceType::BLACK) ? PieceType::WHITE : PieceType::BLACK;
+        advanceClock();
         
-        update();
+        update(dirty | decorationRegion());
+        emit positionChanged();
     }
 }
 
-bool Board::checkWin(int row, int col)
+void Board::advanceClock()
 {
-    // 定义四个方向：垂直、水平、对角线、反对角线
-    const std::vector<std::pair<int, int>> directions = {
-        {1, 0},   // 垂直
-        {0, 1},   // 水平
-        {1, 1},   // 对角线
-        {1, -1}   // 反对角线
-    };
+    if (!clock.isRunning()) {
+        return;
+    }
+    clock.finishMove();
+    if (!gameOver) {
+        clock.start(currentPlayer);
+    } else {
+        clockTimer->stop();
+    }
+    emit clockChanged();
+}
 
-    // 检查每个方向
-    for (const auto &dir : directions) {
-        int count = 1;  // 当前方向的连续棋子数
-        PieceType current = board[row][col];  // 当前玩家
-        
-        QPoint start(row, col);
-        QPoint end(row, col);
-
-        // 向正方向检查
-        for (int i = 1; i < 5; ++i) {
-            int newRow = row + dir.first * i;
-            int newCol = col + dir.second * i;
-            // 检查边界和是否为同色棋子
-            if (newRow < 0 || newRow >= BOARD_SIZE || newCol < 0 || newCol >= BOARD_SIZE ||
-                board[newRow][newCol] != current) {
-                break;
-            }
-            count++;
-            end = QPoint(newRow, newCol);
-        }
+void Board::checkClock()
+{
+    const PieceType side = clock.runningSide();
+    if (side == PieceType::NONE) {
+        return;
+    }
+    if (clock.isFlagged(side)) {
+        clock.pause();
+        clockTimer->stop();
+        gameOver = true;
+        finishJournal();
+        emit positionChanged();
+        emit clockChanged();
+        const PieceType winner = (side == PieceType::BLACK) ? PieceType::WHITE : PieceType::BLACK;
+        showGameOver(winner, (side == PieceType::BLACK) ? "黑方超时。" : "白方超时。");
+        return;
+    }
+    emit clockChanged();
+}
 
-        // 向反方向检查
-        for (int i = 1; i < 5; ++i) {
-            int newRow = row - dir.first * i;
-            int newCol = col - dir.second * i;
-            // 检查边界和是否为同色棋子
-            if (newRow < 0 || newRow >= BOARD_SIZE || newCol < 0 || newCol >= BOARD_SIZE ||
-                board[newRow][newCol] != current) {
-                break;
-            }
-            count++;
-            start = QPoint(newRow, newCol);
+bool Board::checkWin(int row, int col)
+{
+    Position::Segment line;
+    Move last = position.getLastMove();
+    if (last.row == row && last.col == col) {
+        // 最后一步：连子长度已在落子时增量算出
+        if (!position.getWinLine(line)) {
+            return false;
         }
-
-        // 如果任意方向达到5个连续棋子，则获胜
-        if (count >= 5) {
-            winLine = WinLine(start, end);  // 记录获胜连线
-            return true;
+    } else {
+        // 其他位置：临时提起该子，按"落在此处"查询后放回
+        PieceType piece = position.getPiece(row, col);
+        if (piece == PieceType::NONE) {
+            return false;
+        }
+        Position probe = position;
+        probe.removePiece(row, col);
+        if (!probe.placePiece(row, col, piece) || !probe.getWinLine(line)) {
+            return false;
         }
     }
 
-    return false;
+    winLine = WinLine(QPoint(line.startRow, line.startCol), QPoint(line.endRow, line.endCol));  // 记录获胜连线
+    return true;
 }
 
 QPoint Board::boardToPixel(int row, int col) const
@@ -312,13 +708,20 @@ QPoint Board::pixelToBoard(int x, int y) const
     return QPoint(row, col);
 }
 
-void Board::showGameOver(PieceType winner)
+void Board::showGameOver(PieceType winner, const QString& reason)
 {
     QString message;
     if (aiEnabled) {
         if (winner == playerPieceType) {
             // 玩家获胜
-            QString aiName = (aiStrategy->getName() == "AStar") ? "启发式搜索AI" : "规则基础AI";
+            QString aiName = "规则基础AI";
+            if (aiStrategy->getName() == "AStar") {
+                aiName = "启发式搜索AI";
+            } else if (aiStrategy->getName() == "MCTS") {
+                aiName = "蒙特卡洛树搜索AI";
+            } else if (aiStrategy->getName() == "AlphaBeta") {
+                aiName = "迭代加深搜索AI";
+            }
             message = QString("恭喜！你成功挑战了难度%1的%2！").arg(aiStrategy->getDifficulty()).arg(aiName);
         } else {
             // AI获胜
@@ -328,7 +731,7 @@ void Board::showGameOver(PieceType winner)
         // 双人对战
         message = (winner == PieceType::BLACK) ? "黑方胜利！" : "白方胜利！";
     }
-    QMessageBox::information(this, "游戏结束", message);
+    QMessageBox::information(this, "游戏结束", reason + message);
 }
 
 bool Board::saveGameState(const QString& filename)
@@ -345,16 +748,15 @@ bool Board::saveGameState(const QString& filename)
     data.board.resize(BOARD_SIZE, std::vector<int>(BOARD_SIZE));
     for (int i = 0; i < BOARD_SIZE; ++i) {
         for (int j = 0; j < BOARD_SIZE; ++j) {
-            data.board[i][j] = static_cast<int>(board[i][j]);
+            data.board[i][j] = static_cast<int>(position.getPiece(i, j));
         }
     }
     
-    std::stack<Move> tempHistory = moveHistory;
-    while (!tempHistory.empty()) {
-        const Move& move = tempHistory.top();
-        data.history.insert(data.history.begin(), 
-            GameSave::Move(move.row, move.col, move.player));
-        tempHistory.pop();
+    // 只保存棋盘上的线路，按顺序一次写出
+    data.history.reserve(history.ply());
+    for (int i = 0; i < history.ply(); ++i) {
+        const Move& move = history.moveAt(i);
+        data.history.emplace_back(move.row, move.col, move.player);
     }
     
     return GameSave::saveGame(filename, data);
@@ -366,36 +768,69 @@ bool Board::loadGameState(const QString& filename)
     if (!GameSave::loadGame(filename, data)) {
         return false;
     }
+    cancelAIMove();
+    finishJournal();
     
     aiEnabled = data.isAIEnabled;
     if (aiEnabled) {
         setAIStrategy("RuleBased");  // 默认使用规则基础AI
         aiStrategy->setDifficulty(data.aiDifficulty);
     }
+    undoLimit = data.undoLimit;
     remainingUndos = data.remainingUndos;
     currentPlayer = static_cast<PieceType>(data.currentPlayer);
     gameOver = false;
     
+    std::vector<std::vector<PieceType>> state(BOARD_SIZE, std::vector<PieceType>(BOARD_SIZE));
     for (int i = 0; i < BOARD_SIZE; ++i) {
         for (int j = 0; j < BOARD_SIZE; ++j) {
-            board[i][j] = static_cast<PieceType>(data.board[i][j]);
+            state[i][j] = static_cast<PieceType>(data.board[i][j]);
         }
     }
     
-    while (!moveHistory.empty()) {
-        moveHistory.pop();
+    // 按历史记录重放，使局面保留落子记录（悔棋可常数时间撤销）；
+    // 历史与棋盘不一致时直接按棋盘重建，并以该局面作为历史的起点
+    position.clear();
+    history.clear();
+    for (const auto& move : data.history) {
+        if (move.row >= 0 && move.row < BOARD_SIZE && move.col >= 0 && move.col < BOARD_SIZE &&
+            position.getPiece(move.row, move.col) == PieceType::NONE) {
+            position.placePiece(move.row, move.col, move.player);
+            history.play(Move(move.row, move.col, move.player), position);
+        }
     }
+    if (position.getBoardState() != state) {
+        position.setBoardState(state);
+        history.clear(position);
+    }
+    livePly = history.ply();
+    const Move last = history.lastMove();
+    lastMove = QPoint(last.row, last.col);
+    winLine = WinLine();
+
+    // 读档后继续的对局同样写入日志，先记下已有的着法
+    startJournal();
     for (const auto& move : data.history) {
-        moveHistory.push(Move(move.row, move.col, move.player));
+        journal.appendMove(move.row, move.col, move.player, remainingUndos);
+    }
+    journal.sync();
+
+    // 存档不含用时，读档后双方从完整的时间重新开始
+    clock.reset(timeControl);
+    if (!timeControl.isUnlimited()) {
+        clock.start(currentPlayer);
+        clockTimer->start();
     }
     
     update();
+    emit positionChanged();
+    emit clockChanged();
     return true;
 }
 
 void Board::drawLastMove(QPainter &painter)
 {
-    if (!moveHistory.empty()) {
+    if (history.ply() > 0) {
         QPoint pixelPos = boardToPixel(lastMove.x(), lastMove.y());
         
         // 设置画笔
@@ -416,6 +851,75 @@ void Board::drawLastMove(QPainter &painter)
     }
 }
 
+void Board::drawVariations(QPainter &painter)
+{
+    // 只有一条线路时不标记
+    const std::vector<Move> variations = history.variations();
+    if (variations.size() < 2) {
+        return;
+    }
+
+    // 用小空心圆标出各分支的下一步，当前线路的一步用蓝色
+    const int current = history.currentVariation();
+    painter.setBrush(Qt::NoBrush);
+    for (int i = 0; i < static_cast<int>(variations.size()); ++i) {
+        QPen pen(i == current ? Qt::blue : Qt::darkGray);
+        pen.setWidth(2);
+        painter.setPen(pen);
+        painter.drawEllipse(boardToPixel(variations[i].row, variations[i].col), 5, 5);
+    }
+}
+
+void Board::setAnalysisMoves(const std::vector<Move>& moves)
+{
+    QRegion dirty = decorationRegion();
+    analysisMoves = moves;
+    update(dirty | decorationRegion());
+}
+
+void Board::setHeatmapVisible(bool visible)
+{
+    heatmapVisible = visible;
+    requestHeatmap();
+    update();
+}
+
+void Board::requestHeatmap()
+{
+    if (!heatmapVisible) {
+        return;
+    }
+    // 与AI使用相同的评估函数；不使用可替换评估函数的策略按棋型评估
+    QString evaluator = aiStrategy ? aiStrategy->getEvaluatorName() : QString();
+    if (evaluator.isEmpty()) {
+        evaluator = "Pattern";
+    }
+    heatmapKey = Heatmap::cacheKey(position, evaluator);
+    heatmap->request(position, evaluator, devicePixelRatioF());
+}
+
+void Board::drawAnalysis(QPainter &painter)
+{
+    // 在候选点上画半透明圆并标出名次，第一名用绿色
+    QFont font = painter.font();
+    font.setBold(true);
+    painter.setFont(font);
+    const int radius = CELL_SIZE / 2 - 6;
+    for (int i = 0; i < static_cast<int>(analysisMoves.size()); ++i) {
+        const Move& move = analysisMoves[i];
+        if (position.getPiece(move.row, move.col) != PieceType::NONE) {
+            continue;
+        }
+        const QPoint center = boardToPixel(move.row, move.col);
+        painter.setPen(Qt::NoPen);
+        painter.setBrush(i == 0 ? QColor(40, 160, 60, 170) : QColor(60, 110, 200, 140));
+        painter.drawEllipse(center, radius, radius);
+        painter.setPen(Qt::white);
+        painter.drawText(QRect(center.x() - radius, center.y() - radius, 2 * radius, 2 * radius),
+                         Qt::AlignCenter, QString::number(i + 1));
+    }
+}
+
 void Board::drawWinLine(QPainter &painter)
 {
     // 设置画笔
@@ -2,13 +2,21 @@
 #define BOARD_H
 
 #include <QWidget>
+#include <QPixmap>
+#include <QRegion>
 #include <vector>
 #include <random>
-#include <stack>
 #include <memory>
 #include "game_types.h"
 #include "gamesave.h"
 #include "ai_strategy.h"
+#include "position.h"
+#include "game_journal.h"
+#include "game_history.h"
+#include "heatmap_overlay.h"
+#include "game_clock.h"
+
+class QTimer;
 
 /**
  * @brief 棋盘类
@@ -36,10 +44,12 @@ public:
      * @param difficulty AI难度（1-5）
      * @param undoLimit 允许的悔棋次数
      * @param playerPieceType 玩家选择的棋子颜色（仅在AI模式下有效）
+     * @param evaluator 评估函数名称（仅搜索类AI使用）
      */
     void resetGame(bool enableAI = false, const QString& aiStrategy = "RuleBased",
                   int difficulty = 3, int undoLimit = 3, 
-                  PieceType playerPieceType = PieceType::BLACK);
+                  PieceType playerPieceType = PieceType::BLACK,
+                  const QString& evaluator = "Pattern");
 
     /**
      * @brief 保存当前游戏状态
@@ -55,12 +65,34 @@ public:
      */
     bool loadGameState(const QString& filename);
 
+    /**
+     * @brief 从自动保存日志恢复对局
+     * @param game GameJournal::recover读出的对局
+     */
+    void restoreGame(const GameJournal::Recovered& game);
+
     /**
      * @brief 设置AI策略
      * @param strategyName AI策略名称
      */
     void setAIStrategy(const QString& strategyName);
 
+    /**
+     * @brief 设置新局是否保留AI的搜索状态（置换表、历史启发等）
+     * @param keep 为false时每局开始前清空
+     */
+    void setKeepSearchState(bool keep);
+
+    /**
+     * @brief 设置时间控制（下一次resetGame起生效）
+     */
+    void setTimeControl(const TimeControl& control) { timeControl = control; }
+
+    /**
+     * @brief 获取对局时钟
+     */
+    const GameClock& getClock() const { return clock; }
+
     /**
      * @brief 获取棋盘大小
      */
@@ -69,31 +101,75 @@ public:
     /**
      * @brief 获取指定位置的棋子类型
      */
-    PieceType getPiece(int row, int col) const { return board[row][col]; }
+    PieceType getPiece(int row, int col) const { return position.getPiece(row, col); }
 
     /**
      * @brief 在指定位置放置棋子
      */
-    void placePiece(int row, int col, PieceType piece) { board[row][col] = piece; }
+    void placePiece(int row, int col, PieceType piece) {
+        position.removePiece(row, col);
+        if (piece != PieceType::NONE) {
+            position.placePiece(row, col, piece);
+        }
+    }
 
     /**
      * @brief 获取棋盘状态
      */
-    std::vector<std::vector<PieceType>> getBoardState() const { return board; }
+    std::vector<std::vector<PieceType>> getBoardState() const { return position.getBoardState(); }
 
     /**
      * @brief 设置棋盘状态
      */
-    void setBoardState(const std::vector<std::vector<PieceType>>& newBoard) { board = newBoard; }
+    void setBoardState(const std::vector<std::vector<PieceType>>& newBoard) { position.setBoardState(newBoard); }
+
+    /**
+     * @brief 获取当前局面
+     */
+    const Position& getPosition() const { return position; }
+
+    /**
+     * @brief 获取当前轮到的一方
+     */
+    PieceType getCurrentPlayer() const { return currentPlayer; }
+
+    /**
+     * @brief 对局是否已结束
+     */
+    bool isGameOver() const { return gameOver; }
+
+    /**
+     * @brief 设置分析模式下标出的候选着法（按名次排列，空表示不标记）
+     */
+    void setAnalysisMoves(const std::vector<Move>& moves);
+
+    /**
+     * @brief 显示或隐藏提示热度图（后台计算，按局面缓存）
+     */
+    void setHeatmapVisible(bool visible);
 
     /**
      * @brief 检查是否获胜
+     *
+     * (row, col)为最后一步时直接读取增量维护的连子长度，否则沿四条轴线扫描。
+     *
      * @param row 行号
      * @param col 列号
      * @return 是否获胜
      */
     bool checkWin(int row, int col);
 
+signals:
+    /**
+     * @brief 局面或轮到的一方发生变化（落子、悔棋、复盘、重置、读档）
+     */
+    void positionChanged();
+
+    /**
+     * @brief 时钟走动或切换（计时中约每100毫秒一次）
+     */
+    void clockChanged();
+
 protected:
     /**
      * @brief 绘制事件处理函数
@@ -107,10 +183,20 @@ protected:
      */
     void mousePressEvent(QMouseEvent *event) override;
 
+    /**
+     * @brief 键盘事件处理函数（复盘：左右键前进后退，Home/End跳到首尾，上下键切换变化）
+     * @param event 键盘事件对象
+     */
+    void keyPressEvent(QKeyEvent *event) override;
+
 private:
     static const int BOARD_SIZE = 15;    ///< 棋盘大小（15x15）
     static const int CELL_SIZE = 35;     ///< 每个格子的大小（像素）
     static const int MARGIN = 20;        ///< 棋盘边距（像素）
+    static const int STONE_EXTENT = CELL_SIZE - 3;  ///< 棋子精灵图的边长（像素，含描边）
+    static const int REPAINT_CELL_LIMIT = 24;       ///< 复盘跳转超过此步数时整体重绘
+    static const int CLOCK_TICK_MS = 100;           ///< 时钟刷新和超时检查的间隔
+    static const long long AI_STEP_NODES = 4096;    ///< 分步AI每次定时器触发推进的节点数（约几十毫秒）
 
     /**
      * @brief 获胜连线结构体
@@ -123,18 +209,32 @@ private:
         WinLine(const QPoint& s, const QPoint& e) : start(s), end(e), valid(true) {}
     };
 
-    std::vector<std::vector<PieceType>> board;  ///< 棋盘状态数组
+    Position position;                          ///< 棋盘状态（含增量连子长度）
     PieceType currentPlayer;                    ///< 当前玩家
     bool gameOver;                          ///< 游戏是否结束
     bool aiEnabled;                         ///< 是否启用AI
-    std::unique_ptr<AIStrategy> aiStrategy;     ///< AI策略
+    std::unique_ptr<AIStrategy> aiStrategy;     ///< AI策略（同一策略跨局沿用）
+    bool keepSearchState;                   ///< 新局是否保留AI的搜索状态
     PieceType playerPieceType;                 ///< 玩家选择的棋子颜色
     
+    int undoLimit;                          ///< 悔棋次数限制
     int remainingUndos;                     ///< 剩余悔棋次数
-    std::stack<Move> moveHistory;           ///< 移动历史记录
+    int livePly;                            ///< 对局实际进行到的步数（复盘离开这一步后再落子算一次悔棋），终局后复盘时为-1
+    GameHistory history;                    ///< 落子历史（含变化分支）
 
     QPoint lastMove;                        ///< 最后一个落子位置
     WinLine winLine;                        ///< 获胜连线
+    GameJournal journal;                    ///< 自动保存日志
+    std::vector<Move> analysisMoves;        ///< 分析模式下标出的候选着法
+    HeatmapOverlay *heatmap;                ///< 提示热度图图层
+    bool heatmapVisible;                    ///< 是否显示热度图
+    uint64_t heatmapKey;                    ///< 当前局面的热度图键
+    QPixmap gridCache;                      ///< 背景和网格（按设备像素比缓存）
+    QPixmap stoneSprites[2];                ///< 黑、白棋子的精灵图
+    TimeControl timeControl;                ///< 时间控制
+    GameClock clock;                        ///< 对局时钟
+    QTimer *clockTimer;                     ///< 时钟刷新定时器
+    QTimer *aiStepTimer;                    ///< 推进分步AI搜索的定时器（空闲时触发）
 
     /**
      * @brief 绘制棋盘
@@ -143,10 +243,26 @@ private:
     void drawBoard(QPainter &painter);
 
     /**
-     * @brief 绘制棋子
+     * @brief 绘制与area相交的棋子（贴精灵图）
      * @param painter 画笔对象
+     * @param area 重绘区域
+     */
+    void drawPieces(QPainter &painter, const QRect& area);
+
+    /**
+     * @brief 按当前设备像素比生成网格缓存和棋子精灵图（比例不变时直接返回）
+     */
+    void ensureRenderCache();
+
+    /**
+     * @brief 一个交叉点周围需要重绘的矩形（棋子和标记）
      */
-    void drawPieces(QPainter &painter);
+    QRect cellRect(int row, int col) const;
+
+    /**
+     * @brief 当前所有标记（最后落子、变化分支、分析名次、获胜连线）覆盖的区域
+     */
+    QRegion decorationRegion() const;
 
     /**
      * @brief 绘制最后落子标记
@@ -154,6 +270,23 @@ private:
      */
     void drawLastMove(QPainter &painter);
 
+    /**
+     * @brief 绘制下一步的可选变化（存在多个分支时）
+     * @param painter 画笔对象
+     */
+    void drawVariations(QPainter &painter);
+
+    /**
+     * @brief 绘制分析候选着法的名次
+     * @param painter 画笔对象
+     */
+    void drawAnalysis(QPainter &painter);
+
+    /**
+     * @brief 为当前局面请求热度图（显示热度图时随局面变化调用）
+     */
+    void requestHeatmap();
+
     /**
      * @brief 绘制获胜连线
      * @param painter 画笔对象
@@ -179,20 +312,77 @@ private:
     /**
      * @brief 显示游戏结束对话框
      * @param winner 获胜方
+     * @param reason 结束原因（如超时），显示在结果之前
+     */
+    void showGameOver(PieceType winner, const QString& reason = QString());
+
+    /**
+     * @brief 一步完成后切换时钟：结算落子方，未终局时开始为currentPlayer计时
      */
-    void showGameOver(PieceType winner);
+    void advanceClock();
+
+    /**
+     * @brief 定时检查正在走的一方是否超时，超时判负
+     */
+    void checkClock();
 
     /**
      * @brief AI下棋
+     *
+     * 支持分步计算的策略在这里只开始搜索，由aiStepTimer推进；其他策略直接算完落子。
      */
     void makeAIMove();
 
+    /**
+     * @brief 推进一片分步AI搜索，算完后落子
+     */
+    void stepAIMove();
+
+    /**
+     * @brief 落下AI算出的着法（输出搜索统计，AI超时时判负）
+     */
+    void applyAIMove(const Move& move);
+
+    /**
+     * @brief 放弃正在进行的分步AI搜索（局面被新局、悔棋、读档等改变时）
+     */
+    void cancelAIMove();
+
     /**
      * @brief 执行悔棋操作
      * @return 是否成功悔棋
      */
     bool undoMove();
 
+    /**
+     * @brief 记录一步着法：写入历史和日志，并更新最后落子位置
+     */
+    void recordMove(int row, int col, PieceType player);
+
+    /**
+     * @brief 复盘时把棋盘移动到当前线路的第ply步
+     *
+     * 不消耗悔棋次数；日志按步写入悔棋或落子记录，与棋盘保持一致。
+     */
+    void navigateTo(int ply);
+
+    /**
+     * @brief 当前是否允许复盘导航（双人对战随时可用，人机对战仅在终局后）
+     *
+     * 双人对战中导航到别的步数后再落子计一次悔棋，悔棋次数用完时不能落子。
+     */
+    bool canNavigate() const { return !aiEnabled || gameOver; }
+
+    /**
+     * @brief 为当前对局开始新的自动保存日志
+     */
+    void startJournal();
+
+    /**
+     * @brief 结束当前对局的日志：有着法时压缩为存档目录中的棋谱，否则删除
+     */
+    void finishJournal();
+
     /**
      * @brief 创建AI策略实例
      * @param strategyName 策略名称
@@ -0,0 +1,50 @@
+#include "cpu_features.h"
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#include <immintrin.h>
+#define GOMOKU_CPUID_MSVC 1
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define GOMOKU_CPUID_BUILTIN 1
+#endif
+
+namespace CpuFeatures {
+
+bool hasSse2()
+{
+#if defined(GOMOKU_CPUID_MSVC)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[3] & (1 << 26)) != 0;
+#elif defined(GOMOKU_CPUID_BUILTIN)
+    return __builtin_cpu_supports("sse2");
+#else
+    return false;
+#endif
+}
+
+bool hasAvx2()
+{
+#if defined(GOMOKU_CPUID_MSVC)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    __cpuid(info, 1);
+    // 需要OSXSAVE和AVX，并确认操作系统保存了XMM/YMM状态
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#elif defined(GOMOKU_CPUID_BUILTIN)
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
+
+} // namespace CpuFeatures
@@ -0,0 +1,24 @@
+#ifndef CPU_FEATURES_H
+#define CPU_FEATURES_H
+
+/**
+ * @brief 运行时CPU指令集检测
+ *
+ * SIMD内核在编译时按各自的指令集单独编译，运行时通过这里的检测结果
+ * 选择当前CPU能执行的最快实现。非x86平台上所有检测均返回false。
+ */
+namespace CpuFeatures {
+
+/**
+ * @brief 是否支持SSE2
+ */
+bool hasSse2();
+
+/**
+ * @brief 是否支持AVX2（同时要求操作系统已启用YMM寄存器状态保存）
+ */
+bool hasAvx2();
+
+} // namespace CpuFeatures
+
+#endif // CPU_FEATURES_H
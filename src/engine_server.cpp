@@ -0,0 +1,375 @@
+#include "engine_server.h"
+#include <QHostAddress>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QMetaObject>
+#include <QPointer>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <algorithm>
+
+namespace {
+
+constexpr qint64 MAX_LINE_BYTES = 4096;   ///< 超过此长度仍没有换行的连接视为异常并关闭
+
+double percentileMs(std::vector<long long> samples, double fraction)
+{
+    if (samples.empty()) {
+        return 0.0;
+    }
+    const size_t index = std::min(samples.size() - 1, static_cast<size_t>(fraction * samples.size()));
+    std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+    return samples[index] / 1000.0;
+}
+
+} // namespace
+
+EngineServer::EngineServer(const Options& options, QObject* parent)
+    : QObject(parent)
+    , options_(options)
+    , pool_(std::make_unique<WorkStealingPool>(options.threads))
+{
+    statsTimer_.start();
+}
+
+EngineServer::~EngineServer()
+{
+    // 让排队和进行中的搜索尽快结束，随后pool_析构时等待它们；
+    // 它们投递回来的结果随本对象一起被丢弃
+    for (auto& entry : games_) {
+        entry.second->stop.store(true, std::memory_order_relaxed);
+    }
+    pool_.reset();
+}
+
+bool EngineServer::listenLocal(const QString& name)
+{
+    // 上次异常退出可能留下套接字文件
+    QLocalServer::removeServer(name);
+    auto* server = new QLocalServer(this);
+    if (!server->listen(name)) {
+        error_ = server->errorString();
+        delete server;
+        return false;
+    }
+    connect(server, &QLocalServer::newConnection, this, [this, server]() {
+        while (QLocalSocket* socket = server->nextPendingConnection()) {
+            connect(socket, &QLocalSocket::disconnected, this, [this, socket]() {
+                dropClient(socket);
+                socket->deleteLater();
+            });
+            attach(socket);
+        }
+    });
+    address_ = server->fullServerName();
+    return true;
+}
+
+bool EngineServer::listenTcp(quint16 port)
+{
+    auto* server = new QTcpServer(this);
+    if (!server->listen(QHostAddress::LocalHost, port)) {
+        error_ = server->errorString();
+        delete server;
+        return false;
+    }
+    connect(server, &QTcpServer::newConnection, this, [this, server]() {
+        while (QTcpSocket* socket = server->nextPendingConnection()) {
+            socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+            connect(socket, &QTcpSocket::disconnected, this, [this, socket]() {
+                dropClient(socket);
+                socket->deleteLater();
+            });
+            attach(socket);
+        }
+    });
+    address_ = QString("127.0.0.1:%1").arg(server->serverPort());
+    return true;
+}
+
+void EngineServer::attach(QIODevice* socket)
+{
+    ++connections_;
+    // go的回复可能在连接断开之后才产生
+    QPointer<QIODevice> guard(socket);
+    const Reply reply = [guard](const QString& text) {
+        if (guard && guard->isOpen()) {
+            guard->write((text + "\n").toUtf8());
+        }
+    };
+    connect(socket, &QIODevice::readyRead, this, [this, socket, reply]() {
+        while (socket->canReadLine()) {
+            const QString line = QString::fromUtf8(socket->readLine()).trimmed();
+            if (line == "quit") {
+                socket->close();
+                return;
+            }
+            if (!line.isEmpty()) {
+                execute(socket, line, reply);
+            }
+        }
+        if (socket->bytesAvailable() > MAX_LINE_BYTES) {
+            reply("error line too long");
+            socket->close();
+        }
+    });
+}
+
+void EngineServer::dropClient(const QObject* client)
+{
+    --connections_;
+    for (auto it = games_.begin(); it != games_.end();) {
+        if (it->second->owner == client) {
+            it->second->stop.store(true, std::memory_order_relaxed);
+            it = games_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void EngineServer::execute(const QObject* client, const QString& line, const Reply& reply)
+{
+    const QStringList words = line.split(' ', Qt::SkipEmptyParts);
+    if (words.isEmpty()) {
+        return;
+    }
+    const QString& command = words.at(0);
+    if (command == "new") {
+        newGame(client, words, reply);
+    } else if (command == "move") {
+        playMove(words, reply);
+    } else if (command == "go") {
+        startSearch(words, reply);
+    } else if (command == "free") {
+        freeGame(words, reply);
+    } else if (command == "stats") {
+        if (words.size() > 1 && words.at(1) == "reset") {
+            resetStats();
+            reply("ok");
+        } else {
+            reply(formatStats(stats()));
+        }
+    } else if (command == "memory") {
+        reply("memory " + MemoryBudget::summary());
+    } else if (command == "ping") {
+        reply("pong");
+    } else {
+        reply(QString("error unknown command %1").arg(command));
+    }
+}
+
+void EngineServer::newGame(const QObject* client, const QStringList& words, const Reply& reply)
+{
+    if (static_cast<int>(games_.size()) >= options_.maxGames) {
+        reply("error too many games");
+        return;
+    }
+    const size_t tableBytes = static_cast<size_t>(options_.tableMB) * 1024 * 1024;
+    if (MemoryBudget::available(MemoryBudget::TRANSPOSITION_TABLES) < tableBytes) {
+        reply("error memory budget exhausted");
+        return;
+    }
+    int moveTimeMs = options_.moveTimeMs;
+    if (words.size() > 1) {
+        bool ok = false;
+        moveTimeMs = words.at(1).toInt(&ok);
+        if (!ok || moveTimeMs <= 0) {
+            reply("error invalid movetime");
+            return;
+        }
+    }
+    auto game = std::make_shared<Game>(static_cast<size_t>(options_.tableMB));
+    game->searcher.setEvaluator(options_.evaluator);
+    game->owner = client;
+    game->moveTimeMs = moveTimeMs;
+    const int id = nextId_++;
+    games_.emplace(id, std::move(game));
+    reply(QString("ok %1").arg(id));
+}
+
+std::shared_ptr<EngineServer::Game> EngineServer::findGame(const QString& word, const Reply& reply) const
+{
+    bool ok = false;
+    const auto it = games_.find(word.toInt(&ok));
+    if (!ok || it == games_.end()) {
+        reply(QString("error unknown game %1").arg(word));
+        return nullptr;
+    }
+    return it->second;
+}
+
+void EngineServer::playMove(const QStringList& words, const Reply& reply)
+{
+    if (words.size() != 4) {
+        reply("error usage: move <id> <row> <col>");
+        return;
+    }
+    const std::shared_ptr<Game> game = findGame(words.at(1), reply);
+    if (!game) {
+        return;
+    }
+    bool rowOk = false;
+    bool colOk = false;
+    const int row = words.at(2).toInt(&rowOk);
+    const int col = words.at(3).toInt(&colOk);
+    if (game->searching) {
+        reply(QString("error game %1 is searching").arg(words.at(1)));
+    } else if (game->over) {
+        reply(QString("error game %1 is over").arg(words.at(1)));
+    } else if (!rowOk || !colOk || row < 0 || row >= Position::SIZE || col < 0 || col >= Position::SIZE ||
+               game->position.getPiece(row, col) != PieceType::NONE) {
+        reply("error illegal move");
+    } else {
+        const bool wins = game->position.placePiece(row, col, game->toMove);
+        game->over = wins || game->position.isFull();
+        game->toMove = game->toMove == PieceType::BLACK ? PieceType::WHITE : PieceType::BLACK;
+        reply(wins ? "ok win" : "ok");
+    }
+}
+
+void EngineServer::startSearch(const QStringList& words, const Reply& reply)
+{
+    if (words.size() != 2) {
+        reply("error usage: go <id>");
+        return;
+    }
+    const std::shared_ptr<Game> game = findGame(words.at(1), reply);
+    if (!game) {
+        return;
+    }
+    if (game->searching) {
+        reply(QString("error game %1 is searching").arg(words.at(1)));
+        return;
+    }
+    if (game->over) {
+        reply(QString("error game %1 is over").arg(words.at(1)));
+        return;
+    }
+
+    const int id = words.at(1).toInt();
+    const Clock::time_point requested = Clock::now();
+    game->searching = true;
+    ++searching_;
+    // 根局面复制一份给搜索任务：搜索期间主线程不修改对局，但任务不应依赖这一点
+    game->root = game->position;
+    game->rootToMove = game->toMove;
+    game->retried = false;
+    game->nodes = 0;
+    Searcher::Limits limits;
+    limits.maxTimeMs = game->moveTimeMs;
+    game->searcher.start(game->root, game->rootToMove, limits);
+    pool_->submit([this, id, game, requested, reply]() {
+        searchSlice(id, game, requested, reply);
+    });
+}
+
+void EngineServer::searchSlice(int id, const std::shared_ptr<Game>& game, Clock::time_point requested,
+                               const Reply& reply)
+{
+    Searcher& searcher = game->searcher;
+    if (!searcher.step(options_.sliceNodes)) {
+        // 本片用完，排到队尾让其他对局的搜索先推进
+        pool_->submit([this, id, game, requested, reply]() {
+            searchSlice(id, game, requested, reply);
+        });
+        return;
+    }
+    const Searcher::Result& result = searcher.bestSoFar();
+    game->nodes += result.nodes;
+    if (result.lineCount == 0 && !game->retried && !game->stop.load(std::memory_order_relaxed)) {
+        // 时限短到第一层都没搜完时（排队太久或机器过载），不限时补搜一层
+        Searcher::Limits limits;
+        limits.maxDepth = 1;
+        game->retried = true;
+        searcher.start(game->root, game->rootToMove, limits);
+        pool_->submit([this, id, game, requested, reply]() {
+            searchSlice(id, game, requested, reply);
+        });
+        return;
+    }
+    const Move move = result.lineCount > 0 ? result.lines[0].move() : Move();
+    const long long nodes = game->nodes;
+    QMetaObject::invokeMethod(this, [this, id, game, move, nodes, requested, reply]() {
+        finishSearch(id, game, move, nodes, requested, reply);
+    }, Qt::QueuedConnection);
+}
+
+void EngineServer::finishSearch(int id, const std::shared_ptr<Game>& game, Move move, long long nodes,
+                                Clock::time_point requested, const Reply& reply)
+{
+    --searching_;
+    nodes_ += nodes;
+    const auto it = games_.find(id);
+    if (it == games_.end() || it->second != game) {
+        // 搜索期间对局已被释放
+        return;
+    }
+    game->searching = false;
+    if (move.row < 0 || game->position.getPiece(move.row, move.col) != PieceType::NONE) {
+        reply(QString("error game %1 search failed").arg(id));
+        return;
+    }
+    const bool wins = game->position.placePiece(move.row, move.col, game->toMove);
+    game->over = wins || game->position.isFull();
+    game->toMove = game->toMove == PieceType::BLACK ? PieceType::WHITE : PieceType::BLACK;
+    latenciesUs_.push_back(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - requested).count());
+    reply(QString("bestmove %1 %2 %3%4").arg(id).arg(move.row).arg(move.col).arg(wins ? " win" : ""));
+}
+
+void EngineServer::freeGame(const QStringList& words, const Reply& reply)
+{
+    if (words.size() != 2) {
+        reply("error usage: free <id>");
+        return;
+    }
+    const std::shared_ptr<Game> game = findGame(words.at(1), reply);
+    if (!game) {
+        return;
+    }
+    game->stop.store(true, std::memory_order_relaxed);
+    games_.erase(words.at(1).toInt());
+    reply("ok");
+}
+
+EngineServer::Stats EngineServer::stats() const
+{
+    Stats stats;
+    stats.connections = connections_;
+    stats.games = static_cast<int>(games_.size());
+    stats.searching = searching_;
+    stats.moves = static_cast<long long>(latenciesUs_.size());
+    stats.nodes = nodes_;
+    stats.p50Ms = percentileMs(latenciesUs_, 0.50);
+    stats.p99Ms = percentileMs(latenciesUs_, 0.99);
+    stats.maxMs = latenciesUs_.empty() ? 0.0 : *std::max_element(latenciesUs_.begin(), latenciesUs_.end()) / 1000.0;
+    const qint64 elapsedMs = statsTimer_.elapsed();
+    stats.movesPerSecond = elapsedMs > 0 ? stats.moves * 1000.0 / elapsedMs : 0.0;
+    stats.threads = pool_->threadCount();
+    stats.stolen = pool_->stolenCount();
+    return stats;
+}
+
+void EngineServer::resetStats()
+{
+    latenciesUs_.clear();
+    nodes_ = 0;
+    statsTimer_.restart();
+}
+
+QString EngineServer::formatStats(const Stats& stats)
+{
+    return QString("stats connections=%1 games=%2 searching=%3 moves=%4 nodes=%5 "
+                   "p50_ms=%6 p99_ms=%7 max_ms=%8 moves_per_s=%9 threads=%10 stolen=%11")
+        .arg(stats.connections)
+        .arg(stats.games)
+        .arg(stats.searching)
+        .arg(stats.moves)
+        .arg(stats.nodes)
+        .arg(stats.p50Ms, 0, 'f', 1)
+        .arg(stats.p99Ms, 0, 'f', 1)
+        .arg(stats.maxMs, 0, 'f', 1)
+        .arg(stats.movesPerSecond, 0, 'f', 1)
+        .arg(stats.threads)
+        .arg(stats.stolen);
+}
@@ -0,0 +1,188 @@
+#ifndef ENGINE_SERVER_H
+#define ENGINE_SERVER_H
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "position.h"
+#include "searcher.h"
+#include "transposition_table.h"
+#include "work_stealing_pool.h"
+
+class QIODevice;
+
+/**
+ * @brief 本地引擎服务：多局对局共用一个搜索线程池
+ *
+ * 在Unix域套接字（Windows上为命名管道）或本机TCP端口上监听，每个连接发送按行分隔的文本命令：
+ * @code
+ *   new [movetime]          -> ok <id>                      新建对局，可指定每步思考毫秒数
+ *   move <id> <row> <col>   -> ok | ok win                  为轮到的一方落子
+ *   go <id>                 -> bestmove <id> <row> <col> [win]   AI为轮到的一方落子（异步返回）
+ *   free <id>               -> ok                           结束对局，正在进行的搜索随即停止
+ *   stats [reset]           -> stats games=... moves=... p50_ms=... p99_ms=... moves_per_s=...
+ *   memory                  -> memory limit_mb=... tt_mb=... tt_resident_mb=... rss_mb=...
+ *   ping                    -> pong
+ *   quit                                                    关闭连接
+ * @endcode
+ * 出错时回复"error <原因>"。置换表额度（见MemoryBudget）不足以再建一张整表时new回复
+ * "error memory budget exhausted"。go的结果在搜索完成后才回复，同一连接可以同时对多局发出go，
+ * 按完成顺序收到bestmove；对同一局在结果返回前再发go或move会被拒绝。
+ *
+ * 每局有自己的局面、置换表和搜索器，局面只在主线程（事件循环所在线程）上修改。go在主线程上
+ * 开始分步搜索（Searcher::start），之后每个池任务只推进sliceNodes个节点：没搜完就把自己重新
+ * 提交到队尾，让同时在搜的其他对局轮流推进，少数线程就能公平地服务大量对局，不会被一局长搜索
+ * 占住线程。搜完后把结果投递回主线程落子并回复。连接断开时释放它创建的所有对局。
+ *
+ * 每步时限也从收到go时算起：负载高时每局分到的搜索时间随之减少，但走子延迟不会随排队无限增长。
+ *
+ * 走子延迟从收到go到发出bestmove计时（包含在线程池中排队的时间），stats按全部已完成的go统计分位数。
+ */
+class EngineServer : public QObject {
+    Q_OBJECT
+
+public:
+    /**
+     * @brief 服务参数
+     */
+    struct Options {
+        int threads = 0;               ///< 搜索线程数，0表示使用硬件并发数
+        int tableMB = 4;               ///< 每局置换表大小（MB）
+        int moveTimeMs = 200;          ///< 默认每步思考时间（毫秒）
+        long long sliceNodes = 20000;  ///< 每个池任务最多推进的节点数（约几毫秒）
+        int maxGames = 1024;           ///< 同时存在的对局数上限
+        QString evaluator = "Pattern"; ///< 评估函数名称
+    };
+
+    /**
+     * @brief 运行统计
+     */
+    struct Stats {
+        int connections = 0;           ///< 当前连接数
+        int games = 0;                 ///< 当前对局数
+        int searching = 0;             ///< 正在排队或搜索的go请求数
+        long long moves = 0;           ///< 已完成的go请求数
+        long long nodes = 0;           ///< 这些搜索的总节点数
+        double p50Ms = 0.0;            ///< 走子延迟中位数（毫秒）
+        double p99Ms = 0.0;            ///< 走子延迟99分位（毫秒）
+        double maxMs = 0.0;            ///< 最大走子延迟（毫秒）
+        double movesPerSecond = 0.0;   ///< 自上次重置统计以来的吞吐量
+        int threads = 0;               ///< 线程池线程数
+        long long stolen = 0;          ///< 线程池累计窃取的任务数
+    };
+
+    /**
+     * @brief 回复一行文本（不含换行）
+     */
+    using Reply = std::function<void(const QString&)>;
+
+    explicit EngineServer(const Options& options, QObject* parent = nullptr);
+    ~EngineServer() override;
+
+    /**
+     * @brief 在本地套接字上监听（同名的残留套接字先删除）
+     */
+    bool listenLocal(const QString& name);
+
+    /**
+     * @brief 在127.0.0.1的TCP端口上监听
+     */
+    bool listenTcp(quint16 port);
+
+    /**
+     * @brief 监听的完整地址（套接字路径或host:port）
+     */
+    QString address() const { return address_; }
+
+    QString errorString() const { return error_; }
+
+    /**
+     * @brief 执行一行命令（不含"quit"）
+     * @param client 发出命令的连接，断开时释放它创建的对局
+     * @param line 命令行
+     * @param reply 回复函数；go的结果稍后在主线程上通过它回复
+     */
+    void execute(const QObject* client, const QString& line, const Reply& reply);
+
+    /**
+     * @brief 当前统计
+     */
+    Stats stats() const;
+
+    /**
+     * @brief 清空延迟样本并重新开始计算吞吐量
+     */
+    void resetStats();
+
+    /**
+     * @brief 格式化为一行"stats ..."回复
+     */
+    static QString formatStats(const Stats& stats);
+
+private:
+    /**
+     * @brief 一局对局
+     */
+    struct Game {
+        explicit Game(size_t tableMB) : table(tableMB), searcher(table) { searcher.setStopFlag(&stop); }
+
+        Position position;
+        PieceType toMove = PieceType::BLACK;
+        TranspositionTable table;      ///< 只被该局当前的搜索任务使用
+        std::atomic<bool> stop{false}; ///< 释放对局时置位
+        const QObject* owner = nullptr;
+        int moveTimeMs = 0;
+        bool searching = false;        ///< 有go请求尚未返回
+        bool over = false;             ///< 已分胜负或下满
+
+        // 以下在go时由主线程设置，之后只被该局的搜索任务（同一时刻至多一个）使用
+        Searcher searcher;             ///< 分步推进的搜索
+        Position root;                 ///< 本次go的根局面
+        PieceType rootToMove = PieceType::BLACK;
+        bool retried = false;          ///< 已不限时补搜过第一层
+        long long nodes = 0;           ///< 本次go已搜的节点数
+    };
+
+    using Clock = std::chrono::steady_clock;
+
+    // 处理新连接：按行读取命令，断开时释放对局
+    void attach(QIODevice* socket);
+    void dropClient(const QObject* client);
+
+    // 命令
+    void newGame(const QObject* client, const QStringList& words, const Reply& reply);
+    void playMove(const QStringList& words, const Reply& reply);
+    void startSearch(const QStringList& words, const Reply& reply);
+    void freeGame(const QStringList& words, const Reply& reply);
+
+    // 按命令参数找到对局，找不到时回复错误并返回空
+    std::shared_ptr<Game> findGame(const QString& word, const Reply& reply) const;
+
+    // 在池线程上推进一片搜索，没搜完时重新提交自己
+    void searchSlice(int id, const std::shared_ptr<Game>& game, Clock::time_point requested, const Reply& reply);
+
+    // 在主线程上应用搜索结果
+    void finishSearch(int id, const std::shared_ptr<Game>& game, Move move, long long nodes,
+                      Clock::time_point requested, const Reply& reply);
+
+    Options options_;
+    std::unordered_map<int, std::shared_ptr<Game>> games_;
+    int nextId_ = 1;
+    int connections_ = 0;
+    int searching_ = 0;
+    long long nodes_ = 0;
+    std::vector<long long> latenciesUs_;   ///< 每个已完成go请求的延迟（微秒）
+    QElapsedTimer statsTimer_;
+    QString address_;
+    QString error_;
+    std::unique_ptr<WorkStealingPool> pool_;  ///< 最后声明：析构时最先等待任务结束
+};
+
+#endif // ENGINE_SERVER_H
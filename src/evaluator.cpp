@@ -0,0 +1,18 @@
+#include "evaluator.h"
+#include "pattern_evaluator.h"
+#include "nnue_evaluator.h"
+
+std::unique_ptr<Evaluator> Evaluator::create(const QString& name)
+{
+    if (name == "Pattern") {
+        return std::make_unique<PatternEvaluator>();
+    } else if (name == "NNUE") {
+        auto network = NnueNetwork::shared();
+        if (network) {
+            return std::make_unique<NnueEvaluator>(std::move(network));
+        }
+        return nullptr;
+    }
+    // 在这里添加其他评估函数的创建
+    return nullptr;
+}
@@ -0,0 +1,58 @@
+#ifndef EVALUATOR_H
+#define EVALUATOR_H
+
+#include <QString>
+#include <memory>
+#include <vector>
+#include "game_types.h"
+
+/**
+ * @brief 局面评估函数接口
+ *
+ * 搜索开始时用reset()传入根局面，之后每次落子/撤销都会通知评估函数，
+ * 使其可以增量维护内部状态（如神经网络第一层的累加器）。
+ * 一个评估函数实例只被一个搜索线程使用。
+ */
+class Evaluator {
+public:
+    virtual ~Evaluator() = default;
+
+    /**
+     * @brief 获取评估函数名称
+     */
+    virtual QString getName() const = 0;
+
+    /**
+     * @brief 以根局面初始化
+     * @param boardState 根局面
+     */
+    virtual void reset(const std::vector<std::vector<PieceType>>& boardState) = 0;
+
+    /**
+     * @brief 通知落子
+     */
+    virtual void makeMove(int row, int col, PieceType piece) = 0;
+
+    /**
+     * @brief 通知撤销落子（与makeMove严格按后进先出顺序配对）
+     */
+    virtual void unmakeMove(int row, int col, PieceType piece) = 0;
+
+    /**
+     * @brief 评估当前局面
+     * @param boardState 当前局面（与reset/makeMove/unmakeMove的累计结果一致）
+     * @param currentPlayer 评估视角
+     * @return 评分，正值对currentPlayer有利
+     */
+    virtual int evaluate(const std::vector<std::vector<PieceType>>& boardState,
+                         PieceType currentPlayer) = 0;
+
+    /**
+     * @brief 按名称创建评估函数
+     * @param name "Pattern"（棋型评估）或"NNUE"（神经网络评估）
+     * @return 评估函数实例；名称未知或所需权重文件无法加载时返回nullptr
+     */
+    static std::unique_ptr<Evaluator> create(const QString& name);
+};
+
+#endif // EVALUATOR_H
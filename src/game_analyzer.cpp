@@ -0,0 +1,315 @@
+#include "game_analyzer.h"
+#include "evaluator.h"
+#include "position.h"
+#include "profiler.h"
+#include "searcher.h"
+#include "transposition_table.h"
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSet>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+namespace {
+
+/**
+ * @brief 待分析的存档及其输出文件
+ */
+struct Job {
+    QString input;
+    QString output;
+};
+
+/**
+ * @brief 单个存档的分析结果
+ */
+struct JobResult {
+    bool ok = false;
+    qint64 plies = 0;
+    qint64 nodes = 0;
+    qint64 blunders = 0;
+};
+
+QString moveText(const Move& move)
+{
+    return move.row >= 0 ? QString("%1,%2").arg(move.row).arg(move.col) : QString();
+}
+
+QString playerName(PieceType player)
+{
+    switch (player) {
+    case PieceType::BLACK: return "black";
+    case PieceType::WHITE: return "white";
+    default: return "none";
+    }
+}
+
+PieceType opponentOf(PieceType piece)
+{
+    return piece == PieceType::BLACK ? PieceType::WHITE : PieceType::BLACK;
+}
+
+bool isGlob(const QString& path)
+{
+    return path.contains("*") || path.contains("?") || path.contains("[");
+}
+
+// 输出文件名：相对路径换成.json扩展名，重名时追加序号
+QString outputName(const QString& relative, QSet<QString>& used)
+{
+    const int dot = relative.lastIndexOf('.');
+    const QString stem = dot > relative.lastIndexOf('/') ? relative.left(dot) : relative;
+    QString name = stem + ".json";
+    for (int i = 2; used.contains(name); ++i) {
+        name = QString("%1-%2.json").arg(stem).arg(i);
+    }
+    used.insert(name);
+    return name;
+}
+
+} // namespace
+
+QJsonObject GameAnalyzer::GameAnnotation::toJson(const Options& options) const
+{
+    QJsonArray curve;
+    for (int score : evalCurve) {
+        curve.append(score);
+    }
+
+    QJsonArray moveArray;
+    for (size_t i = 0; i < moves.size(); ++i) {
+        const MoveAnnotation& m = moves[i];
+        QJsonObject object;
+        object["ply"] = static_cast<int>(i + 1);
+        object["player"] = playerName(m.move.player);
+        object["move"] = moveText(m.move);
+        object["best"] = moveText(m.best);
+        object["bestScore"] = m.bestScore;
+        object["playedScore"] = m.playedScore;
+        object["loss"] = m.loss;
+        object["depth"] = m.depth;
+        object["blunder"] = m.blunder;
+        moveArray.append(object);
+    }
+
+    QJsonObject object;
+    object["file"] = file;
+    object["evaluator"] = options.evaluator;
+    object["nodeBudget"] = static_cast<double>(options.nodeBudget);
+    object["plies"] = static_cast<int>(moves.size());
+    object["winner"] = playerName(winner);
+    object["nodes"] = static_cast<double>(nodes);
+    object["elapsedMs"] = elapsedUs / 1000.0;
+    object["evalCurve"] = curve;
+    object["moves"] = moveArray;
+    return object;
+}
+
+bool GameAnalyzer::analyze(const std::vector<GameSave::Move>& moves, Searcher& searcher,
+                           const Options& options, GameAnnotation& annotation)
+{
+    PROFILE_ZONE("GameAnalyzer::analyze");
+    const auto startTime = std::chrono::steady_clock::now();
+    const int count = static_cast<int>(moves.size());
+    annotation.moves.assign(count, MoveAnnotation());
+    annotation.evalCurve.assign(count + 1, 0);
+    annotation.winner = PieceType::NONE;
+    annotation.nodes = 0;
+
+    // scores[i]：第i步之前的局面中轮到一方的分数
+    std::vector<int> scores(count + 1, 0);
+    Searcher::Limits limits;
+    limits.maxNodes = options.nodeBudget;
+
+    Position position;
+    PieceType toMove = PieceType::BLACK;
+    for (int i = 0; i <= count; ++i) {
+        if (i < count) {
+            toMove = moves[i].player;
+            if (position.lastMoveWins() || (toMove != PieceType::BLACK && toMove != PieceType::WHITE)) {
+                return false;
+            }
+        } else if (count > 0) {
+            toMove = opponentOf(moves[count - 1].player);
+        }
+
+        if (position.lastMoveWins()) {
+            // 对方刚连五：与搜索中"立即连五"的分数一致
+            scores[i] = -(Searcher::WIN_SCORE - 1);
+            annotation.winner = opponentOf(toMove);
+        } else if (!position.isFull()) {
+            const Searcher::Result result = searcher.search(position, toMove, limits);
+            annotation.nodes += result.nodes;
+            if (result.lineCount > 0) {
+                scores[i] = result.lines[0].score;
+                if (i < count) {
+                    annotation.moves[i].best = result.lines[0].move();
+                    annotation.moves[i].depth = result.depth;
+                }
+            }
+        }
+        annotation.evalCurve[i] = toMove == PieceType::BLACK ? scores[i] : -scores[i];
+
+        if (i < count) {
+            const GameSave::Move& move = moves[i];
+            if (move.row < 0 || move.row >= Position::SIZE || move.col < 0 || move.col >= Position::SIZE ||
+                position.getPiece(move.row, move.col) != PieceType::NONE) {
+                return false;
+            }
+            position.placePiece(move.row, move.col, move.player);
+            annotation.moves[i].move = Move(move.row, move.col, move.player);
+        }
+    }
+
+    for (int i = 0; i < count; ++i) {
+        MoveAnnotation& m = annotation.moves[i];
+        if (m.best.row < 0) {
+            // 节点数不足以完成第一层，不评价这一步
+            m.bestScore = m.playedScore = -scores[i + 1];
+            continue;
+        }
+        m.bestScore = scores[i];
+        const bool same = m.best.row == m.move.row && m.best.col == m.move.col;
+        m.playedScore = same ? m.bestScore : -scores[i + 1];
+        m.loss = std::max(0, m.bestScore - m.playedScore);
+        m.blunder = m.loss >= options.blunderThreshold;
+    }
+
+    annotation.elapsedUs = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - startTime).count();
+    return true;
+}
+
+bool GameAnalyzer::expandPath(const QString& path, QStringList& files, QString* basePath)
+{
+    QStringList found;
+    QDir base;
+    QFileInfo info(path);
+    if (isGlob(path)) {
+        base = info.dir();
+        QDirIterator it(base.path(), {info.fileName()}, QDir::Files);
+        while (it.hasNext()) {
+            found.append(it.next());
+        }
+    } else if (info.isDir()) {
+        base = QDir(path);
+        QDirIterator it(path, {"*.gomoku", "*.gmkr"}, QDir::Files, QDirIterator::Subdirectories);
+        while (it.hasNext()) {
+            found.append(it.next());
+        }
+    } else if (info.isFile()) {
+        base = info.dir();
+        found.append(path);
+    } else {
+        return false;
+    }
+    std::sort(found.begin(), found.end());
+    files.append(found);
+    if (basePath) {
+        *basePath = base.path();
+    }
+    return true;
+}
+
+bool GameAnalyzer::run(const QString& outputDir, Stats* stats)
+{
+    Stats localStats;
+    Stats& s = stats ? *stats : localStats;
+    s = Stats();
+
+    if (!Evaluator::create(options_.evaluator)) {
+        error_ = QString("无法创建评估函数 %1").arg(options_.evaluator);
+        return false;
+    }
+
+    // 收集存档，排序保证输出文件名稳定
+    std::vector<Job> jobs;
+    QSet<QString> used;
+    for (const QString& path : paths_) {
+        QStringList files;
+        QString basePath;
+        if (!expandPath(path, files, &basePath)) {
+            error_ = QString("找不到 %1").arg(path);
+            return false;
+        }
+        const QDir base(basePath);
+        for (const QString& file : files) {
+            jobs.push_back({file, QDir(outputDir).filePath(outputName(base.relativeFilePath(file), used))});
+        }
+    }
+    s.files = static_cast<int>(jobs.size());
+
+    // 输出目录在分发前建好，工作线程只写文件
+    for (const Job& job : jobs) {
+        const QString dir = QFileInfo(job.output).absolutePath();
+        if (!QDir().mkpath(dir)) {
+            error_ = QString("无法创建目录 %1").arg(dir);
+            return false;
+        }
+    }
+
+    int threads = threadCount_ > 0 ? threadCount_ : static_cast<int>(std::thread::hardware_concurrency());
+    threads = std::max(1, std::min(threads, static_cast<int>(jobs.size())));
+
+    // 按对局动态分配，长短不一的对局也能均衡
+    std::vector<JobResult> results(jobs.size());
+    std::atomic<int> nextJob{0};
+    auto worker = [&]() {
+        TranspositionTable table(options_.tableMB);
+        Searcher searcher(table);
+        searcher.setEvaluator(options_.evaluator);
+        GameAnnotation annotation;
+        for (int i = nextJob++; i < static_cast<int>(jobs.size()); i = nextJob++) {
+            GameSave::SaveData data;
+            if (!GameSave::loadGame(jobs[i].input, data)) {
+                continue;
+            }
+            // 每局从空的置换表和历史分数开始，结果与对局分到哪个线程无关
+            table.clear();
+            searcher.clearHistory();
+            if (!analyze(data.history, searcher, options_, annotation)) {
+                continue;
+            }
+            annotation.file = jobs[i].input;
+            QFile file(jobs[i].output);
+            if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+                continue;
+            }
+            file.write(QJsonDocument(annotation.toJson(options_)).toJson());
+
+            JobResult& result = results[i];
+            result.ok = true;
+            result.plies = static_cast<qint64>(annotation.moves.size());
+            result.nodes = annotation.nodes;
+            result.blunders = std::count_if(annotation.moves.begin(), annotation.moves.end(),
+                                            [](const MoveAnnotation& m) { return m.blunder; });
+        }
+    };
+    std::vector<std::thread> workers;
+    for (int t = 1; t < threads; ++t) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : workers) {
+        thread.join();
+    }
+
+    for (const JobResult& result : results) {
+        if (!result.ok) {
+            ++s.failedFiles;
+            continue;
+        }
+        ++s.games;
+        s.plies += result.plies;
+        s.nodes += result.nodes;
+        s.blunders += result.blunders;
+    }
+    error_.clear();
+    return true;
+}
@@ -0,0 +1,121 @@
+#ifndef GAME_ANALYZER_H
+#define GAME_ANALYZER_H
+
+#include <QJsonObject>
+#include <QString>
+#include <QStringList>
+#include <vector>
+#include "game_types.h"
+#include "gamesave.h"
+
+class Searcher;
+
+/**
+ * @brief 批量分析存档：逐步搜索每个局面，给出形势曲线、最佳着法和每步的损失
+ *
+ * 每个存档通过GameSave::loadGame读取后重放，对每一步之前的局面以固定节点数搜索，
+ * 得到轮到一方的分数和最佳着法；实战着法的分数取下一局面分数的相反数
+ * （与最佳着法相同时直接取最佳着法的分数），两者之差即为该步的损失。
+ * 对局按文件分给多个线程，每个线程有自己的置换表和搜索器，
+ * 每局开始时清空置换表，结果与线程数无关。
+ */
+class GameAnalyzer {
+public:
+    /**
+     * @brief 分析参数
+     */
+    struct Options {
+        long long nodeBudget = 20000;    ///< 每个局面的节点数
+        int tableMB = 16;                ///< 每个线程的置换表大小（MB）
+        QString evaluator = "Pattern";   ///< 评估函数
+        int blunderThreshold = 3000;     ///< 损失不低于此值的着法记为败着
+    };
+
+    /**
+     * @brief 一步棋的分析结果（分数均为落子一方视角）
+     */
+    struct MoveAnnotation {
+        Move move;                 ///< 实战着法（含落子方）
+        Move best;                 ///< 引擎的最佳着法，局面未能搜索时行列为-1
+        int bestScore = 0;         ///< 最佳着法的分数
+        int playedScore = 0;       ///< 实战着法的分数
+        int loss = 0;              ///< 损失（不小于0）
+        int depth = 0;             ///< 完成的搜索深度
+        bool blunder = false;      ///< 是否为败着
+    };
+
+    /**
+     * @brief 一局的分析结果
+     */
+    struct GameAnnotation {
+        QString file;                        ///< 存档文件
+        std::vector<MoveAnnotation> moves;   ///< 每步的分析
+        std::vector<int> evalCurve;          ///< 第0..n步之后的形势（黑方视角），共n+1个
+        PieceType winner = PieceType::NONE;  ///< 胜方
+        long long nodes = 0;                 ///< 总节点数
+        long long elapsedUs = 0;             ///< 用时（微秒）
+
+        /**
+         * @brief 转为JSON（着法写作"行,列"）
+         */
+        QJsonObject toJson(const Options& options) const;
+    };
+
+    /**
+     * @brief 分析统计
+     */
+    struct Stats {
+        int files = 0;           ///< 找到的存档数
+        int failedFiles = 0;     ///< 无法读取或着法非法的存档数
+        int games = 0;           ///< 分析完成的对局数
+        qint64 plies = 0;        ///< 分析的步数
+        qint64 nodes = 0;        ///< 总节点数
+        qint64 blunders = 0;     ///< 败着数
+    };
+
+    /**
+     * @brief 添加存档文件、目录（递归搜索 *.gomoku 和 *.gmkr）或通配符（如 games/2024-*.gomoku）
+     */
+    void addPath(const QString& path) { paths_.append(path); }
+
+    /**
+     * @brief 线程数，0表示使用全部硬件线程
+     */
+    void setThreadCount(int threads) { threadCount_ = threads; }
+
+    void setOptions(const Options& options) { options_ = options; }
+
+    /**
+     * @brief 分析所有存档，每局写出一个JSON文件到outputDir（保持目录输入中的相对路径）
+     */
+    bool run(const QString& outputDir, Stats* stats = nullptr);
+
+    QString errorString() const { return error_; }
+
+    /**
+     * @brief 展开一个存档路径（规则同addPath）
+     * @param files 追加找到的文件（按路径排序）
+     * @param basePath 输出相对路径的基准目录（可为nullptr）
+     * @return 路径不存在时返回false
+     */
+    static bool expandPath(const QString& path, QStringList& files, QString* basePath = nullptr);
+
+    /**
+     * @brief 分析一局
+     * @param moves 着法序列（黑方先行）
+     * @param searcher 搜索器（调用前应已设置评估函数，置换表由调用方清空）
+     * @param options 分析参数
+     * @param annotation 输出
+     * @return 着法非法时返回false
+     */
+    static bool analyze(const std::vector<GameSave::Move>& moves, Searcher& searcher,
+                        const Options& options, GameAnnotation& annotation);
+
+private:
+    QStringList paths_;
+    int threadCount_ = 0;
+    Options options_;
+    QString error_;
+};
+
+#endif // GAME_ANALYZER_H
@@ -0,0 +1,119 @@
+#include "game_clock.h"
+#include "position.h"
+#include <algorithm>
+
+void GameClock::reset(const TimeControl& control)
+{
+    control_ = control;
+    remaining_[0] = remaining_[1] = control.mode == TimeControl::Mode::Fischer ? control.baseMs : 0;
+    running_ = PieceType::NONE;
+}
+
+void GameClock::start(PieceType side)
+{
+    pause();
+    if (control_.isUnlimited()) {
+        return;
+    }
+    running_ = side;
+    startedAt_ = Clock::now();
+}
+
+void GameClock::finishMove()
+{
+    if (!isRunning()) {
+        return;
+    }
+    const PieceType side = running_;
+    pause();
+    if (control_.mode == TimeControl::Mode::Fischer) {
+        remaining_[index(side)] += control_.incrementMs;
+    }
+}
+
+void GameClock::pause()
+{
+    if (!isRunning()) {
+        return;
+    }
+    // 每步限时不累计，下一步重新计时
+    if (control_.mode == TimeControl::Mode::Fischer) {
+        remaining_[index(running_)] -= elapsedMs();
+    }
+    running_ = PieceType::NONE;
+}
+
+int GameClock::elapsedMs() const
+{
+    return static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        Clock::now() - startedAt_).count());
+}
+
+int GameClock::remainingMs(PieceType side) const
+{
+    const int running = running_ == side ? elapsedMs() : 0;
+    switch (control_.mode) {
+    case TimeControl::Mode::Fischer:
+        return remaining_[index(side)] - running;
+    case TimeControl::Mode::PerMove:
+        return control_.moveMs - running;
+    default:
+        return -1;
+    }
+}
+
+bool GameClock::isFlagged(PieceType side) const
+{
+    return !control_.isUnlimited() && remainingMs(side) <= 0;
+}
+
+TimeBudget GameClock::allocate(PieceType side, const Position& position) const
+{
+    TimeBudget budget;
+    if (control_.isUnlimited()) {
+        return budget;
+    }
+
+    const double factor = complexity(position);
+    const int available = std::max(MIN_BUDGET_MS, remainingMs(side) - OVERHEAD_MS);
+    if (control_.mode == TimeControl::Mode::PerMove) {
+        // 每步限时：硬时限用满，平静的局面提前结束
+        budget.hardMs = available;
+        budget.softMs = static_cast<int>(available * 0.5 * factor);
+    } else {
+        // 剩余时间平摊到预计的剩余步数，加上大部分增量
+        const int movesToGo = std::max(MIN_MOVES_TO_GO, EXPECTED_MOVES - position.getStoneCount() / 2);
+        const int share = available / movesToGo + control_.incrementMs * 3 / 4;
+        budget.softMs = static_cast<int>(share * factor);
+        budget.hardMs = std::min(budget.softMs * HARD_FACTOR, available / 3 + control_.incrementMs);
+    }
+    budget.hardMs = std::clamp(budget.hardMs, MIN_BUDGET_MS, available);
+    budget.softMs = std::clamp(budget.softMs, MIN_BUDGET_MS, budget.hardMs);
+    return budget;
+}
+
+double GameClock::complexity(const Position& position)
+{
+    // 数出落子即可成四或连五的空位，最多计4个
+    const int MAX_THREATS = 4;
+    int threats = 0;
+    const PieceType sides[] = {PieceType::BLACK, PieceType::WHITE};
+    for (int cell = 0; cell < Position::CELLS && threats < MAX_THREATS; ++cell) {
+        const int row = cell / Position::SIZE;
+        const int col = cell % Position::SIZE;
+        if (position.getPiece(row, col) != PieceType::NONE) {
+            continue;
+        }
+        for (PieceType side : sides) {
+            int longest = 0;
+            for (int axis = 0; axis < 4; ++axis) {
+                longest = std::max(longest, position.lineLengthIfPlaced(row, col, side, axis));
+            }
+            if (longest >= 4) {
+                ++threats;
+                break;
+            }
+        }
+    }
+    return 1.0 + 0.25 * threats;
+}
@@ -0,0 +1,108 @@
+#ifndef GAME_CLOCK_H
+#define GAME_CLOCK_H
+
+#include <chrono>
+#include "ai_strategy.h"
+#include "game_types.h"
+
+class Position;
+
+/**
+ * @brief 时间控制
+ */
+struct TimeControl {
+    enum class Mode {
+        Unlimited,   ///< 不限时（AI按难度使用默认思考时间）
+        Fischer,     ///< 基本时间 + 每步加秒
+        PerMove      ///< 每步固定时间
+    };
+
+    Mode mode = Mode::Unlimited;
+    int baseMs = 0;         ///< 基本时间（Fischer）
+    int incrementMs = 0;    ///< 每步加秒（Fischer）
+    int moveMs = 0;         ///< 每步时间（PerMove）
+
+    static TimeControl fischer(int baseMs, int incrementMs) { return {Mode::Fischer, baseMs, incrementMs, 0}; }
+    static TimeControl perMove(int moveMs) { return {Mode::PerMove, 0, 0, moveMs}; }
+
+    bool isUnlimited() const { return mode == Mode::Unlimited; }
+};
+
+/**
+ * @brief 对局时钟
+ *
+ * 同一时间只有一方的时钟在走。Fischer模式下每方有一份剩余时间，
+ * 走完一步扣除用时后加上增量；每步限时模式下每步重新计时。
+ * allocate()按剩余时间和局面的复杂程度给AI分配软、硬两个时限：
+ * 软时限内完成的迭代才继续加深，硬时限到达时搜索立即停止。
+ */
+class GameClock {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr int OVERHEAD_MS = 30;        ///< 为落子和界面刷新预留的时间
+    static constexpr int MIN_BUDGET_MS = 10;      ///< 最少分配的思考时间
+    static constexpr int EXPECTED_MOVES = 30;     ///< 预计每方还要走的步数（开局时）
+    static constexpr int MIN_MOVES_TO_GO = 10;    ///< 预计剩余步数的下限
+    static constexpr int HARD_FACTOR = 3;         ///< 硬时限最多为软时限的倍数
+
+    /**
+     * @brief 按时间控制重置双方时间并停止计时
+     */
+    void reset(const TimeControl& control);
+
+    const TimeControl& control() const { return control_; }
+
+    /**
+     * @brief 轮到side：结算正在走的一方（不加增量），开始为side计时
+     */
+    void start(PieceType side);
+
+    /**
+     * @brief 正在走的一方完成一步：扣除用时、加上增量并停止计时
+     */
+    void finishMove();
+
+    /**
+     * @brief 暂停：结算正在走的一方，不加增量
+     */
+    void pause();
+
+    bool isRunning() const { return running_ != PieceType::NONE; }
+
+    /**
+     * @brief 正在计时的一方
+     */
+    PieceType runningSide() const { return running_; }
+
+    /**
+     * @brief side的剩余时间（毫秒，含正在走的这一步），不限时返回-1
+     */
+    int remainingMs(PieceType side) const;
+
+    /**
+     * @brief side是否已超时
+     */
+    bool isFlagged(PieceType side) const;
+
+    /**
+     * @brief 为side的下一步分配思考时间；不限时返回空预算
+     */
+    TimeBudget allocate(PieceType side, const Position& position) const;
+
+    /**
+     * @brief 局面的复杂程度（1.0-2.0）：任一方落下即可成四或连五的空位越多越高
+     */
+    static double complexity(const Position& position);
+
+private:
+    TimeControl control_;
+    int remaining_[2] = {0, 0};            ///< 黑、白的剩余时间（不含正在走的这一步）
+    PieceType running_ = PieceType::NONE;  ///< 正在计时的一方
+    Clock::time_point startedAt_;          ///< 本步开始的时刻
+
+    int elapsedMs() const;
+    static int index(PieceType side) { return side == PieceType::BLACK ? 0 : 1; }
+};
+
+#endif // GAME_CLOCK_H
@@ -0,0 +1,494 @@
+#include "game_database.h"
+#include "gamesave.h"
+#include "position.h"
+#include "zobrist.h"
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QSysInfo>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
+
+using namespace GameDatabaseFormat;
+
+namespace {
+
+/**
+ * @brief 构建时的索引记录，比文件中的记录多带哈希
+ */
+struct BuildPosting {
+    uint64_t hash;
+    uint32_t gameId;
+    uint16_t ply;
+    uint8_t nextMove;
+    uint8_t symmetry;
+
+    bool operator<(const BuildPosting& other) const {
+        if (hash != other.hash) return hash < other.hash;
+        if (gameId != other.gameId) return gameId < other.gameId;
+        return ply < other.ply;
+    }
+};
+
+/**
+ * @brief 单个文件的解析结果，gameId为文件内的局部编号
+ */
+struct FileResult {
+    std::vector<GameRecord> games;
+    std::vector<uint8_t> winners;
+    std::vector<BuildPosting> postings;
+    qint64 rejected = 0;
+    bool failed = false;
+};
+
+constexpr int BUCKET_BITS = 8;
+constexpr int BUCKET_COUNT = 1 << BUCKET_BITS;
+
+inline qint64 alignUp(qint64 value)
+{
+    return (value + 7) & ~qint64(7);
+}
+
+/**
+ * @brief 重放一局棋并生成索引记录
+ * @return 着法非法时返回false
+ */
+bool indexGame(const GameRecord& record, uint32_t gameId, int maxPly, Position& position,
+               uint8_t& winner, std::vector<BuildPosting>& postings)
+{
+    const size_t oldSize = postings.size();
+    position.clear();
+    SymmetricHash hash;
+    winner = 0;
+
+    const int moveCount = static_cast<int>(record.moves.size());
+    const int lastIndexed = maxPly > 0 ? std::min(maxPly, moveCount) : moveCount;
+    for (int ply = 0; ply <= moveCount; ++ply) {
+        if (ply <= lastIndexed) {
+            int sym = 0;
+            BuildPosting posting;
+            posting.hash = hash.canonical(&sym);
+            posting.gameId = gameId;
+            posting.ply = static_cast<uint16_t>(ply);
+            posting.nextMove = ply < moveCount
+                ? static_cast<uint8_t>(Symmetry::transform(sym, record.moves[ply])) : NO_MOVE;
+            posting.symmetry = static_cast<uint8_t>(sym);
+            postings.push_back(posting);
+        }
+        if (ply == moveCount) {
+            break;
+        }
+
+        const int cell = record.moves[ply];
+        const int row = cell / Position::SIZE;
+        const int col = cell % Position::SIZE;
+        const PieceType player = record.playerAt(ply);
+        // 已分胜负后继续落子也视为非法
+        if (cell >= Position::CELLS || position.getPiece(row, col) != PieceType::NONE || winner != 0) {
+            postings.resize(oldSize);
+            return false;
+        }
+        if (position.placePiece(row, col, player)) {
+            winner = static_cast<uint8_t>(player);
+        }
+        hash.toggle(row, col, player);
+    }
+    return true;
+}
+
+/**
+ * @brief 读取一个文件中的全部棋谱并建立局部索引
+ */
+void loadFile(const QString& filename, int maxPly, Position& position, FileResult& result)
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly)) {
+        result.failed = true;
+        return;
+    }
+
+    auto addGame = [&](GameRecord& record) {
+        uint8_t winner = 0;
+        const auto localId = static_cast<uint32_t>(result.games.size());
+        if (indexGame(record, localId, maxPly, position, winner, result.postings)) {
+            result.games.push_back(std::move(record));
+            result.winners.push_back(winner);
+        } else {
+            ++result.rejected;
+        }
+    };
+
+    if (isGameRecordData(file.peek(sizeof(GameRecord::MAGIC)))) {
+        GameRecordReader reader(&file);
+        GameRecord record;
+        while (reader.readNext(record)) {
+            addGame(record);
+        }
+        result.failed = reader.hasError() && result.games.empty();
+        return;
+    }
+
+    file.close();
+    GameSave::SaveData data;
+    GameRecord record;
+    if (!GameSave::loadGame(filename, data)) {
+        result.failed = true;
+    } else if (!GameRecord::fromSaveData(data, record)) {
+        ++result.rejected;
+    } else {
+        addGame(record);
+    }
+}
+
+template <typename T>
+bool writeArray(QFile& file, const T* data, size_t count)
+{
+    const qint64 bytes = static_cast<qint64>(count * sizeof(T));
+    return bytes == 0 || file.write(reinterpret_cast<const char*>(data), bytes) == bytes;
+}
+
+bool writePadding(QFile& file)
+{
+    static const char zeros[8] = {};
+    const qint64 padding = alignUp(file.pos()) - file.pos();
+    return padding == 0 || file.write(zeros, padding) == padding;
+}
+
+} // namespace
+
+GameDatabase::~GameDatabase()
+{
+    close();
+}
+
+bool GameDatabase::open(const QString& filename)
+{
+    close();
+    if (QSysInfo::ByteOrder != QSysInfo::LittleEndian) {
+        error_ = "棋谱数据库只支持小端序平台";
+        return false;
+    }
+
+    file_.setFileName(filename);
+    if (!file_.open(QIODevice::ReadOnly)) {
+        error_ = QString("无法打开 %1").arg(filename);
+        return false;
+    }
+    size_ = file_.size();
+    data_ = size_ >= static_cast<qint64>(sizeof(Header)) ? file_.map(0, size_) : nullptr;
+    if (!data_) {
+        error_ = QString("无法映射 %1").arg(filename);
+        close();
+        return false;
+    }
+
+    const auto* header = reinterpret_cast<const Header*>(data_);
+    auto sectionFits = [&](uint64_t offset, uint64_t count, size_t entrySize) {
+        return offset % 8 == 0 && offset <= static_cast<uint64_t>(size_) &&
+               count <= (static_cast<uint64_t>(size_) - offset) / entrySize;
+    };
+    if (std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0 || header->version != VERSION) {
+        error_ = "不是棋谱数据库或版本不受支持";
+        close();
+        return false;
+    }
+    if (!sectionFits(header->gamesOffset, header->gameCount, sizeof(GameEntry)) ||
+        !sectionFits(header->keysOffset, header->keyCount, sizeof(KeyEntry)) ||
+        !sectionFits(header->postingsOffset, header->postingCount, sizeof(PostingEntry))) {
+        error_ = "棋谱数据库已损坏";
+        close();
+        return false;
+    }
+
+    header_ = header;
+    games_ = reinterpret_cast<const GameEntry*>(data_ + header->gamesOffset);
+    keys_ = reinterpret_cast<const KeyEntry*>(data_ + header->keysOffset);
+    postings_ = reinterpret_cast<const PostingEntry*>(data_ + header->postingsOffset);
+    error_.clear();
+    return true;
+}
+
+void GameDatabase::close()
+{
+    if (data_) {
+        file_.unmap(const_cast<uchar*>(data_));
+    }
+    file_.close();
+    data_ = nullptr;
+    size_ = 0;
+    header_ = nullptr;
+    games_ = nullptr;
+    keys_ = nullptr;
+    postings_ = nullptr;
+}
+
+bool GameDatabase::game(uint32_t gameId, GameRecord& record) const
+{
+    if (!header_ || gameId >= header_->gameCount) {
+        return false;
+    }
+    const uint64_t offset = games_[gameId].offset;
+    if (offset >= static_cast<uint64_t>(size_)) {
+        return false;
+    }
+    return GameRecord::decode(reinterpret_cast<const char*>(data_ + offset),
+                              size_ - static_cast<qint64>(offset), record) > 0;
+}
+
+PieceType GameDatabase::winner(uint32_t gameId) const
+{
+    if (!header_ || gameId >= header_->gameCount) {
+        return PieceType::NONE;
+    }
+    return static_cast<PieceType>(games_[gameId].winner);
+}
+
+GameDatabase::QueryResult GameDatabase::find(const Position& position, int maxGames) const
+{
+    QueryResult result;
+    if (!header_) {
+        return result;
+    }
+
+    SymmetricHash hash;
+    for (int row = 0; row < Position::SIZE; ++row) {
+        for (int col = 0; col < Position::SIZE; ++col) {
+            const PieceType piece = position.getPiece(row, col);
+            if (piece != PieceType::NONE) {
+                hash.toggle(row, col, piece);
+            }
+        }
+    }
+    int querySym = 0;
+    const uint64_t key = hash.canonical(&querySym);
+    const int toQuery = Symmetry::inverse(querySym);
+
+    const KeyEntry* keysEnd = keys_ + header_->keyCount;
+    const KeyEntry* entry = std::lower_bound(keys_, keysEnd, key,
+        [](const KeyEntry& e, uint64_t h) { return e.hash < h; });
+    if (entry == keysEnd || entry->hash != key ||
+        uint64_t(entry->first) + entry->count > header_->postingCount) {
+        return result;
+    }
+
+    MoveStat stats[Position::CELLS];
+    const PostingEntry* begin = postings_ + entry->first;
+    const PostingEntry* end = begin + entry->count;
+    for (const PostingEntry* posting = begin; posting != end; ++posting) {
+        if (posting->gameId >= header_->gameCount) {
+            continue;
+        }
+        ++result.totalGames;
+        if (static_cast<int>(result.games.size()) < maxGames) {
+            result.games.push_back({posting->gameId, posting->ply,
+                                    Symmetry::compose(posting->symmetry, toQuery)});
+        }
+        if (posting->nextMove == NO_MOVE || posting->nextMove >= Position::CELLS) {
+            ++result.endedHere;
+            continue;
+        }
+        MoveStat& stat = stats[Symmetry::transform(toQuery, posting->nextMove)];
+        ++stat.count;
+        const auto winner = static_cast<PieceType>(games_[posting->gameId].winner);
+        stat.blackWins += winner == PieceType::BLACK ? 1 : 0;
+        stat.whiteWins += winner == PieceType::WHITE ? 1 : 0;
+    }
+
+    for (int cell = 0; cell < Position::CELLS; ++cell) {
+        if (stats[cell].count > 0) {
+            stats[cell].row = cell / Position::SIZE;
+            stats[cell].col = cell % Position::SIZE;
+            result.nextMoves.push_back(stats[cell]);
+        }
+    }
+    std::stable_sort(result.nextMoves.begin(), result.nextMoves.end(),
+                     [](const MoveStat& a, const MoveStat& b) { return a.count > b.count; });
+    return result;
+}
+
+bool GameDatabaseBuilder::build(const QString& filename, Stats* stats)
+{
+    Stats localStats;
+    Stats& s = stats ? *stats : localStats;
+    s = Stats();
+
+    if (QSysInfo::ByteOrder != QSysInfo::LittleEndian) {
+        error_ = "棋谱数据库只支持小端序平台";
+        return false;
+    }
+
+    // 收集文件，排序保证同样的输入得到同样的对局编号
+    QStringList files;
+    const QString outputPath = QFileInfo(filename).absoluteFilePath();
+    for (const QString& path : paths_) {
+        QFileInfo info(path);
+        if (info.isDir()) {
+            QDirIterator it(path, {"*.gomoku", "*.gmkr"}, QDir::Files, QDirIterator::Subdirectories);
+            while (it.hasNext()) {
+                files.append(QFileInfo(it.next()).absoluteFilePath());
+            }
+        } else if (info.isFile()) {
+            files.append(info.absoluteFilePath());
+        } else {
+            error_ = QString("找不到 %1").arg(path);
+            return false;
+        }
+    }
+    files.removeAll(outputPath);
+    std::sort(files.begin(), files.end());
+    files.erase(std::unique(files.begin(), files.end()), files.end());
+    s.files = files.size();
+
+    int threads = threadCount_ > 0 ? threadCount_ : static_cast<int>(std::thread::hardware_concurrency());
+    threads = std::max(1, std::min(threads, static_cast<int>(files.size())));
+
+    // 并行解析和重放，每个文件的结果独立保存
+    std::vector<FileResult> results(files.size());
+    std::atomic<int> nextFile{0};
+    auto loadWorker = [&]() {
+        Position position;
+        for (int i = nextFile++; i < files.size(); i = nextFile++) {
+            loadFile(files[i], maxPly_, position, results[i]);
+        }
+    };
+    std::vector<std::thread> workers;
+    for (int t = 1; t < threads; ++t) {
+        workers.emplace_back(loadWorker);
+    }
+    loadWorker();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    workers.clear();
+
+    // 按文件顺序分配全局对局编号，同时按哈希高位统计各桶大小
+    std::vector<uint32_t> baseIds(results.size());
+    std::vector<size_t> bucketStart(BUCKET_COUNT + 1, 0);
+    uint64_t totalGames = 0;
+    uint64_t totalPostings = 0;
+    for (size_t i = 0; i < results.size(); ++i) {
+        baseIds[i] = static_cast<uint32_t>(totalGames);
+        totalGames += results[i].games.size();
+        totalPostings += results[i].postings.size();
+        s.rejected += results[i].rejected;
+        s.failedFiles += results[i].failed ? 1 : 0;
+        for (const auto& posting : results[i].postings) {
+            ++bucketStart[(posting.hash >> (64 - BUCKET_BITS)) + 1];
+        }
+    }
+    if (totalGames > UINT32_MAX || totalPostings > UINT32_MAX) {
+        error_ = "对局或索引记录过多";
+        return false;
+    }
+
+    // 分桶后各桶并行排序，桶之间已按哈希有序
+    for (int b = 0; b < BUCKET_COUNT; ++b) {
+        bucketStart[b + 1] += bucketStart[b];
+    }
+    std::vector<BuildPosting> postings(totalPostings);
+    {
+        std::vector<size_t> cursor(bucketStart.begin(), bucketStart.end() - 1);
+        for (size_t i = 0; i < results.size(); ++i) {
+            for (BuildPosting posting : results[i].postings) {
+                posting.gameId += baseIds[i];
+                postings[cursor[posting.hash >> (64 - BUCKET_BITS)]++] = posting;
+            }
+            std::vector<BuildPosting>().swap(results[i].postings);
+        }
+    }
+    std::atomic<int> nextBucket{0};
+    auto sortWorker = [&]() {
+        for (int b = nextBucket++; b < BUCKET_COUNT; b = nextBucket++) {
+            std::sort(postings.begin() + bucketStart[b], postings.begin() + bucketStart[b + 1]);
+        }
+    };
+    const int sortThreads = threadCount_ > 0 ? threadCount_
+                                             : static_cast<int>(std::thread::hardware_concurrency());
+    for (int t = 1; t < sortThreads; ++t) {
+        workers.emplace_back(sortWorker);
+    }
+    sortWorker();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    // 写出文件：先占位文件头，最后回填
+    QFile file(filename);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        error_ = QString("无法写入 %1").arg(filename);
+        return false;
+    }
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.gameCount = static_cast<uint32_t>(totalGames);
+    header.postingCount = totalPostings;
+    header.maxPly = static_cast<uint32_t>(std::max(0, maxPly_));
+    header.recordsOffset = sizeof(Header);
+
+    bool ok = writeArray(file, &header, 1);
+    std::vector<GameEntry> gameEntries;
+    gameEntries.reserve(totalGames);
+    {
+        GameRecordWriter writer(&file);
+        uint64_t offset = header.recordsOffset;
+        for (const auto& result : results) {
+            for (size_t g = 0; g < result.games.size() && ok; ++g) {
+                GameEntry entry;
+                std::memset(&entry, 0, sizeof(entry));
+                entry.offset = offset;
+                entry.moveCount = static_cast<uint16_t>(result.games[g].moves.size());
+                entry.winner = result.winners[g];
+                gameEntries.push_back(entry);
+                offset += GameRecord::HEADER_SIZE + result.games[g].moves.size();
+                ok = writer.write(result.games[g]);
+            }
+        }
+        ok = ok && writer.flush();
+    }
+    results.clear();
+
+    ok = ok && writePadding(file);
+    header.gamesOffset = static_cast<uint64_t>(file.pos());
+    ok = ok && writeArray(file, gameEntries.data(), gameEntries.size());
+
+    std::vector<KeyEntry> keys;
+    for (size_t i = 0; i < postings.size(); ++i) {
+        if (keys.empty() || keys.back().hash != postings[i].hash) {
+            keys.push_back({postings[i].hash, static_cast<uint32_t>(i), 0});
+        }
+        ++keys.back().count;
+    }
+    header.keyCount = static_cast<uint32_t>(keys.size());
+    header.keysOffset = static_cast<uint64_t>(file.pos());
+    ok = ok && writeArray(file, keys.data(), keys.size());
+
+    // 记录表分块转换后写出，避免再复制一份完整数组
+    header.postingsOffset = static_cast<uint64_t>(file.pos());
+    std::vector<PostingEntry> chunk;
+    constexpr size_t CHUNK = 1 << 16;
+    for (size_t i = 0; i < postings.size() && ok; i += CHUNK) {
+        chunk.clear();
+        for (size_t j = i; j < std::min(postings.size(), i + CHUNK); ++j) {
+            chunk.push_back({postings[j].gameId, postings[j].ply, postings[j].nextMove,
+                             postings[j].symmetry});
+        }
+        ok = writeArray(file, chunk.data(), chunk.size());
+    }
+
+    ok = ok && file.seek(0) && writeArray(file, &header, 1);
+    s.bytes = file.size();
+    file.close();
+    if (!ok) {
+        error_ = QString("写入 %1 失败").arg(filename);
+        QFile::remove(filename);
+        return false;
+    }
+
+    s.games = static_cast<qint64>(totalGames);
+    s.positions = static_cast<qint64>(keys.size());
+    s.postings = static_cast<qint64>(totalPostings);
+    return true;
+}
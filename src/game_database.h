@@ -0,0 +1,229 @@
+#ifndef GAME_DATABASE_H
+#define GAME_DATABASE_H
+
+#include <QFile>
+#include <QString>
+#include <QStringList>
+#include <cstdint>
+#include <vector>
+#include "game_record.h"
+#include "game_types.h"
+
+class Position;
+
+/**
+ * @brief 棋谱数据库文件格式（.gmdb）
+ *
+ * 一个文件包含首尾相接的二进制棋谱（见game_record.h）和局面索引。
+ * 索引以规范Zobrist哈希（8种对称取最小，见zobrist.h）为键，
+ * 每个键对应一组(对局编号, 步数)记录。文件整体内存映射后直接使用，
+ * 各表中的结构体按小端序原样存储，8字节对齐：
+ * @code
+ * 段         内容
+ * 文件头     GameDatabaseFormat::Header（64字节）
+ * 棋谱       gameCount局二进制棋谱，首尾相接
+ * 对局表     gameCount个GameEntry，按对局编号排列
+ * 键表       keyCount个KeyEntry，按哈希升序排列
+ * 记录表     postingCount个PostingEntry，按键分组，组内按(对局编号, 步数)排列
+ * @endcode
+ */
+namespace GameDatabaseFormat {
+
+constexpr char MAGIC[4] = {'G', 'M', 'D', 'B'};
+constexpr uint32_t VERSION = 1;
+constexpr uint8_t NO_MOVE = 0xFF;   ///< 对局已结束，没有下一步
+
+struct Header {
+    char magic[4];
+    uint32_t version;
+    uint32_t gameCount;
+    uint32_t keyCount;
+    uint64_t postingCount;
+    uint64_t recordsOffset;    ///< 棋谱段偏移
+    uint64_t gamesOffset;      ///< 对局表偏移
+    uint64_t keysOffset;       ///< 键表偏移
+    uint64_t postingsOffset;   ///< 记录表偏移
+    uint32_t maxPly;           ///< 建索引的最大步数，0表示全部
+    uint32_t reserved;
+};
+
+struct GameEntry {
+    uint64_t offset;           ///< 棋谱在文件中的偏移
+    uint16_t moveCount;        ///< 着法数
+    uint8_t winner;            ///< 胜方（PieceType），未分胜负为0
+    uint8_t reserved[5];
+};
+
+struct KeyEntry {
+    uint64_t hash;             ///< 规范哈希
+    uint32_t first;            ///< 第一条记录在记录表中的下标
+    uint32_t count;            ///< 记录数
+};
+
+struct PostingEntry {
+    uint32_t gameId;           ///< 对局编号
+    uint16_t ply;              ///< 局面在对局中出现时已下的步数
+    uint8_t nextMove;          ///< 规范坐标系下的下一步格子，NO_MOVE表示对局结束
+    uint8_t symmetry;          ///< 把对局局面映射到规范局面的对称变换
+};
+
+static_assert(sizeof(Header) == 64, "Header布局变化");
+static_assert(sizeof(GameEntry) == 16, "GameEntry布局变化");
+static_assert(sizeof(KeyEntry) == 16, "KeyEntry布局变化");
+static_assert(sizeof(PostingEntry) == 8, "PostingEntry布局变化");
+
+} // namespace GameDatabaseFormat
+
+/**
+ * @brief 内存映射的棋谱数据库（只读）
+ *
+ * 打开时映射整个文件，查询只在键表上二分查找，再顺序扫描对应的记录，
+ * 不读取棋谱本身；需要着法时再按偏移解析单局棋谱。
+ * 打开后的查询是只读操作，可以在多个线程中并发进行。
+ */
+class GameDatabase {
+public:
+    /**
+     * @brief 一局包含查询局面的对局
+     */
+    struct Hit {
+        uint32_t gameId;     ///< 对局编号
+        int ply;             ///< 局面出现时已下的步数
+        int symmetry;        ///< 把对局坐标映射到查询坐标的对称变换
+    };
+
+    /**
+     * @brief 查询局面之后某一步的统计
+     */
+    struct MoveStat {
+        int row;             ///< 行号（查询坐标系）
+        int col;             ///< 列号（查询坐标系）
+        int count = 0;       ///< 出现次数
+        int blackWins = 0;   ///< 其中黑方获胜的对局数
+        int whiteWins = 0;   ///< 其中白方获胜的对局数
+    };
+
+    /**
+     * @brief 查询结果
+     */
+    struct QueryResult {
+        qint64 totalGames = 0;           ///< 包含该局面的对局总数
+        qint64 endedHere = 0;            ///< 在该局面结束的对局数
+        std::vector<Hit> games;          ///< 匹配的对局（最多maxGames个）
+        std::vector<MoveStat> nextMoves; ///< 下一步统计，按出现次数降序
+    };
+
+    GameDatabase() = default;
+    ~GameDatabase();
+
+    GameDatabase(const GameDatabase&) = delete;
+    GameDatabase& operator=(const GameDatabase&) = delete;
+
+    /**
+     * @brief 打开并映射数据库文件
+     */
+    bool open(const QString& filename);
+
+    /**
+     * @brief 关闭数据库
+     */
+    void close();
+
+    bool isOpen() const { return header_ != nullptr; }
+
+    QString errorString() const { return error_; }
+
+    /**
+     * @brief 对局数
+     */
+    uint32_t gameCount() const { return header_ ? header_->gameCount : 0; }
+
+    /**
+     * @brief 索引中不同局面的数量
+     */
+    uint32_t positionCount() const { return header_ ? header_->keyCount : 0; }
+
+    /**
+     * @brief 建索引的最大步数，0表示全部
+     */
+    int maxPly() const { return header_ ? static_cast<int>(header_->maxPly) : 0; }
+
+    /**
+     * @brief 读取一局棋谱
+     */
+    bool game(uint32_t gameId, GameRecord& record) const;
+
+    /**
+     * @brief 对局的胜方，未分胜负返回NONE
+     */
+    PieceType winner(uint32_t gameId) const;
+
+    /**
+     * @brief 查询包含该局面（含对称局面）的对局及下一步统计
+     * @param maxGames 最多返回的对局数，统计始终覆盖全部匹配
+     */
+    QueryResult find(const Position& position, int maxGames = 100) const;
+
+private:
+    QFile file_;
+    const uchar* data_ = nullptr;
+    qint64 size_ = 0;
+    const GameDatabaseFormat::Header* header_ = nullptr;
+    const GameDatabaseFormat::GameEntry* games_ = nullptr;
+    const GameDatabaseFormat::KeyEntry* keys_ = nullptr;
+    const GameDatabaseFormat::PostingEntry* postings_ = nullptr;
+    QString error_;
+};
+
+/**
+ * @brief 棋谱数据库构建器
+ *
+ * 收集目录中的存档（.gomoku）和二进制棋谱（.gmkr），多线程并行解析、
+ * 重放并计算每一步的规范哈希，按哈希分桶并行排序后写出数据库文件。
+ * 着法非法（越界、重复落子、非黑白交替）的对局会被跳过。
+ */
+class GameDatabaseBuilder {
+public:
+    /**
+     * @brief 构建统计
+     */
+    struct Stats {
+        int files = 0;           ///< 读取的文件数
+        int failedFiles = 0;     ///< 无法读取的文件数
+        qint64 games = 0;        ///< 收录的对局数
+        qint64 rejected = 0;     ///< 跳过的非法对局数
+        qint64 positions = 0;    ///< 不同局面数
+        qint64 postings = 0;     ///< 索引记录数
+        qint64 bytes = 0;        ///< 输出文件大小
+    };
+
+    /**
+     * @brief 添加文件或目录（目录递归搜索）
+     */
+    void addPath(const QString& path) { paths_.append(path); }
+
+    /**
+     * @brief 线程数，0表示使用全部硬件线程
+     */
+    void setThreadCount(int threads) { threadCount_ = threads; }
+
+    /**
+     * @brief 只为前maxPly步建索引，0表示全部
+     */
+    void setMaxPly(int maxPly) { maxPly_ = maxPly; }
+
+    /**
+     * @brief 构建并写出数据库
+     */
+    bool build(const QString& filename, Stats* stats = nullptr);
+
+    QString errorString() const { return error_; }
+
+private:
+    QStringList paths_;
+    int threadCount_ = 0;
+    int maxPly_ = 0;
+    QString error_;
+};
+
+#endif // GAME_DATABASE_H
@@ -0,0 +1,161 @@
+#include "game_history.h"
+#include <algorithm>
+#include <cstdlib>
+
+GameHistory::GameHistory()
+    : cursor_(0)
+{
+    clear();
+}
+
+void GameHistory::clear(const Position& base)
+{
+    nodes_.clear();
+    line_.clear();
+    snapshots_.clear();
+    snapshots_.push_back(base);
+    nodes_.push_back({Move(), -1, -1, -1, 0});
+    cursor_ = 0;
+}
+
+std::vector<Move> GameHistory::moves() const
+{
+    std::vector<Move> result;
+    result.reserve(cursor_);
+    for (int i = 0; i < cursor_; ++i) {
+        result.push_back(moveAt(i));
+    }
+    return result;
+}
+
+void GameHistory::play(const Move& move, const Position& after)
+{
+    const int parent = cursorNode();
+
+    // 已有相同着法的分支时直接沿用
+    int child = nodes_[parent].firstChild;
+    int lastChild = -1;
+    while (child >= 0) {
+        const Move& existing = nodes_[child].move;
+        if (existing.row == move.row && existing.col == move.col && existing.player == move.player) {
+            break;
+        }
+        lastChild = child;
+        child = nodes_[child].nextSibling;
+    }
+
+    if (child < 0) {
+        child = static_cast<int>(nodes_.size());
+        nodes_.push_back({move, parent, -1, -1, -1});
+        if (lastChild < 0) {
+            nodes_[parent].firstChild = child;
+        } else {
+            nodes_[lastChild].nextSibling = child;
+        }
+        if ((cursor_ + 1) % SNAPSHOT_INTERVAL == 0) {
+            nodes_[child].snapshot = static_cast<int>(snapshots_.size());
+            snapshots_.push_back(after);
+        }
+    }
+
+    if (cursor_ < length() && line_[cursor_] == child) {
+        ++cursor_;
+        return;
+    }
+    followFrom(child);
+    ++cursor_;
+}
+
+bool GameHistory::back(Position& position)
+{
+    if (cursor_ == 0) {
+        return false;
+    }
+    const Move& move = moveAt(cursor_ - 1);
+    position.removePiece(move.row, move.col);
+    --cursor_;
+    return true;
+}
+
+bool GameHistory::forward(Position& position)
+{
+    if (cursor_ >= length()) {
+        return false;
+    }
+    const Move& move = moveAt(cursor_);
+    position.placePiece(move.row, move.col, move.player);
+    ++cursor_;
+    return true;
+}
+
+void GameHistory::seek(Position& position, int ply)
+{
+    ply = std::clamp(ply, 0, length());
+
+    // 距离不超过一个快照间隔时逐步移动
+    if (std::abs(ply - cursor_) < SNAPSHOT_INTERVAL) {
+        while (cursor_ > ply) {
+            back(position);
+        }
+        while (cursor_ < ply) {
+            forward(position);
+        }
+        return;
+    }
+
+    // 否则从目标之前最近的快照开始重放
+    int base = ply - ply % SNAPSHOT_INTERVAL;
+    while (base > 0 && nodes_[line_[base - 1]].snapshot < 0) {
+        base -= SNAPSHOT_INTERVAL;
+    }
+    position = snapshots_[base > 0 ? nodes_[line_[base - 1]].snapshot : 0];
+    cursor_ = base;
+    while (cursor_ < ply) {
+        forward(position);
+    }
+}
+
+std::vector<Move> GameHistory::variations() const
+{
+    std::vector<Move> result;
+    for (int child = nodes_[cursorNode()].firstChild; child >= 0; child = nodes_[child].nextSibling) {
+        result.push_back(nodes_[child].move);
+    }
+    return result;
+}
+
+int GameHistory::currentVariation() const
+{
+    if (cursor_ >= length()) {
+        return -1;
+    }
+    int index = 0;
+    for (int child = nodes_[cursorNode()].firstChild; child >= 0; child = nodes_[child].nextSibling) {
+        if (child == line_[cursor_]) {
+            return index;
+        }
+        ++index;
+    }
+    return -1;
+}
+
+bool GameHistory::selectVariation(int index)
+{
+    int child = nodes_[cursorNode()].firstChild;
+    for (int i = 0; i < index && child >= 0; ++i) {
+        child = nodes_[child].nextSibling;
+    }
+    if (index < 0 || child < 0) {
+        return false;
+    }
+    followFrom(child);
+    return true;
+}
+
+void GameHistory::followFrom(int node)
+{
+    line_.resize(cursor_);
+    for (; node >= 0; node = nodes_[node].firstChild) {
+        line_.push_back(node);
+    }
+}
@@ -0,0 +1,127 @@
+#ifndef GAME_HISTORY_H
+#define GAME_HISTORY_H
+
+#include <vector>
+#include "game_types.h"
+#include "position.h"
+
+/**
+ * @brief 带变化分支的落子历史
+ *
+ * 所有着法保存在一棵树中（节点连续存放在数组里，以下标互相引用），
+ * 当前线路是从根到某个叶子的一条路径，游标表示棋盘停在线路的第几步。
+ * 在中间某步落下与原线路不同的着法时产生新的变化分支，原线路保留。
+ *
+ * 线路上每SNAPSHOT_INTERVAL步保存一份局面快照（含Position的增量连子状态），
+ * 跳转到任意一步时先复制最近的快照，再重放不超过SNAPSHOT_INTERVAL - 1步，
+ * 耗时与对局长度无关；前进、后退一步直接落子或提子。
+ */
+class GameHistory {
+public:
+    static constexpr int SNAPSHOT_INTERVAL = 16;  ///< 快照间隔（步）
+
+    GameHistory();
+
+    /**
+     * @brief 清空历史
+     * @param base 第0步的局面（读档时棋盘与着法不一致可从任意局面开始）
+     */
+    void clear(const Position& base = Position());
+
+    /**
+     * @brief 棋盘所在的步数（已落下的着法数）
+     */
+    int ply() const { return cursor_; }
+
+    /**
+     * @brief 当前线路的总步数
+     */
+    int length() const { return static_cast<int>(line_.size()); }
+
+    /**
+     * @brief 当前线路的第index步（从0开始）
+     */
+    const Move& moveAt(int index) const { return nodes_[line_[index]].move; }
+
+    /**
+     * @brief 棋盘上最后一步，没有时返回无效着法
+     */
+    Move lastMove() const { return cursor_ > 0 ? moveAt(cursor_ - 1) : Move(); }
+
+    /**
+     * @brief 棋盘上的全部着法（线路的前ply()步），按顺序排列
+     */
+    std::vector<Move> moves() const;
+
+    /**
+     * @brief 在当前游标处记录一步着法
+     *
+     * 与线路上的下一步相同时沿线路前进；与已有的其他分支相同时切换到该分支；
+     * 否则新建分支。游标之后的原线路作为变化保留。
+     *
+     * @param move 着法
+     * @param after 落子之后的局面，需要快照时复制
+     */
+    void play(const Move& move, const Position& after);
+
+    /**
+     * @brief 后退一步（从position提走最后一子）
+     */
+    bool back(Position& position);
+
+    /**
+     * @brief 沿当前线路前进一步
+     */
+    bool forward(Position& position);
+
+    /**
+     * @brief 跳转到当前线路的第ply步
+     * @param position 棋盘局面，必须与当前游标一致
+     */
+    void seek(Position& position, int ply);
+
+    /**
+     * @brief 当前游标处可选的下一步（各分支的第一步）
+     */
+    std::vector<Move> variations() const;
+
+    /**
+     * @brief 当前线路在variations()中的下标，游标在线路末尾时返回-1
+     */
+    int currentVariation() const;
+
+    /**
+     * @brief 把游标之后的线路切换到第index个分支（沿各分支的第一个子节点延伸）
+     */
+    bool selectVariation(int index);
+
+    /**
+     * @brief 保存的快照数
+     */
+    int snapshotCount() const { return static_cast<int>(snapshots_.size()); }
+
+private:
+    /**
+     * @brief 树节点
+     */
+    struct Node {
+        Move move;              ///< 走到该节点的着法（根节点无效）
+        int parent;             ///< 父节点
+        int firstChild;         ///< 第一个子节点，没有时为-1
+        int nextSibling;        ///< 下一个兄弟节点，没有时为-1
+        int snapshot;           ///< 局面快照下标，没有时为-1
+    };
+
+    std::vector<Node> nodes_;          ///< 全部节点，0为根
+    std::vector<int> line_;            ///< 当前线路（不含根）
+    std::vector<Position> snapshots_;  ///< 局面快照，0为第0步
+    int cursor_;                       ///< 棋盘所在的步数
+
+    // 游标所在的节点
+    int cursorNode() const { return cursor_ > 0 ? line_[cursor_ - 1] : 0; }
+
+    // 截断游标之后的线路，接上node并沿第一个子节点延伸到叶子
+    void followFrom(int node);
+};
+
+#endif // GAME_HISTORY_H
@@ -0,0 +1,319 @@
+#include "game_journal.h"
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QStandardPaths>
+#include <QtEndian>
+#include <cstring>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr char MAGIC[4] = {'G', 'M', 'K', 'J'};
+constexpr uint8_t VERSION = 1;
+constexpr uint8_t FLAG_AI_ENABLED = 0x01;
+constexpr uint8_t RECORD_MOVE = 1;
+constexpr uint8_t RECORD_UNDO = 2;
+constexpr int NAME_SIZE = 12;
+constexpr int BOARD_SIZE = 15;
+
+// Fletcher-16，初值非零，全零的记录不会通过校验
+uint16_t checksum(const uchar* data, int size)
+{
+    uint16_t a = 0x4A;
+    uint16_t b = 0x4B;
+    for (int i = 0; i < size; ++i) {
+        a = static_cast<uint16_t>((a + data[i]) % 255);
+        b = static_cast<uint16_t>((b + a) % 255);
+    }
+    return static_cast<uint16_t>((b << 8) | a);
+}
+
+void putName(uchar* out, const QString& name)
+{
+    const QByteArray utf8 = name.toUtf8().left(NAME_SIZE);
+    std::memset(out, 0, NAME_SIZE);
+    std::memcpy(out, utf8.constData(), utf8.size());
+}
+
+QString getName(const uchar* in)
+{
+    int length = 0;
+    while (length < NAME_SIZE && in[length] != 0) {
+        ++length;
+    }
+    return QString::fromUtf8(reinterpret_cast<const char*>(in), length);
+}
+
+bool syncFile(QFile& file)
+{
+#ifdef Q_OS_WIN
+    return _commit(file.handle()) == 0;
+#else
+    return ::fsync(file.handle()) == 0;
+#endif
+}
+
+PieceType opponent(PieceType player)
+{
+    return player == PieceType::BLACK ? PieceType::WHITE : PieceType::BLACK;
+}
+
+} // namespace
+
+GameJournal::GameJournal(int syncEvery, int syncIntervalMs)
+    : remainingUndos_(0)
+    , pending_(0)
+    , syncEvery_(syncEvery)
+    , syncIntervalMs_(syncIntervalMs)
+    , appendCount_(0)
+    , syncCount_(0)
+    , appendNs_(0)
+    , syncNs_(0)
+{
+}
+
+GameJournal::~GameJournal()
+{
+    // 保留日志文件，下次启动时用于恢复
+    sync();
+    file_.close();
+}
+
+bool GameJournal::begin(const QString& filename, const Settings& settings)
+{
+    file_.close();
+    QDir().mkpath(QFileInfo(filename).absolutePath());
+    file_.setFileName(filename);
+    // 不使用用户态缓冲，每条记录立即交给操作系统
+    if (!file_.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Unbuffered)) {
+        return false;
+    }
+
+    settings_ = settings;
+    moves_.clear();
+    remainingUndos_ = settings.remainingUndos;
+    pending_ = 0;
+    appendCount_ = 0;
+    syncCount_ = 0;
+    appendNs_ = 0;
+    syncNs_ = 0;
+
+    uchar header[HEADER_SIZE];
+    std::memset(header, 0, sizeof(header));
+    std::memcpy(header, MAGIC, sizeof(MAGIC));
+    header[4] = VERSION;
+    header[5] = settings.aiEnabled ? FLAG_AI_ENABLED : 0;
+    header[6] = static_cast<uchar>(settings.aiDifficulty);
+    header[7] = static_cast<uchar>(settings.undoLimit);
+    header[8] = static_cast<uchar>(settings.remainingUndos);
+    header[9] = static_cast<uchar>(settings.playerPieceType);
+    qToLittleEndian<qint64>(settings.startTime, header + 16);
+    putName(header + 24, settings.aiStrategy);
+    putName(header + 36, settings.evaluator);
+
+    if (file_.write(reinterpret_cast<const char*>(header), HEADER_SIZE) != HEADER_SIZE ||
+        !syncFile(file_)) {
+        file_.close();
+        return false;
+    }
+    sinceSync_.start();
+    return true;
+}
+
+bool GameJournal::appendMove(int row, int col, PieceType player, int remainingUndos)
+{
+    moves_.emplace_back(row, col, player);
+    return appendRecord(RECORD_MOVE, row * BOARD_SIZE + col, player, remainingUndos);
+}
+
+bool GameJournal::appendUndo(int remainingUndos)
+{
+    if (moves_.empty()) {
+        return false;
+    }
+    const Move undone = moves_.back();
+    moves_.pop_back();
+    return appendRecord(RECORD_UNDO, undone.row * BOARD_SIZE + undone.col, undone.player, remainingUndos);
+}
+
+bool GameJournal::appendRecord(uint8_t type, int cell, PieceType player, int remainingUndos)
+{
+    remainingUndos_ = remainingUndos;
+    if (!file_.isOpen()) {
+        return false;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    uchar record[RECORD_SIZE];
+    record[0] = type;
+    record[1] = static_cast<uchar>(cell);
+    record[2] = static_cast<uchar>(player);
+    record[3] = static_cast<uchar>(remainingUndos);
+    qToLittleEndian<quint16>(static_cast<quint16>(moves_.size()), record + 4);
+    qToLittleEndian<quint16>(checksum(record, 6), record + 6);
+    const bool ok = file_.write(reinterpret_cast<const char*>(record), RECORD_SIZE) == RECORD_SIZE;
+    ++appendCount_;
+    ++pending_;
+    appendNs_ += timer.nsecsElapsed();
+
+    if (pending_ >= syncEvery_ || sinceSync_.elapsed() >= syncIntervalMs_) {
+        return sync() && ok;
+    }
+    return ok;
+}
+
+bool GameJournal::sync()
+{
+    if (!file_.isOpen() || pending_ == 0) {
+        return true;
+    }
+    QElapsedTimer timer;
+    timer.start();
+    const bool ok = syncFile(file_);
+    syncNs_ += timer.nsecsElapsed();
+    ++syncCount_;
+    pending_ = 0;
+    sinceSync_.start();
+    return ok;
+}
+
+bool GameJournal::compact(const QString& saveFilename)
+{
+    if (!file_.isOpen()) {
+        return false;
+    }
+    sync();
+
+    Recovered game;
+    game.settings = settings_;
+    game.moves = moves_;
+    game.remainingUndos = remainingUndos_;
+    if (!save(game, saveFilename)) {
+        return false;
+    }
+    discard();
+    return true;
+}
+
+void GameJournal::discard()
+{
+    const QString filename = file_.fileName();
+    file_.close();
+    if (!filename.isEmpty()) {
+        QFile::remove(filename);
+    }
+    moves_.clear();
+    pending_ = 0;
+}
+
+bool GameJournal::recover(const QString& filename, Recovered& game)
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    const QByteArray content = file.readAll();
+    const auto* data = reinterpret_cast<const uchar*>(content.constData());
+    if (content.size() < HEADER_SIZE || std::memcmp(data, MAGIC, sizeof(MAGIC)) != 0 ||
+        data[4] == 0 || data[4] > VERSION) {
+        return false;
+    }
+
+    game = Recovered();
+    Settings& settings = game.settings;
+    settings.aiEnabled = (data[5] & FLAG_AI_ENABLED) != 0;
+    settings.aiDifficulty = data[6];
+    settings.undoLimit = data[7];
+    settings.remainingUndos = data[8];
+    settings.playerPieceType = static_cast<PieceType>(data[9]);
+    settings.startTime = qFromLittleEndian<qint64>(data + 16);
+    settings.aiStrategy = getName(data + 24);
+    settings.evaluator = getName(data + 36);
+    game.remainingUndos = settings.remainingUndos;
+
+    // 逐条重放，遇到第一条无效记录即停止（通常是崩溃时写了一半的末尾记录）
+    bool occupied[BOARD_SIZE * BOARD_SIZE] = {};
+    int offset = HEADER_SIZE;
+    for (; offset + RECORD_SIZE <= content.size(); offset += RECORD_SIZE) {
+        const uchar* record = data + offset;
+        if (qFromLittleEndian<quint16>(record + 6) != checksum(record, 6)) {
+            break;
+        }
+        const int cell = record[1];
+        const auto player = static_cast<PieceType>(record[2]);
+        const int stones = qFromLittleEndian<quint16>(record + 4);
+        if (cell >= BOARD_SIZE * BOARD_SIZE) {
+            break;
+        }
+        if (record[0] == RECORD_MOVE) {
+            if (occupied[cell] || stones != static_cast<int>(game.moves.size()) + 1) {
+                break;
+            }
+            occupied[cell] = true;
+            game.moves.emplace_back(cell / BOARD_SIZE, cell % BOARD_SIZE, player);
+        } else if (record[0] == RECORD_UNDO) {
+            if (game.moves.empty() || stones != static_cast<int>(game.moves.size()) - 1 ||
+                cell != game.moves.back().row * BOARD_SIZE + game.moves.back().col) {
+                break;
+            }
+            occupied[game.moves.back().row * BOARD_SIZE + game.moves.back().col] = false;
+            game.moves.pop_back();
+        } else {
+            break;
+        }
+        game.remainingUndos = record[3];
+        ++game.records;
+    }
+    game.truncated = offset != content.size();
+    return true;
+}
+
+bool GameJournal::save(const Recovered& game, const QString& saveFilename)
+{
+    GameSave::SaveData data;
+    data.timestamp = game.settings.startTime > 0
+        ? QDateTime::fromMSecsSinceEpoch(game.settings.startTime) : QDateTime::currentDateTime();
+    data.isAIEnabled = game.settings.aiEnabled;
+    data.aiDifficulty = game.settings.aiDifficulty;
+    data.undoLimit = game.settings.undoLimit;
+    data.remainingUndos = game.remainingUndos;
+    data.currentPlayer = static_cast<int>(game.moves.empty() ? PieceType::BLACK
+                                                             : opponent(game.moves.back().player));
+    data.board.assign(BOARD_SIZE, std::vector<int>(BOARD_SIZE, static_cast<int>(PieceType::NONE)));
+    for (const auto& move : game.moves) {
+        data.board[move.row][move.col] = static_cast<int>(move.player);
+        data.history.emplace_back(move.row, move.col, move.player);
+    }
+
+    QDir().mkpath(QFileInfo(saveFilename).absolutePath());
+    if (GameSave::saveGame(saveFilename, data)) {
+        return true;
+    }
+    // 二进制棋谱只能表示黑先交替落子，其他情况退回JSON（读档时自动识别）
+    return GameSave::formatForFile(saveFilename) == GameSave::Format::Binary &&
+           GameSave::saveGame(saveFilename, data, GameSave::Format::Json);
+}
+
+QString GameJournal::defaultPath()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/autosave.gmkj";
+}
+
+QString GameJournal::archiveDirectory()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/games";
+}
+
+QString GameJournal::archivePath(qint64 startTime, const QString& extension)
+{
+    const QDateTime time = startTime > 0 ? QDateTime::fromMSecsSinceEpoch(startTime)
+                                         : QDateTime::currentDateTime();
+    return archiveDirectory() + "/" + time.toString("yyyyMMdd-HHmmss-zzz") + extension;
+}
@@ -0,0 +1,189 @@
+#ifndef GAME_JOURNAL_H
+#define GAME_JOURNAL_H
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QString>
+#include <vector>
+#include "game_types.h"
+#include "gamesave.h"
+
+/**
+ * @brief 对局自动保存日志（只追加）
+ *
+ * 对局开始时写入一个文件头，之后每次落子或悔棋追加一条8字节的定长记录，
+ * 不重写已有内容。记录直接写入操作系统（无用户态缓冲），程序崩溃不会丢失；
+ * fsync按条数或时间间隔成批进行，断电时最多丢失最后一批记录。
+ * 启动时可用recover()重放日志恢复未完成的对局，对局结束后compact()
+ * 把日志压缩为普通存档并删除日志。
+ *
+ * 文件格式（多字节字段均为小端序）：
+ * @code
+ * 文件头（48字节）
+ * 偏移  长度  字段
+ * 0     4     魔数 "GMKJ"
+ * 4     1     版本号（当前为1）
+ * 5     1     标志位：bit0 人机对战
+ * 6     1     AI难度
+ * 7     1     悔棋次数限制
+ * 8     1     开局时的剩余悔棋次数
+ * 9     1     玩家执子（PieceType）
+ * 10    6     保留，写0
+ * 16    8     对局开始时间（自1970年起的毫秒数）
+ * 24    12    AI策略名（UTF-8，不足补0）
+ * 36    12    评估函数名（UTF-8，不足补0）
+ *
+ * 记录（8字节）
+ * 0     1     类型：1 落子，2 悔棋（撤销一步）
+ * 1     1     格子下标（行 * 15 + 列）
+ * 2     1     落子方（PieceType）
+ * 3     1     记录后的剩余悔棋次数
+ * 4     2     记录后棋盘上的棋子数
+ * 6     2     校验和，用于识别写了一半的末尾记录
+ * @endcode
+ */
+class GameJournal {
+public:
+    static constexpr int HEADER_SIZE = 48;
+    static constexpr int RECORD_SIZE = 8;
+
+    /**
+     * @brief 对局设置，写在日志文件头中
+     */
+    struct Settings {
+        bool aiEnabled = false;                        ///< 是否为人机对战
+        QString aiStrategy = "RuleBased";              ///< AI策略名
+        QString evaluator = "Pattern";                 ///< 评估函数名
+        int aiDifficulty = 3;                          ///< AI难度
+        int undoLimit = 3;                             ///< 悔棋次数限制
+        int remainingUndos = 3;                        ///< 开局时的剩余悔棋次数
+        PieceType playerPieceType = PieceType::BLACK;  ///< 玩家执子
+        qint64 startTime = 0;                          ///< 对局开始时间（毫秒）
+    };
+
+    /**
+     * @brief 从日志恢复的对局
+     */
+    struct Recovered {
+        Settings settings;         ///< 对局设置
+        std::vector<Move> moves;   ///< 重放悔棋后仍在棋盘上的着法
+        int remainingUndos = 0;    ///< 剩余悔棋次数
+        int records = 0;           ///< 有效记录数
+        bool truncated = false;    ///< 末尾是否有不完整或损坏的记录（已忽略）
+    };
+
+    /**
+     * @param syncEvery 每追加多少条记录fsync一次
+     * @param syncIntervalMs 距上次fsync超过该时间时，下一条记录追加后立即fsync
+     */
+    explicit GameJournal(int syncEvery = 8, int syncIntervalMs = 1000);
+    ~GameJournal();
+
+    GameJournal(const GameJournal&) = delete;
+    GameJournal& operator=(const GameJournal&) = delete;
+
+    /**
+     * @brief 开始新对局：截断并写入文件头
+     */
+    bool begin(const QString& filename, const Settings& settings);
+
+    /**
+     * @brief 追加一条落子记录
+     */
+    bool appendMove(int row, int col, PieceType player, int remainingUndos);
+
+    /**
+     * @brief 追加一条悔棋记录（撤销最后一步）
+     */
+    bool appendUndo(int remainingUndos);
+
+    /**
+     * @brief 立即fsync尚未同步的记录
+     */
+    bool sync();
+
+    /**
+     * @brief 把日志压缩为普通存档并删除日志
+     * @param saveFilename 存档文件名，格式由扩展名决定（见GameSave::saveGame）
+     */
+    bool compact(const QString& saveFilename);
+
+    /**
+     * @brief 关闭并删除日志
+     */
+    void discard();
+
+    bool isOpen() const { return file_.isOpen(); }
+
+    /**
+     * @brief 当前对局的设置
+     */
+    const Settings& settings() const { return settings_; }
+
+    /**
+     * @brief 当前对局仍在棋盘上的着法
+     */
+    const std::vector<Move>& moves() const { return moves_; }
+
+    /**
+     * @brief 本局追加的记录数
+     */
+    qint64 recordCount() const { return appendCount_; }
+
+    /**
+     * @brief 本局fsync次数
+     */
+    qint64 syncCount() const { return syncCount_; }
+
+    /**
+     * @brief 平均每条记录的耗时（微秒，含分摊的fsync）
+     */
+    double averageAppendUs() const {
+        return appendCount_ > 0 ? (appendNs_ + syncNs_) / 1000.0 / appendCount_ : 0.0;
+    }
+
+    /**
+     * @brief 读取并重放日志
+     * @return 文件不存在或文件头无效时返回false
+     */
+    static bool recover(const QString& filename, Recovered& game);
+
+    /**
+     * @brief 把恢复的对局写成普通存档
+     */
+    static bool save(const Recovered& game, const QString& saveFilename);
+
+    /**
+     * @brief 默认的日志文件（应用数据目录下）
+     */
+    static QString defaultPath();
+
+    /**
+     * @brief 压缩后存档的目录（应用数据目录下的games）
+     */
+    static QString archiveDirectory();
+
+    /**
+     * @brief 在存档目录中为开始于startTime的对局生成文件名
+     * @param extension 扩展名（含点号）
+     */
+    static QString archivePath(qint64 startTime, const QString& extension = ".gmkr");
+
+private:
+    QFile file_;
+    Settings settings_;
+    std::vector<Move> moves_;       ///< 重放后的着法，压缩时使用
+    int remainingUndos_;
+    int pending_;                   ///< 尚未fsync的记录数
+    int syncEvery_;
+    int syncIntervalMs_;
+    QElapsedTimer sinceSync_;
+    qint64 appendCount_;
+    qint64 syncCount_;
+    qint64 appendNs_;
+    qint64 syncNs_;
+
+    bool appendRecord(uint8_t type, int cell, PieceType player, int remainingUndos);
+};
+
+#endif // GAME_JOURNAL_H
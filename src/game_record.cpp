@@ -0,0 +1,263 @@
+#include "game_record.h"
+#include <QIODevice>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+void putU16(char* out, uint16_t value)
+{
+    out[0] = static_cast<char>(value & 0xFF);
+    out[1] = static_cast<char>(value >> 8);
+}
+
+void putI64(char* out, qint64 value)
+{
+    uint64_t bits = static_cast<uint64_t>(value);
+    for (int i = 0; i < 8; ++i) {
+        out[i] = static_cast<char>((bits >> (8 * i)) & 0xFF);
+    }
+}
+
+uint16_t getU16(const unsigned char* in)
+{
+    return static_cast<uint16_t>(in[0] | (in[1] << 8));
+}
+
+qint64 getI64(const unsigned char* in)
+{
+    uint64_t bits = 0;
+    for (int i = 7; i >= 0; --i) {
+        bits = (bits << 8) | in[i];
+    }
+    return static_cast<qint64>(bits);
+}
+
+// 解析并校验记录头，返回着法数，格式错误时返回-1
+int decodeHeader(const unsigned char* header, GameRecord& record)
+{
+    if (std::memcmp(header, GameRecord::MAGIC, sizeof(GameRecord::MAGIC)) != 0 ||
+        header[4] == 0 || header[4] > GameRecord::VERSION) {
+        return -1;
+    }
+    const int moveCount = getU16(header + 10);
+    if (moveCount > GameRecord::BOARD_SIZE * GameRecord::BOARD_SIZE) {
+        return -1;
+    }
+
+    record.isAIEnabled = (header[5] & GameRecord::FLAG_AI_ENABLED) != 0;
+    record.whiteFirst = (header[5] & GameRecord::FLAG_WHITE_FIRST) != 0;
+    record.aiDifficulty = header[6];
+    record.undoLimit = header[7];
+    record.remainingUndos = header[8];
+    record.currentPlayer = header[9];
+    record.timestamp = getI64(header + 16);
+    return moveCount;
+}
+
+} // namespace
+
+int GameRecord::decode(const char* data, qint64 size, GameRecord& record)
+{
+    if (size < HEADER_SIZE) {
+        return 0;
+    }
+    const auto* header = reinterpret_cast<const unsigned char*>(data);
+    const int moveCount = decodeHeader(header, record);
+    if (moveCount < 0 || size < HEADER_SIZE + moveCount) {
+        return 0;
+    }
+    record.moves.assign(header + HEADER_SIZE, header + HEADER_SIZE + moveCount);
+    return HEADER_SIZE + moveCount;
+}
+
+bool GameRecord::fromSaveData(const GameSave::SaveData& data, GameRecord& record)
+{
+    record.timestamp = data.timestamp.isValid() ? data.timestamp.toMSecsSinceEpoch() : 0;
+    record.isAIEnabled = data.isAIEnabled;
+    record.aiDifficulty = data.aiDifficulty;
+    record.undoLimit = data.undoLimit;
+    record.remainingUndos = data.remainingUndos;
+    record.currentPlayer = data.currentPlayer;
+    record.whiteFirst = !data.history.empty() && data.history.front().player == PieceType::WHITE;
+    record.moves.clear();
+
+    if (data.history.size() > BOARD_SIZE * BOARD_SIZE) {
+        return false;
+    }
+    record.moves.reserve(data.history.size());
+    for (size_t i = 0; i < data.history.size(); ++i) {
+        const auto& move = data.history[i];
+        // 只能表示黑白交替、落在棋盘内的着法
+        if (move.row < 0 || move.row >= BOARD_SIZE || move.col < 0 || move.col >= BOARD_SIZE ||
+            move.player != record.playerAt(i)) {
+            return false;
+        }
+        record.moves.push_back(static_cast<uint8_t>(move.row * BOARD_SIZE + move.col));
+    }
+    return true;
+}
+
+bool GameRecord::toSaveData(GameSave::SaveData& data) const
+{
+    data.timestamp = QDateTime::fromMSecsSinceEpoch(timestamp);
+    data.isAIEnabled = isAIEnabled;
+    data.aiDifficulty = aiDifficulty;
+    data.undoLimit = undoLimit;
+    data.remainingUndos = remainingUndos;
+    data.currentPlayer = currentPlayer;
+
+    // 重放着法得到棋盘状态
+    data.board.assign(BOARD_SIZE, std::vector<int>(BOARD_SIZE, static_cast<int>(PieceType::NONE)));
+    data.history.clear();
+    data.history.reserve(moves.size());
+    for (size_t i = 0; i < moves.size(); ++i) {
+        const int row = moves[i] / BOARD_SIZE;
+        const int col = moves[i] % BOARD_SIZE;
+        if (moves[i] >= BOARD_SIZE * BOARD_SIZE ||
+            data.board[row][col] != static_cast<int>(PieceType::NONE)) {
+            return false;
+        }
+        const PieceType player = playerAt(i);
+        data.board[row][col] = static_cast<int>(player);
+        data.history.emplace_back(row, col, player);
+    }
+    return true;
+}
+
+GameRecordWriter::GameRecordWriter(QIODevice* device)
+    : device_(device)
+    , count_(0)
+    , failed_(false)
+{
+    buffer_.reserve(BUFFER_SIZE + GameRecord::HEADER_SIZE + GameRecord::BOARD_SIZE * GameRecord::BOARD_SIZE);
+}
+
+GameRecordWriter::~GameRecordWriter()
+{
+    flush();
+}
+
+bool GameRecordWriter::write(const GameRecord& record)
+{
+    if (failed_ || record.moves.size() > GameRecord::BOARD_SIZE * GameRecord::BOARD_SIZE) {
+        return false;
+    }
+
+    char header[GameRecord::HEADER_SIZE];
+    std::memcpy(header, GameRecord::MAGIC, sizeof(GameRecord::MAGIC));
+    header[4] = static_cast<char>(GameRecord::VERSION);
+    header[5] = static_cast<char>((record.isAIEnabled ? GameRecord::FLAG_AI_ENABLED : 0) |
+                                  (record.whiteFirst ? GameRecord::FLAG_WHITE_FIRST : 0));
+    header[6] = static_cast<char>(record.aiDifficulty);
+    header[7] = static_cast<char>(record.undoLimit);
+    header[8] = static_cast<char>(record.remainingUndos);
+    header[9] = static_cast<char>(record.currentPlayer);
+    putU16(header + 10, static_cast<uint16_t>(record.moves.size()));
+    std::memset(header + 12, 0, 4);
+    putI64(header + 16, record.timestamp);
+
+    buffer_.append(header, GameRecord::HEADER_SIZE);
+    buffer_.append(reinterpret_cast<const char*>(record.moves.data()),
+                   static_cast<int>(record.moves.size()));
+    ++count_;
+
+    if (buffer_.size() >= BUFFER_SIZE) {
+        return flush();
+    }
+    return true;
+}
+
+bool GameRecordWriter::flush()
+{
+    if (failed_) {
+        return false;
+    }
+    if (!buffer_.isEmpty()) {
+        if (device_->write(buffer_.constData(), buffer_.size()) != buffer_.size()) {
+            failed_ = true;
+            return false;
+        }
+        buffer_.resize(0);  // 保留容量
+    }
+    return true;
+}
+
+GameRecordReader::GameRecordReader(QIODevice* device)
+    : device_(device)
+    , position_(0)
+    , consumed_(0)
+{
+}
+
+bool GameRecordReader::ensure(int bytes)
+{
+    if (buffer_.size() - position_ >= bytes) {
+        return true;
+    }
+
+    // 丢弃已解析的部分，再从设备补充
+    if (position_ > 0) {
+        buffer_.remove(0, position_);
+        position_ = 0;
+    }
+    while (buffer_.size() < bytes) {
+        const int oldSize = buffer_.size();
+        const int want = std::max(CHUNK_SIZE, bytes - oldSize);
+        buffer_.resize(oldSize + want);
+        qint64 got = device_->read(buffer_.data() + oldSize, want);
+        buffer_.resize(oldSize + static_cast<int>(std::max<qint64>(got, 0)));
+        if (got <= 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool GameRecordReader::readNext(GameRecord& record)
+{
+    if (hasError()) {
+        return false;
+    }
+    if (!ensure(GameRecord::HEADER_SIZE)) {
+        if (buffer_.size() > position_) {
+            error_ = QString("棋谱在偏移%1处被截断").arg(consumed_);
+        }
+        return false;
+    }
+
+    const auto* header = reinterpret_cast<const unsigned char*>(buffer_.constData() + position_);
+    if (std::memcmp(header, GameRecord::MAGIC, sizeof(GameRecord::MAGIC)) != 0) {
+        error_ = QString("偏移%1处不是棋谱记录").arg(consumed_);
+        return false;
+    }
+    if (header[4] == 0 || header[4] > GameRecord::VERSION) {
+        error_ = QString("不支持的棋谱版本%1").arg(static_cast<int>(header[4]));
+        return false;
+    }
+    const int moveCount = decodeHeader(header, record);
+    if (moveCount < 0) {
+        error_ = QString("偏移%1处的着法数无效").arg(consumed_);
+        return false;
+    }
+
+    const int total = GameRecord::HEADER_SIZE + moveCount;
+    if (!ensure(total)) {
+        error_ = QString("棋谱在偏移%1处被截断").arg(consumed_);
+        return false;
+    }
+    // ensure可能移动了缓冲区
+    const auto* body = reinterpret_cast<const uint8_t*>(buffer_.constData() + position_ +
+                                                        GameRecord::HEADER_SIZE);
+    record.moves.assign(body, body + moveCount);
+
+    position_ += total;
+    consumed_ += total;
+    return true;
+}
+
+bool isGameRecordData(const QByteArray& data)
+{
+    return data.size() >= static_cast<int>(sizeof(GameRecord::MAGIC)) &&
+           std::memcmp(data.constData(), GameRecord::MAGIC, sizeof(GameRecord::MAGIC)) == 0;
+}
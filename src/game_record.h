@@ -0,0 +1,166 @@
+#ifndef GAME_RECORD_H
+#define GAME_RECORD_H
+
+#include <QByteArray>
+#include <QString>
+#include <cstdint>
+#include <vector>
+#include "game_types.h"
+#include "gamesave.h"
+
+class QIODevice;
+
+/**
+ * @brief 紧凑二进制棋谱
+ *
+ * 每局棋由24字节的文件头加每步1字节（格子下标 行 * 15 + 列）组成，
+ * 棋盘状态通过重放着法得到，不单独存储。多局棋谱直接首尾相接即为棋谱库。
+ *
+ * 记录格式（多字节字段均为小端序）：
+ * @code
+ * 偏移  长度  字段
+ * 0     4     魔数 "GMKR"
+ * 4     1     版本号（当前为1）
+ * 5     1     标志位：bit0 人机对战，bit1 白方先行
+ * 6     1     AI难度
+ * 7     1     悔棋次数限制
+ * 8     1     剩余悔棋次数
+ * 9     1     当前玩家（PieceType）
+ * 10    2     着法数n
+ * 12    4     保留，写0
+ * 16    8     存档时间（自1970年起的毫秒数）
+ * 24    n     着法，每步一个格子下标（0-224），黑白交替
+ * @endcode
+ */
+struct GameRecord {
+    static constexpr char MAGIC[4] = {'G', 'M', 'K', 'R'};
+    static constexpr uint8_t VERSION = 1;
+    static constexpr int HEADER_SIZE = 24;
+    static constexpr int BOARD_SIZE = 15;
+
+    static constexpr uint8_t FLAG_AI_ENABLED = 0x01;  ///< 人机对战
+    static constexpr uint8_t FLAG_WHITE_FIRST = 0x02; ///< 白方先行
+
+    qint64 timestamp = 0;            ///< 存档时间（毫秒）
+    bool isAIEnabled = false;        ///< 是否为人机对战
+    bool whiteFirst = false;         ///< 是否白方先行
+    int aiDifficulty = 1;            ///< AI难度
+    int undoLimit = 0;               ///< 悔棋次数限制
+    int remainingUndos = 0;          ///< 剩余悔棋次数
+    int currentPlayer = static_cast<int>(PieceType::BLACK);  ///< 当前玩家
+    std::vector<uint8_t> moves;      ///< 着法（格子下标）
+
+    /**
+     * @brief 第ply步的落子方
+     */
+    PieceType playerAt(size_t ply) const {
+        bool black = (ply % 2 == 0) != whiteFirst;
+        return black ? PieceType::BLACK : PieceType::WHITE;
+    }
+
+    /**
+     * @brief 从内存中解析一局棋谱（如内存映射的棋谱库）
+     * @param data 记录起始地址
+     * @param size 可读字节数
+     * @return 记录的总字节数；数据不完整或格式错误时返回0
+     */
+    static int decode(const char* data, qint64 size, GameRecord& record);
+
+    /**
+     * @brief 从存档数据转换
+     * @return 历史记录无法用交替落子的格子下标表示时返回false
+     */
+    static bool fromSaveData(const GameSave::SaveData& data, GameRecord& record);
+
+    /**
+     * @brief 转换为存档数据，棋盘状态由重放着法得到
+     * @return 着法越界或重复落子时返回false
+     */
+    bool toSaveData(GameSave::SaveData& data) const;
+};
+
+/**
+ * @brief 二进制棋谱流式写入
+ *
+ * 记录先写入内部缓冲区，缓冲区满或调用flush()时写入设备。
+ * 设备由调用者打开和关闭，析构时自动flush。
+ */
+class GameRecordWriter {
+public:
+    explicit GameRecordWriter(QIODevice* device);
+    ~GameRecordWriter();
+
+    /**
+     * @brief 追加一局棋谱
+     */
+    bool write(const GameRecord& record);
+
+    /**
+     * @brief 把缓冲区写入设备
+     */
+    bool flush();
+
+    /**
+     * @brief 已写入的棋谱数
+     */
+    qint64 count() const { return count_; }
+
+private:
+    static constexpr int BUFFER_SIZE = 1 << 16;
+
+    QIODevice* device_;
+    QByteArray buffer_;
+    qint64 count_;
+    bool failed_;
+};
+
+/**
+ * @brief 二进制棋谱流式读取
+ *
+ * 按块读入设备内容，逐局解析；readNext复用record的着法缓冲区，
+ * 顺序读取整个棋谱库时不会为每局棋分配内存。
+ */
+class GameRecordReader {
+public:
+    explicit GameRecordReader(QIODevice* device);
+
+    /**
+     * @brief 读取下一局棋谱
+     * @return 读到末尾或格式错误时返回false，用hasError()区分
+     */
+    bool readNext(GameRecord& record);
+
+    /**
+     * @brief 是否遇到格式错误（魔数、版本或截断）
+     */
+    bool hasError() const { return !error_.isEmpty(); }
+
+    /**
+     * @brief 错误描述
+     */
+    QString errorString() const { return error_; }
+
+    /**
+     * @brief 下一局棋谱在设备中的偏移（字节）
+     */
+    qint64 offset() const { return consumed_; }
+
+private:
+    static constexpr int CHUNK_SIZE = 1 << 16;
+
+    QIODevice* device_;
+    QByteArray buffer_;
+    int position_;       ///< 缓冲区中的读取位置
+    qint64 consumed_;    ///< 已解析的字节数
+    QString error_;
+
+    // 保证缓冲区中至少有bytes字节可读，设备已读完时返回false
+    bool ensure(int bytes);
+};
+
+/**
+ * @brief 判断数据是否以二进制棋谱魔数开头
+ */
+bool isGameRecordData(const QByteArray& data);
+
+#endif // GAME_RECORD_H
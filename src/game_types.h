@@ -21,6 +21,8 @@ enum class PieceType {
 enum class AIStrategyType {
     RuleBased,  // 基于规则的AI
     AStar,      // A*启发式搜索AI
+    MCTS,       // 蒙特卡洛树搜索AI
+    AlphaBeta,  // 分步迭代加深搜索AI
     // 后续可以添加更多AI策略类型
 };
 
@@ -8,9 +8,11 @@ GameDialog::GameDialog(QWidget *parent)
     : QDialog(parent)
     , gameMode(GameMode::PlayerVsPlayer)
     , aiStrategy("RuleBased")
+    , evaluator("Pattern")
     , aiDifficulty(3)
     , undoLimit(3)  // 默认允许3次悔棋
     , playerPieceType(PieceType::BLACK)  // 默认玩家执黑
+    , keepSearchState(true)
 {
     setWindowTitle("游戏设置");
     
@@ -33,9 +35,21 @@ GameDialog::GameDialog(QWidget *parent)
     strategyComboBox = new QComboBox(this);
     strategyComboBox->addItem("规则基础AI");  // RuleBased
     strategyComboBox->addItem("A*启发式搜索AI");  // AStar
+    strategyComboBox->addItem("蒙特卡洛树搜索AI");  // MCTS
+    strategyComboBox->addItem("迭代加深搜索AI（思考时界面不卡顿）");  // AlphaBeta
     strategyLayout->addWidget(strategyLabel);
     strategyLayout->addWidget(strategyComboBox);
     mainLayout->addLayout(strategyLayout);
+
+    // 创建评估函数选择（仅搜索类AI可用）
+    QHBoxLayout *evaluatorLayout = new QHBoxLayout;
+    evaluatorLabel = new QLabel("评估函数:", this);
+    evaluatorComboBox = new QComboBox(this);
+    evaluatorComboBox->addItem("棋型评估");  // Pattern
+    evaluatorComboBox->addItem("神经网络评估(NNUE)");  // NNUE
+    evaluatorLayout->addWidget(evaluatorLabel);
+    evaluatorLayout->addWidget(evaluatorComboBox);
+    mainLayout->addLayout(evaluatorLayout);
     
     // 创建AI难度设置
     QHBoxLayout *difficultyLayout = new QHBoxLayout;
@@ -68,6 +82,25 @@ GameDialog::GameDialog(QWidget *parent)
     undoLayout->addWidget(undoLabel);
     undoLayout->addWidget(undoSpinBox);
     mainLayout->addLayout(undoLayout);
+
+    // 创建时间控制选择（双方使用同一时钟，AI按剩余时间分配思考时间）
+    QHBoxLayout *timeLayout = new QHBoxLayout;
+    QLabel *timeLabel = new QLabel("时间控制:", this);
+    timeComboBox = new QComboBox(this);
+    timeComboBox->addItem("不限时");
+    timeComboBox->addItem("3分钟 + 每步2秒");
+    timeComboBox->addItem("5分钟 + 每步3秒");
+    timeComboBox->addItem("10分钟 + 每步5秒");
+    timeComboBox->addItem("每步5秒");
+    timeComboBox->addItem("每步15秒");
+    timeLayout->addWidget(timeLabel);
+    timeLayout->addWidget(timeComboBox);
+    mainLayout->addLayout(timeLayout);
+
+    // 创建搜索状态设置：同一AI的置换表等在各局之间沿用
+    keepSearchCheckBox = new QCheckBox("保留AI上一局的搜索结果", this);
+    keepSearchCheckBox->setChecked(true);
+    mainLayout->addWidget(keepSearchCheckBox);
     
     // 创建按钮
     QDialogButtonBox *buttonBox = new QDialogButtonBox(
@@ -82,6 +115,8 @@ GameDialog::GameDialog(QWidget *parent)
             this, &GameDialog::onGameModeChanged);
     connect(strategyComboBox, QOverload<int>::of(&QComboBox::currentIndexChanged),
             this, &GameDialog::onAIStrategyChanged);
+    connect(evaluatorComboBox, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &GameDialog::onEvaluatorChanged);
     connect(colorComboBox, QOverload<int>::of(&QComboBox::currentIndexChanged),
             this, &GameDialog::onPlayerColorChanged);
     connect(buttonBox, &QDialogButtonBox::accepted, this, &GameDialog::onOkClicked);
@@ -107,6 +142,8 @@ void GameDialog::onGameModeChanged(int index)
     difficultySpinBox->setEnabled(isAIMode);
     colorLabel->setEnabled(isAIMode);
     colorComboBox->setEnabled(isAIMode);
+    keepSearchCheckBox->setEnabled(isAIMode);
+    updateEvaluatorEnabled();
 }
 
 void GameDialog::onAIStrategyChanged(int index)
@@ -119,10 +156,51 @@ void GameDialog::onAIStrategyChanged(int index)
         case 1:
             aiStrategy = "AStar";
             break;
+        case 2:
+            aiStrategy = "MCTS";
+            break;
+        case 3:
+            aiStrategy = "AlphaBeta";
+            break;
         default:
             aiStrategy = "RuleBased";
             break;
     }
+    // 走子模拟只适用于蒙特卡洛树搜索
+    const int rolloutIndex = 2;
+    if (aiStrategy == "MCTS" && evaluatorComboBox->count() <= rolloutIndex) {
+        evaluatorComboBox->addItem("快速走子模拟");  // Rollout
+        evaluatorComboBox->setCurrentIndex(rolloutIndex);
+    } else if (aiStrategy != "MCTS" && evaluatorComboBox->count() > rolloutIndex) {
+        if (evaluatorComboBox->currentIndex() == rolloutIndex) {
+            evaluatorComboBox->setCurrentIndex(0);
+        }
+        evaluatorComboBox->removeItem(rolloutIndex);
+    }
+    updateEvaluatorEnabled();
+}
+
+void GameDialog::onEvaluatorChanged(int index)
+{
+    switch (index) {
+        case 1:
+            evaluator = "NNUE";
+            break;
+        case 2:
+            evaluator = "Rollout";
+            break;
+        default:
+            evaluator = "Pattern";
+            break;
+    }
+}
+
+void GameDialog::updateEvaluatorEnabled()
+{
+    // 规则基础AI不使用评估函数
+    bool enabled = gameMode == GameMode::PlayerVsAI && aiStrategy != "RuleBased";
+    evaluatorLabel->setEnabled(enabled);
+    evaluatorComboBox->setEnabled(enabled);
 }
 
 void GameDialog::onPlayerColorChanged(int index)
@@ -135,5 +213,16 @@ void GameDialog::onOkClicked()
 {
     aiDifficulty = difficultySpinBox->value();
     undoLimit = undoSpinBox->value();
+    keepSearchState = keepSearchCheckBox->isChecked();
+    // 与timeComboBox的选项一一对应
+    const TimeControl presets[] = {
+        TimeControl(),
+        TimeControl::fischer(3 * 60000, 2000),
+        TimeControl::fischer(5 * 60000, 3000),
+        TimeControl::fischer(10 * 60000, 5000),
+        TimeControl::perMove(5000),
+        TimeControl::perMove(15000),
+    };
+    timeControl = presets[timeComboBox->currentIndex()];
     accept();
 } 
\ No newline at end of file
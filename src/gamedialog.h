@@ -4,9 +4,11 @@
 #include <QDialog>
 #include <QComboBox>
 #include <QSpinBox>
+#include <QCheckBox>
 #include <QLabel>
 #include <QString>
 #include "game_types.h"
+#include "game_clock.h"
 
 /**
  * @brief 游戏设置对话框类
@@ -39,6 +41,11 @@ public:
      */
     QString getAIStrategy() const { return aiStrategy; }
 
+    /**
+     * @brief 获取选择的评估函数（仅搜索类AI使用）
+     */
+    QString getEvaluator() const { return evaluator; }
+
     /**
      * @brief 获取AI难度等级
      */
@@ -54,6 +61,16 @@ public:
      */
     PieceType getPlayerPieceType() const { return playerPieceType; }
 
+    /**
+     * @brief 是否保留AI上一局的搜索状态
+     */
+    bool getKeepSearchState() const { return keepSearchState; }
+
+    /**
+     * @brief 获取选择的时间控制
+     */
+    TimeControl getTimeControl() const { return timeControl; }
+
 private slots:
     /**
      * @brief 游戏模式改变时的处理函数
@@ -65,6 +82,11 @@ private slots:
      */
     void onAIStrategyChanged(int index);
 
+    /**
+     * @brief 评估函数改变时的处理函数
+     */
+    void onEvaluatorChanged(int index);
+
     /**
      * @brief 确认按钮点击处理函数
      */
@@ -76,21 +98,33 @@ private slots:
     void onPlayerColorChanged(int index);
 
 private:
+    /**
+     * @brief 根据游戏模式和AI策略更新评估函数控件的可用状态
+     */
+    void updateEvaluatorEnabled();
+
     GameMode gameMode;        ///< 当前选择的游戏模式
     QString aiStrategy;       ///< 当前选择的AI策略
+    QString evaluator;        ///< 当前选择的评估函数
     int aiDifficulty;        ///< AI难度等级（1-5）
     int undoLimit;           ///< 允许的悔棋次数
     PieceType playerPieceType; ///< 玩家选择的棋子颜色
+    bool keepSearchState;    ///< 是否保留AI上一局的搜索状态
+    TimeControl timeControl; ///< 时间控制
     
     QComboBox *modeComboBox;     ///< 游戏模式选择框
     QComboBox *strategyComboBox; ///< AI策略选择框
+    QComboBox *evaluatorComboBox; ///< 评估函数选择框
     QComboBox *colorComboBox;    ///< 棋子颜色选择框
     QLabel *strategyLabel;       ///< AI策略标签
+    QLabel *evaluatorLabel;      ///< 评估函数标签
     QLabel *difficultyLabel;     ///< AI难度标签
     QLabel *colorLabel;          ///< 棋子颜色标签
     QSpinBox *difficultySpinBox; ///< AI难度选择框
     QLabel *undoLabel;           ///< 悔棋次数标签
     QSpinBox *undoSpinBox;
+    QCheckBox *keepSearchCheckBox; ///< 保留搜索状态复选框
+    QComboBox *timeComboBox;     ///< 时间控制选择框
 };
 
 #endif // GAMEDIALOG_H 
\ No newline at end of file
@@ -1,12 +1,36 @@
 #include "gamesave.h"
-#include "board.h"
+#include "game_record.h"
+#include <QBuffer>
 #include <QFile>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
 
+GameSave::Format GameSave::formatForFile(const QString& filename)
+{
+    return filename.endsWith(".gmkr", Qt::CaseInsensitive) ? Format::Binary : Format::Json;
+}
+
 bool GameSave::saveGame(const QString& filename, const SaveData& data)
 {
+    return saveGame(filename, data, formatForFile(filename));
+}
+
+bool GameSave::saveGame(const QString& filename, const SaveData& data, Format format)
+{
+    if (format == Format::Binary) {
+        GameRecord record;
+        if (!GameRecord::fromSaveData(data, record)) {
+            return false;
+        }
+        QFile file(filename);
+        if (!file.open(QIODevice::WriteOnly)) {
+            return false;
+        }
+        GameRecordWriter writer(&file);
+        return writer.write(record) && writer.flush();
+    }
+
     QJsonObject saveObj;
     
     // 保存基本信息
@@ -58,7 +82,18 @@ bool GameSave::loadGame(const QString& filename, SaveData& data)
         return false;
     }
     
-    QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
+    QByteArray content = file.readAll();
+
+    // 二进制棋谱以魔数开头，否则按JSON解析
+    if (isGameRecordData(content)) {
+        QBuffer buffer(&content);
+        buffer.open(QIODevice::ReadOnly);
+        GameRecordReader reader(&buffer);
+        GameRecord record;
+        return reader.readNext(record) && record.toSaveData(data);
+    }
+
+    QJsonDocument doc = QJsonDocument::fromJson(content);
     if (doc.isNull()) {
         return false;
     }
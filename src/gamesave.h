@@ -36,7 +36,20 @@ public:
     };
 
     /**
-     * @brief 保存游戏状态
+     * @brief 存档格式
+     */
+    enum class Format {
+        Json,    ///< JSON文本（.gomoku）
+        Binary   ///< 紧凑二进制棋谱（.gmkr，见game_record.h）
+    };
+
+    /**
+     * @brief 根据扩展名选择存档格式（.gmkr为二进制，其余为JSON）
+     */
+    static Format formatForFile(const QString& filename);
+
+    /**
+     * @brief 保存游戏状态，格式由扩展名决定
      * @param filename 存档文件名
      * @param data 游戏数据
      * @return 是否保存成功
@@ -44,7 +57,12 @@ public:
     static bool saveGame(const QString& filename, const SaveData& data);
 
     /**
-     * @brief 加载游戏状态
+     * @brief 以指定格式保存游戏状态
+     */
+    static bool saveGame(const QString& filename, const SaveData& data, Format format);
+
+    /**
+     * @brief 加载游戏状态，自动识别JSON和二进制格式
      * @param filename 存档文件名
      * @param data 加载到的数据结构
      * @return 是否加载成功
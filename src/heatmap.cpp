@@ -0,0 +1,51 @@
+#include "heatmap.h"
+#include "zobrist.h"
+#include "profiler.h"
+#include <QHash>
+#include <algorithm>
+
+Heatmap Heatmap::compute(const Position& position, Evaluator& evaluator)
+{
+    PROFILE_ZONE("Heatmap::compute");
+    Heatmap heatmap;
+    auto state = position.getBoardState();
+    const int size = position.getSize();
+    evaluator.reset(state);
+
+    const PieceType sides[] = {PieceType::BLACK, PieceType::WHITE};
+    for (PieceType side : sides) {
+        int* gains = (side == PieceType::BLACK) ? heatmap.black : heatmap.white;
+        const int base = evaluator.evaluate(state, side);
+        for (int cell = 0; cell < CELLS; ++cell) {
+            const int row = cell / size;
+            const int col = cell % size;
+            if (state[row][col] != PieceType::NONE) {
+                continue;
+            }
+            if (position.makesFive(row, col, side)) {
+                gains[cell] = WIN_GAIN;
+            } else {
+                // 在同一份棋盘上就地落子、评估、还原
+                state[row][col] = side;
+                evaluator.makeMove(row, col, side);
+                gains[cell] = std::clamp(evaluator.evaluate(state, side) - base, 0, WIN_GAIN);
+                evaluator.unmakeMove(row, col, side);
+                state[row][col] = PieceType::NONE;
+            }
+            heatmap.maxGain = std::max(heatmap.maxGain, gains[cell]);
+        }
+    }
+    return heatmap;
+}
+
+uint64_t Heatmap::cacheKey(const Position& position, const QString& evaluator)
+{
+    uint64_t key = static_cast<uint64_t>(qHash(evaluator)) * 0x9E3779B97F4A7C15ULL;
+    for (int cell = 0; cell < CELLS; ++cell) {
+        const PieceType piece = position.getPiece(cell / position.getSize(), cell % position.getSize());
+        if (piece != PieceType::NONE) {
+            key ^= Zobrist::key(piece, cell);
+        }
+    }
+    return key;
+}
@@ -0,0 +1,38 @@
+#ifndef HEATMAP_H
+#define HEATMAP_H
+
+#include <QString>
+#include <cstdint>
+#include "evaluator.h"
+#include "position.h"
+
+/**
+ * @brief 每个空位对双方的价值
+ *
+ * 对每个空位分别假设黑方、白方落子，用评估函数算出局面分数相对落子前的提升；
+ * 能直接连五的点记为WIN_GAIN。已有棋子的位置为0。
+ * 与轮到哪一方无关，同一局面（及同一评估函数）的结果可以缓存复用。
+ */
+struct Heatmap {
+    static constexpr int CELLS = Position::CELLS;
+    static constexpr int WIN_GAIN = 200000;   ///< 连五点的价值
+
+    uint64_t key = 0;        ///< 局面与评估函数的哈希（cacheKey）
+    int black[CELLS] = {};   ///< 黑方落在各点的价值
+    int white[CELLS] = {};   ///< 白方落在各点的价值
+    int maxGain = 0;         ///< 双方价值的最大值（用于归一化）
+
+    /**
+     * @brief 计算局面的热度图
+     * @param position 局面
+     * @param evaluator 评估函数（会被reset）
+     */
+    static Heatmap compute(const Position& position, Evaluator& evaluator);
+
+    /**
+     * @brief 缓存键：局面的Zobrist哈希与评估函数名称的组合
+     */
+    static uint64_t cacheKey(const Position& position, const QString& evaluator);
+};
+
+#endif // HEATMAP_H
@@ -0,0 +1,124 @@
+#include "heatmap_overlay.h"
+#include "profiler.h"
+#include <QMetaObject>
+#include <QPainter>
+#include <algorithm>
+#include <cmath>
+#include <memory>
+
+HeatmapOverlay::HeatmapOverlay(int margin, int cellSize, int boardSize, QObject *parent)
+    : QObject(parent)
+    , margin_(margin)
+    , cellSize_(cellSize)
+    , boardSize_(boardSize)
+    , cache_(CACHE_ENTRIES)
+    , layerKey_(0)
+    , devicePixelRatio_(1.0)
+    , busy_(false)
+    , hasPending_(false)
+    , wantedKey_(0)
+{
+}
+
+HeatmapOverlay::~HeatmapOverlay()
+{
+    // 等待后台任务结束；它投递的结果事件随本对象一起丢弃
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+void HeatmapOverlay::request(const Position& position, const QString& evaluator, qreal devicePixelRatio)
+{
+    const uint64_t key = Heatmap::cacheKey(position, evaluator);
+    wantedKey_ = key;
+    if (layerKey_ == key && !layer_.isNull() && devicePixelRatio_ == devicePixelRatio) {
+        return;
+    }
+    devicePixelRatio_ = devicePixelRatio;
+
+    // 缓存命中：只需重新画图层
+    if (const Heatmap* cached = cache_.object(key)) {
+        render(*cached);
+        emit ready();
+        return;
+    }
+    if (busy_) {
+        pending_ = position;
+        pendingEvaluator_ = evaluator;
+        hasPending_ = true;
+        return;
+    }
+    start(position, evaluator, key);
+}
+
+void HeatmapOverlay::start(const Position& position, const QString& evaluator, uint64_t key)
+{
+    busy_ = true;
+    if (worker_.joinable()) {
+        worker_.join();  // 上一个任务已投递结果，立即返回
+    }
+    worker_ = std::thread([this, position, evaluator, key]() {
+        auto instance = Evaluator::create(evaluator);
+        if (!instance) {
+            instance = Evaluator::create("Pattern");
+        }
+        auto heatmap = std::make_shared<Heatmap>(Heatmap::compute(position, *instance));
+        heatmap->key = key;
+        QMetaObject::invokeMethod(this, [this, heatmap]() { finish(heatmap.get()); }, Qt::QueuedConnection);
+    });
+}
+
+void HeatmapOverlay::finish(Heatmap* heatmap)
+{
+    busy_ = false;
+    cache_.insert(heatmap->key, new Heatmap(*heatmap));
+    if (heatmap->key == wantedKey_) {
+        render(*heatmap);
+        emit ready();
+    }
+    if (hasPending_) {
+        hasPending_ = false;
+        request(pending_, pendingEvaluator_, devicePixelRatio_);
+    }
+}
+
+void HeatmapOverlay::render(const Heatmap& heatmap)
+{
+    PROFILE_ZONE("HeatmapOverlay::render");
+    const int side = boardSize_ * cellSize_ + 2 * margin_;
+    QPixmap pixmap(QSize(side, side) * devicePixelRatio_);
+    pixmap.setDevicePixelRatio(devicePixelRatio_);
+    pixmap.fill(Qt::transparent);
+
+    QPainter painter(&pixmap);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setPen(Qt::NoPen);
+    const int radius = cellSize_ / 2 - 3;
+    for (int cell = 0; cell < Heatmap::CELLS && heatmap.maxGain > 0; ++cell) {
+        const int black = heatmap.black[cell];
+        const int white = heatmap.white[cell];
+        const int gain = std::max(black, white);
+        if (gain <= 0) {
+            continue;
+        }
+        // 亮度按开方压缩，使次要的点也能看到；颜色按双方价值的比例在橙（黑方）和蓝（白方）之间过渡
+        const double strength = std::sqrt(static_cast<double>(gain) / heatmap.maxGain);
+        if (strength < 0.08) {
+            continue;
+        }
+        const double ratio = static_cast<double>(black) / (black + white);
+        QColor color(static_cast<int>(40 + 190 * ratio),
+                     static_cast<int>(110 + 10 * ratio),
+                     static_cast<int>(220 - 190 * ratio),
+                     static_cast<int>(30 + 170 * strength));
+        painter.setBrush(color);
+        const int row = cell / boardSize_;
+        const int col = cell % boardSize_;
+        painter.drawEllipse(QPoint(margin_ + col * cellSize_, margin_ + row * cellSize_), radius, radius);
+    }
+    painter.end();
+
+    layer_ = pixmap;
+    layerKey_ = heatmap.key;
+}
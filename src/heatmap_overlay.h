@@ -0,0 +1,78 @@
+#ifndef HEATMAP_OVERLAY_H
+#define HEATMAP_OVERLAY_H
+
+#include <QObject>
+#include <QCache>
+#include <QPixmap>
+#include <QString>
+#include <thread>
+#include "heatmap.h"
+#include "position.h"
+
+/**
+ * @brief 棋盘的提示热度图图层
+ *
+ * 热度图在后台线程上计算（每个空位对双方各评估一次），结果按局面哈希缓存；
+ * 计算完成后在界面线程上一次性画成透明的QPixmap图层，paintEvent只需贴图。
+ * 同一时间只有一个后台任务，计算期间局面又变化时只保留最新的请求。
+ */
+class HeatmapOverlay : public QObject {
+    Q_OBJECT
+
+public:
+    /**
+     * @param margin 棋盘边距（像素）
+     * @param cellSize 格子大小（像素）
+     * @param boardSize 棋盘路数
+     */
+    HeatmapOverlay(int margin, int cellSize, int boardSize, QObject *parent = nullptr);
+    ~HeatmapOverlay() override;
+
+    /**
+     * @brief 请求局面的热度图：已缓存时立即生成图层，否则交给后台计算
+     * @param position 局面
+     * @param evaluator 评估函数名称
+     * @param devicePixelRatio 图层的设备像素比
+     */
+    void request(const Position& position, const QString& evaluator, qreal devicePixelRatio);
+
+    /**
+     * @brief 与key对应的图层，尚未算好时返回nullptr
+     */
+    const QPixmap* layer(uint64_t key) const { return layerKey_ == key && !layer_.isNull() ? &layer_ : nullptr; }
+
+signals:
+    /**
+     * @brief 新图层已生成
+     */
+    void ready();
+
+private:
+    static const int CACHE_ENTRIES = 256;  ///< 缓存的局面数
+
+    int margin_;
+    int cellSize_;
+    int boardSize_;
+    QCache<quint64, Heatmap> cache_;       ///< 局面哈希 -> 热度图
+    QPixmap layer_;                        ///< 当前图层
+    uint64_t layerKey_;                    ///< 当前图层对应的键
+    qreal devicePixelRatio_;
+
+    std::thread worker_;                   ///< 后台任务（同一时间最多一个）
+    bool busy_;
+    bool hasPending_;                      ///< 计算期间收到的最新请求
+    Position pending_;
+    QString pendingEvaluator_;
+    uint64_t wantedKey_;                   ///< 最近一次请求的键
+
+    // 在后台开始计算
+    void start(const Position& position, const QString& evaluator, uint64_t key);
+
+    // 后台任务完成（界面线程）
+    void finish(Heatmap* heatmap);
+
+    // 把热度图画成图层
+    void render(const Heatmap& heatmap);
+};
+
+#endif // HEATMAP_OVERLAY_H
@@ -0,0 +1,171 @@
+#include "line_kernel.h"
+#include "line_kernel_impl.h"
+#include "cpu_features.h"
+#include <atomic>
+
+namespace {
+
+// 标量实现：逐行处理16个16位掩码
+struct ScalarOps {
+    struct Vec {
+        uint16_t v[BitBoard::LANES];
+    };
+
+    static Vec load(const uint16_t* p) {
+        Vec r;
+        for (int i = 0; i < BitBoard::LANES; ++i) r.v[i] = p[i];
+        return r;
+    }
+    static void store(uint16_t* p, const Vec& a) {
+        for (int i = 0; i < BitBoard::LANES; ++i) p[i] = a.v[i];
+    }
+    static Vec zero() {
+        return Vec{};
+    }
+    static Vec and_(const Vec& a, const Vec& b) {
+        Vec r;
+        for (int i = 0; i < BitBoard::LANES; ++i) r.v[i] = a.v[i] & b.v[i];
+        return r;
+    }
+    static Vec or_(const Vec& a, const Vec& b) {
+        Vec r;
+        for (int i = 0; i < BitBoard::LANES; ++i) r.v[i] = a.v[i] | b.v[i];
+        return r;
+    }
+    static Vec xor_(const Vec& a, const Vec& b) {
+        Vec r;
+        for (int i = 0; i < BitBoard::LANES; ++i) r.v[i] = a.v[i] ^ b.v[i];
+        return r;
+    }
+    // a & ~b
+    static Vec andNot(const Vec& a, const Vec& b) {
+        Vec r;
+        for (int i = 0; i < BitBoard::LANES; ++i) r.v[i] = a.v[i] & static_cast<uint16_t>(~b.v[i]);
+        return r;
+    }
+    static Vec rowsFromNext(const Vec& a) {
+        Vec r;
+        for (int i = 0; i < BitBoard::LANES - 1; ++i) r.v[i] = a.v[i + 1];
+        r.v[BitBoard::LANES - 1] = 0;
+        return r;
+    }
+    static Vec rowsFromPrev(const Vec& a) {
+        Vec r;
+        r.v[0] = 0;
+        for (int i = 1; i < BitBoard::LANES; ++i) r.v[i] = a.v[i - 1];
+        return r;
+    }
+    static Vec colsFromNext(const Vec& a) {
+        Vec r;
+        for (int i = 0; i < BitBoard::LANES; ++i) r.v[i] = static_cast<uint16_t>(a.v[i] >> 1);
+        return r;
+    }
+    static Vec colsFromPrev(const Vec& a) {
+        Vec r;
+        for (int i = 0; i < BitBoard::LANES; ++i) r.v[i] = static_cast<uint16_t>(a.v[i] << 1);
+        return r;
+    }
+    static bool isZero(const Vec& a) {
+        uint16_t any = 0;
+        for (int i = 0; i < BitBoard::LANES; ++i) any |= a.v[i];
+        return any == 0;
+    }
+    static void expandRow(const uint16_t words[5], uint8_t* out) {
+        for (int col = 0; col < BitBoard::LANES; ++col) {
+            uint8_t value = 0;
+            for (int b = 0; b < 5; ++b) {
+                value |= static_cast<uint8_t>(((words[b] >> col) & 1u) << b);
+            }
+            out[col] = value;
+        }
+    }
+};
+
+void computeScalar(const uint16_t* stones, LineKernel::LineCounts& out)
+{
+    LineKernel::detail::computeLineCountsT<ScalarOps>(stones, out);
+}
+
+LineKernel::detail::ComputeFn implFor(LineKernel::Backend backend)
+{
+    switch (backend) {
+        case LineKernel::Backend::AVX2:
+            return CpuFeatures::hasAvx2() ? LineKernel::detail::avx2Impl : nullptr;
+        case LineKernel::Backend::SSE2:
+            return CpuFeatures::hasSse2() ? LineKernel::detail::sse2Impl : nullptr;
+        case LineKernel::Backend::Scalar:
+            return LineKernel::detail::scalarImpl;
+    }
+    return nullptr;
+}
+
+struct Dispatch {
+    std::atomic<LineKernel::detail::ComputeFn> fn;
+    std::atomic<LineKernel::Backend> backend;
+
+    Dispatch() {
+        // 按从快到慢的顺序选择第一个可用实现
+        const LineKernel::Backend order[] = {
+            LineKernel::Backend::AVX2, LineKernel::Backend::SSE2, LineKernel::Backend::Scalar
+        };
+        for (LineKernel::Backend candidate : order) {
+            if (LineKernel::detail::ComputeFn impl = implFor(candidate)) {
+                fn.store(impl);
+                backend.store(candidate);
+                break;
+            }
+        }
+    }
+};
+
+Dispatch& dispatch()
+{
+    static Dispatch instance;
+    return instance;
+}
+
+} // namespace
+
+namespace LineKernel {
+
+namespace detail {
+const ComputeFn scalarImpl = &computeScalar;
+} // namespace detail
+
+void computeLineCounts(const uint16_t* stones, LineCounts& out)
+{
+    dispatch().fn.load(std::memory_order_relaxed)(stones, out);
+}
+
+Backend activeBackend()
+{
+    return dispatch().backend.load(std::memory_order_relaxed);
+}
+
+bool setBackend(Backend backend)
+{
+    detail::ComputeFn impl = implFor(backend);
+    if (!impl) {
+        return false;
+    }
+    dispatch().fn.store(impl);
+    dispatch().backend.store(backend);
+    return true;
+}
+
+bool isBackendAvailable(Backend backend)
+{
+    return implFor(backend) != nullptr;
+}
+
+const char* backendName(Backend backend)
+{
+    switch (backend) {
+        case Backend::AVX2: return "avx2";
+        case Backend::SSE2: return "sse2";
+        case Backend::Scalar: return "scalar";
+    }
+    return "unknown";
+}
+
+} // namespace LineKernel
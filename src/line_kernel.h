@@ -0,0 +1,79 @@
+#ifndef LINE_KERNEL_H
+#define LINE_KERNEL_H
+
+#include <cstdint>
+#include "bitboard.h"
+
+/**
+ * @brief 整盘连子数计算内核
+ *
+ * 一次性计算棋盘上每个格子在四条轴线（横、竖、主对角线、副对角线）上
+ * 的连子数：假设该格放上一枚指定颜色的棋子后，沿该轴线两侧连续同色
+ * 棋子数加1，即RuleBasedAI::checkLine对每个格子的结果。
+ *
+ * 实现方式是对位平面做逐行/逐对角线平移：第k次平移后仍为1的位表示
+ * 该方向上至少有k个连续同色子，再用位切片加法得到每格的计数。
+ * 内核分别以AVX2、SSE2和标量方式编译，首次调用时按CPU能力选择。
+ */
+namespace LineKernel {
+
+/**
+ * @brief 轴线编号
+ */
+enum Axis {
+    AXIS_HORIZONTAL = 0,  ///< 横向 (0, 1)
+    AXIS_VERTICAL = 1,    ///< 纵向 (1, 0)
+    AXIS_DIAGONAL = 2,    ///< 主对角线 (1, 1)
+    AXIS_ANTI_DIAGONAL = 3,  ///< 副对角线 (1, -1)
+    AXIS_COUNT = 4
+};
+
+/**
+ * @brief 内核实现类型
+ */
+enum class Backend {
+    Scalar,  ///< 标量实现（所有平台可用）
+    SSE2,    ///< 两个128位向量表示整块棋盘
+    AVX2     ///< 一个256位向量表示整块棋盘
+};
+
+/**
+ * @brief 每个格子在四条轴线上的连子数
+ *
+ * 列方向填充到16，便于向量化写出整行。
+ */
+struct LineCounts {
+    alignas(32) uint8_t count[AXIS_COUNT][BitBoard::LANES][BitBoard::LANES];
+};
+
+/**
+ * @brief 计算一种颜色的整盘连子数
+ * @param stones 该颜色的位平面（BitBoard::plane）
+ * @param out 输出结果
+ */
+void computeLineCounts(const uint16_t* stones, LineCounts& out);
+
+/**
+ * @brief 获取当前使用的实现
+ */
+Backend activeBackend();
+
+/**
+ * @brief 强制使用指定实现（用于对比测试和基准）
+ * @return 当前CPU或构建不支持该实现时返回false，保持原实现不变
+ */
+bool setBackend(Backend backend);
+
+/**
+ * @brief 当前CPU和构建是否支持指定实现
+ */
+bool isBackendAvailable(Backend backend);
+
+/**
+ * @brief 获取实现名称
+ */
+const char* backendName(Backend backend);
+
+} // namespace LineKernel
+
+#endif // LINE_KERNEL_H
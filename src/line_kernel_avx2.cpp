@@ -0,0 +1,90 @@
+#include "line_kernel_impl.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+
+namespace {
+
+// AVX2实现：一个256位向量保存整块棋盘（16行 x 16位）
+struct Avx2Ops {
+    using Vec = __m256i;
+
+    static Vec load(const uint16_t* p) {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    }
+    static void store(uint16_t* p, Vec a) {
+        _mm256_store_si256(reinterpret_cast<__m256i*>(p), a);
+    }
+    static Vec zero() {
+        return _mm256_setzero_si256();
+    }
+    static Vec and_(Vec a, Vec b) {
+        return _mm256_and_si256(a, b);
+    }
+    static Vec or_(Vec a, Vec b) {
+        return _mm256_or_si256(a, b);
+    }
+    static Vec xor_(Vec a, Vec b) {
+        return _mm256_xor_si256(a, b);
+    }
+    // a & ~b
+    static Vec andNot(Vec a, Vec b) {
+        return _mm256_andnot_si256(b, a);
+    }
+    // 整个256位右移2字节：高128位的低字移入低128位
+    static Vec rowsFromNext(Vec a) {
+        const __m256i carry = _mm256_permute2x128_si256(a, a, 0x81);
+        return _mm256_alignr_epi8(carry, a, 2);
+    }
+    // 整个256位左移2字节：低128位的高字移入高128位
+    static Vec rowsFromPrev(Vec a) {
+        const __m256i carry = _mm256_permute2x128_si256(a, a, 0x08);
+        return _mm256_alignr_epi8(a, carry, 14);
+    }
+    static Vec colsFromNext(Vec a) {
+        return _mm256_srli_epi16(a, 1);
+    }
+    static Vec colsFromPrev(Vec a) {
+        return _mm256_slli_epi16(a, 1);
+    }
+    static bool isZero(Vec a) {
+        return _mm256_testz_si256(a, a) != 0;
+    }
+    static void expandRow(const uint16_t words[5], uint8_t* out) {
+        const __m256i select = _mm256_setr_epi16(
+            0x0001, 0x0002, 0x0004, 0x0008, 0x0010, 0x0020, 0x0040, 0x0080,
+            0x0100, 0x0200, 0x0400, 0x0800, 0x1000, 0x2000, 0x4000, static_cast<short>(0x8000));
+        __m256i acc = _mm256_setzero_si256();
+        for (int b = 0; b < 5; ++b) {
+            const __m256i word = _mm256_set1_epi16(static_cast<short>(words[b]));
+            const __m256i hit = _mm256_cmpeq_epi16(_mm256_and_si256(word, select), select);
+            acc = _mm256_or_si256(acc, _mm256_and_si256(hit, _mm256_set1_epi16(static_cast<short>(1 << b))));
+        }
+        const __m128i packed = _mm_packus_epi16(_mm256_castsi256_si128(acc),
+                                                _mm256_extracti128_si256(acc, 1));
+        _mm_store_si128(reinterpret_cast<__m128i*>(out), packed);
+    }
+};
+
+void computeAvx2(const uint16_t* stones, LineKernel::LineCounts& out)
+{
+    LineKernel::detail::computeLineCountsT<Avx2Ops>(stones, out);
+}
+
+} // namespace
+
+namespace LineKernel {
+namespace detail {
+const ComputeFn avx2Impl = &computeAvx2;
+} // namespace detail
+} // namespace LineKernel
+
+#else
+
+namespace LineKernel {
+namespace detail {
+const ComputeFn avx2Impl = nullptr;
+} // namespace detail
+} // namespace LineKernel
+
+#endif
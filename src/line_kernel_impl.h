@@ -0,0 +1,124 @@
+#ifndef LINE_KERNEL_IMPL_H
+#define LINE_KERNEL_IMPL_H
+
+// 内核模板，仅供line_kernel_*.cpp包含。每个翻译单元以不同的指令集编译，
+// 并用各自匿名命名空间内的Ops类型实例化，因此这里只能放模板和内部链接的常量。
+
+#include <cstdint>
+#include "line_kernel.h"
+
+namespace LineKernel {
+namespace detail {
+
+// 有效格子掩码：第0-14行的第0-14位
+alignas(32) static const uint16_t VALID_CELLS[BitBoard::LANES] = {
+    0x7FFF, 0x7FFF, 0x7FFF, 0x7FFF, 0x7FFF, 0x7FFF, 0x7FFF, 0x7FFF,
+    0x7FFF, 0x7FFF, 0x7FFF, 0x7FFF, 0x7FFF, 0x7FFF, 0x7FFF, 0x0000
+};
+
+/**
+ * 平移整块棋盘，使(r, c)位置得到(r + DR, c + DC)位置的值，越界补0
+ *
+ * Ops需要提供：rowsFromNext/rowsFromPrev（行平移）、colsFromNext/colsFromPrev（列平移）
+ */
+template <class Ops, int DR, int DC>
+inline typename Ops::Vec shiftToward(typename Ops::Vec v)
+{
+    if constexpr (DR > 0) {
+        v = Ops::rowsFromNext(v);
+    } else if constexpr (DR < 0) {
+        v = Ops::rowsFromPrev(v);
+    }
+    if constexpr (DC > 0) {
+        v = Ops::colsFromNext(v);
+    } else if constexpr (DC < 0) {
+        v = Ops::colsFromPrev(v);
+    }
+    return v;
+}
+
+/**
+ * 计算(DR, DC)方向上的连续同色子数，结果以4个位平面（二进制第0-3位）表示
+ *
+ * run_k为"该方向至少有k个连续同色子"的掩码，run_k = run_1 & shift(run_{k-1})。
+ * 由于run_1 ⊇ run_2 ⊇ ...，计数f的第b位等于所有k为2^b倍数的run_k的异或。
+ */
+template <class Ops, int DR, int DC>
+inline void directionalRun(typename Ops::Vec stones, typename Ops::Vec valid,
+                           typename Ops::Vec bits[4])
+{
+    using Vec = typename Ops::Vec;
+    const Vec step = Ops::and_(shiftToward<Ops, DR, DC>(stones), valid);
+    Vec run = step;
+    bits[0] = bits[1] = bits[2] = bits[3] = Ops::zero();
+
+    for (int k = 1; k < BitBoard::SIZE && !Ops::isZero(run); ++k) {
+        bits[0] = Ops::xor_(bits[0], run);
+        if ((k & 1) == 0) bits[1] = Ops::xor_(bits[1], run);
+        if ((k & 3) == 0) bits[2] = Ops::xor_(bits[2], run);
+        if ((k & 7) == 0) bits[3] = Ops::xor_(bits[3], run);
+        run = Ops::and_(step, shiftToward<Ops, DR, DC>(run));
+    }
+}
+
+/**
+ * 计算一条轴线上的连子数 1 + f + g（位切片加法，结果5位），并展开为逐格计数
+ */
+template <class Ops, int DR, int DC>
+inline void axisCounts(typename Ops::Vec stones, typename Ops::Vec valid,
+                       uint8_t out[BitBoard::LANES][BitBoard::LANES])
+{
+    using Vec = typename Ops::Vec;
+    Vec f[4];
+    Vec g[4];
+    directionalRun<Ops, DR, DC>(stones, valid, f);
+    directionalRun<Ops, -DR, -DC>(stones, valid, g);
+
+    // 最低位带进位1
+    Vec sum[5];
+    sum[0] = Ops::andNot(valid, Ops::xor_(f[0], g[0]));
+    Vec carry = Ops::or_(f[0], g[0]);
+    for (int b = 1; b < 4; ++b) {
+        const Vec half = Ops::xor_(f[b], g[b]);
+        sum[b] = Ops::xor_(half, carry);
+        carry = Ops::or_(Ops::and_(f[b], g[b]), Ops::and_(carry, half));
+    }
+    sum[4] = carry;
+
+    alignas(32) uint16_t planes[5][BitBoard::LANES];
+    for (int b = 0; b < 5; ++b) {
+        Ops::store(planes[b], sum[b]);
+    }
+    for (int row = 0; row < BitBoard::LANES; ++row) {
+        const uint16_t words[5] = {
+            planes[0][row], planes[1][row], planes[2][row], planes[3][row], planes[4][row]
+        };
+        Ops::expandRow(words, out[row]);
+    }
+}
+
+template <class Ops>
+inline void computeLineCountsT(const uint16_t* stonePlane, LineCounts& out)
+{
+    using Vec = typename Ops::Vec;
+    const Vec valid = Ops::load(VALID_CELLS);
+    const Vec stones = Ops::and_(Ops::load(stonePlane), valid);
+
+    axisCounts<Ops, 0, 1>(stones, valid, out.count[AXIS_HORIZONTAL]);
+    axisCounts<Ops, 1, 0>(stones, valid, out.count[AXIS_VERTICAL]);
+    axisCounts<Ops, 1, 1>(stones, valid, out.count[AXIS_DIAGONAL]);
+    axisCounts<Ops, 1, -1>(stones, valid, out.count[AXIS_ANTI_DIAGONAL]);
+}
+
+/**
+ * @brief 各实现的入口，不支持时为nullptr
+ */
+using ComputeFn = void (*)(const uint16_t*, LineCounts&);
+extern const ComputeFn scalarImpl;
+extern const ComputeFn sse2Impl;
+extern const ComputeFn avx2Impl;
+
+} // namespace detail
+} // namespace LineKernel
+
+#endif // LINE_KERNEL_IMPL_H
@@ -0,0 +1,97 @@
+#include "line_kernel_impl.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+
+namespace {
+
+// SSE2实现：lo保存第0-7行，hi保存第8-15行
+struct Sse2Ops {
+    struct Vec {
+        __m128i lo;
+        __m128i hi;
+    };
+
+    static Vec load(const uint16_t* p) {
+        return {_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)),
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 8))};
+    }
+    static void store(uint16_t* p, const Vec& a) {
+        _mm_store_si128(reinterpret_cast<__m128i*>(p), a.lo);
+        _mm_store_si128(reinterpret_cast<__m128i*>(p + 8), a.hi);
+    }
+    static Vec zero() {
+        return {_mm_setzero_si128(), _mm_setzero_si128()};
+    }
+    static Vec and_(const Vec& a, const Vec& b) {
+        return {_mm_and_si128(a.lo, b.lo), _mm_and_si128(a.hi, b.hi)};
+    }
+    static Vec or_(const Vec& a, const Vec& b) {
+        return {_mm_or_si128(a.lo, b.lo), _mm_or_si128(a.hi, b.hi)};
+    }
+    static Vec xor_(const Vec& a, const Vec& b) {
+        return {_mm_xor_si128(a.lo, b.lo), _mm_xor_si128(a.hi, b.hi)};
+    }
+    // a & ~b
+    static Vec andNot(const Vec& a, const Vec& b) {
+        return {_mm_andnot_si128(b.lo, a.lo), _mm_andnot_si128(b.hi, a.hi)};
+    }
+    static Vec rowsFromNext(const Vec& a) {
+        return {_mm_or_si128(_mm_srli_si128(a.lo, 2), _mm_slli_si128(a.hi, 14)),
+                _mm_srli_si128(a.hi, 2)};
+    }
+    static Vec rowsFromPrev(const Vec& a) {
+        return {_mm_slli_si128(a.lo, 2),
+                _mm_or_si128(_mm_slli_si128(a.hi, 2), _mm_srli_si128(a.lo, 14))};
+    }
+    static Vec colsFromNext(const Vec& a) {
+        return {_mm_srli_epi16(a.lo, 1), _mm_srli_epi16(a.hi, 1)};
+    }
+    static Vec colsFromPrev(const Vec& a) {
+        return {_mm_slli_epi16(a.lo, 1), _mm_slli_epi16(a.hi, 1)};
+    }
+    static bool isZero(const Vec& a) {
+        const __m128i any = _mm_or_si128(a.lo, a.hi);
+        return _mm_movemask_epi8(_mm_cmpeq_epi8(any, _mm_setzero_si128())) == 0xFFFF;
+    }
+    static void expandRow(const uint16_t words[5], uint8_t* out) {
+        const __m128i selLo = _mm_setr_epi16(0x0001, 0x0002, 0x0004, 0x0008,
+                                             0x0010, 0x0020, 0x0040, 0x0080);
+        const __m128i selHi = _mm_setr_epi16(0x0100, 0x0200, 0x0400, 0x0800, 0x1000, 0x2000,
+                                             0x4000, static_cast<short>(0x8000));
+        __m128i accLo = _mm_setzero_si128();
+        __m128i accHi = _mm_setzero_si128();
+        for (int b = 0; b < 5; ++b) {
+            const __m128i word = _mm_set1_epi16(static_cast<short>(words[b]));
+            const __m128i value = _mm_set1_epi16(static_cast<short>(1 << b));
+            accLo = _mm_or_si128(accLo, _mm_and_si128(
+                _mm_cmpeq_epi16(_mm_and_si128(word, selLo), selLo), value));
+            accHi = _mm_or_si128(accHi, _mm_and_si128(
+                _mm_cmpeq_epi16(_mm_and_si128(word, selHi), selHi), value));
+        }
+        _mm_store_si128(reinterpret_cast<__m128i*>(out), _mm_packus_epi16(accLo, accHi));
+    }
+};
+
+void computeSse2(const uint16_t* stones, LineKernel::LineCounts& out)
+{
+    LineKernel::detail::computeLineCountsT<Sse2Ops>(stones, out);
+}
+
+} // namespace
+
+namespace LineKernel {
+namespace detail {
+const ComputeFn sse2Impl = &computeSse2;
+} // namespace detail
+} // namespace LineKernel
+
+#else
+
+namespace LineKernel {
+namespace detail {
+const ComputeFn sse2Impl = nullptr;
+} // namespace detail
+} // namespace LineKernel
+
+#endif
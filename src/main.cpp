@@ -1,5 +1,7 @@
 #include <QApplication>
 #include "mainwindow.h"
+#include "pattern_weights.h"
+#include "profiler.h"
 
 /**
  * @brief 程序入口点
@@ -10,11 +12,18 @@
 int main(int argc, char *argv[]) {
     // 创建Qt应用程序对象
     QApplication app(argc, argv);
+
+    // 加载调参工具写出的棋型权重（没有权重文件时使用默认值）
+    PatternWeights::loadStartupFile();
     
     // 创建并显示主窗口
     MainWindow window;
     window.show();
     
     // 进入应用程序主事件循环
-    return app.exec();
+    const int code = app.exec();
+
+    // 启用计时时按GOMOKU_TRACE_FILE导出计时记录
+    Profiler::writeRequestedTrace();
+    return code;
 } 
\ No newline at end of file
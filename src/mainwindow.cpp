@@ -1,17 +1,24 @@
 #include "mainwindow.h"
+#include "profiler.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QWidget>
 #include <QFileDialog>
 #include <QMessageBox>
+#include <QFile>
+#include <QFontDatabase>
+#include <algorithm>
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
     , currentGameMode(GameDialog::GameMode::PlayerVsPlayer)
     , currentAIStrategy("RuleBased")
+    , currentEvaluator("Pattern")
     , currentAIDifficulty(3)
     , currentUndoLimit(3)
     , currentPlayerPieceType(PieceType::BLACK)
+    , currentKeepSearchState(true)
+    , analysisGeneration(0)
 {
     // 设置窗口标题
     setWindowTitle("五子棋");
@@ -42,8 +49,33 @@ MainWindow::MainWindow(QWidget *parent)
     // 创建加载游戏按钮
     loadButton = new QPushButton("加载游戏", this);
     buttonLayout->addWidget(loadButton);
+
+    // 创建分析模式按钮
+    analysisButton = new QPushButton("分析", this);
+    analysisButton->setCheckable(true);
+    buttonLayout->addWidget(analysisButton);
+
+    // 创建提示热度图按钮
+    heatmapButton = new QPushButton("提示", this);
+    heatmapButton->setCheckable(true);
+    buttonLayout->addWidget(heatmapButton);
     
     mainLayout->addLayout(buttonLayout);
+
+    // 时钟显示（限时对局时可见）
+    clockLabel = new QLabel(this);
+    clockLabel->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    clockLabel->setAlignment(Qt::AlignCenter);
+    clockLabel->setVisible(false);
+    mainLayout->addWidget(clockLabel);
+
+    // 分析结果显示（分析模式打开时可见）
+    analysisLabel = new QLabel(this);
+    analysisLabel->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    analysisLabel->setVisible(false);
+    mainLayout->addWidget(analysisLabel);
+    analysisTimer = new QTimer(this);
+    analysisTimer->setInterval(ANALYSIS_REFRESH_MS);
     
     // 设置中央窗口部件
     setCentralWidget(centralWidget);
@@ -53,22 +85,66 @@ MainWindow::MainWindow(QWidget *parent)
     connect(newGameButton, &QPushButton::clicked, this, &MainWindow::newGame);
     connect(saveButton, &QPushButton::clicked, this, &MainWindow::saveGame);
     connect(loadButton, &QPushButton::clicked, this, &MainWindow::loadGame);
+    connect(analysisButton, &QPushButton::toggled, this, &MainWindow::toggleAnalysis);
+    connect(heatmapButton, &QPushButton::toggled, this, &MainWindow::toggleHeatmap);
+    connect(analysisTimer, &QTimer::timeout, this, &MainWindow::pollAnalysis);
+    connect(board, &Board::positionChanged, this, &MainWindow::restartAnalysis);
+    connect(board, &Board::clockChanged, this, &MainWindow::updateClock);
     
     // 设置窗口大小
-    resize(600, 650);
+    resize(600, 720);
     
-    // 启动时显示游戏设置对话框
-    newGame();
+    // 启动时优先恢复上次未完成的对局，否则显示游戏设置对话框
+    if (!recoverGame()) {
+        newGame();
+    }
+}
+
+bool MainWindow::recoverGame()
+{
+    GameJournal::Recovered game;
+    const QString journalPath = GameJournal::defaultPath();
+    if (!GameJournal::recover(journalPath, game) || game.moves.empty()) {
+        return false;
+    }
+
+    QMessageBox::StandardButton answer = QMessageBox::question(
+        this,
+        "恢复对局",
+        QString("检测到上次未完成的对局（已下%1步），是否继续？").arg(game.moves.size())
+    );
+    if (answer != QMessageBox::Yes) {
+        // 不恢复时仍把对局保存到存档目录，避免丢失
+        if (GameJournal::save(game, GameJournal::archivePath(game.settings.startTime))) {
+            QFile::remove(journalPath);
+        }
+        return false;
+    }
+
+    // 沿用恢复对局的设置，之后"重新开始"使用相同的参数
+    const GameJournal::Settings& settings = game.settings;
+    currentGameMode = settings.aiEnabled ? GameDialog::GameMode::PlayerVsAI
+                                         : GameDialog::GameMode::PlayerVsPlayer;
+    currentAIStrategy = settings.aiStrategy;
+    currentEvaluator = settings.evaluator;
+    currentAIDifficulty = settings.aiDifficulty;
+    currentUndoLimit = settings.undoLimit;
+    currentPlayerPieceType = settings.playerPieceType;
+    board->restoreGame(game);
+    return true;
 }
 
 void MainWindow::resetGame()
 {
     // 使用当前的游戏模式重置游戏
+    board->setKeepSearchState(currentKeepSearchState);
+    board->setTimeControl(currentTimeControl);
     board->resetGame(currentGameMode == GameDialog::GameMode::PlayerVsAI,
                     currentAIStrategy,
                     currentAIDifficulty,
                     currentUndoLimit,
-                    currentPlayerPieceType);
+                    currentPlayerPieceType,
+                    currentEvaluator);
 }
 
 void MainWindow::newGame()
@@ -79,9 +155,12 @@ void MainWindow::newGame()
         // 保存设置
         currentGameMode = dialog.getGameMode();
         currentAIStrategy = dialog.getAIStrategy();
+        currentEvaluator = dialog.getEvaluator();
         currentAIDifficulty = dialog.getAIDifficulty();
         currentUndoLimit = dialog.getUndoLimit();
         currentPlayerPieceType = dialog.getPlayerPieceType();
+        currentKeepSearchState = dialog.getKeepSearchState();
+        currentTimeControl = dialog.getTimeControl();
         // 使用新的设置重置游戏
         resetGame();
     }
@@ -93,7 +172,7 @@ void MainWindow::saveGame()
         this,
         "保存游戏",
         QString(),
-        "五子棋存档 (*.gomoku);;所有文件 (*.*)"
+        "五子棋存档 (*.gomoku);;二进制棋谱 (*.gmkr);;所有文件 (*.*)"
     );
     
     if (filename.isEmpty()) {
@@ -101,7 +180,8 @@ void MainWindow::saveGame()
     }
     
     // 如果用户没有指定扩展名，添加默认扩展名
-    if (!filename.endsWith(".gomoku", Qt::CaseInsensitive)) {
+    if (!filename.endsWith(".gomoku", Qt::CaseInsensitive) &&
+        !filename.endsWith(".gmkr", Qt::CaseInsensitive)) {
         filename += ".gomoku";
     }
     
@@ -118,7 +198,7 @@ void MainWindow::loadGame()
         this,
         "加载游戏",
         QString(),
-        "五子棋存档 (*.gomoku);;所有文件 (*.*)"
+        "五子棋存档 (*.gomoku *.gmkr);;所有文件 (*.*)"
     );
     
     if (filename.isEmpty()) {
@@ -130,4 +210,117 @@ void MainWindow::loadGame()
     } else {
         QMessageBox::warning(this, "错误", "加载游戏失败！");
     }
-} 
\ No newline at end of file
+}
+
+void MainWindow::toggleAnalysis(bool enabled)
+{
+    analysisLabel->setVisible(enabled);
+    if (!enabled) {
+        analysisTimer->stop();
+        if (analysisEngine) {
+            analysisEngine->stop();
+        }
+        board->setAnalysisMoves({});
+        return;
+    }
+
+    if (!analysisEngine) {
+        analysisEngine = std::make_unique<AnalysisEngine>();
+        analysisEngine->setMultiPv(ANALYSIS_LINES);
+    }
+    analysisTimer->start();
+    restartAnalysis();
+}
+
+void MainWindow::restartAnalysis()
+{
+    if (!analysisButton->isChecked() || !analysisEngine) {
+        return;
+    }
+
+    board->setAnalysisMoves({});
+    if (board->isGameOver()) {
+        analysisEngine->stop();
+        analysisLabel->setText("对局已结束");
+        return;
+    }
+    // 置换表保留，新局面直接复用之前的搜索结果
+    analysisEngine->setEvaluator(currentEvaluator);
+    analysisGeneration = analysisEngine->analyze(board->getPosition(), board->getCurrentPlayer());
+    analysisLabel->setText("分析中...");
+}
+
+void MainWindow::pollAnalysis()
+{
+    PROFILE_ZONE("MainWindow::pollAnalysis");
+    // 取空队列，只显示当前局面的最新进度；没有新进度时不重绘
+    AnalysisEngine::Update update;
+    AnalysisEngine::Update latest;
+    bool hasUpdate = false;
+    while (analysisEngine->poll(update)) {
+        if (update.generation == analysisGeneration) {
+            latest = update;
+            hasUpdate = true;
+        }
+    }
+    if (!hasUpdate) {
+        return;
+    }
+
+    const Searcher::Result& result = latest.result;
+    const QString side = board->getCurrentPlayer() == PieceType::BLACK ? "黑方" : "白方";
+    QString text = QString("深度 %1%2  节点 %3  %4 kN/s  置换表 %5%（%6视角）")
+        .arg(result.depth)
+        .arg(result.finished ? "（完成）" : "")
+        .arg(result.nodes)
+        .arg(result.elapsedUs > 0 ? result.nodes * 1000 / result.elapsedUs : 0)
+        .arg(result.hashfull / 10)
+        .arg(side);
+
+    std::vector<Move> moves;
+    for (int i = 0; i < result.lineCount; ++i) {
+        const Searcher::Line& line = result.lines[i];
+        QString score;
+        if (line.score >= Searcher::WIN_THRESHOLD) {
+            score = QString("%1步胜").arg(Searcher::WIN_SCORE - line.score);
+        } else if (line.score <= -Searcher::WIN_THRESHOLD) {
+            score = QString("%1步负").arg(Searcher::WIN_SCORE + line.score);
+        } else {
+            score = QString("%1%2").arg(line.score > 0 ? "+" : "").arg(line.score);
+        }
+        QString pv;
+        for (int j = 0; j < std::min(line.length, ANALYSIS_PV_MOVES); ++j) {
+            pv += QString(" %1,%2").arg(line.pv[j] / Position::SIZE).arg(line.pv[j] % Position::SIZE);
+        }
+        text += QString("\n%1. %2 %3").arg(i + 1).arg(score.rightJustified(9)).arg(pv);
+        moves.push_back(line.move());
+    }
+    analysisLabel->setText(text);
+    board->setAnalysisMoves(moves);
+}
+
+void MainWindow::toggleHeatmap(bool visible)
+{
+    board->setHeatmapVisible(visible);
+}
+
+void MainWindow::updateClock()
+{
+    const GameClock& clock = board->getClock();
+    if (clock.control().isUnlimited()) {
+        clockLabel->setVisible(false);
+        return;
+    }
+
+    // 分:秒，最后10秒显示到十分之一秒；正在走的一方前加标记
+    auto format = [&clock](PieceType side, const QString& name) {
+        const int ms = std::max(0, clock.remainingMs(side));
+        QString text = ms < 10000
+            ? QString("%1.%2").arg(ms / 1000).arg(ms / 100 % 10)
+            : QString("%1:%2").arg(ms / 60000, 2, 10, QChar('0')).arg(ms / 1000 % 60, 2, 10, QChar('0'));
+        const QString marker = clock.runningSide() == side ? "▶" : " ";
+        return QString("%1%2 %3").arg(marker, name, text);
+    };
+    clockLabel->setText(format(PieceType::BLACK, "黑方") + "    " + format(PieceType::WHITE, "白方"));
+    clockLabel->setVisible(true);
+}
@@ -4,9 +4,13 @@
 #include <QMainWindow>
 #include <QPushButton>
 #include <QString>
+#include <QLabel>
+#include <QTimer>
+#include <memory>
 #include "board.h"
 #include "gamedialog.h"
 #include "game_types.h"
+#include "analysis_engine.h"
 
 /**
  * @brief 主窗口类
@@ -42,7 +46,44 @@ private slots:
      */
     void loadGame();
 
+    /**
+     * @brief 打开或关闭分析模式
+     * @param enabled 是否打开
+     */
+    void toggleAnalysis(bool enabled);
+
+    /**
+     * @brief 局面变化后从新局面重新开始分析
+     */
+    void restartAnalysis();
+
+    /**
+     * @brief 定时取出分析进度并刷新显示
+     */
+    void pollAnalysis();
+
+    /**
+     * @brief 显示或隐藏提示热度图
+     * @param visible 是否显示
+     */
+    void toggleHeatmap(bool visible);
+
+    /**
+     * @brief 刷新双方剩余时间的显示
+     */
+    void updateClock();
+
 private:
+    static const int ANALYSIS_LINES = 3;         ///< 分析显示的主变数
+    static const int ANALYSIS_REFRESH_MS = 100;  ///< 分析结果的刷新间隔（约10Hz）
+    static const int ANALYSIS_PV_MOVES = 8;      ///< 每条主变最多显示的步数
+
+    /**
+     * @brief 检查上次未完成的对局并询问是否恢复
+     * @return 是否已恢复对局
+     */
+    bool recoverGame();
+
     Board *board;              ///< 棋盘对象指针
     QPushButton *resetButton;  ///< 重新开始按钮指针
     QPushButton *newGameButton; ///< 新游戏按钮指针
@@ -50,9 +91,19 @@ private:
     QPushButton *loadButton;    ///< 加载游戏按钮指针
     GameDialog::GameMode currentGameMode;  ///< 当前游戏模式
     QString currentAIStrategy;   ///< 当前AI策略
+    QString currentEvaluator;    ///< 当前评估函数
     int currentAIDifficulty;    ///< 当前AI难度
     int currentUndoLimit;       ///< 当前允许的悔棋次数
     PieceType currentPlayerPieceType; ///< 当前玩家选择的棋子颜色
+    bool currentKeepSearchState; ///< 新局是否保留AI的搜索状态
+    TimeControl currentTimeControl; ///< 当前时间控制
+    QPushButton *analysisButton; ///< 分析模式按钮指针
+    QPushButton *heatmapButton; ///< 提示热度图按钮指针
+    QLabel *analysisLabel;      ///< 分析结果显示
+    QLabel *clockLabel;         ///< 双方剩余时间显示（限时对局时可见）
+    QTimer *analysisTimer;      ///< 分析结果刷新定时器
+    std::unique_ptr<AnalysisEngine> analysisEngine;  ///< 后台分析（首次打开分析模式时创建）
+    uint32_t analysisGeneration; ///< 当前分析的代号
 };
 
 #endif // MAINWINDOW_H 
\ No newline at end of file
@@ -0,0 +1,574 @@
+#include "mcts_ai.h"
+#include "evaluator.h"
+#include "line_kernel.h"
+#include "profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+namespace {
+
+const double C_PUCT = 1.5;              // PUCT探索系数
+const size_t MIN_NODE_CAPACITY = 1 << 16;      // 节点池额度用完时的最小容量（节点数）
+const double EVALUATOR_SCALE = 5000.0;  // 评估函数分数到[-1, 1]价值的缩放
+
+PieceType opponentOf(PieceType piece)
+{
+    return piece == PieceType::BLACK ? PieceType::WHITE : PieceType::BLACK;
+}
+
+// 某个格子在任一轴线上的最长连子数
+int maxAxisCount(const LineKernel::LineCounts& counts, int row, int col)
+{
+    int best = 0;
+    for (int axis = 0; axis < LineKernel::AXIS_COUNT; ++axis) {
+        best = std::max(best, static_cast<int>(counts.count[axis][row][col]));
+    }
+    return best;
+}
+
+} // namespace
+
+struct MctsAI::Worker {
+    BitBoard bits;                                  ///< 当前局面位平面
+    PieceType cells[CELLS];                         ///< 当前局面
+    std::vector<std::vector<PieceType>> grid;       ///< 供评估函数使用的局面
+    std::unique_ptr<Evaluator> evaluator;           ///< 叶节点评估函数（走子模拟时为空）
+    std::mt19937 rng;                               ///< 走子模拟的随机数
+    std::vector<int32_t> path;                      ///< 本次下降经过的节点
+    PieceType toMove = PieceType::BLACK;            ///< 当前轮到的一方
+    int stones = 0;                                 ///< 棋盘上的棋子数
+
+    void play(int cell, PieceType piece) {
+        const int row = cell / BOARD_SIZE;
+        const int col = cell % BOARD_SIZE;
+        cells[cell] = piece;
+        bits.set(row, col, piece);
+        grid[row][col] = piece;
+        if (evaluator) {
+            evaluator->makeMove(row, col, piece);
+        }
+        ++stones;
+        toMove = opponentOf(piece);
+    }
+
+    void undo(int cell) {
+        const int row = cell / BOARD_SIZE;
+        const int col = cell % BOARD_SIZE;
+        const PieceType piece = cells[cell];
+        if (evaluator) {
+            evaluator->unmakeMove(row, col, piece);
+        }
+        cells[cell] = PieceType::NONE;
+        bits.set(row, col, PieceType::NONE);
+        grid[row][col] = PieceType::NONE;
+        --stones;
+        toMove = piece;
+    }
+};
+
+MctsAI::MctsAI()
+    : thinkTimeMs_(0)
+    , threadCount_(0)
+    , evaluatorName_("Rollout")
+    // 对象池按节点池额度取容量；物理内存随树的增长逐步占用
+    , nodes_(std::min<size_t>(MemoryBudget::componentLimit(MemoryBudget::NODE_POOLS) / sizeof(Node), INT32_MAX),
+             MIN_NODE_CAPACITY)
+    , root_(Arena<Node>::INVALID)
+    , rootToMove_(PieceType::BLACK)
+    , hasTree_(false)
+    , stop_(false)
+{
+    setDifficulty(1);
+}
+
+void MctsAI::setDifficulty(int level)
+{
+    difficulty = std::clamp(level, 1, 5);
+    thinkTimeMs_ = 500 + difficulty * 400;  // 难度1-5对应0.9-2.5秒
+}
+
+bool MctsAI::setEvaluator(const QString& name)
+{
+    if (name == "Rollout") {
+        evaluatorName_ = name;
+        return true;
+    }
+    // 先确认评估函数可用（例如NNUE权重能够加载）
+    if (!Evaluator::create(name)) {
+        return false;
+    }
+    evaluatorName_ = name;
+    return true;
+}
+
+void MctsAI::clearTree()
+{
+    nodes_.clear();
+    root_ = Arena<Node>::INVALID;
+    hasTree_ = false;
+}
+
+Move MctsAI::getNextMove(const Position& position, PieceType currentPlayer)
+{
+    PROFILE_ZONE("MCTS::getNextMove");
+    auto startTime = std::chrono::steady_clock::now();
+    lastStats_ = SearchStats();
+    lastStats_.evaluator = evaluatorName_;
+
+    PieceType cells[CELLS];
+    BitBoard bits;
+    int stones = 0;
+    for (int row = 0; row < BOARD_SIZE; ++row) {
+        for (int col = 0; col < BOARD_SIZE; ++col) {
+            cells[row * BOARD_SIZE + col] = position.getPiece(row, col);
+            bits.set(row, col, position.getPiece(row, col));
+            if (position.getPiece(row, col) != PieceType::NONE) {
+                ++stones;
+            }
+        }
+    }
+    if (stones == CELLS) {
+        return Move{-1, -1};
+    }
+    if (stones == 0) {
+        return Move{BOARD_SIZE / 2, BOARD_SIZE / 2};
+    }
+
+    // 重新定根；对象池使用过半时放弃旧树，避免被不可达的节点占满
+    if (nodes_.size() > nodes_.capacity() / 2 || !reuseTree(cells, currentPlayer)) {
+        nodes_.clear();
+        root_ = nodes_.allocate(1);
+        nodes_[root_].init(0, 1.0f, NOT_TERMINAL);
+        std::copy(cells, cells + CELLS, rootCells_);
+        rootToMove_ = currentPlayer;
+    }
+    hasTree_ = true;
+
+    int threads = threadCount_ > 0
+        ? threadCount_ : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    std::vector<Worker> workers(threads);
+    for (auto& worker : workers) {
+        worker.grid.assign(BOARD_SIZE, std::vector<PieceType>(BOARD_SIZE, PieceType::NONE));
+        for (int cell = 0; cell < CELLS; ++cell) {
+            worker.grid[cell / BOARD_SIZE][cell % BOARD_SIZE] = cells[cell];
+        }
+        std::copy(cells, cells + CELLS, worker.cells);
+        worker.bits = bits;
+        worker.toMove = currentPlayer;
+        worker.stones = stones;
+        worker.rng.seed(std::random_device{}());
+        if (evaluatorName_ != "Rollout") {
+            worker.evaluator = Evaluator::create(evaluatorName_);
+            if (worker.evaluator) {
+                worker.evaluator->reset(worker.grid);
+            }
+        }
+    }
+
+    // 根节点在单线程中扩展，保证所有线程都从已展开的根开始
+    if (nodes_[root_].state.load(std::memory_order_acquire) == UNEXPANDED) {
+        expand(root_, workers[0]);
+    }
+    Node& root = nodes_[root_];
+    if (root.state.load(std::memory_order_acquire) != EXPANDED) {
+        return Move{-1, -1};
+    }
+
+    // 有直接连五的着法时无需搜索
+    const int32_t first = root.firstChild.load(std::memory_order_acquire);
+    for (int i = 0; i < root.childCount; ++i) {
+        if (nodes_[first + i].terminal == MOVER_WINS) {
+            int cell = nodes_[first + i].cell;
+            return Move{cell / BOARD_SIZE, cell % BOARD_SIZE};
+        }
+    }
+
+    // 思考时间：有预算时先搜到软时限，访问最多的着法与平均价值最高的着法不一致时
+    // 每次再延长已用时间的一半，直到硬时限
+    const auto hardDeadline = startTime + std::chrono::milliseconds(
+        timeBudget.isSet() ? timeBudget.hardMs : thinkTimeMs_);
+    auto deadline = timeBudget.isSet() ? startTime + std::chrono::milliseconds(timeBudget.softMs)
+                                       : hardDeadline;
+    std::atomic<long long> iterations(0);
+    while (true) {
+        stop_.store(false);
+        std::vector<std::thread> pool;
+        pool.reserve(threads - 1);
+        for (int i = 1; i < threads; ++i) {
+            pool.emplace_back([this, &workers, i, deadline, &iterations]() {
+                runWorker(workers[i], deadline, iterations);
+            });
+        }
+        runWorker(workers[0], deadline, iterations);
+        for (auto& thread : pool) {
+            thread.join();
+        }
+        if (deadline >= hardDeadline || stopRequested() || !rootUnstable(first, root.childCount)) {
+            break;
+        }
+        deadline = std::min(hardDeadline, std::chrono::steady_clock::now() + (deadline - startTime) / 2);
+    }
+
+    // 选择访问数最多的着法
+    int32_t best = first;
+    for (int i = 1; i < root.childCount; ++i) {
+        if (nodes_[first + i].visits.load() > nodes_[best].visits.load()) {
+            best = first + i;
+        }
+    }
+
+    lastStats_.nodes = iterations.load();
+    lastStats_.elapsedUs = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - startTime).count();
+
+    int cell = nodes_[best].cell;
+    return Move{cell / BOARD_SIZE, cell % BOARD_SIZE};
+}
+
+void MctsAI::runWorker(Worker& worker, std::chrono::steady_clock::time_point deadline,
+                       std::atomic<long long>& iterations)
+{
+    PROFILE_ZONE("MCTS::worker");
+    long long done = 0;
+    while (!stop_.load(std::memory_order_relaxed)) {
+        iterate(worker);
+        ++done;
+        if (std::chrono::steady_clock::now() >= deadline || stopRequested()) {
+            stop_.store(true, std::memory_order_relaxed);
+        }
+    }
+    iterations.fetch_add(done);
+}
+
+void MctsAI::iterate(Worker& worker)
+{
+    worker.path.clear();
+    worker.path.push_back(root_);
+    int32_t current = root_;
+
+    // 选择：沿PUCT值最大的子节点下降，并对经过的节点施加虚拟损失
+    while (nodes_[current].terminal == NOT_TERMINAL &&
+           nodes_[current].state.load(std::memory_order_acquire) == EXPANDED) {
+        int32_t child = selectChild(current);
+        Node& node = nodes_[child];
+        node.visits.fetch_add(1, std::memory_order_relaxed);
+        node.valueSum.fetch_sub(VALUE_SCALE, std::memory_order_relaxed);
+        worker.play(node.cell, worker.toMove);
+        worker.path.push_back(child);
+        current = child;
+    }
+
+    // 评估：value为当前轮到走棋一方视角的价值
+    double value = 0.0;
+    const Node& leaf = nodes_[current];
+    if (leaf.terminal == MOVER_WINS) {
+        value = -1.0;
+    } else if (leaf.terminal == DRAW) {
+        value = 0.0;
+    } else {
+        if (leaf.state.load(std::memory_order_acquire) == UNEXPANDED) {
+            expand(current, worker);
+        }
+        value = evaluateLeaf(worker);
+    }
+
+    // 回传：节点价值以走入该节点的一方为视角，逐层取反；同时撤销虚拟损失
+    double moverValue = -value;
+    for (size_t i = worker.path.size() - 1; i > 0; --i) {
+        Node& node = nodes_[worker.path[i]];
+        node.valueSum.fetch_add(std::llround(moverValue * VALUE_SCALE) + VALUE_SCALE,
+                                std::memory_order_relaxed);
+        worker.undo(node.cell);
+        moverValue = -moverValue;
+    }
+    nodes_[root_].visits.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool MctsAI::rootUnstable(int32_t first, int childCount) const
+{
+    int32_t mostVisited = first;
+    int32_t bestValue = first;
+    auto mean = [this](int32_t index) {
+        const int32_t visits = std::max(1, nodes_[index].visits.load(std::memory_order_relaxed));
+        return static_cast<double>(nodes_[index].valueSum.load(std::memory_order_relaxed)) / visits;
+    };
+    for (int32_t i = first + 1; i < first + childCount; ++i) {
+        if (nodes_[i].visits.load() > nodes_[mostVisited].visits.load()) {
+            mostVisited = i;
+        }
+        if (nodes_[i].visits.load() > 0 && mean(i) > mean(bestValue)) {
+            bestValue = i;
+        }
+    }
+    return mostVisited != bestValue;
+}
+
+int32_t MctsAI::selectChild(int32_t parent) const
+{
+    const Node& node = nodes_[parent];
+    const int32_t first = node.firstChild.load(std::memory_order_acquire);
+    const double sqrtVisits = std::sqrt(static_cast<double>(
+        std::max(1, node.visits.load(std::memory_order_relaxed))));
+
+    int32_t best = first;
+    double bestValue = -1e300;
+    for (int i = 0; i < node.childCount; ++i) {
+        const Node& child = nodes_[first + i];
+        const int32_t visits = child.visits.load(std::memory_order_relaxed);
+        double q = 0.0;
+        if (child.terminal == MOVER_WINS) {
+            q = 1.0;
+        } else if (visits > 0) {
+            q = static_cast<double>(child.valueSum.load(std::memory_order_relaxed)) /
+                (static_cast<double>(visits) * VALUE_SCALE);
+        }
+        const double u = C_PUCT * child.prior * sqrtVisits / (1.0 + visits);
+        if (q + u > bestValue) {
+            bestValue = q + u;
+            best = first + i;
+        }
+    }
+    return best;
+}
+
+bool MctsAI::expand(int32_t index, Worker& worker)
+{
+    Node& node = nodes_[index];
+    uint8_t expected = UNEXPANDED;
+    if (!node.state.compare_exchange_strong(expected, EXPANDING, std::memory_order_acq_rel)) {
+        return false;
+    }
+
+    int candidates[CELLS];
+    int count = collectCandidates(worker.bits, candidates);
+
+    // 用双方的连子数给候选打分：能连五或必须堵的点分数远高于其他点
+    LineKernel::LineCounts own;
+    LineKernel::LineCounts other;
+    LineKernel::computeLineCounts(worker.bits.plane(worker.toMove), own);
+    LineKernel::computeLineCounts(worker.bits.plane(opponentOf(worker.toMove)), other);
+
+    struct Scored {
+        int cell;
+        int weight;
+        bool wins;
+    };
+    std::vector<Scored> scored;
+    scored.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        const int row = candidates[i] / BOARD_SIZE;
+        const int col = candidates[i] % BOARD_SIZE;
+        int weight = 1;
+        for (int axis = 0; axis < LineKernel::AXIS_COUNT; ++axis) {
+            weight += lineWeight(own.count[axis][row][col]);
+            weight += lineWeight(other.count[axis][row][col]);
+        }
+        scored.push_back({candidates[i], weight, maxAxisCount(own, row, col) >= 5});
+    }
+    std::stable_sort(scored.begin(), scored.end(),
+                     [](const Scored& a, const Scored& b) { return a.weight > b.weight; });
+    if (static_cast<int>(scored.size()) > MAX_CHILDREN) {
+        scored.resize(MAX_CHILDREN);
+    }
+
+    int32_t first = scored.empty() ? Arena<Node>::INVALID : nodes_.allocate(scored.size());
+    if (first == Arena<Node>::INVALID) {
+        node.state.store(LEAF_ONLY, std::memory_order_release);
+        return false;
+    }
+
+    double total = 0.0;
+    for (const auto& s : scored) {
+        total += s.weight;
+    }
+    const bool filled = worker.stones + 1 >= CELLS;
+    for (size_t i = 0; i < scored.size(); ++i) {
+        uint8_t terminal = scored[i].wins ? MOVER_WINS : (filled ? DRAW : NOT_TERMINAL);
+        nodes_[first + static_cast<int32_t>(i)].init(
+            scored[i].cell, static_cast<float>(scored[i].weight / total), terminal);
+    }
+
+    // 先写入子节点数，再以release语义发布子节点
+    node.childCount = static_cast<uint16_t>(scored.size());
+    node.firstChild.store(first, std::memory_order_release);
+    node.state.store(EXPANDED, std::memory_order_release);
+    return true;
+}
+
+double MctsAI::evaluateLeaf(Worker& worker)
+{
+    PROFILE_ZONE("MCTS::evaluateLeaf");
+    if (!worker.evaluator) {
+        return rollout(worker);
+    }
+    int score = worker.evaluator->evaluate(worker.grid, worker.toMove);
+    return std::tanh(score / EVALUATOR_SCALE);
+}
+
+double MctsAI::rollout(Worker& worker)
+{
+    const PieceType side = worker.toMove;
+    PieceType winner = PieceType::NONE;
+    int played[ROLLOUT_LIMIT];
+    int plies = 0;
+
+    int candidates[CELLS];
+    LineKernel::LineCounts own;
+    LineKernel::LineCounts other;
+    while (plies < ROLLOUT_LIMIT && worker.stones < CELLS) {
+        const PieceType mover = worker.toMove;
+        int count = collectCandidates(worker.bits, candidates);
+        LineKernel::computeLineCounts(worker.bits.plane(mover), own);
+        LineKernel::computeLineCounts(worker.bits.plane(opponentOf(mover)), other);
+
+        // 能连五则直接获胜，对手能连五则必须堵，否则按棋型权重随机选择
+        int chosen = -1;
+        int forced = -1;
+        long long total = 0;
+        for (int i = 0; i < count; ++i) {
+            const int row = candidates[i] / BOARD_SIZE;
+            const int col = candidates[i] % BOARD_SIZE;
+            if (maxAxisCount(own, row, col) >= 5) {
+                chosen = candidates[i];
+                break;
+            }
+            if (forced < 0 && maxAxisCount(other, row, col) >= 5) {
+                forced = candidates[i];
+            }
+            total += 1 + maxAxisCount(own, row, col) * 4 + maxAxisCount(other, row, col) * 3;
+        }
+        if (chosen >= 0) {
+            worker.play(chosen, mover);
+            played[plies++] = chosen;
+            winner = mover;
+            break;
+        }
+        if (forced >= 0) {
+            chosen = forced;
+        } else {
+            long long pick = std::uniform_int_distribution<long long>(0, total - 1)(worker.rng);
+            for (int i = 0; i < count; ++i) {
+                const int row = candidates[i] / BOARD_SIZE;
+                const int col = candidates[i] % BOARD_SIZE;
+                pick -= 1 + maxAxisCount(own, row, col) * 4 + maxAxisCount(other, row, col) * 3;
+                if (pick < 0) {
+                    chosen = candidates[i];
+                    break;
+                }
+            }
+        }
+        worker.play(chosen, mover);
+        played[plies++] = chosen;
+    }
+
+    while (plies > 0) {
+        worker.undo(played[--plies]);
+    }
+    if (winner == PieceType::NONE) {
+        return 0.0;
+    }
+    return winner == side ? 1.0 : -1.0;
+}
+
+bool MctsAI::reuseTree(const PieceType cells[CELLS], PieceType toMove)
+{
+    PROFILE_ZONE("MCTS::reuseTree");
+    if (!hasTree_ || root_ == Arena<Node>::INVALID) {
+        return false;
+    }
+
+    // 新局面必须是根局面加上最多两步交替落子
+    std::vector<int> added;
+    for (int cell = 0; cell < CELLS; ++cell) {
+        if (rootCells_[cell] != PieceType::NONE) {
+            if (cells[cell] != rootCells_[cell]) {
+                return false;
+            }
+        } else if (cells[cell] != PieceType::NONE) {
+            added.push_back(cell);
+        }
+    }
+    if (added.size() > 2) {
+        return false;
+    }
+    if (added.size() == 2 && cells[added[0]] != rootToMove_) {
+        std::swap(added[0], added[1]);
+    }
+
+    PieceType expected = rootToMove_;
+    int32_t current = root_;
+    for (int cell : added) {
+        if (cells[cell] != expected ||
+            nodes_[current].state.load(std::memory_order_acquire) != EXPANDED) {
+            return false;
+        }
+        const int32_t first = nodes_[current].firstChild.load(std::memory_order_acquire);
+        int32_t next = Arena<Node>::INVALID;
+        for (int i = 0; i < nodes_[current].childCount; ++i) {
+            if (nodes_[first + i].cell == cell) {
+                next = first + i;
+                break;
+            }
+        }
+        if (next == Arena<Node>::INVALID) {
+            return false;
+        }
+        current = next;
+        expected = opponentOf(expected);
+    }
+    if (expected != toMove) {
+        return false;
+    }
+
+    root_ = current;
+    std::copy(cells, cells + CELLS, rootCells_);
+    rootToMove_ = toMove;
+    return true;
+}
+
+int MctsAI::collectCandidates(const BitBoard& bits, int cells[CELLS])
+{
+    uint16_t occupied[BitBoard::LANES];
+    bool any = false;
+    for (int row = 0; row < BitBoard::LANES; ++row) {
+        occupied[row] = bits.black[row] | bits.white[row];
+        any = any || occupied[row] != 0;
+    }
+    if (!any) {
+        cells[0] = (BOARD_SIZE / 2) * BOARD_SIZE + BOARD_SIZE / 2;
+        return 1;
+    }
+
+    // 把已有棋子在行、列方向各膨胀2格，得到附近的空位
+    int count = 0;
+    for (int row = 0; row < BOARD_SIZE; ++row) {
+        uint32_t rows = 0;
+        for (int r = std::max(0, row - 2); r <= std::min(BOARD_SIZE - 1, row + 2); ++r) {
+            rows |= occupied[r];
+        }
+        uint32_t near = rows | (rows << 1) | (rows << 2) | (rows >> 1) | (rows >> 2);
+        near &= BitBoard::ROW_MASK & ~static_cast<uint32_t>(occupied[row]);
+        while (near) {
+            int col = 0;
+            while (((near >> col) & 1u) == 0) {
+                ++col;
+            }
+            cells[count++] = row * BOARD_SIZE + col;
+            near &= near - 1;
+        }
+    }
+    return count;
+}
+
+int MctsAI::lineWeight(int count)
+{
+    switch (count) {
+        case 1: return 1;
+        case 2: return 8;
+        case 3: return 64;
+        case 4: return 512;
+    }
+    return count >= 5 ? 100000 : 0;
+}
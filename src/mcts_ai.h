@@ -0,0 +1,152 @@
+#ifndef MCTS_AI_H
+#define MCTS_AI_H
+
+#include "ai_strategy.h"
+#include "game_types.h"
+#include "position.h"
+#include "arena.h"
+#include "bitboard.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+/**
+ * @brief 蒙特卡洛树搜索AI
+ *
+ * - 选择：PUCT公式，先验概率来自整盘棋型评分（LineKernel）
+ * - 叶节点：棋型引导的快速走子模拟，或使用评估函数（Pattern/NNUE）直接估值
+ * - 并行：多个线程共享一棵树，下降时施加虚拟损失，访问数和价值用原子操作无锁更新
+ * - 节点从预分配的对象池中分配，子节点连续存放
+ * - 两步之间保留搜索树，新一步从上一步的对应子树继续（重新定根）
+ */
+class MctsAI : public AIStrategy {
+public:
+    MctsAI();
+
+    void setDifficulty(int level) override;
+    Move getNextMove(const Position& position, PieceType currentPlayer) override;
+    QString getName() const override { return "MCTS"; }
+    bool setEvaluator(const QString& name) override;
+    QString getEvaluatorName() const override { return evaluatorName_; }
+    SearchStats getLastSearchStats() const override { return lastStats_; }
+    void clearSearchState() override { clearTree(); }
+
+    /**
+     * @brief 设置搜索线程数（0表示使用硬件并发数）
+     */
+    void setThreadCount(int threads) { threadCount_ = threads; }
+
+    /**
+     * @brief 设置单步思考时间（毫秒）
+     */
+    void setThinkTime(int milliseconds) { thinkTimeMs_ = milliseconds; }
+
+    /**
+     * @brief 丢弃保留的搜索树
+     */
+    void clearTree();
+
+private:
+    static constexpr int BOARD_SIZE = BitBoard::SIZE;
+    static constexpr int CELLS = BOARD_SIZE * BOARD_SIZE;
+    static constexpr int64_t VALUE_SCALE = 1 << 16;  ///< 价值定点数的缩放（1.0）
+    static constexpr int MAX_CHILDREN = 32;          ///< 每个节点最多保留的候选数
+    static constexpr int ROLLOUT_LIMIT = 40;         ///< 单次模拟的最大步数
+
+    /**
+     * @brief 节点扩展状态
+     */
+    enum NodeState : uint8_t {
+        UNEXPANDED = 0,  ///< 未扩展
+        EXPANDING = 1,   ///< 某个线程正在扩展
+        EXPANDED = 2,    ///< 子节点已发布
+        LEAF_ONLY = 3    ///< 对象池已满，无法扩展
+    };
+
+    /**
+     * @brief 节点终局类型
+     */
+    enum Terminal : uint8_t {
+        NOT_TERMINAL = 0,  ///< 非终局
+        MOVER_WINS = 1,    ///< 走入该节点的一方连五获胜
+        DRAW = 2           ///< 棋盘已满
+    };
+
+    /**
+     * @brief 搜索树节点
+     *
+     * 访问数和价值均以"走入该节点的一方"为视角。
+     */
+    struct Node {
+        std::atomic<int32_t> visits{0};     ///< 访问数（含虚拟损失）
+        std::atomic<int64_t> valueSum{0};   ///< 累计价值（定点数）
+        std::atomic<int32_t> firstChild{Arena<Node>::INVALID};  ///< 第一个子节点下标
+        std::atomic<uint8_t> state{UNEXPANDED};  ///< 扩展状态
+        uint16_t childCount = 0;            ///< 子节点数
+        uint8_t cell = 0;                   ///< 走入该节点的着法（行 * 15 + 列）
+        uint8_t terminal = NOT_TERMINAL;    ///< 终局类型
+        float prior = 0.0f;                 ///< 先验概率
+
+        void init(int cellIndex, float p, uint8_t terminalType) {
+            visits.store(0, std::memory_order_relaxed);
+            valueSum.store(0, std::memory_order_relaxed);
+            firstChild.store(Arena<Node>::INVALID, std::memory_order_relaxed);
+            state.store(UNEXPANDED, std::memory_order_relaxed);
+            childCount = 0;
+            cell = static_cast<uint8_t>(cellIndex);
+            terminal = terminalType;
+            prior = p;
+        }
+    };
+
+    /**
+     * @brief 每个搜索线程的私有状态
+     */
+    struct Worker;
+
+    int thinkTimeMs_;
+    int threadCount_;
+    QString evaluatorName_;        ///< "Rollout"表示使用走子模拟
+    Arena<Node> nodes_;            ///< 节点对象池
+    int32_t root_;                 ///< 当前根节点
+    PieceType rootCells_[CELLS];   ///< 根节点对应的局面
+    PieceType rootToMove_;         ///< 根节点轮到的一方
+    bool hasTree_;                 ///< 是否保留了可复用的树
+    std::atomic<bool> stop_;       ///< 停止标志
+    SearchStats lastStats_;
+
+    // 线程主循环
+    void runWorker(Worker& worker, std::chrono::steady_clock::time_point deadline,
+                   std::atomic<long long>& iterations);
+
+    // 执行一次选择-扩展-评估-回传
+    void iterate(Worker& worker);
+
+    // 用PUCT选择子节点
+    int32_t selectChild(int32_t parent) const;
+
+    // 根节点访问最多的着法与平均价值最高的着法不一致（结论尚不稳定）
+    bool rootUnstable(int32_t first, int childCount) const;
+
+    // 扩展节点，返回是否成功（其他线程正在扩展或对象池已满时返回false）
+    bool expand(int32_t node, Worker& worker);
+
+    // 评估叶节点，返回轮到走棋一方视角的价值[-1, 1]
+    double evaluateLeaf(Worker& worker);
+
+    // 快速走子模拟
+    double rollout(Worker& worker);
+
+    // 尝试把根节点移动到与当前局面对应的子树
+    bool reuseTree(const PieceType cells[CELLS], PieceType toMove);
+
+    // 收集距离已有棋子2格以内的空位
+    static int collectCandidates(const BitBoard& bits, int cells[CELLS]);
+
+    // 根据某条轴线上的连子数计算候选权重
+    static int lineWeight(int count);
+};
+
+#endif // MCTS_AI_H
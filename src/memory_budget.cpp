@@ -0,0 +1,369 @@
+#include "memory_budget.h"
+#include <QFile>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <set>
+#include <vector>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr size_t MB = 1024 * 1024;
+constexpr size_t HUGE_PAGE_BYTES = 2 * MB;  ///< x86-64的大页大小；块达到此大小才尝试大页
+
+/// 各类组件在总预算中所占的百分比
+constexpr int SHARES[MemoryBudget::COMPONENT_COUNT] = {50, 25, 25};
+
+const char* const NAMES[MemoryBudget::COMPONENT_COUNT] = {"tt", "nodes", "caches"};
+
+size_t initialLimit()
+{
+    bool ok = false;
+    const int megabytes = qEnvironmentVariableIntValue("GOMOKU_MEMORY_MB", &ok);
+    return (ok && megabytes > 0 ? static_cast<size_t>(megabytes) : MemoryBudget::DEFAULT_LIMIT_MB) * MB;
+}
+
+/**
+ * @brief 预算的全局状态（函数内静态变量，其他编译单元的静态对象也可以安全使用）
+ */
+struct State {
+    std::atomic<size_t> limit{initialLimit()};
+    std::atomic<size_t> used[MemoryBudget::COMPONENT_COUNT] = {};
+    std::mutex registryMutex;
+    std::set<const MemoryBlock*> blocks[MemoryBudget::COMPONENT_COUNT];  ///< 现存的内存块，供统计常驻内存
+};
+
+State& state()
+{
+    static State instance;
+    return instance;
+}
+
+size_t pageSize()
+{
+#ifdef Q_OS_WIN
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwPageSize;
+#else
+    static const size_t size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    return size;
+#endif
+}
+
+size_t roundUp(size_t value, size_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+QString megabytes(size_t bytes)
+{
+    return QString::number(bytes / double(MB), 'f', 1);
+}
+
+} // namespace
+
+size_t MemoryBudget::limitBytes()
+{
+    return state().limit.load(std::memory_order_relaxed);
+}
+
+void MemoryBudget::setLimitMB(size_t megabytes)
+{
+    state().limit.store(std::max<size_t>(1, megabytes) * MB, std::memory_order_relaxed);
+}
+
+size_t MemoryBudget::componentLimit(Component component)
+{
+    return limitBytes() / 100 * SHARES[component];
+}
+
+size_t MemoryBudget::used(Component component)
+{
+    return state().used[component].load(std::memory_order_relaxed);
+}
+
+size_t MemoryBudget::available(Component component)
+{
+    const size_t limit = componentLimit(component);
+    const size_t current = used(component);
+    return current < limit ? limit - current : 0;
+}
+
+size_t MemoryBudget::acquire(Component component, size_t wanted, size_t minimum)
+{
+    std::atomic<size_t>& used = state().used[component];
+    size_t current = used.load(std::memory_order_relaxed);
+    for (;;) {
+        const size_t limit = componentLimit(component);
+        const size_t free = current < limit ? limit - current : 0;
+        const size_t granted = std::max(minimum, std::min(wanted, free));
+        if (used.compare_exchange_weak(current, current + granted, std::memory_order_relaxed)) {
+            return granted;
+        }
+    }
+}
+
+bool MemoryBudget::tryAcquire(Component component, size_t bytes)
+{
+    std::atomic<size_t>& used = state().used[component];
+    size_t current = used.load(std::memory_order_relaxed);
+    do {
+        if (current + bytes > componentLimit(component)) {
+            return false;
+        }
+    } while (!used.compare_exchange_weak(current, current + bytes, std::memory_order_relaxed));
+    return true;
+}
+
+void MemoryBudget::release(Component component, size_t bytes)
+{
+    state().used[component].fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+const char* MemoryBudget::componentName(Component component)
+{
+    return NAMES[component];
+}
+
+namespace {
+
+/**
+ * @brief 一类组件的统计
+ */
+struct ComponentUsage {
+    size_t used = 0;
+    size_t resident = 0;
+    int blocks = 0;
+    int hugeBlocks = 0;   ///< 使用或请求了大页的块数
+};
+
+ComponentUsage componentUsage(MemoryBudget::Component component)
+{
+    ComponentUsage usage;
+    usage.used = MemoryBudget::used(component);
+    size_t blockBytes = 0;
+    std::lock_guard<std::mutex> lock(state().registryMutex);
+    for (const MemoryBlock* block : state().blocks[component]) {
+        ++usage.blocks;
+        usage.hugeBlocks += block->pageMode() != MemoryBlock::PageMode::NORMAL ? 1 : 0;
+        usage.resident += block->residentBytes();
+        blockBytes += block->size();
+    }
+    // 不经过MemoryBlock的额度（如缓存的堆内存）按已分配计入常驻
+    usage.resident += usage.used > blockBytes ? usage.used - blockBytes : 0;
+    return usage;
+}
+
+} // namespace
+
+QString MemoryBudget::report()
+{
+    QString text = QString("内存预算 %1 MB\n").arg(megabytes(limitBytes()));
+    text += "组件        额度MB    已申请MB  常驻MB    块数  大页块\n";
+    for (int i = 0; i < COMPONENT_COUNT; ++i) {
+        const auto component = static_cast<Component>(i);
+        const ComponentUsage usage = componentUsage(component);
+        text += QString("%1%2%3%4%5%6\n")
+                    .arg(QString(componentName(component)).leftJustified(12))
+                    .arg(megabytes(componentLimit(component)).leftJustified(10))
+                    .arg(megabytes(usage.used).leftJustified(10))
+                    .arg(megabytes(usage.resident).leftJustified(10))
+                    .arg(QString::number(usage.blocks).leftJustified(6))
+                    .arg(usage.hugeBlocks);
+    }
+    const size_t rss = processResidentBytes();
+    text += QString("进程常驻内存 %1 MB\n").arg(rss > 0 ? megabytes(rss) : QString("未知"));
+    return text;
+}
+
+QString MemoryBudget::summary()
+{
+    QString text = QString("limit_mb=%1").arg(megabytes(limitBytes()));
+    for (int i = 0; i < COMPONENT_COUNT; ++i) {
+        const auto component = static_cast<Component>(i);
+        const ComponentUsage usage = componentUsage(component);
+        text += QString(" %1_mb=%2 %1_resident_mb=%3")
+                    .arg(componentName(component))
+                    .arg(megabytes(usage.used))
+                    .arg(megabytes(usage.resident));
+    }
+    return text + QString(" rss_mb=%1").arg(megabytes(processResidentBytes()));
+}
+
+size_t MemoryBudget::processResidentBytes()
+{
+#ifdef Q_OS_LINUX
+    // /proc/self/statm的第二项为常驻页数
+    QFile file("/proc/self/statm");
+    if (file.open(QIODevice::ReadOnly)) {
+        const QList<QByteArray> fields = file.readAll().split(' ');
+        if (fields.size() > 1) {
+            return static_cast<size_t>(fields.at(1).toULongLong()) * pageSize();
+        }
+    }
+#endif
+    return 0;
+}
+
+MemoryBlock::MemoryBlock(MemoryBudget::Component component, size_t wanted, size_t minimum)
+    : component_(component)
+{
+    const size_t granted = MemoryBudget::acquire(component, wanted, minimum);
+    if (granted == 0) {
+        return;
+    }
+    const bool large = granted >= HUGE_PAGE_BYTES;
+#ifdef Q_OS_WIN
+    const size_t largePage = GetLargePageMinimum();
+    if (large && largePage > 0) {
+        mappedSize_ = roundUp(granted, largePage);
+        data_ = VirtualAlloc(nullptr, mappedSize_, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+        pageMode_ = data_ ? PageMode::HUGE_PAGES : PageMode::NORMAL;
+    }
+    if (!data_) {
+        mappedSize_ = roundUp(granted, pageSize());
+        data_ = VirtualAlloc(nullptr, mappedSize_, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+    }
+#else
+#ifdef MAP_HUGETLB
+    if (large) {
+        mappedSize_ = roundUp(granted, HUGE_PAGE_BYTES);
+        void* address = mmap(nullptr, mappedSize_, PROT_READ | PROT_WRITE,
+                             MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (address != MAP_FAILED) {
+            data_ = address;
+            pageMode_ = PageMode::HUGE_PAGES;
+        }
+    }
+#endif
+    if (!data_) {
+        // 多映射一个大页，裁掉首尾使起始地址按大页对齐，透明大页才能覆盖整个块
+        mappedSize_ = roundUp(granted, large ? HUGE_PAGE_BYTES : pageSize());
+        const size_t padding = large ? HUGE_PAGE_BYTES : 0;
+        void* address = mmap(nullptr, mappedSize_ + padding, PROT_READ | PROT_WRITE,
+                             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (address != MAP_FAILED) {
+            char* begin = static_cast<char*>(address);
+            char* aligned = reinterpret_cast<char*>(roundUp(reinterpret_cast<uintptr_t>(begin), padding ? padding : 1));
+            if (aligned > begin) {
+                munmap(begin, aligned - begin);
+            }
+            if (begin + padding > aligned) {
+                munmap(aligned + mappedSize_, begin + padding - aligned);
+            }
+            data_ = aligned;
+#ifdef MADV_HUGEPAGE
+            if (large && madvise(data_, mappedSize_, MADV_HUGEPAGE) == 0) {
+                pageMode_ = PageMode::ADVISED;
+            }
+#endif
+        }
+    }
+#endif
+    if (!data_) {
+        MemoryBudget::release(component, granted);
+        throw std::bad_alloc();
+    }
+    size_ = granted;
+    std::lock_guard<std::mutex> lock(state().registryMutex);
+    state().blocks[component_].insert(this);
+}
+
+MemoryBlock::~MemoryBlock()
+{
+    reset();
+}
+
+MemoryBlock::MemoryBlock(MemoryBlock&& other) noexcept
+{
+    *this = std::move(other);
+}
+
+MemoryBlock& MemoryBlock::operator=(MemoryBlock&& other) noexcept
+{
+    if (this != &other) {
+        reset();
+        std::lock_guard<std::mutex> lock(state().registryMutex);
+        if (other.data_) {
+            state().blocks[other.component_].erase(&other);
+            state().blocks[other.component_].insert(this);
+        }
+        data_ = other.data_;
+        size_ = other.size_;
+        mappedSize_ = other.mappedSize_;
+        component_ = other.component_;
+        pageMode_ = other.pageMode_;
+        other.data_ = nullptr;
+        other.size_ = 0;
+        other.mappedSize_ = 0;
+        other.pageMode_ = PageMode::NORMAL;
+    }
+    return *this;
+}
+
+void MemoryBlock::reset()
+{
+    if (!data_) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(state().registryMutex);
+        state().blocks[component_].erase(this);
+    }
+#ifdef Q_OS_WIN
+    VirtualFree(data_, 0, MEM_RELEASE);
+#else
+    munmap(data_, mappedSize_);
+#endif
+    MemoryBudget::release(component_, size_);
+    data_ = nullptr;
+    size_ = 0;
+    mappedSize_ = 0;
+    pageMode_ = PageMode::NORMAL;
+}
+
+size_t MemoryBlock::residentBytes() const
+{
+#ifdef Q_OS_LINUX
+    if (!data_) {
+        return 0;
+    }
+    const size_t page = pageSize();
+    std::vector<unsigned char> pages((mappedSize_ + page - 1) / page);
+    if (mincore(data_, mappedSize_, pages.data()) != 0) {
+        return size_;
+    }
+    size_t resident = 0;
+    for (unsigned char flag : pages) {
+        resident += (flag & 1) ? page : 0;
+    }
+    return std::min(resident, size_);
+#else
+    return size_;
+#endif
+}
+
+void MemoryBlock::zero()
+{
+    if (!data_) {
+        return;
+    }
+#ifdef Q_OS_LINUX
+    // 大块直接交还物理页：之后读到的都是零页，常驻内存也随之回落（显式大页仍逐字节清零）
+    if (size_ >= HUGE_PAGE_BYTES && pageMode_ != PageMode::HUGE_PAGES
+        && madvise(data_, mappedSize_, MADV_DONTNEED) == 0) {
+        return;
+    }
+#endif
+    std::memset(data_, 0, size_);
+}
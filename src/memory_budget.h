@@ -0,0 +1,151 @@
+#ifndef MEMORY_BUDGET_H
+#define MEMORY_BUDGET_H
+
+#include <QString>
+#include <cstddef>
+
+/**
+ * @brief 引擎的内存预算
+ *
+ * 进程内所有置换表、节点池和缓存共用一个总预算（MB），按固定比例分给各类组件：
+ * 置换表50%、节点池25%、缓存25%。组件创建大块内存前向预算申请，申请量受该类剩余额度限制：
+ * 置换表按得到的字节数向下取2的幂个条目，节点池按得到的字节数决定容量，缓存申请不到时清空重来。
+ * 对象析构时归还额度。
+ *
+ * 总预算取自环境变量GOMOKU_MEMORY_MB（默认512），也可以在创建引擎对象前调用setLimitMB修改；
+ * 修改只影响之后的申请。
+ */
+class MemoryBudget {
+public:
+    /**
+     * @brief 组件类别
+     */
+    enum Component {
+        TRANSPOSITION_TABLES,   ///< 各搜索器的置换表
+        NODE_POOLS,             ///< 蒙特卡洛树搜索的节点池
+        CACHES,                 ///< 根节点结果缓存、开局库等
+        COMPONENT_COUNT
+    };
+
+    static constexpr size_t DEFAULT_LIMIT_MB = 512;
+
+    /**
+     * @brief 总预算（字节）
+     */
+    static size_t limitBytes();
+
+    static void setLimitMB(size_t megabytes);
+
+    /**
+     * @brief 一类组件的额度（字节）
+     */
+    static size_t componentLimit(Component component);
+
+    /**
+     * @brief 一类组件已申请的字节数
+     */
+    static size_t used(Component component);
+
+    /**
+     * @brief 一类组件的剩余额度（字节）
+     */
+    static size_t available(Component component);
+
+    /**
+     * @brief 申请额度：得到min(wanted, 剩余额度)，但不少于minimum
+     *
+     * minimum让组件在额度用完时仍能以最小规模工作（超出的部分会出现在报告中）。
+     * @return 得到的字节数
+     */
+    static size_t acquire(Component component, size_t wanted, size_t minimum = 0);
+
+    /**
+     * @brief 剩余额度足够时申请bytes字节，否则不申请并返回false
+     */
+    static bool tryAcquire(Component component, size_t bytes);
+
+    /**
+     * @brief 归还额度
+     */
+    static void release(Component component, size_t bytes);
+
+    static const char* componentName(Component component);
+
+    /**
+     * @brief 各组件的额度、已申请、常驻内存和大页使用情况，以及进程常驻内存（多行文本）
+     */
+    static QString report();
+
+    /**
+     * @brief 单行摘要（MB）：limit_mb= 以及每类组件的 <名称>_mb= / <名称>_resident_mb=，和 rss_mb=
+     */
+    static QString summary();
+
+    /**
+     * @brief 进程常驻内存（字节），无法获取时返回0
+     */
+    static size_t processResidentBytes();
+};
+
+/**
+ * @brief 计入内存预算的一大块清零内存
+ *
+ * Linux上用mmap分配：2MB以上的块先尝试MAP_HUGETLB（需要系统预留大页），失败时退回普通映射并
+ * madvise(MADV_HUGEPAGE)请求透明大页；Windows上有锁页权限时用MEM_LARGE_PAGES，否则普通VirtualAlloc；
+ * 其他平台用普通匿名映射。映射的页在首次写入时才分配物理内存，常驻内存随使用增长。
+ *
+ * 构造时按申请到的额度分配（可能小于请求），析构时释放内存并归还额度。只能移动，不能复制。
+ */
+class MemoryBlock {
+public:
+    /**
+     * @brief 大页使用情况
+     */
+    enum class PageMode {
+        NORMAL,       ///< 普通页
+        ADVISED,      ///< 已请求透明大页（是否生效由内核决定）
+        HUGE_PAGES,   ///< 显式大页
+    };
+
+    MemoryBlock() = default;
+
+    /**
+     * @param component 计入的组件类别
+     * @param wanted 希望的字节数
+     * @param minimum 最少字节数（额度不足时也至少分配这么多）
+     */
+    MemoryBlock(MemoryBudget::Component component, size_t wanted, size_t minimum);
+    ~MemoryBlock();
+
+    MemoryBlock(MemoryBlock&& other) noexcept;
+    MemoryBlock& operator=(MemoryBlock&& other) noexcept;
+    MemoryBlock(const MemoryBlock&) = delete;
+    MemoryBlock& operator=(const MemoryBlock&) = delete;
+
+    bool isNull() const { return data_ == nullptr; }
+
+    void* data() const { return data_; }
+    size_t size() const { return size_; }
+    PageMode pageMode() const { return pageMode_; }
+
+    /**
+     * @brief 当前常驻物理内存的字节数（无法查询的平台返回size()）
+     */
+    size_t residentBytes() const;
+
+    /**
+     * @brief 把整块内存清零
+     */
+    void zero();
+
+private:
+    void reset();
+
+    void* data_ = nullptr;
+    size_t size_ = 0;           ///< 可用字节数
+    size_t mappedSize_ = 0;     ///< 实际映射的字节数（按页取整）
+    MemoryBudget::Component component_ = MemoryBudget::CACHES;
+    PageMode pageMode_ = PageMode::NORMAL;
+};
+
+#endif // MEMORY_BUDGET_H
@@ -0,0 +1,41 @@
+#include "nnue_kernels.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+
+namespace {
+
+void affineAvx2Impl(const uint8_t* input, int inputSize, const int8_t* weights,
+                    const int32_t* bias, int outputSize, int32_t* output)
+{
+    const __m256i ones = _mm256_set1_epi16(1);
+    for (int o = 0; o < outputSize; ++o) {
+        const int8_t* row = weights + o * inputSize;
+        __m256i sum = _mm256_setzero_si256();
+        for (int i = 0; i < inputSize; i += 32) {
+            const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + i));
+            const __m256i w = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + i));
+            // uint8 x int8 两两相加得到int16（输入不超过127，不会饱和），再扩展为int32累加
+            const __m256i products = _mm256_maddubs_epi16(x, w);
+            sum = _mm256_add_epi32(sum, _mm256_madd_epi16(products, ones));
+        }
+        __m128i total = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+        total = _mm_add_epi32(total, _mm_shuffle_epi32(total, _MM_SHUFFLE(1, 0, 3, 2)));
+        total = _mm_add_epi32(total, _mm_shuffle_epi32(total, _MM_SHUFFLE(2, 3, 0, 1)));
+        output[o] = bias[o] + _mm_cvtsi128_si32(total);
+    }
+}
+
+} // namespace
+
+namespace NnueKernels {
+const AffineFn affineAvx2 = &affineAvx2Impl;
+} // namespace NnueKernels
+
+#else
+
+namespace NnueKernels {
+const AffineFn affineAvx2 = nullptr;
+} // namespace NnueKernels
+
+#endif
@@ -0,0 +1,294 @@
+#include "nnue_evaluator.h"
+#include "nnue_kernels.h"
+#include "cpu_features.h"
+#include <QCoreApplication>
+#include <QDebug>
+#include <QSysInfo>
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+
+namespace {
+
+const char MAGIC[8] = {'G', 'M', 'K', 'N', 'N', 'U', 'E', '\0'};
+
+// 权重文件中各段的偏移（见nnue_evaluator.h中的格式说明）
+constexpr qint64 HEADER_SIZE = 64;
+constexpr qint64 L1_BIAS_OFFSET = HEADER_SIZE;
+constexpr qint64 L1_WEIGHTS_OFFSET = L1_BIAS_OFFSET + NnueNetwork::L1 * 2;
+constexpr qint64 L2_BIAS_OFFSET = L1_WEIGHTS_OFFSET + NnueNetwork::INPUTS * NnueNetwork::L1 * 2;
+constexpr qint64 L2_WEIGHTS_OFFSET = L2_BIAS_OFFSET + NnueNetwork::L2 * 4;
+constexpr qint64 OUTPUT_BIAS_OFFSET = L2_WEIGHTS_OFFSET + NnueNetwork::L2 * NnueNetwork::L1;
+constexpr qint64 OUTPUT_WEIGHTS_OFFSET = (OUTPUT_BIAS_OFFSET + 4 + 63) / 64 * 64;
+constexpr qint64 FILE_SIZE = OUTPUT_WEIGHTS_OFFSET + NnueNetwork::L2;
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t inputs;
+    uint32_t l1;
+    uint32_t l2;
+    int32_t outputScale;
+    uint32_t reserved;
+};
+
+} // namespace
+
+namespace NnueKernels {
+
+void affineScalar(const uint8_t* input, int inputSize, const int8_t* weights,
+                  const int32_t* bias, int outputSize, int32_t* output)
+{
+    for (int o = 0; o < outputSize; ++o) {
+        const int8_t* row = weights + o * inputSize;
+        int32_t sum = bias[o];
+        for (int i = 0; i < inputSize; ++i) {
+            sum += static_cast<int32_t>(input[i]) * row[i];
+        }
+        output[o] = sum;
+    }
+}
+
+AffineFn best()
+{
+    if (affineAvx2 && CpuFeatures::hasAvx2()) {
+        return affineAvx2;
+    }
+    return &affineScalar;
+}
+
+} // namespace NnueKernels
+
+std::shared_ptr<const NnueNetwork> NnueNetwork::load(const QString& filename, QString* error)
+{
+    auto fail = [error](const QString& message) -> std::shared_ptr<const NnueNetwork> {
+        if (error) {
+            *error = message;
+        }
+        return nullptr;
+    };
+
+    if (QSysInfo::ByteOrder != QSysInfo::LittleEndian) {
+        return fail("NNUE权重文件仅支持小端序平台");
+    }
+
+    std::shared_ptr<NnueNetwork> network(new NnueNetwork());
+    network->file_ = std::make_unique<QFile>(filename);
+    if (!network->file_->open(QIODevice::ReadOnly)) {
+        return fail(QString("无法打开权重文件 %1").arg(filename));
+    }
+    if (network->file_->size() != FILE_SIZE) {
+        return fail(QString("权重文件大小不正确：%1 字节，应为 %2 字节")
+                        .arg(network->file_->size()).arg(FILE_SIZE));
+    }
+
+    const uchar* data = network->file_->map(0, FILE_SIZE);
+    if (!data) {
+        return fail(QString("无法映射权重文件 %1").arg(filename));
+    }
+
+    FileHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+        return fail("不是NNUE权重文件");
+    }
+    if (header.version != VERSION) {
+        return fail(QString("不支持的权重文件版本 %1").arg(header.version));
+    }
+    if (header.inputs != INPUTS || header.l1 != L1 || header.l2 != L2) {
+        return fail("权重文件的网络结构与程序不一致");
+    }
+
+    network->outputScale_ = header.outputScale;
+    network->l1Bias_ = reinterpret_cast<const int16_t*>(data + L1_BIAS_OFFSET);
+    network->l1Weights_ = reinterpret_cast<const int16_t*>(data + L1_WEIGHTS_OFFSET);
+    network->l2Bias_ = reinterpret_cast<const int32_t*>(data + L2_BIAS_OFFSET);
+    network->l2Weights_ = reinterpret_cast<const int8_t*>(data + L2_WEIGHTS_OFFSET);
+    network->outputBias_ = reinterpret_cast<const int32_t*>(data + OUTPUT_BIAS_OFFSET);
+    network->outputWeights_ = reinterpret_cast<const int8_t*>(data + OUTPUT_WEIGHTS_OFFSET);
+    return network;
+}
+
+std::shared_ptr<const NnueNetwork> NnueNetwork::shared()
+{
+    static std::mutex mutex;
+    static std::shared_ptr<const NnueNetwork> network;
+    static bool attempted = false;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!attempted) {
+        attempted = true;
+        QString path = qEnvironmentVariable("GOMOKU_NNUE_FILE");
+        if (path.isEmpty()) {
+            path = QCoreApplication::instance()
+                ? QCoreApplication::applicationDirPath() + "/gomoku.nnue"
+                : QString("gomoku.nnue");
+        }
+        QString error;
+        network = load(path, &error);
+        if (!network) {
+            qWarning().noquote() << "NNUE评估不可用：" << error;
+        }
+    }
+    return network;
+}
+
+bool NnueNetwork::save(const QString& filename, const std::vector<int16_t>& l1Bias,
+                       const std::vector<int16_t>& l1Weights, const std::vector<int32_t>& l2Bias,
+                       const std::vector<int8_t>& l2Weights, int32_t outputBias,
+                       const std::vector<int8_t>& outputWeights, int32_t outputScale)
+{
+    if (l1Bias.size() != static_cast<size_t>(L1) ||
+        l1Weights.size() != static_cast<size_t>(INPUTS * L1) ||
+        l2Bias.size() != static_cast<size_t>(L2) ||
+        l2Weights.size() != static_cast<size_t>(L2 * L1) ||
+        outputWeights.size() != static_cast<size_t>(L2)) {
+        return false;
+    }
+
+    QByteArray buffer(static_cast<int>(FILE_SIZE), '\0');
+    FileHeader header = {};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.inputs = INPUTS;
+    header.l1 = L1;
+    header.l2 = L2;
+    header.outputScale = outputScale;
+    char* data = buffer.data();
+    std::memcpy(data, &header, sizeof(header));
+    std::memcpy(data + L1_BIAS_OFFSET, l1Bias.data(), l1Bias.size() * sizeof(int16_t));
+    std::memcpy(data + L1_WEIGHTS_OFFSET, l1Weights.data(), l1Weights.size() * sizeof(int16_t));
+    std::memcpy(data + L2_BIAS_OFFSET, l2Bias.data(), l2Bias.size() * sizeof(int32_t));
+    std::memcpy(data + L2_WEIGHTS_OFFSET, l2Weights.data(), l2Weights.size());
+    std::memcpy(data + OUTPUT_BIAS_OFFSET, &outputBias, sizeof(outputBias));
+    std::memcpy(data + OUTPUT_WEIGHTS_OFFSET, outputWeights.data(), outputWeights.size());
+
+    QFile file(filename);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    return file.write(buffer) == buffer.size();
+}
+
+int NnueNetwork::forward(const uint8_t* input) const
+{
+    static const NnueKernels::AffineFn affine = NnueKernels::best();
+
+    alignas(32) int32_t hidden[L2];
+    affine(input, L1, l2Weights_, l2Bias_, L2, hidden);
+
+    alignas(32) uint8_t clipped[L2];
+    for (int j = 0; j < L2; ++j) {
+        clipped[j] = static_cast<uint8_t>(std::clamp(hidden[j] >> L2_SHIFT, 0, CLIP));
+    }
+
+    int32_t output;
+    affine(clipped, L2, outputWeights_, outputBias_, 1, &output);
+    return static_cast<int>(static_cast<int64_t>(output) * outputScale_ / 1024);
+}
+
+NnueEvaluator::NnueEvaluator(std::shared_ptr<const NnueNetwork> network)
+    : network_(std::move(network))
+{
+    reset(std::vector<std::vector<PieceType>>(
+        BOARD_SIZE, std::vector<PieceType>(BOARD_SIZE, PieceType::NONE)));
+}
+
+void NnueEvaluator::reset(const std::vector<std::vector<PieceType>>& boardState)
+{
+    std::copy(network_->l1Bias(), network_->l1Bias() + NnueNetwork::L1, accumulator_[0]);
+    std::copy(network_->l1Bias(), network_->l1Bias() + NnueNetwork::L1, accumulator_[1]);
+    winners_.clear();
+
+    for (int row = 0; row < BOARD_SIZE; ++row) {
+        for (int col = 0; col < BOARD_SIZE; ++col) {
+            cells_[row][col] = boardState[row][col];
+            if (cells_[row][col] != PieceType::NONE) {
+                applyPiece(row, col, cells_[row][col], 1);
+            }
+        }
+    }
+
+    // 根局面中已有的连五作为初始胜负状态
+    PieceType rootWinner = PieceType::NONE;
+    for (int row = 0; row < BOARD_SIZE && rootWinner == PieceType::NONE; ++row) {
+        for (int col = 0; col < BOARD_SIZE; ++col) {
+            if (cells_[row][col] != PieceType::NONE && makesFive(row, col)) {
+                rootWinner = cells_[row][col];
+                break;
+            }
+        }
+    }
+    winners_.push_back(rootWinner);
+}
+
+void NnueEvaluator::makeMove(int row, int col, PieceType piece)
+{
+    cells_[row][col] = piece;
+    applyPiece(row, col, piece, 1);
+
+    // 保留最早形成的连五
+    PieceType winner = winners_.back();
+    if (winner == PieceType::NONE && makesFive(row, col)) {
+        winner = piece;
+    }
+    winners_.push_back(winner);
+}
+
+void NnueEvaluator::unmakeMove(int row, int col, PieceType piece)
+{
+    winners_.pop_back();
+    applyPiece(row, col, piece, -1);
+    cells_[row][col] = PieceType::NONE;
+}
+
+int NnueEvaluator::evaluate(const std::vector<std::vector<PieceType>>&, PieceType currentPlayer)
+{
+    PieceType winner = winners_.back();
+    if (winner != PieceType::NONE) {
+        return winner == currentPlayer ? WIN_SCORE : -WIN_SCORE;
+    }
+
+    const int16_t* accumulator = accumulator_[currentPlayer == PieceType::BLACK ? 0 : 1];
+    alignas(32) uint8_t input[NnueNetwork::L1];
+    for (int i = 0; i < NnueNetwork::L1; ++i) {
+        input[i] = static_cast<uint8_t>(std::clamp<int>(accumulator[i], 0, NnueNetwork::CLIP));
+    }
+
+    // 网络评分不应越过胜负分数
+    return std::clamp(network_->forward(input), -WIN_SCORE + 1, WIN_SCORE - 1);
+}
+
+void NnueEvaluator::applyPiece(int row, int col, PieceType piece, int sign)
+{
+    const int cell = row * BOARD_SIZE + col;
+    // 特征编号 = 格子 * 2 + (是否为对方棋子)
+    const int16_t* blackView = network_->l1Weights(cell * 2 + (piece == PieceType::BLACK ? 0 : 1));
+    const int16_t* whiteView = network_->l1Weights(cell * 2 + (piece == PieceType::WHITE ? 0 : 1));
+    for (int i = 0; i < NnueNetwork::L1; ++i) {
+        accumulator_[0][i] = static_cast<int16_t>(accumulator_[0][i] + sign * blackView[i]);
+        accumulator_[1][i] = static_cast<int16_t>(accumulator_[1][i] + sign * whiteView[i]);
+    }
+}
+
+bool NnueEvaluator::makesFive(int row, int col) const
+{
+    const PieceType piece = cells_[row][col];
+    const int directions[4][2] = {{1, 0}, {0, 1}, {1, 1}, {1, -1}};
+    for (const auto& dir : directions) {
+        int count = 1;
+        for (int sign = -1; sign <= 1; sign += 2) {
+            int r = row + sign * dir[0];
+            int c = col + sign * dir[1];
+            while (r >= 0 && r < BOARD_SIZE && c >= 0 && c < BOARD_SIZE && cells_[r][c] == piece) {
+                ++count;
+                r += sign * dir[0];
+                c += sign * dir[1];
+            }
+        }
+        if (count >= 5) {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,127 @@
+#ifndef NNUE_EVALUATOR_H
+#define NNUE_EVALUATOR_H
+
+#include <QFile>
+#include <QString>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "evaluator.h"
+
+/**
+ * @brief NNUE网络权重（只读，多个评估函数实例共享）
+ *
+ * 网络结构：450输入（225格 x {己方, 对方}） -> 64 (int16累加器) -> 32 -> 1。
+ * 第一层按视角维护两套累加器并在落子/撤销时增量更新；
+ * 后两层输入为截断到[0, 127]的uint8，权重为int8，使用SIMD点积计算。
+ *
+ * 权重文件格式（小端序，版本1），各数组起始位置按64字节对齐：
+ * @code
+ *   偏移  类型        内容
+ *   0     char[8]     魔数 "GMKNNUE\0"
+ *   8     uint32      版本号（1）
+ *   12    uint32      输入维度（450）
+ *   16    uint32      第一层维度（64）
+ *   20    uint32      第二层维度（32）
+ *   24    int32       输出缩放（评分 = 网络输出 * 输出缩放 / 1024）
+ *   28    uint32      保留，写0
+ *   64    int16[64]          第一层偏置
+ *   192   int16[450][64]     第一层权重（按输入特征排列）
+ *   57792 int32[32]          第二层偏置
+ *   57920 int8[32][64]       第二层权重（按输出排列）
+ *   59968 int32              输出层偏置（后补60字节对齐）
+ *   60032 int8[32]           输出层权重
+ *   60064                    文件结束
+ * @endcode
+ * 文件通过QFile::map内存映射，权重直接从映射区读取，不做拷贝。
+ */
+class NnueNetwork {
+public:
+    static constexpr int BOARD_CELLS = 15 * 15;   ///< 格子数
+    static constexpr int INPUTS = BOARD_CELLS * 2;  ///< 输入特征数
+    static constexpr int L1 = 64;                 ///< 第一层（累加器）维度
+    static constexpr int L2 = 32;                 ///< 第二层维度
+    static constexpr uint32_t VERSION = 1;        ///< 支持的文件版本
+    static constexpr int CLIP = 127;              ///< 截断ReLU的上界
+    static constexpr int L2_SHIFT = 6;            ///< 第二层输出的定点右移位数
+
+    /**
+     * @brief 从权重文件加载
+     * @param filename 权重文件路径
+     * @param error 失败时的错误描述（可为nullptr）
+     * @return 加载失败返回nullptr
+     */
+    static std::shared_ptr<const NnueNetwork> load(const QString& filename, QString* error = nullptr);
+
+    /**
+     * @brief 获取默认权重（进程内只加载一次）
+     *
+     * 路径取环境变量GOMOKU_NNUE_FILE，未设置时为程序目录下的gomoku.nnue。
+     */
+    static std::shared_ptr<const NnueNetwork> shared();
+
+    /**
+     * @brief 将权重写成版本1格式的文件（供训练工具使用）
+     */
+    static bool save(const QString& filename, const std::vector<int16_t>& l1Bias,
+                     const std::vector<int16_t>& l1Weights, const std::vector<int32_t>& l2Bias,
+                     const std::vector<int8_t>& l2Weights, int32_t outputBias,
+                     const std::vector<int8_t>& outputWeights, int32_t outputScale);
+
+    const int16_t* l1Bias() const { return l1Bias_; }
+    const int16_t* l1Weights(int feature) const { return l1Weights_ + feature * L1; }
+
+    /**
+     * @brief 由截断后的累加器计算评分
+     * @param input 截断到[0, 127]的第一层输出
+     */
+    int forward(const uint8_t* input) const;
+
+private:
+    NnueNetwork() = default;
+
+    std::unique_ptr<QFile> file_;      ///< 保持映射有效的文件对象
+    const int16_t* l1Bias_ = nullptr;
+    const int16_t* l1Weights_ = nullptr;
+    const int32_t* l2Bias_ = nullptr;
+    const int8_t* l2Weights_ = nullptr;
+    const int32_t* outputBias_ = nullptr;
+    const int8_t* outputWeights_ = nullptr;
+    int32_t outputScale_ = 0;
+};
+
+/**
+ * @brief 基于NNUE网络的评估函数
+ *
+ * 每个视角（黑/白）各维护一个int16累加器，落子时加上对应特征的权重列，
+ * 撤销时减去，因此每个节点只需更新两列而不是重算整层。
+ */
+class NnueEvaluator : public Evaluator {
+public:
+    explicit NnueEvaluator(std::shared_ptr<const NnueNetwork> network);
+
+    QString getName() const override { return "NNUE"; }
+
+    void reset(const std::vector<std::vector<PieceType>>& boardState) override;
+    void makeMove(int row, int col, PieceType piece) override;
+    void unmakeMove(int row, int col, PieceType piece) override;
+    int evaluate(const std::vector<std::vector<PieceType>>& boardState,
+                 PieceType currentPlayer) override;
+
+private:
+    static constexpr int BOARD_SIZE = 15;
+    static constexpr int WIN_SCORE = 100000;  ///< 与棋型评估一致的胜负分数
+
+    std::shared_ptr<const NnueNetwork> network_;
+    alignas(32) int16_t accumulator_[2][NnueNetwork::L1];  ///< [0]黑方视角，[1]白方视角
+    PieceType cells_[BOARD_SIZE][BOARD_SIZE];              ///< 用于判断连五
+    std::vector<PieceType> winners_;                       ///< 每步落子后的连五方（NONE表示未成五）
+
+    // 对两个视角的累加器加上/减去一枚棋子的特征
+    void applyPiece(int row, int col, PieceType piece, int sign);
+
+    // 判断(row, col)处的棋子是否构成连五
+    bool makesFive(int row, int col) const;
+};
+
+#endif // NNUE_EVALUATOR_H
@@ -0,0 +1,35 @@
+#ifndef NNUE_KERNELS_H
+#define NNUE_KERNELS_H
+
+#include <cstdint>
+
+/**
+ * @brief NNUE全连接层内核
+ *
+ * output[o] = bias[o] + sum(input[i] * weights[o * inputSize + i])，
+ * input为uint8（截断ReLU输出），weights为int8，inputSize须为32的倍数。
+ */
+namespace NnueKernels {
+
+using AffineFn = void (*)(const uint8_t* input, int inputSize, const int8_t* weights,
+                          const int32_t* bias, int outputSize, int32_t* output);
+
+/**
+ * @brief 标量实现
+ */
+void affineScalar(const uint8_t* input, int inputSize, const int8_t* weights,
+                  const int32_t* bias, int outputSize, int32_t* output);
+
+/**
+ * @brief AVX2实现（maddubs点积），构建不支持时为nullptr
+ */
+extern const AffineFn affineAvx2;
+
+/**
+ * @brief 按CPU能力选择的实现
+ */
+AffineFn best();
+
+} // namespace NnueKernels
+
+#endif // NNUE_KERNELS_H
@@ -0,0 +1,623 @@
+#include "opening_book.h"
+#include "position.h"
+#include "transposition_table.h"
+#include "zobrist.h"
+#include <QSaveFile>
+#include <QSysInfo>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+using namespace OpeningBookFormat;
+
+namespace {
+
+PieceType sideToMove(int stones)
+{
+    return stones % 2 == 0 ? PieceType::BLACK : PieceType::WHITE;
+}
+
+void unpack(const PackedPosition& packed, Position& position)
+{
+    position.clear();
+    for (int cell = 0; cell < Position::CELLS; ++cell) {
+        const PieceType piece = packed.piece(cell);
+        if (piece != PieceType::NONE) {
+            position.placePiece(cell / Position::SIZE, cell % Position::SIZE, piece);
+        }
+    }
+}
+
+/**
+ * @brief 在规范局面上走一步，得到走后局面的规范哈希和规范方向的局面
+ * @return 这一步是否成五（成五时不生成局面）
+ */
+bool playCanonical(const PackedPosition& parent, int stones, int cell, uint64_t* hash, PackedPosition* child)
+{
+    const PieceType mover = sideToMove(stones);
+    Position position;
+    unpack(parent, position);
+    if (position.getPiece(cell / Position::SIZE, cell % Position::SIZE) != PieceType::NONE ||
+        position.placePiece(cell / Position::SIZE, cell % Position::SIZE, mover)) {
+        return true;
+    }
+
+    SymmetricHash symmetric;
+    for (int c = 0; c < Position::CELLS; ++c) {
+        const PieceType piece = position.getPiece(c / Position::SIZE, c % Position::SIZE);
+        if (piece != PieceType::NONE) {
+            symmetric.toggle(c / Position::SIZE, c % Position::SIZE, piece);
+        }
+    }
+    int sym = 0;
+    *hash = symmetric.canonical(&sym);
+    *child = PackedPosition();
+    child->toMove = static_cast<uint8_t>(sideToMove(stones + 1));
+    for (int c = 0; c < Position::CELLS; ++c) {
+        const PieceType piece = position.getPiece(c / Position::SIZE, c % Position::SIZE);
+        if (piece != PieceType::NONE) {
+            child->setPiece(Symmetry::transform(sym, c), piece);
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+OpeningBook::~OpeningBook()
+{
+    close();
+}
+
+bool OpeningBook::open(const QString& filename)
+{
+    close();
+    if (QSysInfo::ByteOrder != QSysInfo::LittleEndian) {
+        error_ = "开局库只支持小端序平台";
+        return false;
+    }
+
+    file_.setFileName(filename);
+    if (!file_.open(QIODevice::ReadOnly)) {
+        error_ = QString("无法打开 %1").arg(filename);
+        return false;
+    }
+    size_ = file_.size();
+    data_ = size_ >= static_cast<qint64>(sizeof(Header)) ? file_.map(0, size_) : nullptr;
+    if (!data_) {
+        error_ = QString("无法映射 %1").arg(filename);
+        close();
+        return false;
+    }
+
+    const auto* header = reinterpret_cast<const Header*>(data_);
+    auto sectionFits = [&](uint64_t offset, uint64_t count, size_t entrySize) {
+        return offset % 8 == 0 && offset <= static_cast<uint64_t>(size_) &&
+               count <= (static_cast<uint64_t>(size_) - offset) / entrySize;
+    };
+    if (std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0 || header->version != VERSION) {
+        error_ = "不是开局库或版本不受支持";
+        close();
+        return false;
+    }
+    if (!sectionFits(header->entriesOffset, header->entryCount, sizeof(Entry)) ||
+        !sectionFits(header->movesOffset, header->moveCount, sizeof(MoveEntry))) {
+        error_ = "开局库已损坏";
+        close();
+        return false;
+    }
+
+    header_ = header;
+    entries_ = reinterpret_cast<const Entry*>(data_ + header->entriesOffset);
+    moves_ = reinterpret_cast<const MoveEntry*>(data_ + header->movesOffset);
+    error_.clear();
+    return true;
+}
+
+void OpeningBook::close()
+{
+    if (data_) {
+        file_.unmap(const_cast<uchar*>(data_));
+    }
+    file_.close();
+    data_ = nullptr;
+    size_ = 0;
+    header_ = nullptr;
+    entries_ = nullptr;
+    moves_ = nullptr;
+}
+
+bool OpeningBook::find(const Position& position, std::vector<BookMove>& moves, int* value) const
+{
+    moves.clear();
+    if (!header_) {
+        return false;
+    }
+
+    SymmetricHash hash;
+    for (int row = 0; row < Position::SIZE; ++row) {
+        for (int col = 0; col < Position::SIZE; ++col) {
+            const PieceType piece = position.getPiece(row, col);
+            if (piece != PieceType::NONE) {
+                hash.toggle(row, col, piece);
+            }
+        }
+    }
+    int querySym = 0;
+    const uint64_t key = hash.canonical(&querySym);
+    const int toQuery = Symmetry::inverse(querySym);
+
+    const Entry* entriesEnd = entries_ + header_->entryCount;
+    const Entry* entry = std::lower_bound(entries_, entriesEnd, key,
+        [](const Entry& e, uint64_t h) { return e.hash < h; });
+    if (entry == entriesEnd || entry->hash != key ||
+        uint64_t(entry->firstMove) + entry->moveCount > header_->moveCount) {
+        return false;
+    }
+
+    const MoveEntry* begin = moves_ + entry->firstMove;
+    for (const MoveEntry* move = begin; move != begin + entry->moveCount; ++move) {
+        if (move->cell >= Position::CELLS) {
+            continue;
+        }
+        const int cell = Symmetry::transform(toQuery, move->cell);
+        BookMove bookMove;
+        bookMove.move = Move(cell / Position::SIZE, cell % Position::SIZE);
+        bookMove.score = move->score;
+        bookMove.inBook = (move->flags & IN_BOOK) != 0;
+        moves.push_back(bookMove);
+    }
+    if (value) {
+        *value = entry->value;
+    }
+    return true;
+}
+
+/**
+ * @brief 一个搜索线程，构造后在各批之间复用
+ */
+struct OpeningBookBuilder::Worker {
+    explicit Worker(size_t tableMB) : table(tableMB), searcher(table) {}
+
+    TranspositionTable table;
+    Searcher searcher;
+    Position position;
+};
+
+OpeningBookBuilder::OpeningBookBuilder(const Options& options)
+    : options_(options)
+    , stop_(false)
+    , totalNodes_(0)
+{
+    options_.depth = std::clamp(options_.depth, 1, 255);
+    options_.multiPv = std::clamp(options_.multiPv, 1, Searcher::MAX_LINES);
+    options_.maxPly = std::clamp(options_.maxPly, 1, static_cast<int>(Position::CELLS));
+    options_.batch = std::max(1, options_.batch);
+
+    int threads = options.threads;
+    if (threads <= 0) {
+        threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    }
+    for (int i = 0; i < threads; ++i) {
+        auto worker = std::make_unique<Worker>(static_cast<size_t>(std::max(1, options.tableMB)));
+        if (!worker->searcher.setEvaluator(options.evaluator)) {
+            error_ = QString("无法创建评估函数 %1").arg(options.evaluator);
+            workers_.clear();
+            return;
+        }
+        workers_.push_back(std::move(worker));
+    }
+}
+
+OpeningBookBuilder::~OpeningBookBuilder() = default;
+
+bool OpeningBookBuilder::load(const QString& filename)
+{
+    OpeningBook book;
+    if (!book.open(filename)) {
+        error_ = book.errorString();
+        return false;
+    }
+    const Header* header = book.header_;
+    const Entry* entries = book.entries_;
+    const MoveEntry* moves = book.moves_;
+
+    // 先按文件顺序读入，局面本身之后从空棋盘重放
+    std::vector<Node> nodes(header->entryCount);
+    std::unordered_map<uint64_t, int32_t> index;
+    index.reserve(header->entryCount);
+    for (uint32_t i = 0; i < header->entryCount; ++i) {
+        const Entry& entry = entries[i];
+        if (uint64_t(entry.firstMove) + entry.moveCount > header->moveCount || !index.emplace(entry.hash, i).second) {
+            error_ = "开局库已损坏";
+            return false;
+        }
+        Node& node = nodes[i];
+        node.hash = entry.hash;
+        node.stones = -1;
+        node.depth = entry.depth;
+        node.value = entry.value;
+        node.cost = -1;
+        for (uint32_t m = entry.firstMove; m < entry.firstMove + entry.moveCount; ++m) {
+            if (moves[m].cell >= Position::CELLS) {
+                error_ = "开局库已损坏";
+                return false;
+            }
+            // 已收录的着法先标记为0，重放时换成下标
+            node.moves.push_back({moves[m].score, moves[m].cell, (moves[m].flags & IN_BOOK) ? 0 : -1});
+        }
+    }
+
+    const auto root = index.find(SymmetricHash().canonical());
+    if (root == index.end()) {
+        error_ = "开局库中没有空棋盘";
+        return false;
+    }
+
+    // 从空棋盘沿库内着法按棋子数逐层重放，新的下标按重放顺序排列（根为0）
+    std::vector<int32_t> order{root->second};
+    nodes[root->second].stones = 0;
+    nodes[root->second].position = PackedPosition();
+    for (size_t i = 0; i < order.size(); ++i) {
+        Node& node = nodes[order[i]];
+        for (Candidate& candidate : node.moves) {
+            if (candidate.child < 0) {
+                continue;
+            }
+            uint64_t hash = 0;
+            PackedPosition position;
+            const auto child = playCanonical(node.position, node.stones, candidate.cell, &hash, &position)
+                               ? index.end() : index.find(hash);
+            if (child == index.end()) {
+                error_ = "开局库已损坏：库内着法走到的局面不在库中";
+                return false;
+            }
+            Node& next = nodes[child->second];
+            if (next.stones < 0) {
+                next.stones = node.stones + 1;
+                next.position = position;
+                order.push_back(child->second);
+            }
+            candidate.child = child->second;
+        }
+    }
+
+    std::vector<int32_t> renumber(nodes.size(), -1);
+    for (size_t i = 0; i < order.size(); ++i) {
+        renumber[order[i]] = static_cast<int32_t>(i);
+    }
+    nodes_.clear();
+    index_.clear();
+    nodes_.reserve(order.size());
+    for (int32_t old : order) {
+        Node& node = nodes[old];
+        for (Candidate& candidate : node.moves) {
+            candidate.child = candidate.child >= 0 ? renumber[candidate.child] : -1;
+        }
+        index_.emplace(node.hash, static_cast<int32_t>(nodes_.size()));
+        nodes_.push_back(std::move(node));
+    }
+    totalNodes_ = static_cast<long long>(header->totalNodes);
+    updateValues();
+    return true;
+}
+
+int OpeningBookBuilder::moveValue(const Candidate& candidate) const
+{
+    if (candidate.child < 0) {
+        return candidate.score;
+    }
+    int value = -nodes_[candidate.child].value;
+    if (value >= Searcher::WIN_THRESHOLD) {
+        value -= 1;
+    } else if (value <= -Searcher::WIN_THRESHOLD) {
+        value += 1;
+    }
+    return value;
+}
+
+void OpeningBookBuilder::updateValues()
+{
+    // 库内着法总是多一个棋子，按棋子数排序即为拓扑序
+    std::vector<int32_t> order(nodes_.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        order[i] = static_cast<int32_t>(i);
+    }
+    std::stable_sort(order.begin(), order.end(),
+                     [this](int32_t a, int32_t b) { return nodes_[a].stones < nodes_[b].stones; });
+
+    for (auto it = order.rbegin(); it != order.rend(); ++it) {
+        Node& node = nodes_[*it];
+        if (node.moves.empty()) {
+            continue;  // 没有着法的局面保留搜索分数
+        }
+        int best = -Searcher::WIN_SCORE;
+        for (const Candidate& candidate : node.moves) {
+            best = std::max(best, moveValue(candidate));
+        }
+        node.value = best;
+    }
+
+    for (Node& node : nodes_) {
+        node.cost = -1;
+    }
+    if (!nodes_.empty()) {
+        nodes_[0].cost = 0;
+    }
+    for (int32_t i : order) {
+        const Node& node = nodes_[i];
+        if (node.cost < 0) {
+            continue;
+        }
+        for (const Candidate& candidate : node.moves) {
+            if (candidate.child < 0) {
+                continue;
+            }
+            const long long cost = node.cost + (node.value - moveValue(candidate)) + options_.plyCost;
+            long long& childCost = nodes_[candidate.child].cost;
+            childCost = childCost < 0 ? cost : std::min(childCost, cost);
+        }
+    }
+}
+
+void OpeningBookBuilder::searchJobs(std::vector<Job>& jobs)
+{
+    std::atomic<size_t> next(0);
+    Searcher::Limits limits;
+    limits.maxDepth = options_.depth;
+    limits.maxNodes = options_.maxNodes;
+    limits.multiPv = options_.multiPv;
+
+    auto work = [&](Worker& worker) {
+        for (;;) {
+            const size_t index = next.fetch_add(1, std::memory_order_relaxed);
+            if (index >= jobs.size()) {
+                break;
+            }
+            Job& job = jobs[index];
+            const PieceType toMove = sideToMove(job.stones);
+            unpack(job.position, worker.position);
+            worker.table.clear();
+            worker.searcher.clearHistory();
+            job.result = worker.searcher.search(worker.position, toMove, limits);
+            if (job.result.lineCount == 0) {
+                // 节点上限在第一层内就用完时退回一层不限节点的搜索
+                Searcher::Limits fallback = limits;
+                fallback.maxDepth = 1;
+                fallback.maxNodes = 0;
+                const long long nodes = job.result.nodes;
+                job.result = worker.searcher.search(worker.position, toMove, fallback);
+                job.result.nodes += nodes;
+            }
+        }
+    };
+
+    const size_t threads = std::min(workers_.size(), jobs.size());
+    std::vector<std::thread> pool;
+    pool.reserve(threads - 1);
+    for (size_t t = 1; t < threads; ++t) {
+        pool.emplace_back(work, std::ref(*workers_[t]));
+    }
+    work(*workers_[0]);
+    for (auto& thread : pool) {
+        thread.join();
+    }
+}
+
+int32_t OpeningBookBuilder::addNode(const Job& job)
+{
+    Node node;
+    node.hash = job.hash;
+    node.position = job.position;
+    node.stones = job.stones;
+    node.depth = job.result.depth;
+    node.value = job.result.lineCount > 0 ? job.result.lines[0].score : 0;
+    node.cost = -1;
+    for (int i = 0; i < job.result.lineCount; ++i) {
+        const Searcher::Line& line = job.result.lines[i];
+        if (line.length > 0 && line.pv[0] < Position::CELLS) {
+            node.moves.push_back({line.score, static_cast<uint8_t>(line.pv[0]), -1});
+        }
+    }
+    const auto index = static_cast<int32_t>(nodes_.size());
+    index_.emplace(node.hash, index);
+    nodes_.push_back(std::move(node));
+    return index;
+}
+
+OpeningBookBuilder::Stats OpeningBookBuilder::expand(long long positions, const Progress& progress)
+{
+    Stats stats;
+    stats.threads = static_cast<int>(workers_.size());
+    if (workers_.empty()) {
+        return stats;
+    }
+    stop_.store(false, std::memory_order_relaxed);
+    const auto startTime = std::chrono::steady_clock::now();
+
+    /**
+     * @brief 一个可展开的候选着法
+     */
+    struct Frontier {
+        long long priority;
+        uint64_t hash;        ///< 所在局面的哈希，用于确定性地打破平局
+        int32_t node;
+        int32_t move;
+    };
+    /**
+     * @brief 本批搜完后要连接的着法
+     */
+    struct Link {
+        int32_t node;
+        int32_t move;
+        size_t job;
+    };
+    std::vector<Frontier> frontier;
+    std::vector<Job> jobs;
+    std::vector<Link> links;
+    std::unordered_map<uint64_t, size_t> pending;
+
+    if (nodes_.empty() && positions > 0) {
+        jobs.push_back({SymmetricHash().canonical(), PackedPosition(), 0, Searcher::Result()});
+        searchJobs(jobs);
+        addNode(jobs[0]);
+        stats.searched = 1;
+        stats.nodes = jobs[0].result.nodes;
+    }
+
+    while (stats.searched < positions && !stop_.load(std::memory_order_relaxed)) {
+        updateValues();
+
+        // 候选着法按路径代价加这一步的drop-out排序
+        frontier.clear();
+        for (size_t i = 0; i < nodes_.size(); ++i) {
+            const Node& node = nodes_[i];
+            if (node.cost < 0 || node.stones >= options_.maxPly) {
+                continue;
+            }
+            for (size_t m = 0; m < node.moves.size(); ++m) {
+                const Candidate& candidate = node.moves[m];
+                if (candidate.child >= 0 || std::abs(candidate.score) >= Searcher::WIN_THRESHOLD) {
+                    continue;
+                }
+                frontier.push_back({node.cost + (node.value - candidate.score) + options_.plyCost,
+                                    node.hash, static_cast<int32_t>(i), static_cast<int32_t>(m)});
+            }
+        }
+        std::sort(frontier.begin(), frontier.end(), [this](const Frontier& a, const Frontier& b) {
+            if (a.priority != b.priority) return a.priority < b.priority;
+            if (a.hash != b.hash) return a.hash < b.hash;
+            return nodes_[a.node].moves[a.move].cell < nodes_[b.node].moves[b.move].cell;
+        });
+
+        // 选出一批新局面：已在库中的只连接，同一批内重复的只搜一次
+        const size_t batch = static_cast<size_t>(std::min<long long>(options_.batch, positions - stats.searched));
+        jobs.clear();
+        links.clear();
+        pending.clear();
+        long long linked = 0;
+        for (const Frontier& item : frontier) {
+            if (jobs.size() >= batch) {
+                break;
+            }
+            const Node& node = nodes_[item.node];
+            Job job;
+            job.stones = node.stones + 1;
+            if (playCanonical(node.position, node.stones, node.moves[item.move].cell, &job.hash, &job.position)) {
+                continue;  // 成五的着法应已是胜负分数，这里只是防御
+            }
+            const auto existing = index_.find(job.hash);
+            if (existing != index_.end()) {
+                nodes_[item.node].moves[item.move].child = existing->second;
+                ++linked;
+                continue;
+            }
+            const auto same = pending.find(job.hash);
+            if (same != pending.end()) {
+                links.push_back({item.node, item.move, same->second});
+                ++linked;
+                continue;
+            }
+            pending.emplace(job.hash, jobs.size());
+            links.push_back({item.node, item.move, jobs.size()});
+            jobs.push_back(std::move(job));
+        }
+        stats.transpositions += linked;
+        if (jobs.empty() && linked == 0) {
+            break;  // 没有可展开的着法
+        }
+
+        searchJobs(jobs);
+        std::vector<int32_t> added(jobs.size());
+        for (size_t i = 0; i < jobs.size(); ++i) {
+            added[i] = addNode(jobs[i]);
+            stats.nodes += jobs[i].result.nodes;
+        }
+        for (const Link& link : links) {
+            nodes_[link.node].moves[link.move].child = added[link.job];
+        }
+        stats.searched += static_cast<long long>(jobs.size());
+        stats.positions = positionCount();
+        stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+        if (progress) {
+            progress(stats);
+        }
+    }
+
+    updateValues();
+    totalNodes_ += stats.nodes;
+    stats.positions = positionCount();
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    return stats;
+}
+
+bool OpeningBookBuilder::save(const QString& filename)
+{
+    // 局面表按哈希排序，着法组按局面表的顺序排列
+    std::vector<int32_t> order(nodes_.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        order[i] = static_cast<int32_t>(i);
+    }
+    std::sort(order.begin(), order.end(),
+              [this](int32_t a, int32_t b) { return nodes_[a].hash < nodes_[b].hash; });
+
+    std::vector<Entry> entries;
+    std::vector<MoveEntry> moves;
+    entries.reserve(order.size());
+    for (int32_t i : order) {
+        const Node& node = nodes_[i];
+        Entry entry;
+        std::memset(&entry, 0, sizeof(entry));
+        entry.hash = node.hash;
+        entry.value = node.value;
+        entry.firstMove = static_cast<uint32_t>(moves.size());
+        entry.moveCount = static_cast<uint16_t>(node.moves.size());
+        entry.depth = static_cast<uint8_t>(std::clamp(node.depth, 0, 255));
+        entries.push_back(entry);
+
+        const size_t first = moves.size();
+        for (const Candidate& candidate : node.moves) {
+            MoveEntry move;
+            std::memset(&move, 0, sizeof(move));
+            move.score = moveValue(candidate);
+            move.cell = candidate.cell;
+            move.flags = candidate.child >= 0 ? IN_BOOK : 0;
+            moves.push_back(move);
+        }
+        std::stable_sort(moves.begin() + static_cast<std::ptrdiff_t>(first), moves.end(),
+                         [](const MoveEntry& a, const MoveEntry& b) { return a.score > b.score; });
+    }
+
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.entryCount = static_cast<uint32_t>(entries.size());
+    header.moveCount = static_cast<uint32_t>(moves.size());
+    header.entriesOffset = sizeof(Header);
+    header.movesOffset = header.entriesOffset + entries.size() * sizeof(Entry);
+    header.searchDepth = static_cast<uint32_t>(options_.depth);
+    header.multiPv = static_cast<uint32_t>(options_.multiPv);
+    header.searchNodes = static_cast<uint64_t>(std::max(0LL, options_.maxNodes));
+    header.totalNodes = static_cast<uint64_t>(totalNodes_);
+    header.maxPly = static_cast<uint32_t>(options_.maxPly);
+
+    QSaveFile file(filename);
+    if (!file.open(QIODevice::WriteOnly)) {
+        error_ = QString("无法写入 %1").arg(filename);
+        return false;
+    }
+    const auto writeBytes = [&file](const void* data, size_t bytes) {
+        return bytes == 0 || file.write(static_cast<const char*>(data), static_cast<qint64>(bytes)) ==
+                             static_cast<qint64>(bytes);
+    };
+    if (!writeBytes(&header, sizeof(header)) ||
+        !writeBytes(entries.data(), entries.size() * sizeof(Entry)) ||
+        !writeBytes(moves.data(), moves.size() * sizeof(MoveEntry)) || !file.commit()) {
+        error_ = QString("写入 %1 失败：%2").arg(filename, file.errorString());
+        return false;
+    }
+    return true;
+}
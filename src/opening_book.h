@@ -0,0 +1,295 @@
+#ifndef OPENING_BOOK_H
+#define OPENING_BOOK_H
+
+#include <QFile>
+#include <QString>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "batch_evaluator.h"
+#include "game_types.h"
+#include "searcher.h"
+
+class Position;
+
+/**
+ * @brief 开局库文件格式（.gmbk）
+ *
+ * 库中的局面以规范Zobrist哈希（8种对称取最小，见zobrist.h）为键，着法保存为规范局面上的格子，
+ * 轮到的一方由棋子数的奇偶决定（黑先）。分数都以局面中轮到的一方为视角，胜负分数同Searcher。
+ * 文件整体内存映射后直接使用，各表中的结构体按小端序原样存储，8字节对齐：
+ * @code
+ * 段         内容
+ * 文件头     OpeningBookFormat::Header（64字节）
+ * 局面表     entryCount个Entry，按哈希升序排列
+ * 着法表     moveCount个MoveEntry，按局面分组，组内按分数降序排列
+ * @endcode
+ */
+namespace OpeningBookFormat {
+
+constexpr char MAGIC[4] = {'G', 'M', 'B', 'K'};
+constexpr uint32_t VERSION = 1;
+
+struct Header {
+    char magic[4];
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t moveCount;
+    uint64_t entriesOffset;    ///< 局面表偏移
+    uint64_t movesOffset;      ///< 着法表偏移
+    uint32_t searchDepth;      ///< 每个局面的搜索深度
+    uint32_t multiPv;          ///< 每个局面保留的候选数
+    uint64_t searchNodes;      ///< 每个局面的节点上限，0表示不限
+    uint64_t totalNodes;       ///< 建库累计搜索的节点数
+    uint32_t maxPly;           ///< 只展开棋子数少于此值的局面
+    uint32_t reserved;
+};
+
+struct Entry {
+    uint64_t hash;             ///< 规范哈希
+    int32_t value;             ///< 按库内着法回溯的负极大值
+    uint32_t firstMove;        ///< 第一个着法在着法表中的下标
+    uint16_t moveCount;        ///< 着法数
+    uint8_t depth;             ///< 搜索深度
+    uint8_t reserved[5];
+};
+
+struct MoveEntry {
+    int32_t score;             ///< 着法分数：已收录的着法为后续局面的回溯值，否则为搜索分数
+    uint8_t cell;              ///< 规范坐标系下的格子（行 * 15 + 列）
+    uint8_t flags;             ///< MoveFlags的组合
+    uint16_t reserved;
+};
+
+enum MoveFlags : uint8_t {
+    IN_BOOK = 1,               ///< 走后的局面也在库中
+};
+
+static_assert(sizeof(Header) == 64, "Header布局变化");
+static_assert(sizeof(Entry) == 24, "Entry布局变化");
+static_assert(sizeof(MoveEntry) == 8, "MoveEntry布局变化");
+
+} // namespace OpeningBookFormat
+
+/**
+ * @brief 内存映射的开局库（只读）
+ *
+ * 打开时映射整个文件，查询在局面表上二分查找，把着法从规范坐标映射回查询局面。
+ * 打开后的查询是只读操作，可以在多个线程中并发进行。
+ */
+class OpeningBook {
+public:
+    /**
+     * @brief 库中的一个着法
+     */
+    struct BookMove {
+        Move move;                 ///< 着法（查询坐标系）
+        int score = 0;             ///< 分数（轮到的一方视角）
+        bool inBook = false;       ///< 走后的局面也在库中
+    };
+
+    OpeningBook() = default;
+    ~OpeningBook();
+
+    OpeningBook(const OpeningBook&) = delete;
+    OpeningBook& operator=(const OpeningBook&) = delete;
+
+    /**
+     * @brief 打开并映射开局库文件
+     */
+    bool open(const QString& filename);
+
+    /**
+     * @brief 关闭开局库
+     */
+    void close();
+
+    bool isOpen() const { return header_ != nullptr; }
+
+    QString errorString() const { return error_; }
+
+    /**
+     * @brief 文件头（未打开时为空）
+     */
+    const OpeningBookFormat::Header* header() const { return header_; }
+
+    /**
+     * @brief 库中的局面数
+     */
+    uint32_t positionCount() const { return header_ ? header_->entryCount : 0; }
+
+    /**
+     * @brief 查询局面（含对称局面）
+     * @param moves 输出库中的着法，按分数降序排列
+     * @param value 输出局面的回溯值，可以为空
+     * @return 局面是否在库中
+     */
+    bool find(const Position& position, std::vector<BookMove>& moves, int* value = nullptr) const;
+
+private:
+    friend class OpeningBookBuilder;
+
+    QFile file_;
+    const uchar* data_ = nullptr;
+    qint64 size_ = 0;
+    const OpeningBookFormat::Header* header_ = nullptr;
+    const OpeningBookFormat::Entry* entries_ = nullptr;
+    const OpeningBookFormat::MoveEntry* moves_ = nullptr;
+    QString error_;
+};
+
+/**
+ * @brief 用drop-out展开建立开局库
+ *
+ * 从空棋盘开始，每个收录的局面用定深（或定节点数）搜索保留前multiPv个候选着法。之后反复：
+ * 1. 按库内着法自底向上回溯负极大值，再自顶向下计算每个局面的路径代价：
+ *    从根到该局面经过的每一步比所在局面的最佳着法差多少分（drop-out）之和，每多一步另加plyCost；
+ * 2. 未收录的候选着法的优先级为所在局面的路径代价加上这一步的drop-out，按优先级从小到大选出一批；
+ *    走后的局面按规范哈希去重，已在库中（换序到达的同一局面）时只连接不搜索；
+ * 3. 这一批新局面分给所有线程并行搜索后收录。
+ * 已分胜负的着法和棋子数达到maxPly的局面不再展开。每个局面搜索前清空置换表和历史分数，
+ * 每批选哪些局面只取决于之前的库内容和batch，所以同样的参数下库的内容与线程数无关。
+ *
+ * 可以先load()已有的库接着扩展：文件中不保存局面本身，从空棋盘沿库内着法重放还原。
+ */
+class OpeningBookBuilder {
+public:
+    /**
+     * @brief 建库参数
+     */
+    struct Options {
+        QString evaluator = "Pattern";  ///< 评估函数名称
+        int depth = 6;                  ///< 每个局面的搜索深度
+        long long maxNodes = 0;         ///< 每个局面的节点上限，0表示不限
+        int multiPv = 4;                ///< 每个局面保留的候选数（1到Searcher::MAX_LINES）
+        int maxPly = 12;                ///< 只展开棋子数少于此值的局面
+        int plyCost = 100;              ///< 路径每多一步增加的代价（评估分数单位）
+        int threads = 0;                ///< 线程数，0表示使用硬件并发数
+        int tableMB = 16;               ///< 每个线程的置换表大小（MB）
+        int batch = 32;                 ///< 每批搜索的局面数（库的内容取决于它，与线程数无关）
+    };
+
+    /**
+     * @brief 建库统计
+     */
+    struct Stats {
+        long long positions = 0;        ///< 库中的局面数
+        long long searched = 0;         ///< 本次新搜索的局面数
+        long long transpositions = 0;   ///< 本次换序连接到已有局面的着法数
+        long long nodes = 0;            ///< 本次搜索的节点数
+        double seconds = 0.0;           ///< 本次用时
+        int threads = 0;                ///< 线程数
+    };
+
+    /**
+     * @brief 每搜完一批时调用（在调用expand的线程上）
+     */
+    using Progress = std::function<void(const Stats&)>;
+
+    explicit OpeningBookBuilder(const Options& options);
+    ~OpeningBookBuilder();
+
+    OpeningBookBuilder(const OpeningBookBuilder&) = delete;
+    OpeningBookBuilder& operator=(const OpeningBookBuilder&) = delete;
+
+    /**
+     * @brief 评估函数是否创建成功
+     */
+    bool isValid() const { return error_.isEmpty(); }
+
+    QString errorString() const { return error_; }
+
+    int threadCount() const { return static_cast<int>(workers_.size()); }
+
+    /**
+     * @brief 读入已有的库，之后的expand在其基础上扩展
+     */
+    bool load(const QString& filename);
+
+    /**
+     * @brief 搜索并收录最多positions个新局面（库为空时先收录空棋盘）
+     *
+     * 所有候选着法都已收录或不可展开时提前结束。
+     */
+    Stats expand(long long positions, const Progress& progress = Progress());
+
+    /**
+     * @brief 写出库文件（先写临时文件，成功后替换）
+     */
+    bool save(const QString& filename);
+
+    /**
+     * @brief 库中的局面数
+     */
+    long long positionCount() const { return static_cast<long long>(nodes_.size()); }
+
+    /**
+     * @brief 根局面（空棋盘）的回溯值
+     */
+    int rootValue() const { return nodes_.empty() ? 0 : nodes_[0].value; }
+
+    /**
+     * @brief 请求停止：当前这一批搜完后结束（可在其他线程调用）
+     */
+    void stop() { stop_.store(true, std::memory_order_relaxed); }
+
+private:
+    struct Worker;
+
+    /**
+     * @brief 一个候选着法
+     */
+    struct Candidate {
+        int score;                      ///< 搜索分数（轮到的一方视角）
+        uint8_t cell;                   ///< 规范坐标系下的格子
+        int32_t child;                  ///< 走后局面的下标，未收录为-1
+    };
+
+    /**
+     * @brief 库中的一个局面（规范方向）
+     */
+    struct Node {
+        uint64_t hash;
+        PackedPosition position;
+        int stones;
+        int depth;
+        int value;                      ///< 回溯值
+        long long cost;                 ///< 路径代价，根不可达时为-1
+        std::vector<Candidate> moves;   ///< 按搜索分数降序
+    };
+
+    /**
+     * @brief 一个待搜索的新局面
+     */
+    struct Job {
+        uint64_t hash;
+        PackedPosition position;
+        int stones;
+        Searcher::Result result;
+    };
+
+    Options options_;
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::vector<Node> nodes_;
+    std::unordered_map<uint64_t, int32_t> index_;   ///< 规范哈希到局面下标
+    std::atomic<bool> stop_;
+    long long totalNodes_;                          ///< 建库累计节点数（含之前的运行）
+    QString error_;
+
+    // 已收录着法的分数：后续局面回溯值取反，胜负分数多算一步
+    int moveValue(const Candidate& candidate) const;
+
+    // 回溯所有局面的值并计算路径代价
+    void updateValues();
+
+    // 并行搜索一批局面
+    void searchJobs(std::vector<Job>& jobs);
+
+    // 收录搜索完的局面
+    int32_t addNode(const Job& job);
+};
+
+#endif // OPENING_BOOK_H
@@ -0,0 +1,185 @@
+#include "pattern_evaluator.h"
+#include <algorithm>
+#include <cmath>
+
+void PatternEvaluator::reset(const std::vector<std::vector<PieceType>>& boardState) {
+    rootState_ = boardState;
+}
+
+int PatternEvaluator::evaluate(const std::vector<std::vector<PieceType>>& boardState,
+                               PieceType currentPlayer) {
+    int score = 0;
+    int size = boardState.size();
+    // 位置价值按根局面统计邻近棋子；未调用reset时使用当前局面
+    const auto& positionState = rootState_.empty() ? boardState : rootState_;
+    const int directions[4][2] = {{1, 0}, {0, 1}, {1, 1}, {1, -1}};
+    
+    // 评估所有位置
+    for (int i = 0; i < size; ++i) {
+        for (int j = 0; j < size; ++j) {
+            if (boardState[i][j] != PieceType::NONE) {
+                PieceType piece = boardState[i][j];
+                int multiplier = (piece == currentPlayer) ? 1 : -1;
+                
+                // 连子价值
+                int lineScoreSum = 0;
+                for (const auto& dir : directions) {
+                    int lineScore = checkLine(boardState, i, j, dir[0], dir[1], piece);
+                    // 如果发现必胜局面，立即返回
+                    if (lineScore >= PatternWeights::MAX_SCORE) {
+                        return multiplier * PatternWeights::FIVE_SCORE;
+                    }
+                    lineScoreSum += lineScore;
+                }
+                score += multiplier * lineScoreSum;
+
+                // 位置价值（根据局势动态调整权重）
+                if (std::abs(lineScoreSum) < 2000) {
+                    int positionScore = calculatePositionScore(positionState, i, j, piece);
+                    score += multiplier * positionScore;
+                }
+            }
+        }
+    }
+
+    return score;
+}
+
+int PatternEvaluator::checkLine(const std::vector<std::vector<PieceType>>& boardState, int startRow, int startCol,
+                                int dRow, int dCol, PieceType player) {
+    const LineShape line = classifyLine(boardState, startRow, startCol, dRow, dCol, player);
+    return PatternWeights::active().score(line.shape, line.gapped);
+}
+
+PatternEvaluator::LineShape PatternEvaluator::classifyLine(const std::vector<std::vector<PieceType>>& boardState,
+                                                           int startRow, int startCol,
+                                                           int dRow, int dCol, PieceType player) {
+    int count = 1;
+    int empty = 0;
+    int size = boardState.size();
+    bool blocked = false;
+    bool hasGap = false;
+    
+    // 向一个方向检查
+    for (int i = 1; i < 5; ++i) {
+        int newRow = startRow + dRow * i;
+        int newCol = startCol + dCol * i;
+        
+        if (newRow < 0 || newRow >= size || newCol < 0 || newCol >= size) {
+            blocked = true;
+            break;
+        }
+        
+        PieceType piece = boardState[newRow][newCol];
+        if (piece == player) {
+            if (empty > 0) hasGap = true;
+            count++;
+        } else if (piece == PieceType::NONE) {
+            if (empty == 0 && i <= 4) {
+                empty++;
+                continue;
+            }
+            break;
+        } else {
+            blocked = true;
+            break;
+        }
+    }
+    
+    int backEmpty = 0;
+    bool backBlocked = false;
+    
+    // 向相反方向检查
+    for (int i = 1; i < 5; ++i) {
+        int newRow = startRow - dRow * i;
+        int newCol = startCol - dCol * i;
+        
+        if (newRow < 0 || newRow >= size || newCol < 0 || newCol >= size) {
+            backBlocked = true;
+            break;
+        }
+        
+        PieceType piece = boardState[newRow][newCol];
+        if (piece == player) {
+            if (backEmpty > 0) hasGap = true;
+            count++;
+        } else if (piece == PieceType::NONE) {
+            if (backEmpty == 0 && i <= 4) {
+                backEmpty++;
+                continue;
+            }
+            break;
+        } else {
+            backBlocked = true;
+            break;
+        }
+    }
+    
+    empty += backEmpty;
+    blocked = blocked && backBlocked;
+    
+    // 根据连子数和空位数确定棋型；只有冲四、冲三、冲二的分数因间断降低
+    if (count >= 5) return {PatternWeights::FIVE, false};  // 胜利
+
+    if (blocked) {
+        if (count == 4) return {PatternWeights::DEAD_FOUR, false};
+        if (count == 3) return {PatternWeights::DEAD_THREE, false};
+        if (count == 2) return {PatternWeights::DEAD_TWO, false};
+        return {PatternWeights::DEAD_ONE, false};
+    }
+    if (count == 4) {
+        return empty >= 2 ? LineShape{PatternWeights::OPEN_FOUR, false}
+                          : LineShape{PatternWeights::HALF_FOUR, hasGap};
+    }
+    if (count == 3) {
+        return empty >= 2 ? LineShape{PatternWeights::OPEN_THREE, false}
+                          : LineShape{PatternWeights::HALF_THREE, hasGap};
+    }
+    if (count == 2) {
+        return empty >= 2 ? LineShape{PatternWeights::OPEN_TWO, false}
+                          : LineShape{PatternWeights::HALF_TWO, hasGap};
+    }
+    return {PatternWeights::OPEN_ONE, false};  // 单子不会有间断
+}
+
+int PatternEvaluator::calculatePositionScore(const std::vector<std::vector<PieceType>>& boardState,
+                                             int row, int col, PieceType player) {
+    int size = boardState.size();
+    int centerValue = size / 2;
+    
+    // 使用曼哈顿距离计算到中心的距离
+    int distanceToCenter = std::abs(row - centerValue) + std::abs(col - centerValue);
+    
+    // 基础分数：越靠近中心分数越高
+    int baseScore = 120 - (distanceToCenter * 8);
+    
+    // 根据周围棋子情况调整分数
+    int neighborScore = 0;
+    const int searchRange = 2;
+    
+    for (int dr = -searchRange; dr <= searchRange; ++dr) {
+        for (int dc = -searchRange; dc <= searchRange; ++dc) {
+            if (dr == 0 && dc == 0) continue;
+            
+            int newRow = row + dr;
+            int newCol = col + dc;
+            
+            if (newRow >= 0 && newRow < size && newCol >= 0 && newCol < size) {
+                PieceType piece = boardState[newRow][newCol];
+                if (piece != PieceType::NONE) {
+                    // 相邻位置的己方子分数高一些
+                    if (std::abs(dr) + std::abs(dc) == 1) {
+                        neighborScore += (piece == player) ? 15 : 10;
+                    }
+                    // 次相邻位置分数较低
+                    else if (std::abs(dr) + std::abs(dc) == 2) {
+                        neighborScore += (piece == player) ? 8 : 5;
+                    }
+                }
+            }
+        }
+    }
+    
+    // 最终分数为基础分数和邻近分数的加权和
+    return std::max(0, baseScore + (neighborScore / 2));
+} 
@@ -0,0 +1,66 @@
+#ifndef PATTERN_EVALUATOR_H
+#define PATTERN_EVALUATOR_H
+
+#include "evaluator.h"
+#include "pattern_weights.h"
+
+/**
+ * @brief 基于棋型的手工评估函数
+ *
+ * 对每枚棋子在四个方向上识别连五、活四、死四、活三等棋型并累加分数，
+ * 棋型不明显时再加上位置价值。棋型的分数取自PatternWeights::active()。
+ * 评估不依赖增量状态，makeMove/unmakeMove为空操作。
+ */
+class PatternEvaluator : public Evaluator {
+public:
+    QString getName() const override { return "Pattern"; }
+
+    void reset(const std::vector<std::vector<PieceType>>& boardState) override;
+    void makeMove(int, int, PieceType) override {}
+    void unmakeMove(int, int, PieceType) override {}
+    int evaluate(const std::vector<std::vector<PieceType>>& boardState,
+                 PieceType currentPlayer) override;
+
+    /**
+     * @brief 一个方向上的棋型
+     */
+    struct LineShape {
+        int shape;      ///< PatternWeights::Shape
+        bool gapped;    ///< 连子中间是否有空位
+    };
+
+    /**
+     * @brief 识别(startRow, startCol)处棋子在一个方向上的棋型（参数同checkLine）
+     */
+    static LineShape classifyLine(const std::vector<std::vector<PieceType>>& boardState, int startRow, int startCol,
+                                  int dRow, int dCol, PieceType player);
+
+    /**
+     * @brief 检查连子情况
+     * @param boardState 棋盘状态
+     * @param startRow 起始行
+     * @param startCol 起始列
+     * @param dRow 行方向
+     * @param dCol 列方向
+     * @param player 棋子颜色
+     * @return 该方向上的棋型分数
+     */
+    static int checkLine(const std::vector<std::vector<PieceType>>& boardState, int startRow, int startCol,
+                         int dRow, int dCol, PieceType player);
+
+    /**
+     * @brief 计算位置分数
+     * @param boardState 用于统计邻近棋子的局面
+     * @param row 行号
+     * @param col 列号
+     * @param player 棋子颜色
+     * @return 位置价值
+     */
+    static int calculatePositionScore(const std::vector<std::vector<PieceType>>& boardState,
+                                      int row, int col, PieceType player);
+
+private:
+    std::vector<std::vector<PieceType>> rootState_;  ///< 根局面（位置价值按根局面的邻近棋子统计）
+};
+
+#endif // PATTERN_EVALUATOR_H
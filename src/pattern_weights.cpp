@@ -0,0 +1,117 @@
+#include "pattern_weights.h"
+#include <QCoreApplication>
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+
+PatternWeights PatternWeights::active_;
+
+namespace {
+
+const char FORMAT[] = "gomoku-pattern-weights";
+constexpr int VERSION = 1;
+
+const char* const SHAPE_NAMES[PatternWeights::SHAPE_COUNT] = {
+    "deadFour", "deadThree", "deadTwo", "deadOne",
+    "openFour", "halfOpenFour", "openThree", "halfOpenThree",
+    "openTwo", "halfOpenTwo", "openOne"
+};
+
+} // namespace
+
+const char* PatternWeights::shapeName(int shape)
+{
+    return shape >= 0 && shape < SHAPE_COUNT ? SHAPE_NAMES[shape] : "five";
+}
+
+bool PatternWeights::load(const QString& filename, QString* error)
+{
+    auto fail = [error](const QString& message) {
+        if (error) {
+            *error = message;
+        }
+        return false;
+    };
+
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return fail(QString("无法打开权重文件 %1").arg(filename));
+    }
+    const QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
+    const QJsonObject object = doc.object();
+    if (!doc.isObject() || object["format"].toString() != FORMAT) {
+        return fail("不是棋型权重文件");
+    }
+    if (object["version"].toInt() != VERSION) {
+        return fail(QString("不支持的权重文件版本 %1").arg(object["version"].toInt()));
+    }
+
+    PatternWeights weights = *this;
+    for (int shape = 0; shape < SHAPE_COUNT; ++shape) {
+        if (object.contains(SHAPE_NAMES[shape])) {
+            weights.values[shape] = object[SHAPE_NAMES[shape]].toInt();
+            if (weights.values[shape] < 0 || weights.values[shape] >= MAX_SCORE) {
+                return fail(QString("%1 的分数超出范围 [0, %2)").arg(SHAPE_NAMES[shape]).arg(MAX_SCORE));
+            }
+        }
+    }
+    weights.gapNumerator = object["gapNumerator"].toInt(weights.gapNumerator);
+    weights.gapDenominator = object["gapDenominator"].toInt(weights.gapDenominator);
+    if (weights.gapNumerator < 0 || weights.gapDenominator <= 0 ||
+        weights.gapNumerator > weights.gapDenominator) {
+        return fail("间断系数应在0到1之间");
+    }
+    *this = weights;
+    return true;
+}
+
+bool PatternWeights::save(const QString& filename, QString* error) const
+{
+    QJsonObject object;
+    object["format"] = FORMAT;
+    object["version"] = VERSION;
+    for (int shape = 0; shape < SHAPE_COUNT; ++shape) {
+        object[SHAPE_NAMES[shape]] = values[shape];
+    }
+    object["gapNumerator"] = gapNumerator;
+    object["gapDenominator"] = gapDenominator;
+
+    QSaveFile file(filename);
+    if (!file.open(QIODevice::WriteOnly)) {
+        if (error) {
+            *error = file.errorString();
+        }
+        return false;
+    }
+    file.write(QJsonDocument(object).toJson());
+    if (!file.commit()) {
+        if (error) {
+            *error = file.errorString();
+        }
+        return false;
+    }
+    return true;
+}
+
+void PatternWeights::loadStartupFile()
+{
+    QString path = qEnvironmentVariable("GOMOKU_WEIGHTS_FILE");
+    if (path.isEmpty()) {
+        path = QCoreApplication::instance()
+            ? QCoreApplication::applicationDirPath() + "/pattern_weights.json"
+            : QString("pattern_weights.json");
+        if (!QFileInfo(path).exists()) {
+            return;
+        }
+    }
+    PatternWeights weights;
+    QString error;
+    if (weights.load(path, &error)) {
+        active_ = weights;
+    } else {
+        qWarning().noquote() << "棋型权重文件无效，使用默认权重：" << error;
+    }
+}
@@ -0,0 +1,99 @@
+#ifndef PATTERN_WEIGHTS_H
+#define PATTERN_WEIGHTS_H
+
+#include <QString>
+
+/**
+ * @brief 棋型评估（PatternEvaluator::checkLine）的权重
+ *
+ * 一个方向上的棋型按连子数、两端是否被堵、空位数分为11类，每类一个分数；
+ * 冲四、冲三、冲二中间有空位时再乘以间断系数gapNumerator / gapDenominator。
+ * 连五固定为FIVE_SCORE，不参与调整。默认值即最初手工设定的常数。
+ *
+ * 程序启动时调用loadStartupFile()读取调参工具（AIGomokuTool tune-weights）写出的权重文件，
+ * 之后所有棋型评估都使用这组权重，运行时没有额外开销。
+ *
+ * 权重文件为JSON对象，键为shapeName()给出的棋型名以及gapNumerator、gapDenominator，
+ * 缺少的键保留默认值：
+ * @code
+ * {"format": "gomoku-pattern-weights", "version": 1,
+ *  "deadFour": 3000, "openFour": 20000, ..., "gapNumerator": 2, "gapDenominator": 3}
+ * @endcode
+ */
+struct PatternWeights {
+    /**
+     * @brief 棋型
+     */
+    enum Shape {
+        DEAD_FOUR = 0,    ///< 死四（两端被堵）
+        DEAD_THREE,       ///< 死三
+        DEAD_TWO,         ///< 死二
+        DEAD_ONE,         ///< 两端被堵的单子
+        OPEN_FOUR,        ///< 活四（两侧都有空位）
+        HALF_FOUR,        ///< 冲四（只有一个空位）
+        OPEN_THREE,       ///< 活三
+        HALF_THREE,       ///< 冲三
+        OPEN_TWO,         ///< 活二
+        HALF_TWO,         ///< 冲二
+        OPEN_ONE,         ///< 单子
+        SHAPE_COUNT,
+        FIVE = SHAPE_COUNT  ///< 连五（固定分数）
+    };
+
+    static constexpr int FIVE_SCORE = 100000;  ///< 连五的分数
+    static constexpr int MAX_SCORE = 90000;    ///< 其他棋型分数的上限（评估时以此识别连五）
+
+    int values[SHAPE_COUNT] = {3000, 300, 30, 8, 20000, 8000, 3000, 800, 200, 50, 15};
+    int gapNumerator = 2;      ///< 间断系数分子
+    int gapDenominator = 3;    ///< 间断系数分母
+
+    /**
+     * @brief 棋型的分数
+     * @param gapped 是否有间断（只对冲四、冲三、冲二有效）
+     */
+    int score(int shape, bool gapped) const {
+        if (shape == FIVE) {
+            return FIVE_SCORE;
+        }
+        return gapped ? values[shape] * gapNumerator / gapDenominator : values[shape];
+    }
+
+    /**
+     * @brief 棋型在权重文件中的键名
+     */
+    static const char* shapeName(int shape);
+
+    /**
+     * @brief 从权重文件读取
+     * @return 文件无法读取、格式不对或分数超出范围时返回false，权重保持不变
+     */
+    bool load(const QString& filename, QString* error = nullptr);
+
+    /**
+     * @brief 写出权重文件
+     */
+    bool save(const QString& filename, QString* error = nullptr) const;
+
+    /**
+     * @brief 当前生效的权重
+     */
+    static const PatternWeights& active() { return active_; }
+
+    /**
+     * @brief 替换当前生效的权重（只应在没有搜索运行时调用，如启动时或工具开始前）
+     */
+    static void setActive(const PatternWeights& weights) { active_ = weights; }
+
+    /**
+     * @brief 启动时加载权重文件
+     *
+     * 路径取环境变量GOMOKU_WEIGHTS_FILE，未设置时为程序目录下的pattern_weights.json；
+     * 文件不存在时使用默认权重，存在但无法读取时输出警告并使用默认权重。
+     */
+    static void loadStartupFile();
+
+private:
+    static PatternWeights active_;
+};
+
+#endif // PATTERN_WEIGHTS_H
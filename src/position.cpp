@@ -0,0 +1,197 @@
+#include "position.h"
+#include <algorithm>
+#include <cstring>
+
+const int Position::DIRECTIONS[AXIS_COUNT][2] = {
+    {0, 1},   // 横向
+    {1, 0},   // 纵向
+    {1, 1},   // 主对角线
+    {1, -1}   // 副对角线
+};
+
+namespace {
+
+inline bool inside(int row, int col)
+{
+    return row >= 0 && row < Position::SIZE && col >= 0 && col < Position::SIZE;
+}
+
+} // namespace
+
+Position::Position()
+    : grid_(SIZE, std::vector<PieceType>(SIZE, PieceType::NONE))
+    , stones_(0)
+{
+    std::memset(runLength_, 0, sizeof(runLength_));
+}
+
+void Position::clear()
+{
+    for (auto& row : grid_) {
+        std::fill(row.begin(), row.end(), PieceType::NONE);
+    }
+    std::memset(runLength_, 0, sizeof(runLength_));
+    records_.clear();
+    stones_ = 0;
+}
+
+void Position::setBoardState(const std::vector<std::vector<PieceType>>& state)
+{
+    clear();
+    // 端点长度与落子顺序无关，按行扫描依次落子即可
+    for (int row = 0; row < SIZE; ++row) {
+        for (int col = 0; col < SIZE; ++col) {
+            if (state[row][col] != PieceType::NONE) {
+                placePiece(row, col, state[row][col]);
+            }
+        }
+    }
+    records_.clear();
+}
+
+int Position::lineLengthIfPlaced(int row, int col, PieceType piece, int axis) const
+{
+    const int dr = DIRECTIONS[axis][0];
+    const int dc = DIRECTIONS[axis][1];
+    int length = 1;
+    // 空位两侧的相邻同色棋子一定是所在连子段的端点
+    if (inside(row - dr, col - dc) && grid_[row - dr][col - dc] == piece) {
+        length += runLength_[axis][(row - dr) * SIZE + col - dc];
+    }
+    if (inside(row + dr, col + dc) && grid_[row + dr][col + dc] == piece) {
+        length += runLength_[axis][(row + dr) * SIZE + col + dc];
+    }
+    return length;
+}
+
+bool Position::makesFive(int row, int col, PieceType piece) const
+{
+    for (int axis = 0; axis < AXIS_COUNT; ++axis) {
+        if (lineLengthIfPlaced(row, col, piece, axis) >= 5) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Position::placePiece(int row, int col, PieceType piece)
+{
+    Record record;
+    record.cell = static_cast<uint8_t>(row * SIZE + col);
+    record.piece = piece;
+    record.wins = false;
+
+    for (int axis = 0; axis < AXIS_COUNT; ++axis) {
+        const int dr = DIRECTIONS[axis][0];
+        const int dc = DIRECTIONS[axis][1];
+        int left = 0;
+        int right = 0;
+        if (inside(row - dr, col - dc) && grid_[row - dr][col - dc] == piece) {
+            left = runLength_[axis][(row - dr) * SIZE + col - dc];
+        }
+        if (inside(row + dr, col + dc) && grid_[row + dr][col + dc] == piece) {
+            right = runLength_[axis][(row + dr) * SIZE + col + dc];
+        }
+        const int length = left + 1 + right;
+
+        // 合并后的连子段只需更新两个端点
+        runLength_[axis][(row - left * dr) * SIZE + col - left * dc] = static_cast<uint8_t>(length);
+        runLength_[axis][(row + right * dr) * SIZE + col + right * dc] = static_cast<uint8_t>(length);
+
+        record.left[axis] = static_cast<uint8_t>(left);
+        record.right[axis] = static_cast<uint8_t>(right);
+        record.wins = record.wins || length >= 5;
+    }
+
+    grid_[row][col] = piece;
+    ++stones_;
+    records_.push_back(record);
+    return record.wins;
+}
+
+void Position::removePiece(int row, int col)
+{
+    const PieceType piece = grid_[row][col];
+    if (piece == PieceType::NONE) {
+        return;
+    }
+
+    if (!records_.empty() && records_.back().cell == row * SIZE + col) {
+        // 撤销最后一步：落子前的两侧长度已记录
+        const Record& record = records_.back();
+        for (int axis = 0; axis < AXIS_COUNT; ++axis) {
+            restoreRuns(row, col, axis, record.left[axis], record.right[axis]);
+        }
+        records_.pop_back();
+    } else {
+        // 提走中间的棋子：重新数两侧连子；之后的落子记录不再可靠
+        for (int axis = 0; axis < AXIS_COUNT; ++axis) {
+            const int dr = DIRECTIONS[axis][0];
+            const int dc = DIRECTIONS[axis][1];
+            restoreRuns(row, col, axis, countRun(row, col, -dr, -dc, piece),
+                        countRun(row, col, dr, dc, piece));
+        }
+        records_.clear();
+    }
+
+    grid_[row][col] = PieceType::NONE;
+    --stones_;
+}
+
+Move Position::getLastMove() const
+{
+    if (records_.empty()) {
+        return Move();
+    }
+    const Record& record = records_.back();
+    return Move(record.cell / SIZE, record.cell % SIZE, record.piece);
+}
+
+bool Position::getWinLine(Segment& line) const
+{
+    if (!lastMoveWins()) {
+        return false;
+    }
+    const Record& record = records_.back();
+    const int row = record.cell / SIZE;
+    const int col = record.cell % SIZE;
+    for (int axis = 0; axis < AXIS_COUNT; ++axis) {
+        if (record.left[axis] + 1 + record.right[axis] >= 5) {
+            const int dr = DIRECTIONS[axis][0];
+            const int dc = DIRECTIONS[axis][1];
+            line.startRow = row - record.left[axis] * dr;
+            line.startCol = col - record.left[axis] * dc;
+            line.endRow = row + record.right[axis] * dr;
+            line.endCol = col + record.right[axis] * dc;
+            return true;
+        }
+    }
+    return false;
+}
+
+int Position::countRun(int row, int col, int dr, int dc, PieceType piece) const
+{
+    int count = 0;
+    int r = row + dr;
+    int c = col + dc;
+    while (inside(r, c) && grid_[r][c] == piece) {
+        ++count;
+        r += dr;
+        c += dc;
+    }
+    return count;
+}
+
+void Position::restoreRuns(int row, int col, int axis, int left, int right)
+{
+    const int dr = DIRECTIONS[axis][0];
+    const int dc = DIRECTIONS[axis][1];
+    if (left > 0) {
+        runLength_[axis][(row - dr) * SIZE + col - dc] = static_cast<uint8_t>(left);
+        runLength_[axis][(row - left * dr) * SIZE + col - left * dc] = static_cast<uint8_t>(left);
+    }
+    if (right > 0) {
+        runLength_[axis][(row + dr) * SIZE + col + dc] = static_cast<uint8_t>(right);
+        runLength_[axis][(row + right * dr) * SIZE + col + right * dc] = static_cast<uint8_t>(right);
+    }
+}
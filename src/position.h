@@ -0,0 +1,150 @@
+#ifndef POSITION_H
+#define POSITION_H
+
+#include <cstdint>
+#include <vector>
+#include "game_types.h"
+
+/**
+ * @brief 棋局局面（与界面无关）
+ *
+ * 保存棋盘状态，并在落子和提子时增量维护每条轴线上的连子长度：
+ * 每段连续同色棋子只在两个端点记录该段长度。落子时左右相邻的棋子
+ * 必然是各自连子段的端点，因此新连子长度 = 左段 + 1 + 右段，
+ * "这一步是否连五"是常数时间的查表，无需再逐格扫描。
+ *
+ * 界面（胜负判断和获胜连线）、AI搜索（终局判断）和无界面工具共用此类。
+ */
+class Position {
+public:
+    static constexpr int SIZE = 15;   ///< 棋盘大小
+    static constexpr int CELLS = SIZE * SIZE;
+
+    /**
+     * @brief 轴线编号，与LineKernel::Axis一致
+     */
+    enum Axis {
+        AXIS_HORIZONTAL = 0,     ///< 横向 (0, 1)
+        AXIS_VERTICAL = 1,       ///< 纵向 (1, 0)
+        AXIS_DIAGONAL = 2,       ///< 主对角线 (1, 1)
+        AXIS_ANTI_DIAGONAL = 3,  ///< 副对角线 (1, -1)
+        AXIS_COUNT = 4
+    };
+
+    /**
+     * @brief 连线端点（棋盘坐标）
+     */
+    struct Segment {
+        int startRow = -1;
+        int startCol = -1;
+        int endRow = -1;
+        int endCol = -1;
+    };
+
+    Position();
+
+    /**
+     * @brief 清空棋盘
+     */
+    void clear();
+
+    /**
+     * @brief 获取棋盘大小
+     */
+    int getSize() const { return SIZE; }
+
+    /**
+     * @brief 获取指定位置的棋子类型
+     */
+    PieceType getPiece(int row, int col) const { return grid_[row][col]; }
+
+    /**
+     * @brief 获取棋盘状态（供评估函数使用，不复制）
+     */
+    const std::vector<std::vector<PieceType>>& getBoardState() const { return grid_; }
+
+    /**
+     * @brief 设置棋盘状态，重建连子长度，清空落子记录
+     */
+    void setBoardState(const std::vector<std::vector<PieceType>>& state);
+
+    /**
+     * @brief 棋盘上的棋子数
+     */
+    int getStoneCount() const { return stones_; }
+
+    /**
+     * @brief 棋盘是否已满
+     */
+    bool isFull() const { return stones_ == CELLS; }
+
+    /**
+     * @brief 在空位落子
+     * @return 这一步是否形成五连（或更长）
+     */
+    bool placePiece(int row, int col, PieceType piece);
+
+    /**
+     * @brief 提走一枚棋子
+     *
+     * 提走最后一步落下的棋子时使用落子记录，常数时间完成；
+     * 提走其他棋子时沿四条轴线重新数出两侧连子，并丢弃落子记录。
+     */
+    void removePiece(int row, int col);
+
+    /**
+     * @brief 假设在空位(row, col)放上piece，该轴线上的连子长度
+     */
+    int lineLengthIfPlaced(int row, int col, PieceType piece, int axis) const;
+
+    /**
+     * @brief 在空位(row, col)放上piece是否形成五连
+     */
+    bool makesFive(int row, int col, PieceType piece) const;
+
+    /**
+     * @brief 最后一步落子是否形成五连
+     */
+    bool lastMoveWins() const { return !records_.empty() && records_.back().wins; }
+
+    /**
+     * @brief 获取最后一步落子（没有记录时返回无效着法）
+     */
+    Move getLastMove() const;
+
+    /**
+     * @brief 获取最后一步形成的五连端点
+     * @return 最后一步没有形成五连时返回false
+     */
+    bool getWinLine(Segment& line) const;
+
+    /**
+     * @brief 轴线方向 {dr, dc}
+     */
+    static const int DIRECTIONS[AXIS_COUNT][2];
+
+private:
+    /**
+     * @brief 落子记录，用于常数时间撤销
+     */
+    struct Record {
+        uint8_t cell;                 ///< 落子位置（行 * 15 + 列）
+        PieceType piece;              ///< 落子颜色
+        uint8_t left[AXIS_COUNT];     ///< 落子前反方向相邻的同色连子数
+        uint8_t right[AXIS_COUNT];    ///< 落子前正方向相邻的同色连子数
+        bool wins;                    ///< 是否形成五连
+    };
+
+    std::vector<std::vector<PieceType>> grid_;  ///< 棋盘状态
+    uint8_t runLength_[AXIS_COUNT][CELLS];      ///< 连子段端点处记录的段长度
+    std::vector<Record> records_;               ///< 落子记录
+    int stones_;                                ///< 棋子数
+
+    // 从(row, col)的相邻格开始，沿(dr, dc)数同色连子（逐格扫描，仅用于非末步提子）
+    int countRun(int row, int col, int dr, int dc, PieceType piece) const;
+
+    // 提子后把两侧连子段的端点长度恢复为left/right
+    void restoreRuns(int row, int col, int axis, int left, int right);
+};
+
+#endif // POSITION_H
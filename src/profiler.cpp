@@ -0,0 +1,183 @@
+#include "profiler.h"
+#include <QDebug>
+#include <QSaveFile>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Profiler {
+
+namespace {
+
+/**
+ * @brief 所有线程的缓冲区和时间戳的换算基准
+ */
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;  ///< 所有缓冲区（程序结束前不释放）
+    std::vector<ThreadBuffer*> idle;                     ///< 线程已退出、可复用的缓冲区
+    uint64_t originTicks = now();                        ///< 换算基准：时间戳
+    std::chrono::steady_clock::time_point originTime = std::chrono::steady_clock::now();
+};
+
+// 有意不析构：静态对象析构之后仍可能有线程退出
+Registry& registry()
+{
+    static Registry* instance = new Registry;
+    return *instance;
+}
+
+/**
+ * @brief 线程退出时把缓冲区交还给登记表
+ */
+struct Lease {
+    ThreadBuffer* buffer = nullptr;
+    ~Lease() {
+        if (buffer) {
+            Registry& r = registry();
+            std::lock_guard<std::mutex> lock(r.mutex);
+            r.idle.push_back(buffer);
+        }
+        threadBuffer = nullptr;
+    }
+};
+
+thread_local Lease lease;
+
+// 每微秒的时间戳数：用程序运行期间的TSC增量对照steady_clock
+double ticksPerMicrosecond(Registry& r)
+{
+    const auto minimum = std::chrono::milliseconds(10);
+    if (std::chrono::steady_clock::now() - r.originTime < minimum) {
+        std::this_thread::sleep_for(minimum);
+    }
+    const uint64_t ticks = now() - r.originTicks;
+    const auto elapsedUs = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - r.originTime).count();
+    return static_cast<double>(ticks) / static_cast<double>(elapsedUs);
+}
+
+// 区段名只做JSON必需的转义
+QByteArray jsonName(const char* name)
+{
+    QByteArray text;
+    for (const char* p = name; *p; ++p) {
+        if (*p == '"' || *p == '\\') {
+            text.append('\\');
+        }
+        text.append(*p);
+    }
+    return text;
+}
+
+} // namespace
+
+ThreadBuffer* attachThread()
+{
+    Registry& r = registry();
+    ThreadBuffer* buffer = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(r.mutex);
+        if (!r.idle.empty()) {
+            buffer = r.idle.back();
+            r.idle.pop_back();
+        } else {
+            r.buffers.push_back(std::make_unique<ThreadBuffer>(static_cast<int>(r.buffers.size()) + 1));
+            buffer = r.buffers.back().get();
+        }
+    }
+    lease.buffer = buffer;
+    threadBuffer = buffer;
+    return buffer;
+}
+
+void clear()
+{
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (const auto& buffer : r.buffers) {
+        buffer->clear();
+    }
+}
+
+bool writeChromeTrace(const QString& path, QString* error)
+{
+    if (!ENABLED) {
+        if (error) {
+            *error = "未启用计时（需要以GOMOKU_ENABLE_PROFILING=ON编译）";
+        }
+        return false;
+    }
+
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    const double scale = 1.0 / ticksPerMicrosecond(r);
+
+    // 以最早的区段为时间零点
+    uint64_t origin = std::numeric_limits<uint64_t>::max();
+    for (const auto& buffer : r.buffers) {
+        const uint32_t count = buffer->count();
+        const uint32_t first = count > ThreadBuffer::CAPACITY ? count - ThreadBuffer::CAPACITY : 0;
+        for (uint32_t i = first; i < count; ++i) {
+            origin = std::min(origin, buffer->at(i).begin);
+        }
+    }
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        if (error) {
+            *error = file.errorString();
+        }
+        return false;
+    }
+
+    // 分块写出，避免整份JSON留在内存中
+    QByteArray chunk = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    char line[128];
+    for (const auto& buffer : r.buffers) {
+        const uint32_t count = buffer->count();
+        const uint32_t begin = count > ThreadBuffer::CAPACITY ? count - ThreadBuffer::CAPACITY : 0;
+        for (uint32_t i = begin; i < count; ++i) {
+            const Event& event = buffer->at(i);
+            chunk += first ? "{\"name\":\"" : ",\n{\"name\":\"";
+            first = false;
+            chunk += jsonName(event.name);
+            std::snprintf(line, sizeof(line), "\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                          buffer->id(), (event.begin - origin) * scale, (event.end - event.begin) * scale);
+            chunk += line;
+            if (chunk.size() > (1 << 20)) {
+                file.write(chunk);
+                chunk.clear();
+            }
+        }
+    }
+    chunk += "\n]}\n";
+    file.write(chunk);
+    if (!file.commit()) {
+        if (error) {
+            *error = file.errorString();
+        }
+        return false;
+    }
+    return true;
+}
+
+void writeRequestedTrace()
+{
+    const QString path = qEnvironmentVariable("GOMOKU_TRACE_FILE");
+    if (path.isEmpty()) {
+        return;
+    }
+    QString error;
+    if (!writeChromeTrace(path, &error)) {
+        qWarning().noquote() << QString("无法导出计时记录 %1: %2").arg(path, error);
+    }
+}
+
+} // namespace Profiler
@@ -0,0 +1,153 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <QString>
+#include <atomic>
+#include <cstdint>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define GOMOKU_PROFILER_RDTSC 1
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define GOMOKU_PROFILER_RDTSC 1
+#else
+#include <chrono>
+#endif
+
+/**
+ * @brief 热点路径的分段计时
+ *
+ * 用PROFILE_ZONE("名称")标出一个作用域，离开作用域时把起止时间戳
+ * （x86上为TSC，其他平台为steady_clock纳秒）写入当前线程的环形缓冲区。
+ * 写入不加锁，只有线程第一次记录时登记缓冲区需要加锁；缓冲区满后覆盖最早的记录，
+ * 外层区段在内层之后写入，因此覆盖总是先丢掉最早的内层区段。
+ * 线程退出后缓冲区连同记录一起留给之后的新线程继续使用，线程反复创建也不会增加内存。
+ *
+ * 只有定义了GOMOKU_PROFILING（CMake选项GOMOKU_ENABLE_PROFILING）时PROFILE_ZONE才展开，
+ * 否则为空语句，不产生任何代码。writeChromeTrace导出Chrome trace / Perfetto可读的JSON，
+ * 应在被计时的线程空闲时调用（例如程序退出前）。
+ */
+namespace Profiler {
+
+#ifdef GOMOKU_PROFILING
+constexpr bool ENABLED = true;
+#else
+constexpr bool ENABLED = false;
+#endif
+
+/**
+ * @brief 一个已结束的区段
+ */
+struct Event {
+    const char* name;   ///< 区段名（字符串字面量）
+    uint64_t begin;     ///< 开始时间戳
+    uint64_t end;       ///< 结束时间戳
+};
+
+/**
+ * @brief 单个线程的环形缓冲区（只由所属线程写入）
+ */
+class ThreadBuffer {
+public:
+    static constexpr uint32_t CAPACITY = 1 << 18;  ///< 每个线程保留的区段数（2的幂，约6MB）
+
+    explicit ThreadBuffer(int id) : id_(id) {}
+
+    void record(const char* name, uint64_t begin, uint64_t end) {
+        const uint32_t count = count_.load(std::memory_order_relaxed);
+        events_[count & (CAPACITY - 1)] = Event{name, begin, end};
+        count_.store(count + 1, std::memory_order_release);
+    }
+
+    int id() const { return id_; }
+
+    /**
+     * @brief 累计写入的区段数（超过CAPACITY时只保留最后CAPACITY个）
+     */
+    uint32_t count() const { return count_.load(std::memory_order_acquire); }
+
+    const Event& at(uint32_t index) const { return events_[index & (CAPACITY - 1)]; }
+
+    void clear() { count_.store(0, std::memory_order_release); }
+
+private:
+    Event events_[CAPACITY];
+    std::atomic<uint32_t> count_{0};
+    int id_;
+};
+
+/**
+ * @brief 当前时间戳
+ */
+inline uint64_t now()
+{
+#if defined(GOMOKU_PROFILER_RDTSC)
+    return __rdtsc();
+#else
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+/**
+ * @brief 为当前线程取得缓冲区（优先复用已退出线程留下的）
+ */
+ThreadBuffer* attachThread();
+
+inline thread_local ThreadBuffer* threadBuffer = nullptr;  ///< 当前线程的缓冲区，首次记录时取得
+
+inline void record(const char* name, uint64_t begin, uint64_t end)
+{
+    ThreadBuffer* buffer = threadBuffer;
+    if (!buffer) {
+        buffer = attachThread();
+    }
+    buffer->record(name, begin, end);
+}
+
+/**
+ * @brief 作用域计时：构造时取开始时间，析构时写入一个区段
+ */
+class Zone {
+public:
+    explicit Zone(const char* name) : name_(name), begin_(now()) {}
+    ~Zone() { record(name_, begin_, now()); }
+
+    Zone(const Zone&) = delete;
+    Zone& operator=(const Zone&) = delete;
+
+private:
+    const char* name_;
+    uint64_t begin_;
+};
+
+/**
+ * @brief 清空所有线程已记录的区段
+ */
+void clear();
+
+/**
+ * @brief 导出为Chrome trace JSON（chrome://tracing、ui.perfetto.dev可直接打开）
+ * @param path 输出文件
+ * @param error 失败原因（可为nullptr）
+ * @return 未启用计时或无法写入时返回false
+ */
+bool writeChromeTrace(const QString& path, QString* error = nullptr);
+
+/**
+ * @brief 环境变量GOMOKU_TRACE_FILE非空时导出到该文件（程序退出前调用），失败时输出警告
+ */
+void writeRequestedTrace();
+
+} // namespace Profiler
+
+#ifdef GOMOKU_PROFILING
+#define GOMOKU_PROFILE_CONCAT_(a, b) a##b
+#define GOMOKU_PROFILE_CONCAT(a, b) GOMOKU_PROFILE_CONCAT_(a, b)
+#define PROFILE_ZONE(name) Profiler::Zone GOMOKU_PROFILE_CONCAT(profileZone_, __LINE__)(name)
+#else
+#define PROFILE_ZONE(name) ((void)0)
+#endif
+
+#endif // PROFILER_H
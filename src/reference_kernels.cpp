@@ -0,0 +1,301 @@
+#include "reference_kernels.h"
+#include <algorithm>
+#include <cstdlib>
+#include <utility>
+
+namespace ReferenceKernels {
+
+int astarCheckLine(const BoardState& boardState, int startRow, int startCol,
+                   int dRow, int dCol, PieceType player) {
+    int count = 1;
+    int empty = 0;
+    int size = boardState.size();
+    bool blocked = false;
+    bool hasGap = false;
+
+    // 向一个方向检查
+    for (int i = 1; i < 5; ++i) {
+        int newRow = startRow + dRow * i;
+        int newCol = startCol + dCol * i;
+
+        if (newRow < 0 || newRow >= size || newCol < 0 || newCol >= size) {
+            blocked = true;
+            break;
+        }
+
+        PieceType piece = boardState[newRow][newCol];
+        if (piece == player) {
+            if (empty > 0) hasGap = true;
+            count++;
+        } else if (piece == PieceType::NONE) {
+            if (empty == 0 && i <= 4) {
+                empty++;
+                continue;
+            }
+            break;
+        } else {
+            blocked = true;
+            break;
+        }
+    }
+
+    int backEmpty = 0;
+    bool backBlocked = false;
+
+    // 向相反方向检查
+    for (int i = 1; i < 5; ++i) {
+        int newRow = startRow - dRow * i;
+        int newCol = startCol - dCol * i;
+
+        if (newRow < 0 || newRow >= size || newCol < 0 || newCol >= size) {
+            backBlocked = true;
+            break;
+        }
+
+        PieceType piece = boardState[newRow][newCol];
+        if (piece == player) {
+            if (backEmpty > 0) hasGap = true;
+            count++;
+        } else if (piece == PieceType::NONE) {
+            if (backEmpty == 0 && i <= 4) {
+                backEmpty++;
+                continue;
+            }
+            break;
+        } else {
+            backBlocked = true;
+            break;
+        }
+    }
+
+    empty += backEmpty;
+    blocked = blocked && backBlocked;
+
+    // 根据连子数和空位数计算分数
+    if (count >= 5) return 100000;  // 胜利
+
+    // 基础分数
+    int baseScore;
+    if (blocked) {
+        if (count == 4) return 3000;  // 死四
+        if (count == 3) return 300;   // 死三
+        if (count == 2) return 30;    // 死二
+        baseScore = count * 8;
+    } else {
+        if (count == 4) {
+            if (empty >= 2) return 20000;  // 活四
+            baseScore = 8000;              // 单活四
+        } else if (count == 3) {
+            if (empty >= 2) return 3000;   // 活三
+            baseScore = 800;               // 单活三
+        } else if (count == 2) {
+            if (empty >= 2) return 200;    // 活二
+            baseScore = 50;                // 单活二
+        } else {
+            baseScore = count * 15;
+        }
+    }
+
+    // 有间断的情况分数降低
+    if (hasGap) {
+        baseScore = baseScore * 2 / 3;
+    }
+
+    return baseScore;
+}
+
+int astarPositionScore(const BoardState& rootState, int row, int col, PieceType player) {
+    int size = rootState.size();
+    int centerValue = size / 2;
+
+    // 使用曼哈顿距离计算到中心的距离
+    int distanceToCenter = std::abs(row - centerValue) + std::abs(col - centerValue);
+
+    // 基础分数：越靠近中心分数越高
+    int baseScore = 120 - (distanceToCenter * 8);
+
+    // 根据周围棋子情况调整分数
+    int neighborScore = 0;
+    const int searchRange = 2;
+
+    for (int dr = -searchRange; dr <= searchRange; ++dr) {
+        for (int dc = -searchRange; dc <= searchRange; ++dc) {
+            if (dr == 0 && dc == 0) continue;
+
+            int newRow = row + dr;
+            int newCol = col + dc;
+
+            if (newRow >= 0 && newRow < size && newCol >= 0 && newCol < size) {
+                PieceType piece = rootState[newRow][newCol];
+                if (piece != PieceType::NONE) {
+                    // 相邻位置的己方子分数高一些
+                    if (std::abs(dr) + std::abs(dc) == 1) {
+                        neighborScore += (piece == player) ? 15 : 10;
+                    }
+                    // 次相邻位置分数较低
+                    else if (std::abs(dr) + std::abs(dc) == 2) {
+                        neighborScore += (piece == player) ? 8 : 5;
+                    }
+                }
+            }
+        }
+    }
+
+    // 最终分数为基础分数和邻近分数的加权和
+    return std::max(0, baseScore + (neighborScore / 2));
+}
+
+int astarEvaluateBoard(const BoardState& rootState, const BoardState& boardState, PieceType currentPlayer) {
+    int score = 0;
+    int size = rootState.size();
+    const int directions[4][2] = {{1, 0}, {0, 1}, {1, 1}, {1, -1}};
+
+    // 评估所有位置
+    for (int i = 0; i < size; ++i) {
+        for (int j = 0; j < size; ++j) {
+            if (boardState[i][j] != PieceType::NONE) {
+                PieceType piece = boardState[i][j];
+                int multiplier = (piece == currentPlayer) ? 1 : -1;
+
+                // 连子价值
+                int lineScoreSum = 0;
+                for (const auto& dir : directions) {
+                    int lineScore = astarCheckLine(boardState, i, j, dir[0], dir[1], piece);
+                    // 如果发现必胜局面，立即返回
+                    if (lineScore >= 90000) {
+                        return multiplier * 100000;
+                    }
+                    lineScoreSum += lineScore;
+                }
+                score += multiplier * lineScoreSum;
+
+                // 位置价值（根据局势动态调整权重）
+                if (std::abs(lineScoreSum) < 2000) {
+                    int positionScore = astarPositionScore(rootState, i, j, piece);
+                    score += multiplier * positionScore;
+                }
+            }
+        }
+    }
+
+    return score;
+}
+
+int ruleCheckLine(const BoardState& boardState, int row, int col, int dRow, int dCol,
+                  PieceType currentPlayer) {
+    // 最初版本按15x15判断边界
+    auto isValidPosition = [](int r, int c) { return r >= 0 && r < 15 && c >= 0 && c < 15; };
+    int count = 1;  // 包含当前位置
+    int r, c;
+
+    // 向一个方向检查
+    r = row + dRow;
+    c = col + dCol;
+    while (isValidPosition(r, c) && boardState[r][c] == currentPlayer) {
+        count++;
+        r += dRow;
+        c += dCol;
+    }
+
+    // 向相反方向检查
+    r = row - dRow;
+    c = col - dCol;
+    while (isValidPosition(r, c) && boardState[r][c] == currentPlayer) {
+        count++;
+        r -= dRow;
+        c -= dCol;
+    }
+
+    return count;
+}
+
+int ruleEvaluatePosition(const BoardState& boardState, int row, int col, PieceType currentPlayer) {
+    int score = 0;
+
+    // 检查八个方向
+    const int directions[8][2] = {
+        {-1, -1}, {-1, 0}, {-1, 1}, {0, -1},
+        {0, 1}, {1, -1}, {1, 0}, {1, 1}
+    };
+
+    for (const auto& dir : directions) {
+        int count = ruleCheckLine(boardState, row, col, dir[0], dir[1], currentPlayer);
+
+        // 根据连子数量评分
+        switch (count) {
+            case 5: score += 100000; break;  // 胜利
+            case 4: score += 10000; break;   // 四子连珠
+            case 3: score += 1000; break;    // 三子连珠
+            case 2: score += 100; break;     // 两子连珠
+            case 1: score += 10; break;      // 单子
+        }
+    }
+
+    return score;
+}
+
+int ruleCellScore(const BoardState& boardState, int row, int col, PieceType currentPlayer, int difficulty) {
+    const int boardSize = boardState.size();
+    const int boardCenter = boardSize / 2;
+
+    int score = ruleEvaluatePosition(boardState, row, col, currentPlayer);
+
+    // 根据难度增加评估的复杂度
+    if (difficulty >= 2) {
+        // 考虑对手的威胁
+        score = std::max(score,
+            ruleEvaluatePosition(boardState, row, col,
+                currentPlayer == PieceType::BLACK ? PieceType::WHITE : PieceType::BLACK));
+    }
+
+    if (difficulty >= 3) {
+        // 考虑位置的战略价值
+        int centerDistance = abs(row - boardCenter) +
+                           abs(col - boardCenter);
+        score += (boardSize - centerDistance) * 2;
+    }
+
+    if (difficulty >= 4) {
+        // 考虑多方向的威胁
+        for (int dx = -1; dx <= 1; dx++) {
+            for (int dy = -1; dy <= 1; dy++) {
+                if (dx == 0 && dy == 0) continue;
+                score += ruleCheckLine(boardState, row, col, dx, dy, currentPlayer) * 10;
+            }
+        }
+    }
+    return score;
+}
+
+Move ruleBestMove(const BoardState& boardState, PieceType currentPlayer) {
+    const int boardSize = boardState.size();
+    std::vector<Move> emptyPositions;
+    for (int i = 0; i < boardSize; i++) {
+        for (int j = 0; j < boardSize; j++) {
+            if (boardState[i][j] == PieceType::NONE) {
+                emptyPositions.emplace_back(Move{i, j});
+            }
+        }
+    }
+    if (emptyPositions.empty()) {
+        return Move{-1, -1};
+    }
+
+    // 如果是第一步，选择靠近中心的位置
+    if (static_cast<int>(emptyPositions.size()) == boardSize * boardSize) {
+        int center = boardSize / 2;
+        return Move{center, center};
+    }
+
+    std::vector<std::pair<int, Move>> scoredMoves;
+    for (const auto& pos : emptyPositions) {
+        scoredMoves.emplace_back(ruleCellScore(boardState, pos.row, pos.col, currentPlayer, 5), pos);
+    }
+
+    // 根据分数排序
+    std::sort(scoredMoves.begin(), scoredMoves.end(),
+              [](const auto& a, const auto& b) { return a.first > b.first; });
+    return scoredMoves[0].second;
+}
+
+} // namespace ReferenceKernels
@@ -0,0 +1,60 @@
+#ifndef REFERENCE_KERNELS_H
+#define REFERENCE_KERNELS_H
+
+#include <vector>
+#include "game_types.h"
+
+/**
+ * @brief 冻结的参考实现，供对照测试（verify-kernels）使用
+ *
+ * 逐行保留最初版本中AStarAI::checkLine、AStarAI::evaluateBoard、
+ * RuleBasedAI::evaluatePosition及其调用方式，只把Board参数换成棋盘状态。
+ * 这些函数定义了引擎的预期行为，优化后的内核必须与之给出相同的结果；
+ * 不要为了速度或风格修改这里的代码。
+ */
+namespace ReferenceKernels {
+
+using BoardState = std::vector<std::vector<PieceType>>;
+
+/**
+ * @brief AStarAI::checkLine：一个方向上的棋型分数
+ */
+int astarCheckLine(const BoardState& boardState, int startRow, int startCol,
+                   int dRow, int dCol, PieceType player);
+
+/**
+ * @brief AStarAI::calculatePositionScore：位置价值（按根局面统计邻近棋子）
+ */
+int astarPositionScore(const BoardState& rootState, int row, int col, PieceType player);
+
+/**
+ * @brief AStarAI::evaluateBoard：整盘评估（currentPlayer视角）
+ * @param rootState 搜索开始时的局面（位置价值按它统计）
+ * @param boardState 待评估的局面
+ */
+int astarEvaluateBoard(const BoardState& rootState, const BoardState& boardState, PieceType currentPlayer);
+
+/**
+ * @brief RuleBasedAI::checkLine：假设(row, col)为己方时一个方向上的连子数
+ */
+int ruleCheckLine(const BoardState& boardState, int row, int col, int dRow, int dCol,
+                  PieceType currentPlayer);
+
+/**
+ * @brief RuleBasedAI::evaluatePosition：八个方向的连子数评分
+ */
+int ruleEvaluatePosition(const BoardState& boardState, int row, int col, PieceType currentPlayer);
+
+/**
+ * @brief RuleBasedAI::getNextMove中一个空位的综合评分
+ */
+int ruleCellScore(const BoardState& boardState, int row, int col, PieceType currentPlayer, int difficulty);
+
+/**
+ * @brief RuleBasedAI::getNextMove在难度5时的着法（无随机性）
+ */
+Move ruleBestMove(const BoardState& boardState, PieceType currentPlayer);
+
+} // namespace ReferenceKernels
+
+#endif // REFERENCE_KERNELS_H
@@ -1,4 +1,5 @@
 #include "rule_based_ai.h"
+#include "profiler.h"
 #include <algorithm>
 #include <random>
 #include <cstdlib>  // 为abs函数添加头文件
@@ -11,52 +12,37 @@ void RuleBasedAI::setDifficulty(int level) {
     difficulty = std::clamp(level, 1, 5);
 }
 
-Move RuleBasedAI::getNextMove(const Board& board, PieceType currentPlayer) {
-    auto emptyPositions = getEmptyPositions(board);
-    if (emptyPositions.empty()) {
+Move RuleBasedAI::getNextMove(const Position& position, PieceType currentPlayer) {
+    PROFILE_ZONE("RuleBased::getNextMove");
+    const int boardSize = position.getSize();
+    BitBoard stones;
+    for (int i = 0; i < boardSize; i++) {
+        for (int j = 0; j < boardSize; j++) {
+            stones.set(i, j, position.getPiece(i, j));
+        }
+    }
+
+    int scores[BitBoard::SIZE][BitBoard::SIZE];
+    int emptyCount = scoreBoard(stones, currentPlayer, scores);
+    if (emptyCount == 0) {
         return Move{-1, -1};
     }
 
     // 如果是第一步，选择靠近中心的位置
-    if (emptyPositions.size() == board.getSize() * board.getSize()) {
-        int center = board.getSize() / 2;
+    if (emptyCount == boardSize * boardSize) {
+        int center = boardSize / 2;
         return Move{center, center};
     }
 
-    // 根据难度级别评估不同的策略
+    // 按行优先顺序收集空位，保持与逐格评估相同的排序输入
     std::vector<std::pair<int, Move>> scoredMoves;
-    const int boardSize = board.getSize();
-    const int boardCenter = boardSize / 2;
-    
-    for (const auto& pos : emptyPositions) {
-        int score = evaluatePosition(board, pos.row, pos.col, currentPlayer);
-        
-        // 根据难度增加评估的复杂度
-        if (difficulty >= 2) {
-            // 考虑对手的威胁
-            score = std::max(score, 
-                evaluatePosition(board, pos.row, pos.col, 
-                    currentPlayer == PieceType::BLACK ? PieceType::WHITE : PieceType::BLACK));
-        }
-        
-        if (difficulty >= 3) {
-            // 考虑位置的战略价值
-            int centerDistance = abs(pos.row - boardCenter) + 
-                               abs(pos.col - boardCenter);
-            score += (boardSize - centerDistance) * 2;
-        }
-        
-        if (difficulty >= 4) {
-            // 考虑多方向的威胁
-            for (int dx = -1; dx <= 1; dx++) {
-                for (int dy = -1; dy <= 1; dy++) {
-                    if (dx == 0 && dy == 0) continue;
-                    score += checkLine(board, pos.row, pos.col, dx, dy, currentPlayer) * 10;
-                }
+    scoredMoves.reserve(emptyCount);
+    for (int i = 0; i < boardSize; i++) {
+        for (int j = 0; j < boardSize; j++) {
+            if (scores[i][j] >= 0) {
+                scoredMoves.emplace_back(scores[i][j], Move{i, j});
             }
         }
-        
-        scoredMoves.emplace_back(score, pos);
     }
 
     // 根据分数排序
@@ -78,70 +64,73 @@ Move RuleBasedAI::getNextMove(const Board& board, PieceType currentPlayer) {
     }
 }
 
-int RuleBasedAI::evaluatePosition(const Board& board, int row, int col, PieceType currentPlayer) {
-    int score = 0;
-    
-    // 检查八个方向
-    const int directions[8][2] = {
-        {-1, -1}, {-1, 0}, {-1, 1}, {0, -1},
-        {0, 1}, {1, -1}, {1, 0}, {1, 1}
-    };
-
-    for (const auto& dir : directions) {
-        int count = checkLine(board, row, col, dir[0], dir[1], currentPlayer);
-        
-        // 根据连子数量评分
-        switch (count) {
-            case 5: score += 100000; break;  // 胜利
-            case 4: score += 10000; break;   // 四子连珠
-            case 3: score += 1000; break;    // 三子连珠
-            case 2: score += 100; break;     // 两子连珠
-            case 1: score += 10; break;      // 单子
-        }
-    }
-    
-    return score;
-}
+int RuleBasedAI::scoreBoard(const BitBoard& stones, PieceType currentPlayer,
+                            int scores[BitBoard::SIZE][BitBoard::SIZE]) const {
+    PROFILE_ZONE("RuleBased::scoreBoard");
+    const int boardCenter = BitBoard::SIZE / 2;
+    const PieceType opponent =
+        currentPlayer == PieceType::BLACK ? PieceType::WHITE : PieceType::BLACK;
 
-int RuleBasedAI::checkLine(const Board& board, int row, int col, int dRow, int dCol,
-                          PieceType currentPlayer) {
-    int count = 1;  // 包含当前位置
-    int r, c;
-    
-    // 向一个方向检查
-    r = row + dRow;
-    c = col + dCol;
-    while (isValidPosition(r, c) && board.getPiece(r, c) == currentPlayer) {
-        count++;
-        r += dRow;
-        c += dCol;
+    // 一次内核调用得到所有格子四条轴线上的连子数
+    LineKernel::LineCounts own;
+    LineKernel::LineCounts other;
+    LineKernel::computeLineCounts(stones.plane(currentPlayer), own);
+    if (difficulty >= 2) {
+        LineKernel::computeLineCounts(stones.plane(opponent), other);
     }
-    
-    // 向相反方向检查
-    r = row - dRow;
-    c = col - dCol;
-    while (isValidPosition(r, c) && board.getPiece(r, c) == currentPlayer) {
-        count++;
-        r -= dRow;
-        c -= dCol;
-    }
-    
-    return count;
-}
 
-std::vector<Move> RuleBasedAI::getEmptyPositions(const Board& board) {
-    std::vector<Move> emptyPositions;
-    int size = board.getSize();
-    for (int i = 0; i < size; i++) {
-        for (int j = 0; j < size; j++) {
-            if (board.getPiece(i, j) == PieceType::NONE) {
-                emptyPositions.emplace_back(Move{i, j});
+    int emptyCount = 0;
+    for (int i = 0; i < BitBoard::SIZE; i++) {
+        for (int j = 0; j < BitBoard::SIZE; j++) {
+            if (!stones.isEmpty(i, j)) {
+                scores[i][j] = -1;
+                continue;
+            }
+            emptyCount++;
+
+            // 八个方向按四条轴线合并，每条轴线的正反方向连子数相同
+            int score = 0;
+            int lineSum = 0;
+            for (int axis = 0; axis < LineKernel::AXIS_COUNT; axis++) {
+                score += 2 * lineScore(own.count[axis][i][j]);
+                lineSum += own.count[axis][i][j];
+            }
+
+            // 根据难度增加评估的复杂度
+            if (difficulty >= 2) {
+                // 考虑对手的威胁
+                int defense = 0;
+                for (int axis = 0; axis < LineKernel::AXIS_COUNT; axis++) {
+                    defense += 2 * lineScore(other.count[axis][i][j]);
+                }
+                score = std::max(score, defense);
             }
+
+            if (difficulty >= 3) {
+                // 考虑位置的战略价值
+                int centerDistance = abs(i - boardCenter) + abs(j - boardCenter);
+                score += (BitBoard::SIZE - centerDistance) * 2;
+            }
+
+            if (difficulty >= 4) {
+                // 考虑多方向的威胁
+                score += 2 * lineSum * 10;
+            }
+
+            scores[i][j] = score;
         }
     }
-    return emptyPositions;
+    return emptyCount;
 }
 
-bool RuleBasedAI::isValidPosition(int row, int col) const {
-    return row >= 0 && row < 15 && col >= 0 && col < 15;  // 假设棋盘大小为15x15
-} 
\ No newline at end of file
+int RuleBasedAI::lineScore(int count) {
+    // 根据连子数量评分
+    switch (count) {
+        case 5: return 100000;  // 胜利
+        case 4: return 10000;   // 四子连珠
+        case 3: return 1000;    // 三子连珠
+        case 2: return 100;     // 两子连珠
+        case 1: return 10;      // 单子
+    }
+    return 0;
+}
\ No newline at end of file
@@ -2,29 +2,30 @@
 #define RULE_BASED_AI_H
 
 #include "ai_strategy.h"
-#include "board.h"
+#include "position.h"
+#include "line_kernel.h"
 
 class RuleBasedAI : public AIStrategy {
 public:
     RuleBasedAI();
     
     void setDifficulty(int level) override;
-    Move getNextMove(const Board& board, PieceType currentPlayer) override;
+    Move getNextMove(const Position& position, PieceType currentPlayer) override;
     QString getName() const override { return "RuleBased"; }
 
+    /**
+     * @brief 计算整盘评分图
+     * @param stones 棋盘位平面
+     * @param currentPlayer 当前玩家
+     * @param scores 输出：每个空位的评分，非空位置为-1
+     * @return 空位数量
+     */
+    int scoreBoard(const BitBoard& stones, PieceType currentPlayer,
+                   int scores[BitBoard::SIZE][BitBoard::SIZE]) const;
+
 private:
-    // 评估某个位置的分数
-    int evaluatePosition(const Board& board, int row, int col, PieceType currentPlayer);
-    
-    // 检查连子数量（横、竖、斜）
-    int checkLine(const Board& board, int row, int col, int dRow, int dCol,
-                 PieceType currentPlayer);
-    
-    // 获取空位置列表
-    std::vector<Move> getEmptyPositions(const Board& board);
-    
-    // 检查是否在边界内
-    bool isValidPosition(int row, int col) const;
+    // 根据某条轴线上的连子数评分（对应正反两个方向各计一次）
+    static int lineScore(int count);
 };
 
-#endif // RULE_BASED_AI_H 
\ No newline at end of file
+#endif // RULE_BASED_AI_H
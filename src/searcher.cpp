@@ -0,0 +1,521 @@
+#include "searcher.h"
+#include "pattern_evaluator.h"
+#include "profiler.h"
+#include "zobrist.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+constexpr int INF = std::numeric_limits<int>::max() / 2;
+constexpr uint64_t WHITE_TO_MOVE_KEY = 0x9E3779B97F4A7C15ULL;  ///< 轮到白方时异或到哈希上
+
+PieceType opponentOf(PieceType piece)
+{
+    return piece == PieceType::BLACK ? PieceType::WHITE : PieceType::BLACK;
+}
+
+int colorIndex(PieceType piece)
+{
+    return piece == PieceType::BLACK ? 0 : 1;
+}
+
+// 胜负分数在置换表中按"距本局面的步数"保存，读出时换算回距根节点的步数
+int scoreToTable(int score, int ply)
+{
+    if (score >= Searcher::WIN_THRESHOLD) return score + ply;
+    if (score <= -Searcher::WIN_THRESHOLD) return score - ply;
+    return score;
+}
+
+int scoreFromTable(int score, int ply)
+{
+    if (score >= Searcher::WIN_THRESHOLD) return score - ply;
+    if (score <= -Searcher::WIN_THRESHOLD) return score + ply;
+    return score;
+}
+
+} // namespace
+
+Searcher::Searcher(TranspositionTable& table)
+    : table_(table)
+    , evaluator_(std::make_unique<PatternEvaluator>())
+    , stop_(nullptr)
+    , key_(0)
+    , nodes_(0)
+    , maxNodes_(0)
+    , deadline_(std::chrono::steady_clock::time_point::max())
+    , aborted_(false)
+    , ply_(0)
+    , returning_(false)
+    , childScore_(0)
+    , rootToMove_(PieceType::BLACK)
+    , rootCount_(0)
+    , rootIndex_(0)
+    , rootAlpha_(0)
+    , lineTarget_(1)
+    , depth_(0)
+    , maxDepth_(0)
+    , finished_(true)
+    , callback_(nullptr)
+{
+    std::memset(near_, 0, sizeof(near_));
+    std::memset(killers_, 0xFF, sizeof(killers_));
+    std::memset(history_, 0, sizeof(history_));
+    std::memset(pvLength_, 0, sizeof(pvLength_));
+}
+
+bool Searcher::setEvaluator(const QString& name)
+{
+    auto evaluator = Evaluator::create(name);
+    if (!evaluator) {
+        return false;
+    }
+    evaluator_ = std::move(evaluator);
+    return true;
+}
+
+void Searcher::clearHistory()
+{
+    std::memset(history_, 0, sizeof(history_));
+}
+
+void Searcher::start(const Position& position, PieceType toMove, const Limits& limits)
+{
+    PROFILE_ZONE("Searcher::start");
+    startTime_ = std::chrono::steady_clock::now();
+    lineTarget_ = std::clamp(limits.multiPv, 1, MAX_LINES);
+    maxDepth_ = std::clamp(limits.maxDepth, 1, MAX_PLY - 1);
+
+    // 初始化单次搜索的状态；历史启发分数减半后沿用
+    position_ = position;
+    key_ = 0;
+    std::memset(near_, 0, sizeof(near_));
+    for (int cell = 0; cell < CELLS; ++cell) {
+        const PieceType piece = position_.getPiece(cell / Position::SIZE, cell % Position::SIZE);
+        if (piece != PieceType::NONE) {
+            key_ ^= Zobrist::key(piece, cell);
+            const int row = cell / Position::SIZE;
+            const int col = cell % Position::SIZE;
+            for (int r = std::max(0, row - 2); r <= std::min(Position::SIZE - 1, row + 2); ++r) {
+                for (int c = std::max(0, col - 2); c <= std::min(Position::SIZE - 1, col + 2); ++c) {
+                    ++near_[r * Position::SIZE + c];
+                }
+            }
+        }
+    }
+    std::memset(killers_, 0xFF, sizeof(killers_));
+    for (auto& color : history_) {
+        for (int& value : color) {
+            value /= 2;
+        }
+    }
+    evaluator_->reset(position_.getBoardState());
+    table_.newSearch();
+    nodes_ = 0;
+    maxNodes_ = limits.maxNodes;
+    deadline_ = limits.maxTimeMs > 0 ? startTime_ + std::chrono::milliseconds(limits.maxTimeMs)
+                                     : std::chrono::steady_clock::time_point::max();
+    aborted_ = false;
+    ply_ = 0;
+    returning_ = false;
+    childScore_ = 0;
+    rootToMove_ = toMove;
+    rootIndex_ = 0;
+    depth_ = 1;
+    current_ = Result();
+    current_.depth = 1;
+    result_ = Result();
+    best_ = Result();
+    finished_ = false;
+
+    rootCount_ = position_.lastMoveWins() || position_.isFull()
+        ? 0 : generateMoves(toMove, 0, -1, rootMoves_);
+    if (rootCount_ == 0) {
+        finish();
+        return;
+    }
+    std::fill(rootScores_, rootScores_ + rootCount_, -INF);
+    lineTarget_ = std::min(lineTarget_, rootCount_);
+}
+
+bool Searcher::step(long long maxNodes)
+{
+    PROFILE_ZONE("Searcher::step");
+    if (finished_) {
+        return true;
+    }
+    const long long sliceEnd = maxNodes > 0 ? nodes_ + maxNodes : std::numeric_limits<long long>::max();
+    for (;;) {
+        if (returning_) {
+            returnToParent();
+            if (finished_) {
+                return true;
+            }
+            continue;
+        }
+
+        if (ply_ > 0) {
+            Frame& frame = frames_[ply_];
+            if (frame.index == frame.count) {
+                // 所有候选搜完（或已截断），存入置换表后把分数交给上层
+                const TranspositionTable::Bound bound =
+                    frame.bestScore <= frame.originalAlpha ? TranspositionTable::BOUND_UPPER
+                    : frame.bestScore >= frame.beta ? TranspositionTable::BOUND_LOWER
+                    : TranspositionTable::BOUND_EXACT;
+                table_.store(frame.key, frame.depth, scoreToTable(frame.bestScore, ply_), bound, frame.bestMove);
+                childScore_ = frame.bestScore;
+                returning_ = true;
+                --ply_;
+                continue;
+            }
+            // 只在走下一步之前暂停，分片大小不影响搜索结果
+            if (nodes_ >= sliceEnd) {
+                return false;
+            }
+            const int cell = frame.moves[frame.index];
+            if (makeMove(cell, frame.toMove)) {
+                // 连五即终局，越早获胜分数越高
+                childScore_ = -(WIN_SCORE - ply_ - 1);
+                pvLength_[ply_ + 1] = 0;
+                returning_ = true;
+            } else {
+                int score;
+                if (enter(frame.depth - 1, -frame.beta, -frame.alpha, ply_ + 1, opponentOf(frame.toMove), score)) {
+                    childScore_ = score;
+                    returning_ = true;
+                }
+            }
+            continue;
+        }
+
+        // 根节点
+        if (rootIndex_ == rootCount_) {
+            if (finishIteration()) {
+                finish();
+                return true;
+            }
+            continue;
+        }
+        if (nodes_ >= sliceEnd) {
+            return false;
+        }
+        const int cell = rootMoves_[rootIndex_];
+        // 前N名已满时只需判断能否超过第N名
+        rootAlpha_ = current_.lineCount == lineTarget_ ? current_.lines[lineTarget_ - 1].score : -INF;
+        if (makeMove(cell, rootToMove_)) {
+            childScore_ = -(WIN_SCORE - 1);
+            pvLength_[1] = 0;
+            returning_ = true;
+        } else {
+            int score;
+            if (enter(depth_ - 1, -INF, -rootAlpha_, 1, opponentOf(rootToMove_), score)) {
+                childScore_ = score;
+                returning_ = true;
+            }
+        }
+    }
+}
+
+Searcher::Result Searcher::search(const Position& position, PieceType toMove, const Limits& limits,
+                                  const Callback& callback)
+{
+    PROFILE_ZONE("Searcher::search");
+    callback_ = callback ? &callback : nullptr;
+    start(position, toMove, limits);
+    while (!step(0)) {
+    }
+    callback_ = nullptr;
+    return best_;
+}
+
+bool Searcher::enter(int depth, int alpha, int beta, int ply, PieceType toMove, int& score)
+{
+    pvLength_[ply] = 0;
+    score = 0;
+    if (shouldStop()) {
+        return true;
+    }
+    ++nodes_;
+    if (position_.isFull()) {
+        return true;
+    }
+
+    // 置换表（之前搜索的条目只取着法，其分数按别的根局面评估）
+    const uint64_t key = toMove == PieceType::WHITE ? key_ ^ WHITE_TO_MOVE_KEY : key_;
+    int ttMove = -1;
+    TranspositionTable::Entry entry;
+    if (table_.probe(key, entry)) {
+        ttMove = entry.move == TranspositionTable::NO_MOVE ? -1 : entry.move;
+        if (entry.depth >= depth && table_.isCurrent(entry)) {
+            const int tableScore = scoreFromTable(entry.score, ply);
+            if (entry.bound == TranspositionTable::BOUND_EXACT ||
+                (entry.bound == TranspositionTable::BOUND_LOWER && tableScore >= beta) ||
+                (entry.bound == TranspositionTable::BOUND_UPPER && tableScore <= alpha)) {
+                score = tableScore;
+                return true;
+            }
+        }
+    }
+
+    if (depth <= 0) {
+        PROFILE_ZONE("Searcher::evaluate");
+        score = evaluator_->evaluate(position_.getBoardState(), toMove);
+        return true;
+    }
+
+    Frame& frame = frames_[ply];
+    frame.count = std::min(generateMoves(toMove, ply, ttMove, frame.moves), MAX_BRANCH);
+    if (frame.count == 0) {
+        score = evaluator_->evaluate(position_.getBoardState(), toMove);
+        return true;
+    }
+    frame.depth = depth;
+    frame.alpha = alpha;
+    frame.beta = beta;
+    frame.originalAlpha = alpha;
+    frame.bestScore = -INF;
+    frame.bestMove = -1;
+    frame.index = 0;
+    frame.key = key;
+    frame.toMove = toMove;
+    ply_ = ply;
+    return false;
+}
+
+void Searcher::returnToParent()
+{
+    returning_ = false;
+    const int score = -childScore_;
+    if (ply_ == 0) {
+        unmakeMove(rootMoves_[rootIndex_], rootToMove_);
+        if (aborted_) {
+            finish();
+            return;
+        }
+        finishRootMove(score);
+        return;
+    }
+
+    Frame& frame = frames_[ply_];
+    const int ply = ply_;
+    const int cell = frame.moves[frame.index];
+    unmakeMove(cell, frame.toMove);
+    if (aborted_) {
+        // 停止时放弃本节点，不存入置换表
+        childScore_ = 0;
+        returning_ = true;
+        --ply_;
+        return;
+    }
+
+    ++frame.index;
+    if (score > frame.bestScore) {
+        frame.bestScore = score;
+        frame.bestMove = cell;
+        if (score > frame.alpha) {
+            frame.alpha = score;
+            pv_[ply][0] = static_cast<uint8_t>(cell);
+            const int length = std::min(pvLength_[ply + 1], MAX_PLY - 1);
+            std::memcpy(pv_[ply] + 1, pv_[ply + 1], length);
+            pvLength_[ply] = length + 1;
+        }
+        if (frame.alpha >= frame.beta) {
+            // 引起截断的着法记入杀手表和历史表
+            if (killers_[ply][0] != cell) {
+                killers_[ply][1] = killers_[ply][0];
+                killers_[ply][0] = static_cast<uint8_t>(cell);
+            }
+            history_[colorIndex(frame.toMove)][cell] += frame.depth * frame.depth;
+            frame.index = frame.count;
+        }
+    }
+}
+
+void Searcher::finishRootMove(int score)
+{
+    const int cell = rootMoves_[rootIndex_];
+    rootScores_[rootIndex_] = score;
+    ++rootIndex_;
+    if (current_.lineCount == lineTarget_ && score <= rootAlpha_) {
+        return;
+    }
+
+    // 插入前N名
+    Line line;
+    line.score = score;
+    line.pv[0] = static_cast<uint8_t>(cell);
+    line.length = 1 + std::min(pvLength_[1], MAX_PLY - 1);
+    std::memcpy(line.pv + 1, pv_[1], line.length - 1);
+    int slot = std::min(current_.lineCount, lineTarget_ - 1);
+    while (slot > 0 && current_.lines[slot - 1].score < score) {
+        current_.lines[slot] = current_.lines[slot - 1];
+        --slot;
+    }
+    current_.lines[slot] = line;
+    current_.lineCount = std::min(current_.lineCount + 1, lineTarget_);
+
+    // 本层已经凑满N条主变后，每次名次变化都发给界面
+    if (depth_ > 1 && current_.lineCount == lineTarget_) {
+        publish(current_);
+    }
+}
+
+bool Searcher::finishIteration()
+{
+    result_ = current_;
+    const bool decided = std::all_of(result_.lines, result_.lines + result_.lineCount,
+                                     [](const Line& line) {
+                                         return std::abs(line.score) >= WIN_THRESHOLD;
+                                     });
+    if (decided || depth_ >= CELLS - position_.getStoneCount() || depth_ == maxDepth_) {
+        return true;
+    }
+    publish(result_);
+
+    // 下一层按本层分数排序根着法（插入排序：稳定且不分配内存）
+    for (int i = 1; i < rootCount_; ++i) {
+        const uint8_t move = rootMoves_[i];
+        const int score = rootScores_[i];
+        int j = i;
+        while (j > 0 && rootScores_[j - 1] < score) {
+            rootMoves_[j] = rootMoves_[j - 1];
+            rootScores_[j] = rootScores_[j - 1];
+            --j;
+        }
+        rootMoves_[j] = move;
+        rootScores_[j] = score;
+    }
+    ++depth_;
+    current_ = Result();
+    current_.depth = depth_;
+    rootIndex_ = 0;
+    return false;
+}
+
+void Searcher::finish()
+{
+    result_.finished = true;
+    finished_ = true;
+    publish(result_);
+}
+
+void Searcher::publish(const Result& result)
+{
+    best_ = result;
+    best_.nodes = nodes_;
+    best_.elapsedUs = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - startTime_).count();
+    best_.hashfull = table_.hashfull();
+    if (callback_) {
+        (*callback_)(best_);
+    }
+}
+
+int Searcher::generateMoves(PieceType toMove, int ply, int ttMove, uint8_t moves[CELLS]) const
+{
+    if (position_.getStoneCount() == 0) {
+        moves[0] = static_cast<uint8_t>(CELLS / 2);
+        return 1;
+    }
+
+    const PieceType opponent = opponentOf(toMove);
+    int count = 0;
+    int blocks = 0;
+    uint8_t blockMoves[CELLS];
+    for (int cell = 0; cell < CELLS; ++cell) {
+        if (near_[cell] == 0) {
+            continue;
+        }
+        const int row = cell / Position::SIZE;
+        const int col = cell % Position::SIZE;
+        if (position_.getPiece(row, col) != PieceType::NONE) {
+            continue;
+        }
+        // 能连五直接走，对手能连五必须堵
+        if (position_.makesFive(row, col, toMove)) {
+            moves[0] = static_cast<uint8_t>(cell);
+            return 1;
+        }
+        if (position_.makesFive(row, col, opponent)) {
+            blockMoves[blocks++] = static_cast<uint8_t>(cell);
+        }
+        moves[count++] = static_cast<uint8_t>(cell);
+    }
+    if (blocks > 0) {
+        std::memcpy(moves, blockMoves, blocks);
+        return blocks;
+    }
+
+    // 置换表着法 > 杀手着法 > 棋型权重（历史分数区分同权重的着法）
+    int keys[CELLS];
+    const int* history = history_[colorIndex(toMove)];
+    for (int i = 0; i < count; ++i) {
+        const int cell = moves[i];
+        int key;
+        if (cell == ttMove) {
+            key = 1 << 30;
+        } else if (ply < MAX_PLY && (cell == killers_[ply][0] || cell == killers_[ply][1])) {
+            key = (1 << 28) + (cell == killers_[ply][0]);
+        } else {
+            key = ((moveWeight(cell, toMove) + moveWeight(cell, opponent)) << 12) +
+                  std::min(history[cell], 4095);
+        }
+        keys[cell] = key;
+    }
+    std::sort(moves, moves + count, [&](uint8_t a, uint8_t b) { return keys[a] > keys[b]; });
+    return count;
+}
+
+int Searcher::moveWeight(int cell, PieceType piece) const
+{
+    static const int WEIGHTS[] = {0, 1, 10, 100, 1000, 1000};
+    const int row = cell / Position::SIZE;
+    const int col = cell % Position::SIZE;
+    int weight = 0;
+    for (int axis = 0; axis < Position::AXIS_COUNT; ++axis) {
+        weight += WEIGHTS[std::min(position_.lineLengthIfPlaced(row, col, piece, axis), 5)];
+    }
+    return weight;
+}
+
+bool Searcher::makeMove(int cell, PieceType piece)
+{
+    const int row = cell / Position::SIZE;
+    const int col = cell % Position::SIZE;
+    const bool wins = position_.placePiece(row, col, piece);
+    key_ ^= Zobrist::key(piece, cell);
+    for (int r = std::max(0, row - 2); r <= std::min(Position::SIZE - 1, row + 2); ++r) {
+        for (int c = std::max(0, col - 2); c <= std::min(Position::SIZE - 1, col + 2); ++c) {
+            ++near_[r * Position::SIZE + c];
+        }
+    }
+    evaluator_->makeMove(row, col, piece);
+    return wins;
+}
+
+void Searcher::unmakeMove(int cell, PieceType piece)
+{
+    const int row = cell / Position::SIZE;
+    const int col = cell % Position::SIZE;
+    evaluator_->unmakeMove(row, col, piece);
+    for (int r = std::max(0, row - 2); r <= std::min(Position::SIZE - 1, row + 2); ++r) {
+        for (int c = std::max(0, col - 2); c <= std::min(Position::SIZE - 1, col + 2); ++c) {
+            --near_[r * Position::SIZE + c];
+        }
+    }
+    key_ ^= Zobrist::key(piece, cell);
+    position_.removePiece(row, col);
+}
+
+bool Searcher::shouldStop()
+{
+    if ((nodes_ & 1023) == 0 && !aborted_) {
+        aborted_ = (stop_ && stop_->load(std::memory_order_relaxed)) ||
+                   (maxNodes_ > 0 && nodes_ >= maxNodes_) ||
+                   std::chrono::steady_clock::now() >= deadline_;
+    }
+    return aborted_;
+}
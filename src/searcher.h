@@ -0,0 +1,239 @@
+#ifndef SEARCHER_H
+#define SEARCHER_H
+
+#include <QString>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include "evaluator.h"
+#include "game_types.h"
+#include "position.h"
+#include "transposition_table.h"
+
+/**
+ * @brief 多主变的迭代加深Alpha-Beta搜索
+ *
+ * 负极大值框架，逐层加深直到达到深度或节点上限、或者停止标志被置位。
+ * 根节点同时保留得分最高的multiPv个着法及其主变：每个根着法以当前第N名的
+ * 分数作为alpha搜索，超过时插入前N名。置换表由调用方持有，
+ * 同一个表可以在多次搜索之间复用（局面变化后重新开始时命中之前的结果）。
+ *
+ * 结果都是定长结构，可以直接放进无锁队列传给界面线程。
+ *
+ * 搜索用显式的帧栈而不是递归实现，可以分片执行：start()设好根局面后，每次step(maxNodes)
+ * 最多再搜约maxNodes个节点就返回，中间状态都留在对象里，下次调用接着搜；bestSoFar()随时
+ * 取到已发布的最好结果。这样界面线程的定时器或服务端的线程池可以轮流推进许多局的搜索，
+ * 不必为每局占一个线程。只在走下一步之前检查分片是否用完，所以不限时的搜索结果与怎样分片无关。
+ * search()即一次走完的step，搜索过程中按回调发布结果。
+ */
+class Searcher {
+public:
+    static constexpr int MAX_PLY = 48;          ///< 最大搜索深度（主变最大长度）
+    static constexpr int MAX_LINES = 8;         ///< 最多同时保留的主变数
+    static constexpr int WIN_SCORE = 1000000;   ///< 连五的分数（减去步数）
+    static constexpr int WIN_THRESHOLD = WIN_SCORE - 1000;  ///< 高于此值视为必胜
+
+    /**
+     * @brief 一条主变
+     */
+    struct Line {
+        int score = 0;                 ///< 分数（根节点轮到的一方视角）
+        int length = 0;                ///< 主变长度
+        uint8_t pv[MAX_PLY] = {};      ///< 主变着法（行 * 15 + 列）
+
+        Move move() const { return length > 0 ? Move(pv[0] / Position::SIZE, pv[0] % Position::SIZE) : Move(); }
+    };
+
+    /**
+     * @brief 搜索结果（按分数从高到低排列的前lineCount条主变）
+     */
+    struct Result {
+        int depth = 0;               ///< 深度（本层凑满主变后，名次变化时提前发出）
+        int lineCount = 0;           ///< 主变数
+        Line lines[MAX_LINES];       ///< 主变
+        long long nodes = 0;         ///< 节点数
+        long long elapsedUs = 0;     ///< 用时（微秒）
+        int hashfull = 0;            ///< 置换表占用率（千分比）
+        bool finished = false;       ///< 搜索已结束（达到上限或局面已分胜负）
+    };
+
+    /**
+     * @brief 搜索限制
+     */
+    struct Limits {
+        int maxDepth = MAX_PLY;      ///< 最大深度
+        long long maxNodes = 0;      ///< 节点上限，0表示不限
+        int maxTimeMs = 0;           ///< 用时上限（毫秒），0表示不限
+        int multiPv = 1;             ///< 保留的主变数
+    };
+
+    /**
+     * @brief 每完成一条主变或一层深度时调用
+     */
+    using Callback = std::function<void(const Result&)>;
+
+    /**
+     * @param table 置换表（调用方持有，生命周期长于Searcher）
+     */
+    explicit Searcher(TranspositionTable& table);
+
+    /**
+     * @brief 设置评估函数（"Pattern"/"NNUE"）
+     * @return 加载失败时返回false并保持原评估函数
+     */
+    bool setEvaluator(const QString& name);
+
+    /**
+     * @brief 当前评估函数名称
+     */
+    QString getEvaluatorName() const { return evaluator_->getName(); }
+
+    /**
+     * @brief 设置停止标志，搜索每1024个节点检查一次
+     */
+    void setStopFlag(const std::atomic<bool>* stop) { stop_ = stop; }
+
+    /**
+     * @brief 清空历史启发分数
+     *
+     * 历史分数默认减半后带到下一次搜索；需要每次搜索的结果与之前搜过什么无关时
+     * （如批量评估互不相关的局面），在搜索前调用并清空置换表。
+     */
+    void clearHistory();
+
+    /**
+     * @brief 开始分步搜索：设好根局面和限制，之后用step()推进
+     *
+     * 用时上限从调用start()时算起（包括两次step之间的时间）。
+     * 局面已分胜负或下满时直接结束，isFinished()为true。
+     */
+    void start(const Position& position, PieceType toMove, const Limits& limits);
+
+    /**
+     * @brief 推进搜索
+     * @param maxNodes 本次最多再搜的节点数（到达后在下一步之前暂停），0表示一直搜到结束
+     * @return 搜索已结束（达到限制、停止标志被置位或局面已分胜负）
+     */
+    bool step(long long maxNodes);
+
+    /**
+     * @brief 搜索是否已结束
+     */
+    bool isFinished() const { return finished_; }
+
+    /**
+     * @brief 最近一次发布的结果（每完成一层或本层名次变化时更新；第一层完成前lineCount为0）
+     */
+    const Result& bestSoFar() const { return best_; }
+
+    /**
+     * @brief 本次搜索到目前为止的节点数
+     */
+    long long nodes() const { return nodes_; }
+
+    /**
+     * @brief 搜索局面（start后一直step到结束）
+     * @param position 根局面
+     * @param toMove 轮到的一方
+     * @param limits 搜索限制
+     * @param callback 进度回调，可以为空
+     * @return 最后一次回调的结果
+     */
+    Result search(const Position& position, PieceType toMove, const Limits& limits,
+                  const Callback& callback = Callback());
+
+private:
+    static constexpr int MAX_BRANCH = 20;  ///< 内部节点最多搜索的候选数
+    static constexpr int CELLS = Position::CELLS;
+
+    /**
+     * @brief 搜索栈上一个内部节点的状态（下标为距根的步数）
+     */
+    struct Frame {
+        int depth;
+        int alpha;
+        int beta;
+        int originalAlpha;
+        int bestScore;
+        int bestMove;
+        int count;                        ///< 候选数
+        int index;                        ///< 正在搜索的候选
+        uint64_t key;
+        PieceType toMove;
+        uint8_t moves[CELLS];             ///< 候选着法（前count个有效）
+    };
+
+    TranspositionTable& table_;
+    std::unique_ptr<Evaluator> evaluator_;
+    const std::atomic<bool>* stop_;
+
+    // 以下为单次搜索的状态
+    Position position_;
+    uint64_t key_;                        ///< 当前局面的Zobrist哈希
+    uint8_t near_[CELLS];                 ///< 2格以内的棋子数（>0的空位为候选）
+    uint8_t killers_[MAX_PLY][2];         ///< 每层引起截断的着法
+    int history_[2][CELLS];               ///< 历史启发分数（按颜色）
+    uint8_t pv_[MAX_PLY][MAX_PLY];        ///< 三角主变表
+    int pvLength_[MAX_PLY];
+    long long nodes_;
+    long long maxNodes_;
+    std::chrono::steady_clock::time_point deadline_;  ///< 用时上限，未设置时为time_point::max()
+    bool aborted_;
+
+    // 以下为分步搜索的状态
+    Frame frames_[MAX_PLY];
+    int ply_;                             ///< 栈顶节点距根的步数，0表示在根节点
+    bool returning_;                      ///< 刚得出ply_ + 1层节点的分数，等待上层处理
+    int childScore_;                      ///< 该分数（子节点轮到的一方视角）
+    PieceType rootToMove_;
+    uint8_t rootMoves_[CELLS];
+    int rootScores_[CELLS];               ///< 根着法上一层的分数（用于排序）
+    int rootCount_;
+    int rootIndex_;                       ///< 正在搜索的根着法
+    int rootAlpha_;                       ///< 该根着法搜索时的alpha（第N名的分数）
+    int lineTarget_;                      ///< 要保留的主变数
+    int depth_;                           ///< 当前迭代深度
+    int maxDepth_;
+    Result current_;                      ///< 本层的前N名
+    Result result_;                       ///< 上一层完成时的结果
+    Result best_;                         ///< 最近一次发布的结果
+    bool finished_;
+    std::chrono::steady_clock::time_point startTime_;
+    const Callback* callback_;            ///< search()的回调，分步搜索时为空
+
+    // 进入ply层的节点：能直接得出分数（停止、置换表截断、叶节点）时写入score并返回true，
+    // 否则压入一帧由step()逐个搜索候选
+    bool enter(int depth, int alpha, int beta, int ply, PieceType toMove, int& score);
+
+    // 处理刚搜完的子节点分数（childScore_）：撤销着法、更新最佳着法和主变
+    void returnToParent();
+
+    // 一个根着法搜索完毕，插入前N名
+    void finishRootMove(int score);
+
+    // 一层搜索完毕：返回true表示整个搜索结束，否则排序根着法开始下一层
+    bool finishIteration();
+
+    // 结束搜索并发布最终结果
+    void finish();
+
+    // 填写节点数、用时等统计，记为最近一次发布的结果并调用回调
+    void publish(const Result& result);
+
+    // 生成并排序候选着法，返回数量；一方能连五时只返回该着法或必须防守的点
+    int generateMoves(PieceType toMove, int ply, int ttMove, uint8_t moves[CELLS]) const;
+
+    // 落子/提子并维护哈希、候选和评估函数
+    bool makeMove(int cell, PieceType piece);
+    void unmakeMove(int cell, PieceType piece);
+
+    // 每1024个节点检查一次停止条件（停止标志、节点上限、用时上限）
+    bool shouldStop();
+
+    // 着法对一方的棋型权重（连子越长越高）
+    int moveWeight(int cell, PieceType piece) const;
+};
+
+#endif // SEARCHER_H
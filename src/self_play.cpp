@@ -0,0 +1,200 @@
+#include "self_play.h"
+#include "batch_evaluator.h"
+#include "position.h"
+#include "searcher.h"
+#include "training_data.h"
+#include "transposition_table.h"
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <random>
+#include <thread>
+
+namespace {
+
+PieceType opponentOf(PieceType piece)
+{
+    return piece == PieceType::BLACK ? PieceType::WHITE : PieceType::BLACK;
+}
+
+/**
+ * @brief 随机着法：空盘时在天元3x3范围内，否则在上一步5x5范围内（都满时取任一空位）
+ */
+int randomNearMove(const Position& position, std::mt19937& rng)
+{
+    const int center = Position::SIZE / 2;
+    const Move last = position.getStoneCount() > 0 ? position.getLastMove() : Move(center, center);
+    const int radius = position.getStoneCount() > 0 ? 2 : 1;
+    for (int attempt = 0; attempt < 64; ++attempt) {
+        const int row = std::clamp(last.row + static_cast<int>(rng() % (2 * radius + 1)) - radius, 0, Position::SIZE - 1);
+        const int col = std::clamp(last.col + static_cast<int>(rng() % (2 * radius + 1)) - radius, 0, Position::SIZE - 1);
+        if (position.getPiece(row, col) == PieceType::NONE) {
+            return row * Position::SIZE + col;
+        }
+    }
+    for (int cell = 0; cell < Position::CELLS; ++cell) {
+        if (position.getPiece(cell / Position::SIZE, cell % Position::SIZE) == PieceType::NONE) {
+            return cell;
+        }
+    }
+    return -1;
+}
+
+} // namespace
+
+/**
+ * @brief 一个线程的对局状态，构造后在各局之间复用
+ */
+struct SelfPlayGenerator::Worker {
+    explicit Worker(size_t tableMB) : table(tableMB), searcher(table) {}
+
+    TranspositionTable table;
+    Searcher searcher;
+    Position position;
+    std::vector<TrainingSample> game;     ///< 当前对局的样本
+    std::vector<TrainingSample> pending;  ///< 攒着还没写出的样本
+};
+
+SelfPlayGenerator::SelfPlayGenerator(const Options& options)
+    : options_(options)
+    , stop_(false)
+{
+    int threads = options.threads;
+    if (threads <= 0) {
+        threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    }
+    for (int i = 0; i < threads; ++i) {
+        auto worker = std::make_unique<Worker>(static_cast<size_t>(std::max(1, options.tableMB)));
+        if (!worker->searcher.setEvaluator(options.evaluator)) {
+            error_ = QString("无法创建评估函数 %1").arg(options.evaluator);
+            workers_.clear();
+            return;
+        }
+        worker->game.reserve(Position::CELLS);
+        worker->pending.reserve(options.chunkSamples + Position::CELLS);
+        workers_.push_back(std::move(worker));
+    }
+}
+
+SelfPlayGenerator::~SelfPlayGenerator() = default;
+
+SelfPlayGenerator::Stats SelfPlayGenerator::run(long long games, TrainingDataWriter& writer,
+                                                const Progress& progress)
+{
+    Stats stats;
+    if (games <= 0 || workers_.empty()) {
+        return stats;
+    }
+    stop_.store(false, std::memory_order_relaxed);
+    const auto startTime = std::chrono::steady_clock::now();
+    std::atomic<long long> next(0);
+    std::mutex mutex;
+    bool failed = false;
+
+    Searcher::Limits limits;
+    limits.maxDepth = std::max(1, options_.depth);
+    limits.maxNodes = options_.maxNodes;
+    limits.maxTimeMs = options_.moveTimeMs;
+    const int maxPlies = std::clamp(options_.maxPlies, 1, static_cast<int>(Position::CELLS));
+
+    // 把攒着的样本压缩后写出；压缩在本线程上做，只有写入加锁
+    auto writePending = [&](Worker& worker) {
+        if (worker.pending.empty()) {
+            return;
+        }
+        const QByteArray chunk = TrainingDataFormat::encodeChunk(worker.pending.data(), worker.pending.size());
+        std::lock_guard<std::mutex> lock(mutex);
+        failed = failed || !writer.writeChunk(chunk, worker.pending.size());
+        worker.pending.clear();
+    };
+
+    auto playGame = [&](Worker& worker, long long gameIndex) {
+        // 开局只取决于种子和对局编号
+        std::seed_seq seeds{options_.seed, static_cast<uint32_t>(gameIndex), static_cast<uint32_t>(gameIndex >> 32)};
+        std::mt19937 rng(seeds);
+        Position& position = worker.position;
+        position.clear();
+        worker.table.clear();
+        worker.searcher.clearHistory();
+        worker.game.clear();
+
+        PieceType toMove = PieceType::BLACK;
+        PieceType winner = PieceType::NONE;
+        long long nodes = 0;
+        for (int ply = 0; ply < maxPlies && winner == PieceType::NONE && !position.isFull(); ++ply) {
+            int cell = -1;
+            if (ply >= options_.randomPlies) {
+                const Searcher::Result result = worker.searcher.search(position, toMove, limits);
+                nodes += result.nodes;
+                if (result.lineCount > 0) {
+                    TrainingSample sample;
+                    sample.position = PackedPosition::pack(position, toMove);
+                    sample.score = result.lines[0].score;
+                    sample.bestMove = result.lines[0].pv[0];
+                    sample.depth = static_cast<uint8_t>(result.depth);
+                    worker.game.push_back(sample);
+                    cell = sample.bestMove;
+                }
+            }
+            // 随机开局，或节点/时间上限在第一层内就用完
+            if (cell < 0) {
+                cell = randomNearMove(position, rng);
+            }
+            if (position.placePiece(cell / Position::SIZE, cell % Position::SIZE, toMove)) {
+                winner = toMove;
+            }
+            toMove = opponentOf(toMove);
+        }
+
+        for (TrainingSample& sample : worker.game) {
+            sample.result = static_cast<int8_t>(winner == PieceType::NONE ? 0
+                                                : sample.position.sideToMove() == winner ? 1 : -1);
+        }
+        worker.pending.insert(worker.pending.end(), worker.game.begin(), worker.game.end());
+
+        std::lock_guard<std::mutex> lock(mutex);
+        ++stats.games;
+        stats.positions += static_cast<long long>(worker.game.size());
+        stats.nodes += nodes;
+        stats.blackWins += winner == PieceType::BLACK ? 1 : 0;
+        stats.whiteWins += winner == PieceType::WHITE ? 1 : 0;
+        stats.draws += winner == PieceType::NONE ? 1 : 0;
+        stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+        if (progress) {
+            progress(stats);
+        }
+    };
+
+    auto work = [&](Worker& worker) {
+        for (;;) {
+            const long long index = next.fetch_add(1, std::memory_order_relaxed);
+            if (index >= games || stop_.load(std::memory_order_relaxed)) {
+                break;
+            }
+            playGame(worker, index);
+            if (worker.pending.size() >= options_.chunkSamples) {
+                writePending(worker);
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            if (failed) {
+                stop_.store(true, std::memory_order_relaxed);
+            }
+        }
+        writePending(worker);
+    };
+
+    const size_t threads = static_cast<size_t>(std::min<long long>(static_cast<long long>(workers_.size()), games));
+    std::vector<std::thread> pool;
+    pool.reserve(threads - 1);
+    for (size_t t = 1; t < threads; ++t) {
+        pool.emplace_back(work, std::ref(*workers_[t]));
+    }
+    work(*workers_[0]);
+    for (auto& thread : pool) {
+        thread.join();
+    }
+
+    stats.threads = static_cast<int>(threads);
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    return stats;
+}
@@ -0,0 +1,96 @@
+#ifndef SELF_PLAY_H
+#define SELF_PLAY_H
+
+#include <QString>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+class TrainingDataWriter;
+
+/**
+ * @brief 自我对弈训练数据生成
+ *
+ * 多个线程各自下完整的对局：先按对局编号的随机数下若干步随机开局（天元附近起手，
+ * 之后每步落在上一步5x5范围内），之后双方都用Searcher按给定深度/节点数/时限搜索落子。
+ * 每个搜索过的局面记录为一个TrainingSample（分数、最佳着法、深度），对局结束后补上
+ * 以各局面轮到一方为视角的胜负。
+ *
+ * 每个线程有自己的置换表和搜索器，每局开始前清空，开局随机数只取决于种子和对局编号，
+ * 所以不限时的生成结果与线程数无关（块的先后顺序除外）。线程攒够一块样本后自己压缩，
+ * 只在写入文件时加锁；同一局的样本总在同一块中。
+ */
+class SelfPlayGenerator {
+public:
+    /**
+     * @brief 生成参数
+     */
+    struct Options {
+        QString evaluator = "Pattern";  ///< 评估函数名称
+        int depth = 4;                  ///< 每步搜索深度
+        long long maxNodes = 0;         ///< 每步节点上限，0表示不限
+        int moveTimeMs = 0;             ///< 每步用时上限（毫秒），0表示不限
+        int tableMB = 16;               ///< 每个线程的置换表大小（MB）
+        int threads = 0;                ///< 线程数，0表示使用硬件并发数
+        int randomPlies = 6;            ///< 随机开局的步数
+        int maxPlies = 225;             ///< 每局最多步数（含开局），到达时判和
+        uint32_t seed = 1;              ///< 随机开局的种子
+        size_t chunkSamples = 4096;     ///< 每块至少攒多少个样本再压缩写入
+    };
+
+    /**
+     * @brief 生成统计
+     */
+    struct Stats {
+        long long games = 0;       ///< 完成的对局数
+        long long positions = 0;   ///< 写出的样本数
+        long long nodes = 0;       ///< 搜索节点数
+        long long blackWins = 0;
+        long long whiteWins = 0;
+        long long draws = 0;
+        double seconds = 0.0;      ///< 用时
+        int threads = 0;           ///< 线程数
+    };
+
+    /**
+     * @brief 每完成一局时调用（在生成线程上，已加锁，不会并发调用）
+     */
+    using Progress = std::function<void(const Stats&)>;
+
+    explicit SelfPlayGenerator(const Options& options);
+    ~SelfPlayGenerator();
+
+    SelfPlayGenerator(const SelfPlayGenerator&) = delete;
+    SelfPlayGenerator& operator=(const SelfPlayGenerator&) = delete;
+
+    /**
+     * @brief 评估函数是否创建成功
+     */
+    bool isValid() const { return error_.isEmpty(); }
+
+    QString errorString() const { return error_; }
+
+    int threadCount() const { return static_cast<int>(workers_.size()); }
+
+    /**
+     * @brief 下games局，样本写入writer（写入失败时提前结束）
+     */
+    Stats run(long long games, TrainingDataWriter& writer, const Progress& progress = Progress());
+
+    /**
+     * @brief 请求停止：正在下的对局下完后结束（可在其他线程调用）
+     */
+    void stop() { stop_.store(true, std::memory_order_relaxed); }
+
+private:
+    struct Worker;
+
+    Options options_;
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::atomic<bool> stop_;
+    QString error_;
+};
+
+#endif // SELF_PLAY_H
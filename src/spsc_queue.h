@@ -0,0 +1,66 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+
+/**
+ * @brief 无锁单生产者单消费者环形队列
+ *
+ * 只允许一个线程调用push、另一个线程调用pop。元素按值存放在定长数组中，
+ * 入队出队不分配内存、不加锁；读写下标分别放在不同的缓存行上，避免伪共享。
+ *
+ * @tparam T 元素类型（需可平凡复制）
+ * @tparam Capacity 容量，必须是2的幂
+ */
+template <typename T, size_t Capacity>
+class SpscQueue {
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity必须是2的幂");
+    static_assert(std::is_trivially_copyable<T>::value, "元素需可平凡复制");
+
+public:
+    SpscQueue() : head_(0), tail_(0) {}
+
+    /**
+     * @brief 入队（仅生产者线程调用）
+     * @return 队列已满时返回false，元素不入队
+     */
+    bool push(const T& value) {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_.load(std::memory_order_acquire) == Capacity) {
+            return false;
+        }
+        slots_[tail & (Capacity - 1)] = value;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief 出队（仅消费者线程调用）
+     * @return 队列为空时返回false
+     */
+    bool pop(T& value) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_.load(std::memory_order_acquire)) {
+            return false;
+        }
+        value = slots_[head & (Capacity - 1)];
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief 队列是否为空（近似值，仅供参考）
+     */
+    bool empty() const {
+        return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+    }
+
+private:
+    alignas(64) std::atomic<size_t> head_;  ///< 读下标（消费者写）
+    alignas(64) std::atomic<size_t> tail_;  ///< 写下标（生产者写）
+    alignas(64) T slots_[Capacity];
+};
+
+#endif // SPSC_QUEUE_H
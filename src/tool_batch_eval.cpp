@@ -0,0 +1,277 @@
+#include "tools.h"
+#include "batch_evaluator.h"
+#include "memory_budget.h"
+#include "position.h"
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTextStream>
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+/**
+ * @brief 解析225个字符的棋盘（'.'空、'x'黑、'o'白，按行排列），后面可跟轮到的一方（x/o）
+ */
+bool parseBoard(const char* text, int length, PackedPosition& packed)
+{
+    int black = 0;
+    int white = 0;
+    for (int cell = 0; cell < Position::CELLS; ++cell) {
+        switch (text[cell]) {
+        case '.': case '-': packed.setPiece(cell, PieceType::NONE); break;
+        case 'x': case 'X': packed.setPiece(cell, PieceType::BLACK); ++black; break;
+        case 'o': case 'O': packed.setPiece(cell, PieceType::WHITE); ++white; break;
+        default: return false;
+        }
+    }
+    // 没有写轮到的一方时按子数推断（黑先）
+    packed.toMove = static_cast<uint8_t>(black == white ? PieceType::BLACK : PieceType::WHITE);
+    int i = Position::CELLS;
+    while (i < length && isSpace(text[i])) {
+        ++i;
+    }
+    if (i < length) {
+        const char side = text[i];
+        if (side == 'x' || side == 'X' || side == 'b' || side == 'B') {
+            packed.toMove = static_cast<uint8_t>(PieceType::BLACK);
+        } else if (side == 'o' || side == 'O' || side == 'w' || side == 'W') {
+            packed.toMove = static_cast<uint8_t>(PieceType::WHITE);
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief 解析着法列表，如"7,7 8,8 6,8"（行,列，从0开始），黑方先行
+ */
+bool parseMoves(const char* text, int length, PackedPosition& packed)
+{
+    PieceType player = PieceType::BLACK;
+    int i = 0;
+    while (i < length) {
+        if (isSpace(text[i]) || text[i] == ';') {
+            ++i;
+            continue;
+        }
+        int values[2] = {0, 0};
+        for (int part = 0; part < 2; ++part) {
+            if (part == 1) {
+                if (i >= length || text[i] != ',') {
+                    return false;
+                }
+                ++i;
+            }
+            const int start = i;
+            while (i < length && text[i] >= '0' && text[i] <= '9' && i - start < 3) {
+                values[part] = values[part] * 10 + (text[i] - '0');
+                ++i;
+            }
+            if (i == start) {
+                return false;
+            }
+        }
+        if (values[0] >= Position::SIZE || values[1] >= Position::SIZE) {
+            return false;
+        }
+        const int cell = values[0] * Position::SIZE + values[1];
+        if (packed.piece(cell) != PieceType::NONE) {
+            return false;
+        }
+        packed.setPiece(cell, player);
+        player = player == PieceType::BLACK ? PieceType::WHITE : PieceType::BLACK;
+    }
+    packed.toMove = static_cast<uint8_t>(player);
+    return true;
+}
+
+/**
+ * @brief 解析一行文本局面；无法解析时返回false
+ */
+bool parseLine(const QByteArray& line, PackedPosition& packed)
+{
+    packed = PackedPosition();
+    const char* text = line.constData();
+    int length = line.size();
+    while (length > 0 && isSpace(text[length - 1])) {
+        --length;
+    }
+    if (length >= Position::CELLS && !isSpace(text[0]) && text[1] != ',' && text[2] != ',') {
+        return parseBoard(text, length, packed);
+    }
+    return parseMoves(text, length, packed);
+}
+
+void appendResult(QByteArray& out, const BatchResult& result)
+{
+    if (result.flags & BatchResult::INVALID) {
+        out.append("-\t-\t-\t-\t-\tinvalid\n");
+        return;
+    }
+    out.append(QByteArray::number(result.staticEval));
+    out.append('\t');
+    out.append(QByteArray::number(result.score));
+    out.append('\t');
+    if (result.bestMove >= 0) {
+        out.append(QByteArray::number(result.bestMove / Position::SIZE));
+        out.append(',');
+        out.append(QByteArray::number(result.bestMove % Position::SIZE));
+    } else {
+        out.append('-');
+    }
+    out.append('\t');
+    out.append(QByteArray::number(result.depth));
+    out.append('\t');
+    out.append(QByteArray::number(static_cast<qint64>(result.nodes)));
+    out.append((result.flags & BatchResult::TERMINAL) ? "\tterminal\n" : "\tok\n");
+}
+
+} // namespace
+
+int Tools::batchEval(const QStringList& args)
+{
+    QCommandLineParser parser;
+    parser.setApplicationDescription("批量评估局面：从文件流式读取局面，输出静态评估、搜索分数和最佳着法。\n"
+                                     "文本输入每行一个局面：着法列表\"7,7 8,8 ...\"（黑先），"
+                                     "或225个字符的棋盘（.空 x黑 o白，按行）加可选的轮到一方（x/o）；"
+                                     "空行和#开头的行跳过。--packed时输入为连续的64字节PackedPosition。\n"
+                                     "输出每个局面一行：静态评估、搜索分数、最佳着法（行,列）、深度、节点数、状态，制表符分隔");
+    parser.addHelpOption();
+    QCommandLineOption outputOption({"o", "output"}, "输出文件（默认标准输出）", "file");
+    QCommandLineOption depthOption("depth", "搜索深度，0为只做静态评估", "n", "0");
+    QCommandLineOption nodesOption("nodes", "每个局面的节点上限，0为不限", "n", "0");
+    QCommandLineOption evaluatorOption("evaluator", "评估函数（Pattern/NNUE）", "name", "Pattern");
+    QCommandLineOption threadsOption("threads", "线程数（0为全部硬件线程）", "n", "0");
+    QCommandLineOption hashOption("hash", "每个线程的置换表大小（MB）", "mb", "1");
+    QCommandLineOption batchOption("batch", "每批读入并评估的局面数", "n", "4096");
+    QCommandLineOption packedOption("packed", "输入为PackedPosition数组（二进制）");
+    parser.addOption(outputOption);
+    parser.addOption(depthOption);
+    parser.addOption(nodesOption);
+    parser.addOption(evaluatorOption);
+    parser.addOption(threadsOption);
+    parser.addOption(hashOption);
+    parser.addOption(batchOption);
+    parser.addOption(packedOption);
+    parser.addPositionalArgument("input", "局面文件，-为标准输入", "<输入>");
+    parser.process(args);
+
+    QTextStream err(stderr);
+    if (parser.positionalArguments().size() != 1) {
+        err << "需要一个输入文件\n";
+        return 1;
+    }
+    const QString inputName = parser.positionalArguments().at(0);
+    QFile input(inputName);
+    const bool opened = inputName == "-" ? input.open(stdin, QIODevice::ReadOnly)
+                                         : input.open(QIODevice::ReadOnly);
+    if (!opened) {
+        err << "无法打开 " << inputName << "\n";
+        return 1;
+    }
+    QFile output;
+    bool outputOpened = false;
+    if (parser.isSet(outputOption)) {
+        output.setFileName(parser.value(outputOption));
+        outputOpened = output.open(QIODevice::WriteOnly | QIODevice::Truncate);
+    } else {
+        outputOpened = output.open(stdout, QIODevice::WriteOnly);
+    }
+    if (!outputOpened) {
+        err << "无法写入 " << parser.value(outputOption) << "\n";
+        return 1;
+    }
+
+    BatchEvaluator::Options options;
+    options.evaluator = parser.value(evaluatorOption);
+    options.depth = std::clamp(parser.value(depthOption).toInt(), 0, 40);
+    options.maxNodes = std::max(0LL, parser.value(nodesOption).toLongLong());
+    options.threads = std::max(0, parser.value(threadsOption).toInt());
+    options.tableMB = std::max(1, parser.value(hashOption).toInt());
+    BatchEvaluator evaluator(options);
+    if (!evaluator.isValid()) {
+        err << evaluator.errorString() << "\n";
+        return 1;
+    }
+
+    const bool packedInput = parser.isSet(packedOption);
+    const size_t batchSize = static_cast<size_t>(std::max(1, parser.value(batchOption).toInt()));
+    std::vector<PackedPosition> positions(batchSize);
+    std::vector<BatchResult> results(batchSize);
+    QByteArray text;
+
+    QElapsedTimer total;
+    total.start();
+    qint64 evaluateNs = 0;
+    long long count = 0;
+    long long invalid = 0;
+    long long nodes = 0;
+    output.write("# static\tscore\tmove\tdepth\tnodes\tstatus\n");
+    for (;;) {
+        // 读入一批
+        size_t filled = 0;
+        if (packedInput) {
+            const qint64 bytes = input.read(reinterpret_cast<char*>(positions.data()),
+                                            static_cast<qint64>(batchSize * sizeof(PackedPosition)));
+            if (bytes < 0 || bytes % static_cast<qint64>(sizeof(PackedPosition)) != 0) {
+                err << "输入不是完整的PackedPosition数组\n";
+                return 1;
+            }
+            filled = static_cast<size_t>(bytes) / sizeof(PackedPosition);
+        } else {
+            while (filled < batchSize && !input.atEnd()) {
+                const QByteArray line = input.readLine();
+                if (line.trimmed().isEmpty() || line.startsWith("#")) {
+                    continue;
+                }
+                if (!parseLine(line, positions[filled])) {
+                    // 保持输出与输入逐行对应：无法解析的行按无效局面输出
+                    positions[filled].toMove = 0;
+                }
+                ++filled;
+            }
+        }
+        if (filled == 0) {
+            break;
+        }
+
+        QElapsedTimer timer;
+        timer.start();
+        evaluator.evaluate(positions.data(), filled, results.data());
+        evaluateNs += timer.nsecsElapsed();
+
+        text.clear();
+        for (size_t i = 0; i < filled; ++i) {
+            appendResult(text, results[i]);
+            invalid += (results[i].flags & BatchResult::INVALID) ? 1 : 0;
+            nodes += results[i].nodes;
+        }
+        output.write(text);
+        count += static_cast<long long>(filled);
+    }
+    output.flush();
+
+    const double evaluateSeconds = evaluateNs / 1e9;
+    err << QString("%1 个局面（%2 个无效），评估用时 %3 s，%4 局面/秒（%5 线程，深度 %6），总用时 %7 s")
+               .arg(count)
+               .arg(invalid)
+               .arg(evaluateSeconds, 0, 'f', 2)
+               .arg(evaluateSeconds > 0 ? count / evaluateSeconds : 0.0, 0, 'f', 0)
+               .arg(evaluator.threadCount())
+               .arg(options.depth)
+               .arg(total.nsecsElapsed() / 1e9, 0, 'f', 2);
+    if (nodes > 0) {
+        err << QString("，%1 节点/秒").arg(evaluateSeconds > 0 ? nodes / evaluateSeconds : 0.0, 0, 'f', 0);
+    }
+    err << "\n" << MemoryBudget::report();
+    return 0;
+}
@@ -0,0 +1,189 @@
+#include "tools.h"
+#include "game_journal.h"
+#include "gamesave.h"
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <algorithm>
+#include <random>
+
+namespace {
+
+/**
+ * @brief 单次写入耗时的分布（纳秒）
+ */
+struct Latency {
+    std::vector<qint64> samples;
+
+    double percentileUs(double p) {
+        if (samples.empty()) {
+            return 0.0;
+        }
+        const size_t index = std::min(samples.size() - 1, static_cast<size_t>(p * samples.size()));
+        std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+        return samples[index] / 1000.0;
+    }
+
+    double meanUs() const {
+        qint64 total = 0;
+        for (qint64 sample : samples) {
+            total += sample;
+        }
+        return samples.empty() ? 0.0 : total / 1000.0 / samples.size();
+    }
+};
+
+/**
+ * @brief 随机落子（约十分之一为悔棋），每局最多100步，统计每条记录的写入耗时
+ */
+bool runJournal(const QString& path, int records, int syncEvery, std::mt19937& rng,
+                Latency& latency, qint64& syncs, bool& recovered)
+{
+    GameJournal journal(syncEvery, 1000);
+    GameJournal::Settings settings;
+    latency.samples.clear();
+    latency.samples.reserve(records);
+    syncs = 0;
+
+    bool occupied[225] = {};
+    int undos = 3;
+    auto newGame = [&]() {
+        syncs += journal.syncCount();
+        std::fill(std::begin(occupied), std::end(occupied), false);
+        undos = settings.remainingUndos;
+        return journal.begin(path, settings);
+    };
+    if (!newGame()) {
+        return false;
+    }
+
+    QElapsedTimer timer;
+    for (int i = 0; i < records; ++i) {
+        const auto& moves = journal.moves();
+        if (moves.size() >= 100 && !newGame()) {
+            return false;
+        }
+        const bool undo = !moves.empty() && rng() % 10 == 0;
+        if (undo) {
+            const Move last = moves.back();
+            occupied[last.row * 15 + last.col] = false;
+            undos = std::max(0, undos - 1);
+            timer.start();
+            journal.appendUndo(undos);
+            latency.samples.push_back(timer.nsecsElapsed());
+            continue;
+        }
+
+        int cell = static_cast<int>(rng() % 225);
+        while (occupied[cell]) {
+            cell = (cell + 1) % 225;
+        }
+        occupied[cell] = true;
+        const PieceType player = moves.size() % 2 == 0 ? PieceType::BLACK : PieceType::WHITE;
+        timer.start();
+        journal.appendMove(cell / 15, cell % 15, player, undos);
+        latency.samples.push_back(timer.nsecsElapsed());
+    }
+    journal.sync();
+    syncs += journal.syncCount();
+
+    // 用最后一局校验恢复结果
+    GameJournal::Recovered game;
+    recovered = GameJournal::recover(path, game) && !game.truncated &&
+                game.moves.size() == journal.moves().size() &&
+                std::equal(game.moves.begin(), game.moves.end(), journal.moves().begin(),
+                           [](const Move& a, const Move& b) {
+                               return a.row == b.row && a.col == b.col && a.player == b.player;
+                           });
+    return true;
+}
+
+} // namespace
+
+int Tools::benchJournal(const QStringList& args)
+{
+    QCommandLineParser parser;
+    parser.setApplicationDescription("自动保存日志每步写入耗时基准（与每步全量重写存档对比）");
+    parser.addHelpOption();
+    QCommandLineOption recordsOption("records", "写入的记录数", "n", "20000");
+    QCommandLineOption syncOption("sync-every", "每多少条记录fsync一次", "n", "8");
+    QCommandLineOption rewriteOption("rewrites", "用于对比的全量重写次数", "n", "500");
+    QCommandLineOption seedOption("seed", "随机种子", "n", "1");
+    parser.addOption(recordsOption);
+    parser.addOption(syncOption);
+    parser.addOption(rewriteOption);
+    parser.addOption(seedOption);
+    parser.process(args);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+    QTemporaryDir tempDir;
+    if (!tempDir.isValid()) {
+        err << "无法创建临时目录\n";
+        return 1;
+    }
+    const int records = std::max(1, parser.value(recordsOption).toInt());
+    const int syncEvery = std::max(1, parser.value(syncOption).toInt());
+    std::mt19937 rng(parser.value(seedOption).toUInt());
+
+    const int syncSettings[] = {syncEvery, 1};
+    for (int setting : syncSettings) {
+        Latency latency;
+        qint64 syncs = 0;
+        bool recovered = false;
+        if (!runJournal(tempDir.filePath("bench.gmkj"), records, setting, rng, latency, syncs, recovered)) {
+            err << "无法写入日志\n";
+            return 1;
+        }
+        out << QString("日志（每%1条fsync）: %2 条记录，%3 次fsync，恢复校验%4\n")
+                   .arg(setting).arg(records).arg(syncs).arg(recovered ? "通过" : "失败");
+        out << QString("  平均 %1 us，p50 %2 us，p99 %3 us，最大 %4 us\n")
+                   .arg(latency.meanUs(), 0, 'f', 2)
+                   .arg(latency.percentileUs(0.50), 0, 'f', 2)
+                   .arg(latency.percentileUs(0.99), 0, 'f', 2)
+                   .arg(latency.percentileUs(1.0), 0, 'f', 2);
+        if (!recovered) {
+            return 1;
+        }
+    }
+
+    // 对比：每步把整局写成JSON存档
+    const int rewrites = std::max(0, parser.value(rewriteOption).toInt());
+    if (rewrites > 0) {
+        GameSave::SaveData data;
+        data.timestamp = QDateTime::currentDateTime();
+        data.isAIEnabled = false;
+        data.aiDifficulty = 3;
+        data.undoLimit = 3;
+        data.remainingUndos = 3;
+        data.board.assign(15, std::vector<int>(15, static_cast<int>(PieceType::NONE)));
+        Latency latency;
+        QElapsedTimer timer;
+        const QString path = tempDir.filePath("bench.gomoku");
+        for (int i = 0; i < rewrites; ++i) {
+            if (data.history.size() >= 100) {
+                data.history.clear();
+                data.board.assign(15, std::vector<int>(15, static_cast<int>(PieceType::NONE)));
+            }
+            int cell = static_cast<int>(rng() % 225);
+            while (data.board[cell / 15][cell % 15] != static_cast<int>(PieceType::NONE)) {
+                cell = (cell + 1) % 225;
+            }
+            const PieceType player = data.history.size() % 2 == 0 ? PieceType::BLACK : PieceType::WHITE;
+            data.board[cell / 15][cell % 15] = static_cast<int>(player);
+            data.history.emplace_back(cell / 15, cell % 15, player);
+            data.currentPlayer = static_cast<int>(player == PieceType::BLACK ? PieceType::WHITE
+                                                                             : PieceType::BLACK);
+            timer.start();
+            GameSave::saveGame(path, data, GameSave::Format::Json);
+            latency.samples.push_back(timer.nsecsElapsed());
+        }
+        out << QString("全量重写JSON存档（不fsync）: %1 次\n").arg(rewrites);
+        out << QString("  平均 %1 us，p50 %2 us，p99 %3 us\n")
+                   .arg(latency.meanUs(), 0, 'f', 2)
+                   .arg(latency.percentileUs(0.50), 0, 'f', 2)
+                   .arg(latency.percentileUs(0.99), 0, 'f', 2);
+    }
+    return 0;
+}
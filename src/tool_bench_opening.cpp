@@ -0,0 +1,166 @@
+#include "tools.h"
+#include "astar_ai.h"
+#include "position.h"
+#include "zobrist.h"
+#include <QCommandLineParser>
+#include <QTextStream>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace {
+
+/**
+ * @brief 一个待搜索的开局局面
+ */
+struct OpeningPosition {
+    std::vector<int> moves;  ///< 黑方先手的着法序列（行 * 15 + 列）
+};
+
+/**
+ * @brief 以天元开局、在上一步附近随机落子的开局着法，中途连五时提前结束
+ */
+std::vector<int> randomOpening(std::mt19937& rng, int plies)
+{
+    Position position;
+    std::vector<int> moves;
+    int row = Position::SIZE / 2;
+    int col = Position::SIZE / 2;
+    for (int ply = 0; ply < plies; ++ply) {
+        if (ply > 0) {
+            // 上一步附近都满时（开局很长或靠近边缘）改取任一空位，棋盘满了就结束
+            const Move last = position.getLastMove();
+            int attempt = 0;
+            do {
+                row = std::clamp(last.row + static_cast<int>(rng() % 5) - 2, 0, Position::SIZE - 1);
+                col = std::clamp(last.col + static_cast<int>(rng() % 5) - 2, 0, Position::SIZE - 1);
+            } while (position.getPiece(row, col) != PieceType::NONE && ++attempt < 64);
+            for (int cell = 0; cell < Position::CELLS && position.getPiece(row, col) != PieceType::NONE; ++cell) {
+                row = cell / Position::SIZE;
+                col = cell % Position::SIZE;
+            }
+            if (position.getPiece(row, col) != PieceType::NONE) {
+                break;
+            }
+        }
+        moves.push_back(row * Position::SIZE + col);
+        if (position.placePiece(row, col, ply % 2 == 0 ? PieceType::BLACK : PieceType::WHITE)) {
+            break;
+        }
+    }
+    return moves;
+}
+
+/**
+ * @brief 一种设置下搜索全部局面的累计结果
+ */
+struct RunTotals {
+    long long nodes = 0;
+    long long ttProbes = 0;
+    long long ttHits = 0;
+    long long elapsedUs = 0;
+    int cached = 0;
+    std::vector<int> moves;  ///< 每个局面选出的着法
+};
+
+RunTotals runPositions(const std::vector<OpeningPosition>& positions, int difficulty, int symmetryPlies)
+{
+    // 与界面一样，整个过程只用一个AI实例，置换表和根节点缓存跨局面保留
+    AStarAI ai(difficulty);
+    ai.setSymmetryPlies(symmetryPlies);
+    RunTotals totals;
+    for (const auto& opening : positions) {
+        Position position;
+        for (size_t ply = 0; ply < opening.moves.size(); ++ply) {
+            position.placePiece(opening.moves[ply] / Position::SIZE, opening.moves[ply] % Position::SIZE,
+                                ply % 2 == 0 ? PieceType::BLACK : PieceType::WHITE);
+        }
+        const PieceType toMove = opening.moves.size() % 2 == 0 ? PieceType::BLACK : PieceType::WHITE;
+        const Move move = ai.getNextMove(position, toMove);
+        const SearchStats stats = ai.getLastSearchStats();
+        totals.nodes += stats.nodes;
+        totals.ttProbes += stats.ttProbes;
+        totals.ttHits += stats.ttHits;
+        totals.elapsedUs += stats.elapsedUs;
+        totals.cached += stats.cached ? 1 : 0;
+        totals.moves.push_back(move.row * Position::SIZE + move.col);
+    }
+    return totals;
+}
+
+QString describe(const RunTotals& totals)
+{
+    return QString("节点 %1，置换表命中率 %2%，用时 %3 ms，根节点缓存命中 %4 次")
+        .arg(totals.nodes)
+        .arg(totals.ttProbes > 0 ? 100.0 * totals.ttHits / totals.ttProbes : 0.0, 0, 'f', 1)
+        .arg(totals.elapsedUs / 1000.0, 0, 'f', 0)
+        .arg(totals.cached);
+}
+
+double reduction(long long before, long long after)
+{
+    return before > 0 ? 100.0 * (before - after) / before : 0.0;
+}
+
+} // namespace
+
+int Tools::benchOpening(const QStringList& args)
+{
+    QCommandLineParser parser;
+    parser.setApplicationDescription("开局对称规范化基准：比较关闭和开启时的置换表命中率与搜索用时");
+    parser.addHelpOption();
+    QCommandLineOption openingsOption("openings", "不同开局的数量", "n", "8");
+    QCommandLineOption gamesOption("games", "对局数（每局随机取一个开局和一种对称变换）", "n", "64");
+    QCommandLineOption pliesOption("plies", "规范化的开局步数，也是每局搜索的步数", "n",
+                                   QString::number(AStarAI::DEFAULT_SYMMETRY_PLIES));
+    QCommandLineOption difficultyOption("difficulty", "AI难度（1-5）", "n", "3");
+    QCommandLineOption seedOption("seed", "随机种子", "n", "1");
+    parser.addOption(openingsOption);
+    parser.addOption(gamesOption);
+    parser.addOption(pliesOption);
+    parser.addOption(difficultyOption);
+    parser.addOption(seedOption);
+    parser.process(args);
+
+    QTextStream out(stdout);
+    const int openings = std::max(1, parser.value(openingsOption).toInt());
+    const int games = std::max(1, parser.value(gamesOption).toInt());
+    const int plies = std::clamp(parser.value(pliesOption).toInt(), 1, Position::CELLS);
+    const int difficulty = std::clamp(parser.value(difficultyOption).toInt(), 1, 5);
+    std::mt19937 rng(parser.value(seedOption).toUInt());
+
+    // 实际对局中同一开局常以不同方向出现：每局从开局库中取一个，再做一次随机对称变换，
+    // 然后依次搜索该局第1步之后到第plies步之前的各个局面
+    std::vector<std::vector<int>> lines;
+    for (int i = 0; i < openings; ++i) {
+        lines.push_back(randomOpening(rng, plies));
+    }
+    std::vector<OpeningPosition> positions;
+    for (int game = 0; game < games; ++game) {
+        const auto& line = lines[rng() % lines.size()];
+        const int sym = static_cast<int>(rng() % Symmetry::COUNT);
+        OpeningPosition position;
+        for (size_t ply = 0; ply + 1 < line.size(); ++ply) {
+            position.moves.push_back(Symmetry::transform(sym, line[ply]));
+            positions.push_back(position);
+        }
+    }
+    out << QString("开局 %1 种，对局 %2 局，每局前 %3 步，共 %4 个局面，难度 %5\n")
+               .arg(openings).arg(games).arg(plies).arg(positions.size()).arg(difficulty);
+
+    const RunTotals plain = runPositions(positions, difficulty, 0);
+    out << "关闭规范化: " << describe(plain) << "\n";
+    const RunTotals symmetric = runPositions(positions, difficulty, plies);
+    out << "开启规范化: " << describe(symmetric) << "\n";
+
+    int sameMoves = 0;
+    for (size_t i = 0; i < positions.size(); ++i) {
+        sameMoves += plain.moves[i] == symmetric.moves[i] ? 1 : 0;
+    }
+    out << QString("节点减少 %1%，用时减少 %2%，%3/%4 个局面选出相同着法（其余为同分着法或受时限影响）\n")
+               .arg(reduction(plain.nodes, symmetric.nodes), 0, 'f', 1)
+               .arg(reduction(plain.elapsedUs, symmetric.elapsedUs), 0, 'f', 1)
+               .arg(sameMoves)
+               .arg(positions.size());
+    return 0;
+}
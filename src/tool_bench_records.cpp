@@ -0,0 +1,206 @@
+#include "tools.h"
+#include "game_record.h"
+#include "gamesave.h"
+#include "position.h"
+#include <QCommandLineParser>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <algorithm>
+#include <random>
+
+namespace {
+
+/**
+ * @brief 生成一局随机对局：在已有棋子附近随机落子，直到连五或达到指定步数
+ */
+void randomGame(std::mt19937& rng, GameRecord& record)
+{
+    Position position;
+    record.moves.clear();
+    record.whiteFirst = false;
+    record.timestamp = 1700000000000LL + static_cast<qint64>(rng() % 1000000000u);
+
+    const int maxPlies = 20 + static_cast<int>(rng() % 100);
+    int row = Position::SIZE / 2;
+    int col = Position::SIZE / 2;
+    for (int ply = 0; ply < maxPlies && !position.isFull(); ++ply) {
+        if (ply > 0) {
+            // 以上一步为中心随机选一个空位，找不到时全盘随机
+            int attempts = 0;
+            do {
+                if (++attempts > 32) {
+                    row = static_cast<int>(rng() % Position::SIZE);
+                    col = static_cast<int>(rng() % Position::SIZE);
+                } else {
+                    const Move last = position.getLastMove();
+                    row = std::clamp(last.row + static_cast<int>(rng() % 5) - 2, 0, Position::SIZE - 1);
+                    col = std::clamp(last.col + static_cast<int>(rng() % 5) - 2, 0, Position::SIZE - 1);
+                }
+            } while (position.getPiece(row, col) != PieceType::NONE);
+        }
+        record.moves.push_back(static_cast<uint8_t>(row * Position::SIZE + col));
+        if (position.placePiece(row, col, record.playerAt(ply))) {
+            break;
+        }
+    }
+    record.currentPlayer = static_cast<int>(record.playerAt(record.moves.size()));
+}
+
+double perSecond(qint64 count, qint64 nanoseconds)
+{
+    return nanoseconds > 0 ? count * 1e9 / nanoseconds : 0.0;
+}
+
+} // namespace
+
+int Tools::benchRecords(const QStringList& args)
+{
+    QCommandLineParser parser;
+    parser.setApplicationDescription("二进制棋谱读写吞吐量基准（与JSON存档对比）");
+    parser.addHelpOption();
+    QCommandLineOption gamesOption("games", "棋谱库中的对局数", "n", "200000");
+    QCommandLineOption jsonOption("json", "用于对比的JSON存档数", "n", "2000");
+    QCommandLineOption fileOption("file", "棋谱库文件（默认写到临时目录）", "path");
+    QCommandLineOption seedOption("seed", "随机种子", "n", "1");
+    parser.addOption(gamesOption);
+    parser.addOption(jsonOption);
+    parser.addOption(fileOption);
+    parser.addOption(seedOption);
+    parser.process(args);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+    const int games = std::max(1, parser.value(gamesOption).toInt());
+    const int jsonGames = std::max(0, std::min(games, parser.value(jsonOption).toInt()));
+    std::mt19937 rng(parser.value(seedOption).toUInt());
+
+    QTemporaryDir tempDir;
+    QString archivePath = parser.value(fileOption);
+    if (archivePath.isEmpty()) {
+        if (!tempDir.isValid()) {
+            err << "无法创建临时目录\n";
+            return 1;
+        }
+        archivePath = tempDir.filePath("bench.gmkr");
+    }
+
+    // 预先生成对局，避免把生成时间计入写入耗时
+    std::vector<GameRecord> records(games);
+    qint64 totalMoves = 0;
+    for (auto& record : records) {
+        randomGame(rng, record);
+        totalMoves += static_cast<qint64>(record.moves.size());
+    }
+    out << QString("对局数 %1，平均 %2 步\n")
+               .arg(games).arg(static_cast<double>(totalMoves) / games, 0, 'f', 1);
+
+    // 写入
+    QFile writeFile(archivePath);
+    if (!writeFile.open(QIODevice::WriteOnly)) {
+        err << "无法写入 " << archivePath << "\n";
+        return 1;
+    }
+    QElapsedTimer timer;
+    timer.start();
+    {
+        GameRecordWriter writer(&writeFile);
+        for (const auto& record : records) {
+            if (!writer.write(record)) {
+                err << "写入失败\n";
+                return 1;
+            }
+        }
+        if (!writer.flush()) {
+            err << "写入失败\n";
+            return 1;
+        }
+    }
+    writeFile.close();
+    const qint64 writeNs = timer.nsecsElapsed();
+    const qint64 archiveBytes = QFile(archivePath).size();
+
+    // 顺序读取
+    QFile readFile(archivePath);
+    if (!readFile.open(QIODevice::ReadOnly)) {
+        err << "无法读取 " << archivePath << "\n";
+        return 1;
+    }
+    timer.start();
+    GameRecordReader reader(&readFile);
+    GameRecord record;
+    qint64 readGames = 0;
+    qint64 readMoves = 0;
+    while (reader.readNext(record)) {
+        ++readGames;
+        readMoves += static_cast<qint64>(record.moves.size());
+    }
+    const qint64 readNs = timer.nsecsElapsed();
+    if (reader.hasError() || readGames != games || readMoves != totalMoves) {
+        err << "读取校验失败: " << reader.errorString() << "\n";
+        return 1;
+    }
+
+    // 读取并重放到局面（含连五检测）
+    readFile.seek(0);
+    timer.start();
+    GameRecordReader replayReader(&readFile);
+    Position position;
+    qint64 finished = 0;
+    while (replayReader.readNext(record)) {
+        position.clear();
+        bool won = false;
+        for (size_t ply = 0; ply < record.moves.size(); ++ply) {
+            won = position.placePiece(record.moves[ply] / Position::SIZE,
+                                      record.moves[ply] % Position::SIZE, record.playerAt(ply));
+        }
+        finished += won ? 1 : 0;
+    }
+    const qint64 replayNs = timer.nsecsElapsed();
+
+    const double megabytes = archiveBytes / (1024.0 * 1024.0);
+    out << QString("二进制: %1 字节/局，共 %2 MB\n")
+               .arg(static_cast<double>(archiveBytes) / games, 0, 'f', 1)
+               .arg(megabytes, 0, 'f', 2);
+    out << QString("  写入 %1 局/秒，%2 MB/秒\n")
+               .arg(perSecond(games, writeNs), 0, 'f', 0)
+               .arg(perSecond(archiveBytes, writeNs) / (1024.0 * 1024.0), 0, 'f', 1);
+    out << QString("  读取 %1 局/秒，%2 MB/秒\n")
+               .arg(perSecond(games, readNs), 0, 'f', 0)
+               .arg(perSecond(archiveBytes, readNs) / (1024.0 * 1024.0), 0, 'f', 1);
+    out << QString("  读取并重放 %1 局/秒（%2 局以连五结束）\n")
+               .arg(perSecond(games, replayNs), 0, 'f', 0)
+               .arg(finished);
+
+    // JSON存档对比：每局一个文件，与界面保存/读取的路径相同
+    if (jsonGames > 0 && tempDir.isValid()) {
+        QDir dir(tempDir.path());
+        qint64 jsonBytes = 0;
+        timer.start();
+        for (int i = 0; i < jsonGames; ++i) {
+            GameSave::SaveData data;
+            records[i].toSaveData(data);
+            GameSave::saveGame(dir.filePath(QString("%1.gomoku").arg(i)), data, GameSave::Format::Json);
+        }
+        const qint64 jsonWriteNs = timer.nsecsElapsed();
+        for (int i = 0; i < jsonGames; ++i) {
+            jsonBytes += QFile(dir.filePath(QString("%1.gomoku").arg(i))).size();
+        }
+        timer.start();
+        for (int i = 0; i < jsonGames; ++i) {
+            GameSave::SaveData data;
+            GameSave::loadGame(dir.filePath(QString("%1.gomoku").arg(i)), data);
+        }
+        const qint64 jsonReadNs = timer.nsecsElapsed();
+
+        out << QString("JSON: %1 字节/局（%2 局样本）\n")
+                   .arg(static_cast<double>(jsonBytes) / jsonGames, 0, 'f', 1)
+                   .arg(jsonGames);
+        out << QString("  写入 %1 局/秒，读取 %2 局/秒\n")
+                   .arg(perSecond(jsonGames, jsonWriteNs), 0, 'f', 0)
+                   .arg(perSecond(jsonGames, jsonReadNs), 0, 'f', 0);
+    }
+    return 0;
+}
@@ -0,0 +1,235 @@
+#include "tools.h"
+#include "opening_book.h"
+#include "position.h"
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QRegularExpression>
+#include <QTextStream>
+#include <algorithm>
+
+namespace {
+
+/**
+ * @brief 解析着法列表，如"7,7 8,8 6,8"（行,列，从0开始），黑方先行
+ */
+bool parseMoves(const QString& text, Position& position, QString& error)
+{
+    const QStringList tokens = text.split(QRegularExpression("[\\s;]+"), Qt::SkipEmptyParts);
+    PieceType player = PieceType::BLACK;
+    for (const QString& token : tokens) {
+        const QStringList parts = token.split(",");
+        bool rowOk = false;
+        bool colOk = false;
+        const int row = parts.size() == 2 ? parts[0].toInt(&rowOk) : -1;
+        const int col = parts.size() == 2 ? parts[1].toInt(&colOk) : -1;
+        if (!rowOk || !colOk || row < 0 || row >= Position::SIZE || col < 0 || col >= Position::SIZE ||
+            position.getPiece(row, col) != PieceType::NONE) {
+            error = QString("无效着法: %1").arg(token);
+            return false;
+        }
+        position.placePiece(row, col, player);
+        player = player == PieceType::BLACK ? PieceType::WHITE : PieceType::BLACK;
+    }
+    return true;
+}
+
+} // namespace
+
+int Tools::bookBuild(const QStringList& args)
+{
+    QCommandLineParser parser;
+    parser.setApplicationDescription("用drop-out展开建立开局库：从空棋盘起反复展开路径代价最小的候选着法，\n"
+                                     "多线程定深搜索新局面，按规范哈希去重，写出可内存映射的.gmbk文件（格式见opening_book.h）。\n"
+                                     "输出文件已存在时读入后接着扩展，未指定的搜索参数沿用文件中的设置");
+    parser.addHelpOption();
+    QCommandLineOption outputOption({"o", "output"}, "开局库文件", "file", "book.gmbk");
+    QCommandLineOption positionsOption("positions", "本次新收录的局面数", "n", "1000");
+    QCommandLineOption depthOption("depth", "每个局面的搜索深度", "n", "6");
+    QCommandLineOption nodesOption("nodes", "每个局面的节点上限，0为不限", "n", "0");
+    QCommandLineOption multiPvOption("multipv", "每个局面保留的候选数", "n", "4");
+    QCommandLineOption maxPlyOption("max-ply", "只展开棋子数少于n的局面", "n", "12");
+    QCommandLineOption plyCostOption("ply-cost", "路径每多一步增加的代价", "n", "100");
+    QCommandLineOption batchOption("batch", "每批搜索的局面数（影响库的内容，与线程数无关）", "n", "32");
+    QCommandLineOption evaluatorOption("evaluator", "评估函数（Pattern/NNUE）", "name", "Pattern");
+    QCommandLineOption threadsOption("threads", "线程数（0为全部硬件线程）", "n", "0");
+    QCommandLineOption hashOption("hash", "每个线程的置换表大小（MB）", "mb", "16");
+    QCommandLineOption checkpointOption("checkpoint", "每收录n个局面保存一次，0为只在结束时保存", "n", "0");
+    parser.addOption(outputOption);
+    parser.addOption(positionsOption);
+    parser.addOption(depthOption);
+    parser.addOption(nodesOption);
+    parser.addOption(multiPvOption);
+    parser.addOption(maxPlyOption);
+    parser.addOption(plyCostOption);
+    parser.addOption(batchOption);
+    parser.addOption(evaluatorOption);
+    parser.addOption(threadsOption);
+    parser.addOption(hashOption);
+    parser.addOption(checkpointOption);
+    parser.process(args);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+    const QString path = parser.value(outputOption);
+
+    OpeningBookBuilder::Options options;
+    options.evaluator = parser.value(evaluatorOption);
+    options.depth = std::clamp(parser.value(depthOption).toInt(), 1, 40);
+    options.maxNodes = std::max(0LL, parser.value(nodesOption).toLongLong());
+    options.multiPv = std::clamp(parser.value(multiPvOption).toInt(), 1, Searcher::MAX_LINES);
+    options.maxPly = std::clamp(parser.value(maxPlyOption).toInt(), 1, 225);
+    options.plyCost = std::max(0, parser.value(plyCostOption).toInt());
+    options.batch = std::max(1, parser.value(batchOption).toInt());
+    options.threads = std::max(0, parser.value(threadsOption).toInt());
+    options.tableMB = std::max(1, parser.value(hashOption).toInt());
+
+    // 接着扩展已有的库时沿用其中记录的搜索参数，命令行上明确指定的除外
+    const bool resume = QFile::exists(path);
+    if (resume) {
+        OpeningBook existing;
+        if (!existing.open(path)) {
+            err << path << ": " << existing.errorString() << "\n";
+            return 1;
+        }
+        const OpeningBookFormat::Header* header = existing.header();
+        if (!parser.isSet(depthOption)) {
+            options.depth = static_cast<int>(header->searchDepth);
+        }
+        if (!parser.isSet(nodesOption)) {
+            options.maxNodes = static_cast<long long>(header->searchNodes);
+        }
+        if (!parser.isSet(multiPvOption)) {
+            options.multiPv = static_cast<int>(header->multiPv);
+        }
+        if (!parser.isSet(maxPlyOption)) {
+            options.maxPly = static_cast<int>(header->maxPly);
+        }
+    }
+
+    OpeningBookBuilder builder(options);
+    if (!builder.isValid()) {
+        err << builder.errorString() << "\n";
+        return 1;
+    }
+    if (resume) {
+        if (!builder.load(path)) {
+            err << path << ": " << builder.errorString() << "\n";
+            return 1;
+        }
+        out << QString("%1 已有 %2 个局面，接着扩展\n").arg(path).arg(builder.positionCount());
+    }
+
+    const long long positions = std::max(1LL, parser.value(positionsOption).toLongLong());
+    const long long checkpoint = std::max(0LL, parser.value(checkpointOption).toLongLong());
+    out << QString("收录 %1 个局面，%2 线程，深度 %3，候选 %4，最多 %5 子\n")
+               .arg(positions)
+               .arg(builder.threadCount())
+               .arg(options.depth)
+               .arg(options.multiPv)
+               .arg(options.maxPly);
+    out.flush();
+
+    // 进度每秒最多打印一次
+    QElapsedTimer timer;
+    timer.start();
+    QElapsedTimer progressTimer;
+    progressTimer.start();
+    OpeningBookBuilder::Stats total;
+    auto progress = [&](const OpeningBookBuilder::Stats& stats) {
+        if (progressTimer.elapsed() < 1000) {
+            return;
+        }
+        progressTimer.restart();
+        const long long searched = total.searched + stats.searched;
+        err << QString("\r%1/%2 个局面，库中 %3 个，%4 局面/秒")
+                   .arg(searched)
+                   .arg(positions)
+                   .arg(stats.positions)
+                   .arg(timer.elapsed() > 0 ? searched * 1000.0 / timer.elapsed() : 0.0, 0, 'f', 1);
+        err.flush();
+    };
+
+    while (total.searched < positions) {
+        const long long step = checkpoint > 0 ? std::min(checkpoint, positions - total.searched)
+                                              : positions - total.searched;
+        const OpeningBookBuilder::Stats stats = builder.expand(step, progress);
+        total.searched += stats.searched;
+        total.transpositions += stats.transpositions;
+        total.nodes += stats.nodes;
+        total.threads = stats.threads;
+        if (!builder.save(path)) {
+            err << "\n" << builder.errorString() << "\n";
+            return 1;
+        }
+        if (stats.searched < step) {
+            break;  // 没有可展开的着法了
+        }
+    }
+    err << "\n";
+
+    const double seconds = timer.elapsed() / 1000.0;
+    out << QString("新收录 %1 个局面（换序连接 %2 个），库中共 %3 个局面，空棋盘的回溯值 %4\n")
+               .arg(total.searched)
+               .arg(total.transpositions)
+               .arg(builder.positionCount())
+               .arg(builder.rootValue());
+    out << QString("用时 %1 s，%2 局面/秒，%3 节点/秒（%4 线程）\n")
+               .arg(seconds, 0, 'f', 2)
+               .arg(seconds > 0 ? total.searched / seconds : 0.0, 0, 'f', 1)
+               .arg(seconds > 0 ? total.nodes / seconds : 0.0, 0, 'f', 0)
+               .arg(total.threads);
+    out << QString("写入 %1，%2 字节\n").arg(path).arg(QFile(path).size());
+    return 0;
+}
+
+int Tools::bookQuery(const QStringList& args)
+{
+    QCommandLineParser parser;
+    parser.setApplicationDescription("在开局库中查询局面（含对称局面）");
+    parser.addHelpOption();
+    QCommandLineOption bookOption({"b", "book"}, "开局库文件", "file", "book.gmbk");
+    QCommandLineOption movesOption("moves", "局面的着法序列，如\"7,7 8,8\"（行,列，黑先）", "moves");
+    parser.addOption(bookOption);
+    parser.addOption(movesOption);
+    parser.process(args);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    Position position;
+    QString error;
+    if (!parseMoves(parser.value(movesOption), position, error)) {
+        err << error << "\n";
+        return 1;
+    }
+
+    OpeningBook book;
+    if (!book.open(parser.value(bookOption))) {
+        err << book.errorString() << "\n";
+        return 1;
+    }
+    const OpeningBookFormat::Header* header = book.header();
+    out << QString("开局库: %1 个局面，深度 %2，候选 %3，最多 %4 子\n")
+               .arg(book.positionCount())
+               .arg(header->searchDepth)
+               .arg(header->multiPv)
+               .arg(header->maxPly);
+
+    std::vector<OpeningBook::BookMove> moves;
+    int value = 0;
+    if (!book.find(position, moves, &value)) {
+        out << "局面不在库中\n";
+        return 0;
+    }
+    out << QString("局面回溯值 %1（轮到的一方视角）\n").arg(value);
+    if (!moves.empty()) {
+        out << "\n着法       分数  已收录\n";
+        for (const auto& move : moves) {
+            out << QString("%1,%2").arg(move.move.row).arg(move.move.col).leftJustified(8)
+                << QString::number(move.score).rightJustified(7)
+                << (move.inBook ? "  是" : "") << "\n";
+        }
+    }
+    return 0;
+}
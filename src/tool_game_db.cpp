@@ -0,0 +1,198 @@
+#include "tools.h"
+#include "game_database.h"
+#include "gamesave.h"
+#include "position.h"
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QRegularExpression>
+#include <QTextStream>
+
+namespace {
+
+/**
+ * @brief 解析着法列表，如"7,7 8,8 6,8"（行,列，从0开始），黑方先行
+ */
+bool parseMoves(const QString& text, Position& position, QString& error)
+{
+    const QStringList tokens = text.split(QRegularExpression("[\\s;]+"), Qt::SkipEmptyParts);
+    PieceType player = PieceType::BLACK;
+    for (const QString& token : tokens) {
+        const QStringList parts = token.split(",");
+        bool rowOk = false;
+        bool colOk = false;
+        const int row = parts.size() == 2 ? parts[0].toInt(&rowOk) : -1;
+        const int col = parts.size() == 2 ? parts[1].toInt(&colOk) : -1;
+        if (!rowOk || !colOk || row < 0 || row >= Position::SIZE || col < 0 || col >= Position::SIZE ||
+            position.getPiece(row, col) != PieceType::NONE) {
+            error = QString("无效着法: %1").arg(token);
+            return false;
+        }
+        position.placePiece(row, col, player);
+        player = player == PieceType::BLACK ? PieceType::WHITE : PieceType::BLACK;
+    }
+    return true;
+}
+
+QString winnerName(PieceType winner)
+{
+    switch (winner) {
+    case PieceType::BLACK: return "黑胜";
+    case PieceType::WHITE: return "白胜";
+    default: return "未分胜负";
+    }
+}
+
+QString percent(int part, int whole)
+{
+    return whole > 0 ? QString::number(100.0 * part / whole, 'f', 1) + "%" : QString("-");
+}
+
+} // namespace
+
+int Tools::dbBuild(const QStringList& args)
+{
+    QCommandLineParser parser;
+    parser.setApplicationDescription("从存档目录构建棋谱数据库");
+    parser.addHelpOption();
+    QCommandLineOption outputOption({"o", "output"}, "输出的数据库文件", "file", "games.gmdb");
+    QCommandLineOption threadsOption("threads", "线程数（0为全部硬件线程）", "n", "0");
+    QCommandLineOption maxPlyOption("max-ply", "只为前n步建索引（0为全部）", "n", "0");
+    parser.addOption(outputOption);
+    parser.addOption(threadsOption);
+    parser.addOption(maxPlyOption);
+    parser.addPositionalArgument("paths", "存档文件或目录（递归搜索 *.gomoku 和 *.gmkr）", "<路径...>");
+    parser.process(args);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+    const QStringList paths = parser.positionalArguments();
+    if (paths.isEmpty()) {
+        err << "至少需要一个存档文件或目录\n";
+        return 1;
+    }
+
+    GameDatabaseBuilder builder;
+    for (const QString& path : paths) {
+        builder.addPath(path);
+    }
+    builder.setThreadCount(parser.value(threadsOption).toInt());
+    builder.setMaxPly(parser.value(maxPlyOption).toInt());
+
+    QElapsedTimer timer;
+    timer.start();
+    GameDatabaseBuilder::Stats stats;
+    if (!builder.build(parser.value(outputOption), &stats)) {
+        err << builder.errorString() << "\n";
+        return 1;
+    }
+    const double seconds = timer.nsecsElapsed() / 1e9;
+
+    out << QString("文件 %1 个（%2 个无法读取），对局 %3 局（跳过 %4 局非法对局）\n")
+               .arg(stats.files).arg(stats.failedFiles).arg(stats.games).arg(stats.rejected);
+    out << QString("索引 %1 个局面，%2 条记录，文件 %3 MB\n")
+               .arg(stats.positions).arg(stats.postings)
+               .arg(stats.bytes / (1024.0 * 1024.0), 0, 'f', 2);
+    out << QString("耗时 %1 秒，%2 局/秒\n")
+               .arg(seconds, 0, 'f', 2)
+               .arg(seconds > 0 ? stats.games / seconds : 0.0, 0, 'f', 0);
+    return 0;
+}
+
+int Tools::dbQuery(const QStringList& args)
+{
+    QCommandLineParser parser;
+    parser.setApplicationDescription("在棋谱数据库中查询局面（含对称局面）");
+    parser.addHelpOption();
+    QCommandLineOption dbOption({"d", "db"}, "数据库文件", "file", "games.gmdb");
+    QCommandLineOption movesOption("moves", "局面的着法序列，如\"7,7 8,8\"（行,列，黑先）", "moves");
+    QCommandLineOption saveOption("save", "从存档读取局面", "file");
+    QCommandLineOption plyOption("ply", "只取存档的前n步（默认全部）", "n", "-1");
+    QCommandLineOption gamesOption("games", "最多列出的对局数", "n", "10");
+    QCommandLineOption topOption("top", "最多列出的下一步", "n", "10");
+    parser.addOption(dbOption);
+    parser.addOption(movesOption);
+    parser.addOption(saveOption);
+    parser.addOption(plyOption);
+    parser.addOption(gamesOption);
+    parser.addOption(topOption);
+    parser.process(args);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    Position position;
+    if (parser.isSet(saveOption)) {
+        GameSave::SaveData data;
+        if (!GameSave::loadGame(parser.value(saveOption), data)) {
+            err << "无法读取存档 " << parser.value(saveOption) << "\n";
+            return 1;
+        }
+        const int ply = parser.value(plyOption).toInt();
+        const size_t count = ply < 0 ? data.history.size()
+                                     : std::min(data.history.size(), static_cast<size_t>(ply));
+        for (size_t i = 0; i < count; ++i) {
+            const auto& move = data.history[i];
+            if (move.row < 0 || move.row >= Position::SIZE || move.col < 0 || move.col >= Position::SIZE ||
+                (move.player != PieceType::BLACK && move.player != PieceType::WHITE) ||
+                position.getPiece(move.row, move.col) != PieceType::NONE) {
+                err << QString("存档 %1 第 %2 步无效: %3,%4\n")
+                           .arg(parser.value(saveOption)).arg(i + 1).arg(move.row).arg(move.col);
+                return 1;
+            }
+            position.placePiece(move.row, move.col, move.player);
+        }
+    } else {
+        QString error;
+        if (!parseMoves(parser.value(movesOption), position, error)) {
+            err << error << "\n";
+            return 1;
+        }
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    GameDatabase database;
+    if (!database.open(parser.value(dbOption))) {
+        err << database.errorString() << "\n";
+        return 1;
+    }
+    const qint64 openNs = timer.nsecsElapsed();
+
+    timer.start();
+    const auto result = database.find(position, parser.value(gamesOption).toInt());
+    const qint64 queryNs = timer.nsecsElapsed();
+
+    out << QString("数据库: %1 局，%2 个局面\n").arg(database.gameCount()).arg(database.positionCount());
+    if (database.maxPly() > 0 && position.getStoneCount() > database.maxPly()) {
+        out << QString("注意: 数据库只索引了前 %1 步\n").arg(database.maxPly());
+    }
+    out << QString("匹配 %1 局（%2 局在此结束），打开 %3 ms，查询 %4 ms\n")
+               .arg(result.totalGames).arg(result.endedHere)
+               .arg(openNs / 1e6, 0, 'f', 3).arg(queryNs / 1e6, 0, 'f', 3);
+
+    const int top = std::min<int>(parser.value(topOption).toInt(), static_cast<int>(result.nextMoves.size()));
+    if (top > 0) {
+        out << "\n下一步     次数    占比    黑胜    白胜\n";
+        for (int i = 0; i < top; ++i) {
+            const auto& stat = result.nextMoves[i];
+            out << QString("%1,%2").arg(stat.row).arg(stat.col).leftJustified(8)
+                << QString::number(stat.count).rightJustified(7)
+                << percent(stat.count, static_cast<int>(result.totalGames - result.endedHere)).rightJustified(8)
+                << percent(stat.blackWins, stat.count).rightJustified(8)
+                << percent(stat.whiteWins, stat.count).rightJustified(8) << "\n";
+        }
+    }
+
+    if (!result.games.empty()) {
+        out << "\n对局       步数  总步数  结果\n";
+        GameRecord record;
+        for (const auto& hit : result.games) {
+            const int length = database.game(hit.gameId, record) ? static_cast<int>(record.moves.size()) : -1;
+            out << QString::number(hit.gameId).leftJustified(10)
+                << QString::number(hit.ply).rightJustified(5)
+                << QString::number(length).rightJustified(8) << "  "
+                << winnerName(database.winner(hit.gameId)) << "\n";
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,76 @@
+#include <QCoreApplication>
+#include <QTextStream>
+#include "tools.h"
+#include "pattern_weights.h"
+#include "profiler.h"
+
+namespace {
+
+/**
+ * @brief 子命令表
+ */
+struct Command {
+    const char* name;                     ///< 子命令名
+    int (*run)(const QStringList& args);  ///< 入口函数
+    const char* description;              ///< 说明
+};
+
+const Command COMMANDS[] = {
+    {"bench-records", Tools::benchRecords, "二进制棋谱读写吞吐量基准"},
+    {"bench-journal", Tools::benchJournal, "自动保存日志每步写入耗时基准"},
+    {"db-build", Tools::dbBuild, "从存档目录构建棋谱数据库"},
+    {"db-query", Tools::dbQuery, "在棋谱数据库中查询局面"},
+    {"analyze", Tools::analyzeGames, "批量分析存档，标出最佳着法和败着"},
+    {"verify-kernels", Tools::verifyKernels, "对照参考实现检查优化内核并报告加速比"},
+    {"bench-opening", Tools::benchOpening, "开局对称规范化的置换表命中率和用时基准"},
+    {"tune-weights", Tools::tuneWeights, "从对局存档拟合棋型评估的权重"},
+    {"serve", Tools::serve, "本地引擎服务，多局对局共用搜索线程池"},
+    {"bench-server", Tools::benchServer, "引擎服务并发压测（走子延迟p50/p99和吞吐量）"},
+    {"batch-eval", Tools::batchEval, "批量评估文件中的局面（静态评估或定深搜索）"},
+    {"selfplay", Tools::selfPlay, "多线程自我对弈，生成分块压缩的训练数据"},
+    {"book-build", Tools::bookBuild, "用drop-out展开建立或扩展开局库"},
+    {"book-query", Tools::bookQuery, "在开局库中查询局面"},
+};
+
+int printUsage(QTextStream& out)
+{
+    out << "用法: AIGomokuTool <子命令> [选项]\n\n子命令:\n";
+    for (const auto& command : COMMANDS) {
+        out << "  " << QString(command.name).leftJustified(16) << command.description << "\n";
+    }
+    out << "\n使用 AIGomokuTool <子命令> --help 查看子命令的选项\n";
+    return 1;
+}
+
+} // namespace
+
+/**
+ * @brief 无界面命令行工具入口
+ */
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("AIGomokuTool");
+    PatternWeights::loadStartupFile();
+
+    QTextStream err(stderr);
+    QStringList args = QCoreApplication::arguments();
+    if (args.size() < 2) {
+        return printUsage(err);
+    }
+
+    const QString name = args.at(1);
+    for (const auto& command : COMMANDS) {
+        if (name == command.name) {
+            // 把"程序名 子命令"合并为子命令参数的第一个元素
+            QStringList commandArgs = args.mid(2);
+            commandArgs.prepend(args.at(0) + " " + name);
+            const int code = command.run(commandArgs);
+            Profiler::writeRequestedTrace();
+            return code;
+        }
+    }
+
+    err << "未知子命令: " << name << "\n\n";
+    return printUsage(err);
+}
@@ -0,0 +1,154 @@
+#include "tools.h"
+#include "self_play.h"
+#include "training_data.h"
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTextStream>
+#include <algorithm>
+#include <thread>
+
+int Tools::selfPlay(const QStringList& args)
+{
+    QCommandLineParser parser;
+    parser.setApplicationDescription("自我对弈生成训练数据：多线程对局，记录每个搜索过的局面的分数、最佳着法和最终胜负，\n"
+                                     "分块压缩写入.gmsp文件（格式见training_data.h）");
+    parser.addHelpOption();
+    QCommandLineOption outputOption({"o", "output"}, "输出文件", "file");
+    QCommandLineOption gamesOption("games", "对局数", "n", "100");
+    QCommandLineOption depthOption("depth", "每步搜索深度", "n", "4");
+    QCommandLineOption nodesOption("nodes", "每步节点上限，0为不限", "n", "0");
+    QCommandLineOption moveTimeOption("movetime", "每步用时上限（毫秒），0为不限（不限时结果可复现）", "ms", "0");
+    QCommandLineOption evaluatorOption("evaluator", "评估函数（Pattern/NNUE）", "name", "Pattern");
+    QCommandLineOption threadsOption("threads", "线程数（0为全部硬件线程）", "n", "0");
+    QCommandLineOption hashOption("hash", "每个线程的置换表大小（MB）", "mb", "16");
+    QCommandLineOption randomPliesOption("random-plies", "随机开局的步数", "n", "6");
+    QCommandLineOption maxPliesOption("max-plies", "每局最多步数，到达时判和", "n", "225");
+    QCommandLineOption seedOption("seed", "随机开局的种子", "n", "1");
+    QCommandLineOption chunkOption("chunk", "每块的样本数", "n", "4096");
+    QCommandLineOption appendOption("append", "追加到已有文件（应换用不同的--seed）");
+    parser.addOption(outputOption);
+    parser.addOption(gamesOption);
+    parser.addOption(depthOption);
+    parser.addOption(nodesOption);
+    parser.addOption(moveTimeOption);
+    parser.addOption(evaluatorOption);
+    parser.addOption(threadsOption);
+    parser.addOption(hashOption);
+    parser.addOption(randomPliesOption);
+    parser.addOption(maxPliesOption);
+    parser.addOption(seedOption);
+    parser.addOption(chunkOption);
+    parser.addOption(appendOption);
+    parser.process(args);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+    if (!parser.isSet(outputOption)) {
+        err << "需要用-o指定输出文件\n";
+        return 1;
+    }
+
+    // 追加时先检查已有文件的格式
+    const QString path = parser.value(outputOption);
+    QFile file(path);
+    bool writeHeader = true;
+    if (parser.isSet(appendOption) && file.exists() && file.size() > 0) {
+        if (!file.open(QIODevice::ReadOnly)) {
+            err << "无法读取 " << path << "\n";
+            return 1;
+        }
+        TrainingDataReader reader(&file);
+        std::vector<TrainingSample> samples;
+        long long existing = 0;
+        while (reader.readChunk(samples)) {
+            existing += static_cast<long long>(samples.size());
+        }
+        file.close();
+        if (reader.hasError() || reader.isTruncated()) {
+            err << path << ": " << (reader.hasError() ? reader.errorString() : QString("末尾有不完整的块"))
+                << "，不能追加\n";
+            return 1;
+        }
+        out << QString("%1 已有 %2 个样本\n").arg(path).arg(existing);
+        writeHeader = false;
+    }
+    if (!file.open(writeHeader ? QIODevice::WriteOnly | QIODevice::Truncate : QIODevice::WriteOnly | QIODevice::Append)) {
+        err << "无法写入 " << path << "\n";
+        return 1;
+    }
+
+    SelfPlayGenerator::Options options;
+    options.evaluator = parser.value(evaluatorOption);
+    options.depth = std::clamp(parser.value(depthOption).toInt(), 1, 40);
+    options.maxNodes = std::max(0LL, parser.value(nodesOption).toLongLong());
+    options.moveTimeMs = std::max(0, parser.value(moveTimeOption).toInt());
+    options.threads = std::max(0, parser.value(threadsOption).toInt());
+    options.tableMB = std::max(1, parser.value(hashOption).toInt());
+    options.randomPlies = std::max(0, parser.value(randomPliesOption).toInt());
+    options.maxPlies = std::clamp(parser.value(maxPliesOption).toInt(), 1, 225);
+    options.seed = parser.value(seedOption).toUInt();
+    options.chunkSamples = static_cast<size_t>(std::max(1, parser.value(chunkOption).toInt()));
+    SelfPlayGenerator generator(options);
+    if (!generator.isValid()) {
+        err << generator.errorString() << "\n";
+        return 1;
+    }
+
+    const long long games = std::max(1LL, parser.value(gamesOption).toLongLong());
+    out << QString("%1 局，%2 线程，深度 %3，随机开局 %4 步，种子 %5\n")
+               .arg(games)
+               .arg(generator.threadCount())
+               .arg(options.depth)
+               .arg(options.randomPlies)
+               .arg(options.seed);
+    out.flush();
+
+    // 进度每秒最多打印一次
+    QElapsedTimer progressTimer;
+    progressTimer.start();
+    auto progress = [&](const SelfPlayGenerator::Stats& stats) {
+        if (progressTimer.elapsed() < 1000 && stats.games < games) {
+            return;
+        }
+        progressTimer.restart();
+        err << QString("\r%1/%2 局，%3 个局面，%4 局面/秒")
+                   .arg(stats.games)
+                   .arg(games)
+                   .arg(stats.positions)
+                   .arg(stats.seconds > 0 ? stats.positions / stats.seconds : 0.0, 0, 'f', 0);
+        err.flush();
+    };
+
+    TrainingDataWriter writer(&file, writeHeader, options.chunkSamples);
+    const SelfPlayGenerator::Stats stats = generator.run(games, writer, progress);
+    const bool written = writer.flush();
+    file.close();
+    err << "\n";
+    if (!written) {
+        err << "写入 " << path << " 失败\n";
+        return 1;
+    }
+
+    out << QString("完成 %1 局（黑胜 %2，白胜 %3，和 %4），%5 个局面，用时 %6 s\n")
+               .arg(stats.games)
+               .arg(stats.blackWins)
+               .arg(stats.whiteWins)
+               .arg(stats.draws)
+               .arg(stats.positions)
+               .arg(stats.seconds, 0, 'f', 2);
+    // 线程数超过硬件线程数时按实际可用的核数折算
+    const int cores = std::max(1, std::min(stats.threads, static_cast<int>(std::thread::hardware_concurrency())));
+    const double perSecond = stats.seconds > 0 ? stats.positions / stats.seconds : 0.0;
+    out << QString("吞吐量 %1 局面/秒，每核 %2 局面/秒（%3 线程，%4 核），%5 节点/秒\n")
+               .arg(perSecond, 0, 'f', 0)
+               .arg(perSecond / cores, 0, 'f', 1)
+               .arg(stats.threads)
+               .arg(cores)
+               .arg(stats.seconds > 0 ? stats.nodes / stats.seconds : 0.0, 0, 'f', 0);
+    out << QString("写入 %1 字节，每个局面 %2 字节（未压缩 %3 字节）\n")
+               .arg(writer.bytesWritten())
+               .arg(writer.count() > 0 ? static_cast<double>(writer.bytesWritten()) / writer.count() : 0.0, 0, 'f', 1)
+               .arg(sizeof(TrainingSample));
+    return 0;
+}
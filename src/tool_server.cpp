@@ -0,0 +1,363 @@
+#include "tools.h"
+#include "engine_server.h"
+#include "memory_budget.h"
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QHostAddress>
+#include <QLocalSocket>
+#include <QMetaObject>
+#include <QTcpSocket>
+#include <QTextStream>
+#include <QTimer>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr int IO_TIMEOUT_MS = 60000;
+
+/**
+ * @brief 压测客户端的一条阻塞连接（在各自的线程上使用，不需要事件循环）
+ */
+class BlockingClient {
+public:
+    /**
+     * @brief 连接本地套接字name，port大于0时改为连接127.0.0.1:port
+     */
+    bool connect(const QString& name, int port)
+    {
+        if (port > 0) {
+            auto socket = std::make_unique<QTcpSocket>();
+            socket->connectToHost(QHostAddress::LocalHost, static_cast<quint16>(port));
+            if (!socket->waitForConnected(IO_TIMEOUT_MS)) {
+                return false;
+            }
+            socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+            device_ = std::move(socket);
+        } else {
+            auto socket = std::make_unique<QLocalSocket>();
+            socket->connectToServer(name);
+            if (!socket->waitForConnected(IO_TIMEOUT_MS)) {
+                return false;
+            }
+            device_ = std::move(socket);
+        }
+        return true;
+    }
+
+    /**
+     * @brief 发送一行命令并等待一行回复
+     * @return 未连接、连接出错或超时时返回false
+     */
+    bool request(const QString& line, QString& reply)
+    {
+        if (!device_) {
+            return false;
+        }
+        device_->write((line + "\n").toUtf8());
+        if (!device_->waitForBytesWritten(IO_TIMEOUT_MS)) {
+            return false;
+        }
+        while (!device_->canReadLine()) {
+            if (!device_->waitForReadyRead(IO_TIMEOUT_MS)) {
+                return false;
+            }
+        }
+        reply = QString::fromUtf8(device_->readLine()).trimmed();
+        return true;
+    }
+
+private:
+    std::unique_ptr<QIODevice> device_;
+};
+
+/**
+ * @brief 压测参数
+ */
+struct BenchConfig {
+    QString socketName;
+    int port = 0;
+    int games = 4;        ///< 每个客户端依次下的局数
+    int moveTimeMs = 50;
+    int maxPlies = 40;    ///< 每局最多由AI走的步数
+    unsigned seed = 1;
+};
+
+/**
+ * @brief 一个客户端的结果
+ */
+struct ClientResult {
+    std::vector<long long> latenciesUs;  ///< 每个go请求的往返延迟
+    int games = 0;
+    int errors = 0;
+    QString firstError;
+};
+
+void fail(ClientResult& result, const QString& message)
+{
+    if (result.errors++ == 0) {
+        result.firstError = message;
+    }
+}
+
+/**
+ * @brief 一个客户端：依次新建对局、随机走两步开局，然后让服务端双方轮流走到分出胜负或达到步数
+ */
+void runClient(const BenchConfig& config, int index, ClientResult& result)
+{
+    BlockingClient client;
+    if (!client.connect(config.socketName, config.port)) {
+        fail(result, "无法连接服务端");
+        return;
+    }
+    std::mt19937 rng(config.seed * 7919u + static_cast<unsigned>(index));
+    QString reply;
+    for (int game = 0; game < config.games; ++game) {
+        if (!client.request(QString("new %1").arg(config.moveTimeMs), reply) || !reply.startsWith("ok ")) {
+            fail(result, reply);
+            return;
+        }
+        const QString id = reply.mid(3);
+
+        // 各局开局不同，避免所有搜索完全相同
+        const int row = 5 + static_cast<int>(rng() % 5);
+        const int col = 5 + static_cast<int>(rng() % 5);
+        const int nextRow = row + static_cast<int>(rng() % 3) - 1;
+        const int nextCol = nextRow == row ? col + 1 : col + static_cast<int>(rng() % 3) - 1;
+        client.request(QString("move %1 %2 %3").arg(id).arg(row).arg(col), reply);
+        client.request(QString("move %1 %2 %3").arg(id).arg(nextRow).arg(nextCol), reply);
+
+        for (int ply = 0; ply < config.maxPlies; ++ply) {
+            QElapsedTimer timer;
+            timer.start();
+            if (!client.request(QString("go %1").arg(id), reply)) {
+                fail(result, "等待bestmove超时");
+                return;
+            }
+            if (!reply.startsWith("bestmove ")) {
+                fail(result, reply);
+                break;
+            }
+            result.latenciesUs.push_back(timer.nsecsElapsed() / 1000);
+            if (reply.endsWith(" win")) {
+                break;
+            }
+        }
+        client.request(QString("free %1").arg(id), reply);
+        ++result.games;
+    }
+    client.request("quit", reply);
+}
+
+double percentileMs(std::vector<long long>& samples, double fraction)
+{
+    if (samples.empty()) {
+        return 0.0;
+    }
+    const size_t index = std::min(samples.size() - 1, static_cast<size_t>(fraction * samples.size()));
+    std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+    return samples[index] / 1000.0;
+}
+
+} // namespace
+
+int Tools::serve(const QStringList& args)
+{
+    QCommandLineParser parser;
+    parser.setApplicationDescription("本地引擎服务：在套接字上接受按行分隔的命令，多局对局共用搜索线程池"
+                                     "（协议见engine_server.h）");
+    parser.addHelpOption();
+    QCommandLineOption socketOption("socket", "本地套接字名称", "name", "gomoku-engine");
+    QCommandLineOption portOption("port", "改为在127.0.0.1的TCP端口上监听", "port");
+    QCommandLineOption threadsOption("threads", "搜索线程数（0为全部硬件线程）", "n", "0");
+    QCommandLineOption hashOption("hash", "每局置换表大小（MB）", "mb", "4");
+    QCommandLineOption evaluatorOption("evaluator", "评估函数（Pattern/NNUE）", "name", "Pattern");
+    QCommandLineOption moveTimeOption("movetime", "默认每步思考时间（毫秒）", "ms", "200");
+    QCommandLineOption maxGamesOption("max-games", "同时存在的对局数上限", "n", "1024");
+    QCommandLineOption sliceOption("slice-nodes", "每个搜索任务推进的节点数，用完后让给其他对局", "n", "20000");
+    QCommandLineOption statsOption("stats-interval", "每隔多少秒打印一次统计，0为不打印", "s", "0");
+    QCommandLineOption memoryOption("memory-mb", "引擎内存预算（MB），默认取GOMOKU_MEMORY_MB或512", "mb");
+    parser.addOption(socketOption);
+    parser.addOption(portOption);
+    parser.addOption(threadsOption);
+    parser.addOption(hashOption);
+    parser.addOption(evaluatorOption);
+    parser.addOption(moveTimeOption);
+    parser.addOption(maxGamesOption);
+    parser.addOption(sliceOption);
+    parser.addOption(statsOption);
+    parser.addOption(memoryOption);
+    parser.process(args);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+    if (parser.isSet(memoryOption)) {
+        MemoryBudget::setLimitMB(static_cast<size_t>(std::max(1, parser.value(memoryOption).toInt())));
+    }
+    EngineServer::Options options;
+    options.threads = std::max(0, parser.value(threadsOption).toInt());
+    options.tableMB = std::max(1, parser.value(hashOption).toInt());
+    options.evaluator = parser.value(evaluatorOption);
+    options.moveTimeMs = std::max(1, parser.value(moveTimeOption).toInt());
+    options.maxGames = std::max(1, parser.value(maxGamesOption).toInt());
+    options.sliceNodes = std::max(1LL, parser.value(sliceOption).toLongLong());
+    EngineServer server(options);
+
+    const bool listening = parser.isSet(portOption)
+        ? server.listenTcp(static_cast<quint16>(parser.value(portOption).toUInt()))
+        : server.listenLocal(parser.value(socketOption));
+    if (!listening) {
+        err << "无法监听: " << server.errorString() << "\n";
+        return 1;
+    }
+    out << QString("监听 %1，搜索线程 %2，每局置换表 %3 MB，默认每步 %4 ms，内存预算 %5 MB\n")
+               .arg(server.address())
+               .arg(server.stats().threads)
+               .arg(options.tableMB)
+               .arg(options.moveTimeMs)
+               .arg(MemoryBudget::limitBytes() / (1024 * 1024));
+    out.flush();
+
+    QTimer statsTimer;
+    const int interval = parser.value(statsOption).toInt();
+    if (interval > 0) {
+        QObject::connect(&statsTimer, &QTimer::timeout, &server, [&server, &out]() {
+            out << EngineServer::formatStats(server.stats()) << "\n";
+            out.flush();
+        });
+        statsTimer.start(interval * 1000);
+    }
+    return QCoreApplication::exec();
+}
+
+int Tools::benchServer(const QStringList& args)
+{
+    QCommandLineParser parser;
+    parser.setApplicationDescription("引擎服务压测：多个客户端并发对局，统计走子延迟的p50/p99和吞吐量；"
+                                     "不指定--connect/--port时在本进程内启动服务端");
+    parser.addHelpOption();
+    QCommandLineOption connectOption("connect", "连接已运行的服务端（本地套接字名称）", "name");
+    QCommandLineOption portOption("port", "连接已运行的服务端（127.0.0.1的TCP端口）", "port");
+    QCommandLineOption clientsOption("clients", "并发客户端数", "n", "16");
+    QCommandLineOption gamesOption("games", "每个客户端依次下的局数", "n", "4");
+    QCommandLineOption moveTimeOption("movetime", "每步思考时间（毫秒）", "ms", "50");
+    QCommandLineOption maxPliesOption("max-plies", "每局最多由AI走的步数", "n", "40");
+    QCommandLineOption seedOption("seed", "随机开局的种子", "n", "1");
+    QCommandLineOption threadsOption("threads", "内置服务端的搜索线程数（0为全部硬件线程）", "n", "0");
+    QCommandLineOption hashOption("hash", "内置服务端每局置换表大小（MB）", "mb", "4");
+    QCommandLineOption evaluatorOption("evaluator", "内置服务端的评估函数（Pattern/NNUE）", "name", "Pattern");
+    parser.addOption(connectOption);
+    parser.addOption(portOption);
+    parser.addOption(clientsOption);
+    parser.addOption(gamesOption);
+    parser.addOption(moveTimeOption);
+    parser.addOption(maxPliesOption);
+    parser.addOption(seedOption);
+    parser.addOption(threadsOption);
+    parser.addOption(hashOption);
+    parser.addOption(evaluatorOption);
+    parser.process(args);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+    const int clients = std::max(1, parser.value(clientsOption).toInt());
+    BenchConfig config;
+    config.games = std::max(1, parser.value(gamesOption).toInt());
+    config.moveTimeMs = std::max(1, parser.value(moveTimeOption).toInt());
+    config.maxPlies = std::max(1, parser.value(maxPliesOption).toInt());
+    config.seed = parser.value(seedOption).toUInt();
+
+    std::unique_ptr<EngineServer> server;
+    if (parser.isSet(portOption)) {
+        config.port = parser.value(portOption).toInt();
+    } else if (parser.isSet(connectOption)) {
+        config.socketName = parser.value(connectOption);
+    } else {
+        EngineServer::Options options;
+        options.threads = std::max(0, parser.value(threadsOption).toInt());
+        options.tableMB = std::max(1, parser.value(hashOption).toInt());
+        options.evaluator = parser.value(evaluatorOption);
+        options.maxGames = clients;
+        server = std::make_unique<EngineServer>(options);
+        config.socketName = QString("gomoku-bench-%1").arg(QCoreApplication::applicationPid());
+        if (!server->listenLocal(config.socketName)) {
+            err << "无法启动内置服务端: " << server->errorString() << "\n";
+            return 1;
+        }
+    }
+    out << QString("客户端 %1 个，每个 %2 局，每步 %3 ms，每局最多 %4 步%5\n")
+               .arg(clients)
+               .arg(config.games)
+               .arg(config.moveTimeMs)
+               .arg(config.maxPlies)
+               .arg(server ? QString("，内置服务端 %1 个搜索线程").arg(server->stats().threads) : QString());
+    out.flush();
+
+    // 客户端在各自线程上阻塞收发；内置服务端在主线程的事件循环中运行，最后一个客户端结束时退出循环
+    std::vector<ClientResult> results(clients);
+    std::vector<std::thread> threads;
+    std::atomic<int> running(clients);
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < clients; ++i) {
+        threads.emplace_back([&, i]() {
+            runClient(config, i, results[i]);
+            if (--running == 0 && server) {
+                QMetaObject::invokeMethod(QCoreApplication::instance(), []() { QCoreApplication::quit(); },
+                                          Qt::QueuedConnection);
+            }
+        });
+    }
+    if (server) {
+        QCoreApplication::exec();
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    const double seconds = timer.nsecsElapsed() / 1e9;
+
+    std::vector<long long> latencies;
+    int games = 0;
+    int errors = 0;
+    for (const auto& result : results) {
+        latencies.insert(latencies.end(), result.latenciesUs.begin(), result.latenciesUs.end());
+        games += result.games;
+        if (result.errors > 0 && errors == 0) {
+            err << "客户端错误: " << result.firstError << "\n";
+        }
+        errors += result.errors;
+    }
+    const long long maxUs = latencies.empty() ? 0 : *std::max_element(latencies.begin(), latencies.end());
+    out << QString("完成 %1 局 %2 步，用时 %3 s，吞吐量 %4 步/秒，错误 %5 次\n")
+               .arg(games)
+               .arg(latencies.size())
+               .arg(seconds, 0, 'f', 2)
+               .arg(seconds > 0 ? latencies.size() / seconds : 0.0, 0, 'f', 1)
+               .arg(errors);
+    out << QString("走子延迟（客户端往返）p50 %1 ms，p99 %2 ms，最大 %3 ms\n")
+               .arg(percentileMs(latencies, 0.50), 0, 'f', 1)
+               .arg(percentileMs(latencies, 0.99), 0, 'f', 1)
+               .arg(maxUs / 1000.0, 0, 'f', 1);
+
+    if (server) {
+        out << "服务端: " << EngineServer::formatStats(server->stats()) << "\n";
+        out << MemoryBudget::report();
+    } else {
+        BlockingClient client;
+        QString reply;
+        if (client.connect(config.socketName, config.port)) {
+            if (client.request("stats", reply)) {
+                out << "服务端: " << reply << "\n";
+            }
+            if (client.request("memory", reply)) {
+                out << "服务端: " << reply << "\n";
+            }
+        }
+    }
+    return errors > 0 ? 1 : 0;
+}
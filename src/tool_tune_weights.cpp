@@ -0,0 +1,94 @@
+#include "tools.h"
+#include "weight_tuner.h"
+#include <QCommandLineParser>
+#include <QTextStream>
+#include <algorithm>
+
+int Tools::tuneWeights(const QStringList& args)
+{
+    QCommandLineParser parser;
+    parser.setApplicationDescription("从对局存档拟合棋型评估的权重（Texel方法），写出启动时加载的权重文件");
+    parser.addHelpOption();
+    const WeightTuner::Options defaults;
+    QCommandLineOption outputOption({"o", "output"}, "输出的权重文件", "file", "pattern_weights.json");
+    QCommandLineOption threadsOption("threads", "线程数（0为全部硬件线程）", "n", "0");
+    QCommandLineOption epochsOption("epochs", "梯度下降轮数", "n", QString::number(defaults.epochs));
+    QCommandLineOption rateOption("rate", "学习率（对数空间）", "x", QString::number(defaults.learningRate));
+    QCommandLineOption minPlyOption("min-ply", "跳过每局开始的步数", "n", QString::number(defaults.minPly));
+    QCommandLineOption validationOption("validation-every", "每隔多少局取一局作验证集（0为不留）", "n",
+                                        QString::number(defaults.validationEvery));
+    QCommandLineOption defaultsOption("from-defaults", "从默认权重开始（否则从当前加载的权重文件开始）");
+    parser.addOption(outputOption);
+    parser.addOption(threadsOption);
+    parser.addOption(epochsOption);
+    parser.addOption(rateOption);
+    parser.addOption(minPlyOption);
+    parser.addOption(validationOption);
+    parser.addOption(defaultsOption);
+    parser.addPositionalArgument("paths", "存档文件、目录（递归搜索 *.gomoku 和 *.gmkr）或通配符", "<路径...>");
+    parser.process(args);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+    const QStringList paths = parser.positionalArguments();
+    if (paths.isEmpty()) {
+        err << "至少需要一个存档文件或目录\n";
+        return 1;
+    }
+
+    WeightTuner::Options options;
+    options.epochs = std::max(0, parser.value(epochsOption).toInt());
+    options.learningRate = parser.value(rateOption).toDouble();
+    options.minPly = std::max(0, parser.value(minPlyOption).toInt());
+    options.validationEvery = std::max(0, parser.value(validationOption).toInt());
+
+    WeightTuner tuner;
+    for (const QString& path : paths) {
+        tuner.addPath(path);
+    }
+    tuner.setThreadCount(parser.value(threadsOption).toInt());
+    tuner.setOptions(options);
+    tuner.setProgress([&out, &options](int epoch, double trainLoss, double validationLoss) {
+        if (epoch % 25 == 0 || epoch == options.epochs) {
+            out << QString("  第 %1 轮: 训练误差 %2，验证误差 %3\n")
+                       .arg(epoch).arg(trainLoss, 0, 'f', 6).arg(validationLoss, 0, 'f', 6);
+            out.flush();
+        }
+    });
+
+    const PatternWeights initial = parser.isSet(defaultsOption) ? PatternWeights() : PatternWeights::active();
+    PatternWeights tuned;
+    WeightTuner::Report report;
+    if (!tuner.run(initial, tuned, &report)) {
+        err << tuner.errorString() << "\n";
+        return 1;
+    }
+
+    out << QString("存档 %1 个（%2 个无法读取），对局 %3 局（%4 局未分胜负或着法非法，已跳过）\n")
+               .arg(report.files).arg(report.failedFiles).arg(report.games).arg(report.unfinishedGames);
+    out << QString("训练局面 %1，验证局面 %2，提取用时 %3 ms，调参用时 %4 ms，K = %5\n")
+               .arg(report.trainPositions).arg(report.validationPositions)
+               .arg(report.extractMs).arg(report.tuneMs)
+               .arg(report.scale, 0, 'g', 4);
+    out << QString("训练误差 %1 -> %2，验证误差 %3 -> %4\n")
+               .arg(report.trainLossBefore, 0, 'f', 6).arg(report.trainLossAfter, 0, 'f', 6)
+               .arg(report.validationLossBefore, 0, 'f', 6).arg(report.validationLossAfter, 0, 'f', 6);
+    for (int shape = 0; shape < PatternWeights::SHAPE_COUNT; ++shape) {
+        out << QString("  %1 %2 -> %3\n")
+                   .arg(QString(PatternWeights::shapeName(shape)).leftJustified(14))
+                   .arg(initial.values[shape], 6)
+                   .arg(tuned.values[shape], 6);
+    }
+    out << QString("  %1 %2 -> %3\n")
+               .arg(QString("gap").leftJustified(14))
+               .arg(static_cast<double>(initial.gapNumerator) / initial.gapDenominator, 6, 'f', 3)
+               .arg(static_cast<double>(tuned.gapNumerator) / tuned.gapDenominator, 6, 'f', 3);
+
+    QString error;
+    if (!tuned.save(parser.value(outputOption), &error)) {
+        err << "无法写入 " << parser.value(outputOption) << ": " << error << "\n";
+        return 1;
+    }
+    out << QString("权重已写入 %1（放在程序目录下或用GOMOKU_WEIGHTS_FILE指定）\n").arg(parser.value(outputOption));
+    return 0;
+}
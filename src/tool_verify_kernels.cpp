@@ -0,0 +1,645 @@
+#include "tools.h"
+#include "bitboard.h"
+#include "line_kernel.h"
+#include "pattern_evaluator.h"
+#include "position.h"
+#include "reference_kernels.h"
+#include "rule_based_ai.h"
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using ReferenceKernels::BoardState;
+
+const int SIZE = Position::SIZE;
+const int CELLS = Position::CELLS;
+const int CASES_PER_BLOCK = 64;        ///< 每个任务块的局面数（自我对弈时为同一局的不同阶段）
+const int MAX_RANDOM_STONES = 100;     ///< 随机局面的最多棋子数
+const int MAX_LEAF_MOVES = 4;          ///< 叶局面比根局面最多多出的步数
+const int DIRECTIONS[4][2] = {{1, 0}, {0, 1}, {1, 1}, {1, -1}};
+const int AXES[LineKernel::AXIS_COUNT][2] = {{0, 1}, {1, 0}, {1, 1}, {1, -1}};  ///< 与LineKernel::Axis对应
+const PieceType COLORS[2] = {PieceType::BLACK, PieceType::WHITE};
+
+/**
+ * @brief 一个测试局面：按顺序落下的棋子
+ */
+struct Case {
+    std::vector<Move> moves;              ///< 着法（含颜色）
+    int rootPly = 0;                      ///< 前rootPly步构成根局面（评估时的位置价值按它统计）
+    PieceType toMove = PieceType::BLACK;  ///< 轮到的一方
+};
+
+/**
+ * @brief 由Case生成的各种局面表示（不计入内核用时）
+ */
+struct Prepared {
+    BoardState root;
+    BoardState leaf;
+    BitBoard bits;
+    Position position;
+    mutable PatternEvaluator pattern;  ///< 已按根局面reset
+    PieceType toMove = PieceType::BLACK;
+};
+
+void prepare(const Case& c, Prepared& p)
+{
+    p.root.assign(SIZE, std::vector<PieceType>(SIZE, PieceType::NONE));
+    p.bits.clear();
+    p.position.clear();
+    for (size_t i = 0; i < c.moves.size(); ++i) {
+        const Move& move = c.moves[i];
+        if (static_cast<int>(i) == c.rootPly) {
+            p.root = p.position.getBoardState();
+        }
+        p.bits.set(move.row, move.col, move.player);
+        p.position.placePiece(move.row, move.col, move.player);
+    }
+    p.leaf = p.position.getBoardState();
+    if (c.rootPly >= static_cast<int>(c.moves.size())) {
+        p.root = p.leaf;
+    }
+    p.pattern.reset(p.root);
+    p.toMove = c.toMove;
+}
+
+PieceType opponentOf(PieceType piece)
+{
+    return piece == PieceType::BLACK ? PieceType::WHITE : PieceType::BLACK;
+}
+
+QString colorName(PieceType piece)
+{
+    return piece == PieceType::BLACK ? "黑" : "白";
+}
+
+// ---- 内核对：参考实现与优化实现各自把结果写成一串整数 ----
+
+void checkLineReference(const Prepared& p, std::vector<int>& out)
+{
+    out.clear();
+    for (PieceType color : COLORS) {
+        for (int cell = 0; cell < CELLS; ++cell) {
+            for (const auto& dir : DIRECTIONS) {
+                out.push_back(ReferenceKernels::astarCheckLine(p.leaf, cell / SIZE, cell % SIZE,
+                                                               dir[0], dir[1], color));
+            }
+        }
+    }
+}
+
+void checkLineOptimized(const Prepared& p, std::vector<int>& out)
+{
+    out.clear();
+    for (PieceType color : COLORS) {
+        for (int cell = 0; cell < CELLS; ++cell) {
+            for (const auto& dir : DIRECTIONS) {
+                out.push_back(PatternEvaluator::checkLine(p.leaf, cell / SIZE, cell % SIZE,
+                                                          dir[0], dir[1], color));
+            }
+        }
+    }
+}
+
+QString describeCheckLine(const Case&, size_t index)
+{
+    const int dir = index % 4;
+    const int cell = index / 4 % CELLS;
+    return QString("checkLine(%1,%2 方向(%3,%4) %5)")
+        .arg(cell / SIZE).arg(cell % SIZE).arg(DIRECTIONS[dir][0]).arg(DIRECTIONS[dir][1])
+        .arg(colorName(COLORS[index / (4 * CELLS)]));
+}
+
+void evaluateBoardReference(const Prepared& p, std::vector<int>& out)
+{
+    out.clear();
+    for (PieceType color : COLORS) {
+        out.push_back(ReferenceKernels::astarEvaluateBoard(p.root, p.leaf, color));
+    }
+}
+
+void evaluateBoardOptimized(const Prepared& p, std::vector<int>& out)
+{
+    out.clear();
+    for (PieceType color : COLORS) {
+        out.push_back(p.pattern.evaluate(p.leaf, color));
+    }
+}
+
+QString describeEvaluateBoard(const Case&, size_t index)
+{
+    return QString("evaluateBoard(%1方视角)").arg(colorName(COLORS[index]));
+}
+
+void lineCountsReference(const Prepared& p, std::vector<int>& out)
+{
+    out.clear();
+    for (PieceType color : COLORS) {
+        for (const auto& axis : AXES) {
+            for (int cell = 0; cell < CELLS; ++cell) {
+                out.push_back(ReferenceKernels::ruleCheckLine(p.leaf, cell / SIZE, cell % SIZE,
+                                                              axis[0], axis[1], color));
+            }
+        }
+    }
+}
+
+void lineCountsOptimized(const Prepared& p, std::vector<int>& out)
+{
+    out.clear();
+    LineKernel::LineCounts counts;
+    for (PieceType color : COLORS) {
+        LineKernel::computeLineCounts(p.bits.plane(color), counts);
+        for (int axis = 0; axis < LineKernel::AXIS_COUNT; ++axis) {
+            for (int cell = 0; cell < CELLS; ++cell) {
+                out.push_back(counts.count[axis][cell / SIZE][cell % SIZE]);
+            }
+        }
+    }
+}
+
+QString describeLineCounts(const Case&, size_t index)
+{
+    const int cell = index % CELLS;
+    const int axis = index / CELLS % LineKernel::AXIS_COUNT;
+    return QString("连子数(%1,%2 轴线(%3,%4) %5)")
+        .arg(cell / SIZE).arg(cell % SIZE).arg(AXES[axis][0]).arg(AXES[axis][1])
+        .arg(colorName(COLORS[index / (LineKernel::AXIS_COUNT * CELLS)]));
+}
+
+void ruleScoresReference(const Prepared& p, std::vector<int>& out)
+{
+    out.clear();
+    for (int difficulty = 1; difficulty <= 5; ++difficulty) {
+        for (int cell = 0; cell < CELLS; ++cell) {
+            const int row = cell / SIZE;
+            const int col = cell % SIZE;
+            out.push_back(p.leaf[row][col] != PieceType::NONE ? -1
+                          : ReferenceKernels::ruleCellScore(p.leaf, row, col, p.toMove, difficulty));
+        }
+    }
+}
+
+void ruleScoresOptimized(const Prepared& p, std::vector<int>& out)
+{
+    out.clear();
+    RuleBasedAI ai;
+    int scores[BitBoard::SIZE][BitBoard::SIZE];
+    for (int difficulty = 1; difficulty <= 5; ++difficulty) {
+        ai.setDifficulty(difficulty);
+        ai.scoreBoard(p.bits, p.toMove, scores);
+        for (int cell = 0; cell < CELLS; ++cell) {
+            out.push_back(scores[cell / SIZE][cell % SIZE]);
+        }
+    }
+}
+
+QString describeRuleScores(const Case& c, size_t index)
+{
+    const int cell = index % CELLS;
+    return QString("空位评分(%1,%2 难度%3 %4方)")
+        .arg(cell / SIZE).arg(cell % SIZE).arg(index / CELLS + 1).arg(colorName(c.toMove));
+}
+
+void ruleMoveReference(const Prepared& p, std::vector<int>& out)
+{
+    const Move move = ReferenceKernels::ruleBestMove(p.leaf, p.toMove);
+    out.assign({move.row, move.col});
+}
+
+void ruleMoveOptimized(const Prepared& p, std::vector<int>& out)
+{
+    RuleBasedAI ai;
+    ai.setDifficulty(5);
+    const Move move = ai.getNextMove(p.position, p.toMove);
+    out.assign({move.row, move.col});
+}
+
+QString describeRuleMove(const Case& c, size_t index)
+{
+    return QString("难度5着法的%1（%2方）").arg(QString(index == 0 ? "行" : "列"), colorName(c.toMove));
+}
+
+/**
+ * @brief 一对参考/优化内核
+ */
+struct Kernel {
+    const char* name;
+    const char* description;
+    void (*reference)(const Prepared&, std::vector<int>&);
+    void (*optimized)(const Prepared&, std::vector<int>&);
+    QString (*describe)(const Case&, size_t index);  ///< 第index个输出的含义
+};
+
+const Kernel KERNELS[] = {
+    {"checkLine", "AStarAI::checkLine -> PatternEvaluator::checkLine",
+     checkLineReference, checkLineOptimized, describeCheckLine},
+    {"evaluateBoard", "AStarAI::evaluateBoard -> PatternEvaluator::evaluate",
+     evaluateBoardReference, evaluateBoardOptimized, describeEvaluateBoard},
+    {"lineCounts", "RuleBasedAI::checkLine -> LineKernel::computeLineCounts",
+     lineCountsReference, lineCountsOptimized, describeLineCounts},
+    {"ruleScores", "RuleBasedAI::evaluatePosition -> RuleBasedAI::scoreBoard",
+     ruleScoresReference, ruleScoresOptimized, describeRuleScores},
+    {"ruleMove", "RuleBasedAI::getNextMove（难度5）",
+     ruleMoveReference, ruleMoveOptimized, describeRuleMove},
+};
+const int KERNEL_COUNT = static_cast<int>(sizeof(KERNELS) / sizeof(KERNELS[0]));
+
+// ---- 局面生成 ----
+
+// 空位：一半贴近已有棋子（形成连子），一半在全盘随机
+Move randomEmptyCell(std::mt19937_64& rng, const BoardState& state, const std::vector<Move>& moves)
+{
+    for (int attempt = 0; attempt < 64; ++attempt) {
+        int row;
+        int col;
+        if (!moves.empty() && rng() % 2 == 0) {
+            const Move& anchor = moves[rng() % moves.size()];
+            row = anchor.row + static_cast<int>(rng() % 5) - 2;
+            col = anchor.col + static_cast<int>(rng() % 5) - 2;
+        } else {
+            row = static_cast<int>(rng() % SIZE);
+            col = static_cast<int>(rng() % SIZE);
+        }
+        if (row >= 0 && row < SIZE && col >= 0 && col < SIZE && state[row][col] == PieceType::NONE) {
+            return Move(row, col);
+        }
+    }
+    for (int cell = 0; cell < CELLS; ++cell) {
+        if (state[cell / SIZE][cell % SIZE] == PieceType::NONE) {
+            return Move(cell / SIZE, cell % SIZE);
+        }
+    }
+    return Move();
+}
+
+// 从着法序列取前ply步作为一个测试局面
+void caseFromPrefix(std::mt19937_64& rng, const std::vector<Move>& moves, int ply, Case& c)
+{
+    c.moves.assign(moves.begin(), moves.begin() + ply);
+    c.rootPly = ply - static_cast<int>(rng() % (std::min(ply, MAX_LEAF_MOVES) + 1));
+    c.toMove = ply > 0 ? opponentOf(moves[ply - 1].player) : PieceType::BLACK;
+}
+
+void randomCase(std::mt19937_64& rng, Case& c)
+{
+    BoardState state(SIZE, std::vector<PieceType>(SIZE, PieceType::NONE));
+    std::vector<Move> moves;
+    const int stones = static_cast<int>(rng() % (MAX_RANDOM_STONES + 1));
+    PieceType color = PieceType::BLACK;
+    for (int i = 0; i < stones; ++i) {
+        Move move = randomEmptyCell(rng, state, moves);
+        move.player = color;
+        state[move.row][move.col] = color;
+        moves.push_back(move);
+        // 偶尔连下两手，得到双方子数不均的局面
+        if (rng() % 8 != 0) {
+            color = opponentOf(color);
+        }
+    }
+    caseFromPrefix(rng, moves, stones, c);
+}
+
+bool makesFive(const BoardState& state, const Move& move)
+{
+    for (const auto& dir : DIRECTIONS) {
+        if (ReferenceKernels::ruleCheckLine(state, move.row, move.col, dir[0], dir[1], move.player) >= 5) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// 用参考实现的规则AI自我对弈，夹杂少量随机着法
+void selfPlayGame(std::mt19937_64& rng, std::vector<Move>& moves)
+{
+    BoardState state(SIZE, std::vector<PieceType>(SIZE, PieceType::NONE));
+    moves.clear();
+    const int difficulty = 1 + static_cast<int>(rng() % 5);
+    const int maxPlies = 20 + static_cast<int>(rng() % 100);
+    PieceType color = PieceType::BLACK;
+    std::vector<std::pair<int, Move>> scored;
+    for (int ply = 0; ply < maxPlies; ++ply) {
+        Move move;
+        if (ply > 0 && rng() % 8 == 0) {
+            move = randomEmptyCell(rng, state, moves);
+        } else {
+            scored.clear();
+            for (int cell = 0; cell < CELLS; ++cell) {
+                const int row = cell / SIZE;
+                const int col = cell % SIZE;
+                if (state[row][col] == PieceType::NONE) {
+                    scored.emplace_back(ReferenceKernels::ruleCellScore(state, row, col, color, difficulty),
+                                        Move(row, col));
+                }
+            }
+            if (scored.empty()) {
+                break;
+            }
+            const int range = std::min(static_cast<int>(scored.size()), std::max(1, 6 - difficulty));
+            std::partial_sort(scored.begin(), scored.begin() + range, scored.end(),
+                              [](const auto& a, const auto& b) { return a.first > b.first; });
+            move = scored[rng() % range].second;
+        }
+        if (move.row < 0) {
+            break;
+        }
+        move.player = color;
+        state[move.row][move.col] = color;
+        moves.push_back(move);
+        if (makesFive(state, move)) {
+            break;
+        }
+        color = opponentOf(color);
+    }
+}
+
+// ---- 检查与最小化 ----
+
+/**
+ * @brief 一个内核的统计
+ */
+struct KernelStats {
+    qint64 cases = 0;
+    qint64 mismatches = 0;
+    qint64 referenceNs = 0;
+    qint64 optimizedNs = 0;
+    bool hasFailure = false;
+    qint64 failureIndex = 0;  ///< 最早的不一致局面的编号（与线程数无关）
+    Case failure;
+};
+
+/**
+ * @brief 每个线程的工作区（结果向量复用，不随局面分配）
+ */
+struct Workspace {
+    Prepared prepared;
+    std::vector<int> expected;
+    std::vector<int> actual;
+};
+
+bool mismatches(const Kernel& kernel, const Case& c, Workspace& w)
+{
+    prepare(c, w.prepared);
+    kernel.reference(w.prepared, w.expected);
+    kernel.optimized(w.prepared, w.actual);
+    return w.expected != w.actual;
+}
+
+// 逐个删除着法，只要仍不一致就保留删除，直到删去任何一步都不再出错
+Case minimize(const Kernel& kernel, Case c, Workspace& w)
+{
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int i = static_cast<int>(c.moves.size()) - 1; i >= 0; --i) {
+            Case trial = c;
+            trial.moves.erase(trial.moves.begin() + i);
+            if (i < trial.rootPly) {
+                --trial.rootPly;
+            }
+            if (mismatches(kernel, trial, w)) {
+                c = trial;
+                changed = true;
+            }
+        }
+    }
+    return c;
+}
+
+void printFailure(QTextStream& out, const Kernel& kernel, const Case& c, Workspace& w)
+{
+    mismatches(kernel, c, w);
+    out << QString("\n[%1] 最小化后的不一致局面：%2 步，根局面为前 %3 步，轮到%4方\n")
+               .arg(kernel.name).arg(c.moves.size()).arg(c.rootPly).arg(colorName(c.toMove));
+    QString moves;
+    for (const Move& move : c.moves) {
+        moves += QString("%1%2,%3 ").arg(colorName(move.player)).arg(move.row).arg(move.col);
+    }
+    out << "  着法: " << moves.trimmed() << "\n";
+    out << "     ";
+    for (int col = 0; col < SIZE; ++col) {
+        out << QString::number(col % 10) << " ";
+    }
+    out << "\n";
+    for (int row = 0; row < SIZE; ++row) {
+        out << QString::number(row).rightJustified(4) << " ";
+        for (int col = 0; col < SIZE; ++col) {
+            const PieceType piece = w.prepared.leaf[row][col];
+            out << (piece == PieceType::BLACK ? "X " : piece == PieceType::WHITE ? "O " : ". ");
+        }
+        out << "\n";
+    }
+    const size_t count = std::max(w.expected.size(), w.actual.size());
+    int shown = 0;
+    for (size_t i = 0; i < count && shown < 5; ++i) {
+        const int expected = i < w.expected.size() ? w.expected[i] : 0;
+        const int actual = i < w.actual.size() ? w.actual[i] : 0;
+        if (i >= w.expected.size() || i >= w.actual.size() || expected != actual) {
+            out << QString("  %1: 参考 %2，优化 %3\n").arg(kernel.describe(c, i)).arg(expected).arg(actual);
+            ++shown;
+        }
+    }
+}
+
+qint64 nanosecondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+int Tools::verifyKernels(const QStringList& args)
+{
+    QCommandLineParser parser;
+    parser.setApplicationDescription("对照冻结的参考实现检查优化内核：随机和自我对弈局面上结果必须完全一致，"
+                                     "出错时自动最小化局面，并报告每对内核的加速比");
+    parser.addHelpOption();
+    QCommandLineOption positionsOption("positions", "局面数", "n", "100000");
+    QCommandLineOption seedOption("seed", "随机种子", "n", "1");
+    QCommandLineOption threadsOption("threads", "线程数（0为全部硬件线程）", "n", "0");
+    QCommandLineOption modeOption("mode", "局面来源：mixed、random或selfplay", "mode", "mixed");
+    QCommandLineOption kernelOption("kernel", "只检查指定内核（可重复）", "name");
+    QCommandLineOption backendOption("backend", "连子数内核的实现：auto、scalar、sse2或avx2", "name", "auto");
+    parser.addOption(positionsOption);
+    parser.addOption(seedOption);
+    parser.addOption(threadsOption);
+    parser.addOption(modeOption);
+    parser.addOption(kernelOption);
+    parser.addOption(backendOption);
+    parser.process(args);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    // 参考实现对应最初的常数，不使用启动时加载的权重文件
+    PatternWeights::setActive(PatternWeights());
+
+    const qint64 positions = std::max(1LL, parser.value(positionsOption).toLongLong());
+    const quint64 seed = parser.value(seedOption).toULongLong();
+    const QString mode = parser.value(modeOption);
+    if (mode != "mixed" && mode != "random" && mode != "selfplay") {
+        err << "未知的局面来源: " << mode << "\n";
+        return 1;
+    }
+
+    std::vector<const Kernel*> kernels;
+    const QStringList names = parser.values(kernelOption);
+    for (const Kernel& kernel : KERNELS) {
+        if (names.isEmpty() || names.contains(kernel.name)) {
+            kernels.push_back(&kernel);
+        }
+    }
+    if (kernels.empty()) {
+        err << "未知的内核，可选:";
+        for (const Kernel& kernel : KERNELS) {
+            err << " " << kernel.name;
+        }
+        err << "\n";
+        return 1;
+    }
+
+    const QString backendName = parser.value(backendOption);
+    if (backendName != "auto") {
+        const LineKernel::Backend backends[] = {LineKernel::Backend::Scalar, LineKernel::Backend::SSE2,
+                                                LineKernel::Backend::AVX2};
+        bool found = false;
+        for (LineKernel::Backend backend : backends) {
+            if (backendName.compare(LineKernel::backendName(backend), Qt::CaseInsensitive) == 0) {
+                found = LineKernel::setBackend(backend);
+            }
+        }
+        if (!found) {
+            err << "无法使用连子数内核实现 " << backendName << "\n";
+            return 1;
+        }
+    }
+
+    const qint64 blocks = (positions + CASES_PER_BLOCK - 1) / CASES_PER_BLOCK;
+    int threads = parser.value(threadsOption).toInt();
+    if (threads <= 0) {
+        threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    }
+    threads = static_cast<int>(std::min<qint64>(threads, blocks));
+
+    out << QString("检查 %1 个局面（%2），%3 线程，连子数内核: %4\n")
+               .arg(positions).arg(mode).arg(threads)
+               .arg(LineKernel::backendName(LineKernel::activeBackend()));
+
+    // 按块动态分配；每块的随机数只由种子和块号决定，结果与线程数无关
+    std::vector<KernelStats> totals(kernels.size());
+    std::mutex totalsMutex;
+    std::atomic<qint64> nextBlock{0};
+    QElapsedTimer timer;
+    timer.start();
+    auto worker = [&]() {
+        std::vector<KernelStats> stats(kernels.size());
+        Workspace w;
+        Case c;
+        std::vector<Move> game;
+        for (qint64 block = nextBlock++; block < blocks; block = nextBlock++) {
+            std::mt19937_64 rng(seed * 0x9E3779B97F4A7C15ULL + static_cast<quint64>(block));
+            const bool selfPlay = mode == "selfplay" || (mode == "mixed" && block % 2 == 1);
+            if (selfPlay) {
+                selfPlayGame(rng, game);
+            }
+            const qint64 first = block * CASES_PER_BLOCK;
+            const int count = static_cast<int>(std::min<qint64>(CASES_PER_BLOCK, positions - first));
+            for (int i = 0; i < count; ++i) {
+                if (selfPlay) {
+                    caseFromPrefix(rng, game, static_cast<int>((i + 1) * game.size() / count), c);
+                } else {
+                    randomCase(rng, c);
+                }
+                prepare(c, w.prepared);
+                for (size_t k = 0; k < kernels.size(); ++k) {
+                    // 交替先后顺序，抵消后运行的一方享有的缓存优势
+                    const bool referenceFirst = i % 2 == 0;
+                    for (int pass = 0; pass < 2; ++pass) {
+                        const auto start = std::chrono::steady_clock::now();
+                        if ((pass == 0) == referenceFirst) {
+                            kernels[k]->reference(w.prepared, w.expected);
+                            stats[k].referenceNs += nanosecondsSince(start);
+                        } else {
+                            kernels[k]->optimized(w.prepared, w.actual);
+                            stats[k].optimizedNs += nanosecondsSince(start);
+                        }
+                    }
+                    ++stats[k].cases;
+                    if (w.expected != w.actual) {
+                        ++stats[k].mismatches;
+                        if (!stats[k].hasFailure || first + i < stats[k].failureIndex) {
+                            stats[k].hasFailure = true;
+                            stats[k].failureIndex = first + i;
+                            stats[k].failure = c;
+                        }
+                    }
+                }
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(totalsMutex);
+        for (size_t k = 0; k < kernels.size(); ++k) {
+            KernelStats& total = totals[k];
+            total.cases += stats[k].cases;
+            total.mismatches += stats[k].mismatches;
+            total.referenceNs += stats[k].referenceNs;
+            total.optimizedNs += stats[k].optimizedNs;
+            if (stats[k].hasFailure && (!total.hasFailure || stats[k].failureIndex < total.failureIndex)) {
+                total.hasFailure = true;
+                total.failureIndex = stats[k].failureIndex;
+                total.failure = stats[k].failure;
+            }
+        }
+    };
+    std::vector<std::thread> workers;
+    for (int t = 1; t < threads; ++t) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : workers) {
+        thread.join();
+    }
+    const double seconds = timer.nsecsElapsed() / 1e9;
+
+    out << QString("%1%2%3%4%5\n")
+               .arg("内核", -16).arg("不一致", 10).arg("参考 us/局面", 16).arg("优化 us/局面", 16).arg("加速比", 10);
+    bool failed = false;
+    for (size_t k = 0; k < kernels.size(); ++k) {
+        const KernelStats& s = totals[k];
+        const double referenceUs = s.cases > 0 ? s.referenceNs / 1000.0 / s.cases : 0.0;
+        const double optimizedUs = s.cases > 0 ? s.optimizedNs / 1000.0 / s.cases : 0.0;
+        out << QString("%1%2%3%4%5\n")
+                   .arg(kernels[k]->name, -16)
+                   .arg(s.mismatches, 10)
+                   .arg(referenceUs, 16, 'f', 2)
+                   .arg(optimizedUs, 16, 'f', 2)
+                   .arg(optimizedUs > 0 ? QString::number(referenceUs / optimizedUs, 'f', 2) + "x" : QString("-"), 10);
+        failed = failed || s.mismatches > 0;
+    }
+    out << QString("耗时 %1 秒，%2 局面/秒\n")
+               .arg(seconds, 0, 'f', 2).arg(seconds > 0 ? positions / seconds : 0.0, 0, 'f', 0);
+
+    // 出错的内核各给出一个最小化的局面
+    Workspace w;
+    for (size_t k = 0; k < kernels.size(); ++k) {
+        if (totals[k].hasFailure) {
+            out << QString("\n%1（%2）：第 %3 个局面起不一致").arg(kernels[k]->name, kernels[k]->description)
+                       .arg(totals[k].failureIndex + 1);
+            printFailure(out, *kernels[k], minimize(*kernels[k], totals[k].failure, w), w);
+        }
+    }
+    if (!failed) {
+        out << "所有内核与参考实现一致\n";
+    }
+    return failed ? 1 : 0;
+}
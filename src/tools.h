@@ -0,0 +1,86 @@
+#ifndef TOOLS_H
+#define TOOLS_H
+
+#include <QStringList>
+
+/**
+ * @brief 命令行工具（AIGomokuTool）的子命令
+ *
+ * 每个子命令接收自己的参数列表（第一个元素为"AIGomokuTool <子命令>"，
+ * 便于直接交给QCommandLineParser处理），返回进程退出码。
+ */
+namespace Tools {
+
+/**
+ * @brief 二进制棋谱读写吞吐量基准
+ */
+int benchRecords(const QStringList& args);
+
+/**
+ * @brief 自动保存日志每步写入耗时基准
+ */
+int benchJournal(const QStringList& args);
+
+/**
+ * @brief 从存档目录构建棋谱数据库
+ */
+int dbBuild(const QStringList& args);
+
+/**
+ * @brief 在棋谱数据库中查询局面
+ */
+int dbQuery(const QStringList& args);
+
+/**
+ * @brief 批量分析存档并写出每局的JSON注释
+ */
+int analyzeGames(const QStringList& args);
+
+/**
+ * @brief 对照冻结的参考实现检查优化内核，并报告加速比
+ */
+int verifyKernels(const QStringList& args);
+
+/**
+ * @brief 比较开局对称规范化前后的置换表命中率和搜索用时
+ */
+int benchOpening(const QStringList& args);
+
+/**
+ * @brief 从对局存档拟合棋型评估的权重
+ */
+int tuneWeights(const QStringList& args);
+
+/**
+ * @brief 在本地套接字上运行引擎服务，多局对局共用搜索线程池
+ */
+int serve(const QStringList& args);
+
+/**
+ * @brief 引擎服务的并发压测，报告走子延迟分位数和吞吐量
+ */
+int benchServer(const QStringList& args);
+
+/**
+ * @brief 批量评估文件中的局面（静态评估或定深搜索）
+ */
+int batchEval(const QStringList& args);
+
+/**
+ * @brief 自我对弈生成带分数和胜负标签的训练数据
+ */
+int selfPlay(const QStringList& args);
+
+/**
+ * @brief 用drop-out展开建立或扩展开局库
+ */
+int bookBuild(const QStringList& args);
+
+/**
+ * @brief 在开局库中查询局面
+ */
+int bookQuery(const QStringList& args);
+
+} // namespace Tools
+
+#endif // TOOLS_H
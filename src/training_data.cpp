@@ -0,0 +1,150 @@
+#include "training_data.h"
+#include <QIODevice>
+#include <QtEndian>
+#include <algorithm>
+#include <cstring>
+
+QByteArray TrainingDataFormat::header()
+{
+    char header[HEADER_SIZE];
+    std::memcpy(header, MAGIC, sizeof(MAGIC));
+    qToLittleEndian<quint32>(VERSION, header + 4);
+    qToLittleEndian<quint32>(static_cast<quint32>(sizeof(TrainingSample)), header + 8);
+    qToLittleEndian<quint32>(0, header + 12);
+    return QByteArray(header, HEADER_SIZE);
+}
+
+QByteArray TrainingDataFormat::encodeChunk(const TrainingSample* samples, size_t count)
+{
+    const int rawSize = static_cast<int>(count * sizeof(TrainingSample));
+    const QByteArray compressed = qCompress(reinterpret_cast<const uchar*>(samples), rawSize);
+
+    QByteArray chunk(CHUNK_HEADER_SIZE, Qt::Uninitialized);
+    char* header = chunk.data();
+    std::memcpy(header, CHUNK_MAGIC, sizeof(CHUNK_MAGIC));
+    qToLittleEndian<quint32>(static_cast<quint32>(count), header + 4);
+    qToLittleEndian<quint32>(static_cast<quint32>(rawSize), header + 8);
+    qToLittleEndian<quint32>(static_cast<quint32>(compressed.size()), header + 12);
+    chunk.append(compressed);
+    return chunk;
+}
+
+TrainingDataWriter::TrainingDataWriter(QIODevice* device, bool writeHeader, size_t chunkSamples)
+    : device_(device)
+    , chunkSamples_(std::max<size_t>(1, chunkSamples))
+    , count_(0)
+    , bytes_(0)
+    , failed_(false)
+{
+    pending_.reserve(chunkSamples_);
+    if (writeHeader) {
+        const QByteArray header = TrainingDataFormat::header();
+        failed_ = device_->write(header) != header.size();
+    }
+}
+
+TrainingDataWriter::~TrainingDataWriter()
+{
+    flush();
+}
+
+bool TrainingDataWriter::write(const TrainingSample& sample)
+{
+    if (failed_) {
+        return false;
+    }
+    pending_.push_back(sample);
+    return pending_.size() < chunkSamples_ || flush();
+}
+
+bool TrainingDataWriter::writeChunk(const QByteArray& chunk, size_t samples)
+{
+    if (failed_) {
+        return false;
+    }
+    if (device_->write(chunk) != chunk.size()) {
+        failed_ = true;
+        return false;
+    }
+    count_ += static_cast<qint64>(samples);
+    bytes_ += chunk.size();
+    return true;
+}
+
+bool TrainingDataWriter::flush()
+{
+    if (failed_ || pending_.empty()) {
+        return !failed_;
+    }
+    const QByteArray chunk = TrainingDataFormat::encodeChunk(pending_.data(), pending_.size());
+    const size_t samples = pending_.size();
+    pending_.clear();  // 保留容量
+    return writeChunk(chunk, samples);
+}
+
+TrainingDataReader::TrainingDataReader(QIODevice* device)
+    : device_(device)
+    , headerRead_(false)
+    , truncated_(false)
+{
+}
+
+bool TrainingDataReader::readChunk(std::vector<TrainingSample>& samples)
+{
+    using namespace TrainingDataFormat;
+    samples.clear();
+    if (hasError() || truncated_) {
+        return false;
+    }
+    if (!headerRead_) {
+        const QByteArray header = device_->read(HEADER_SIZE);
+        if (header.size() != HEADER_SIZE || std::memcmp(header.constData(), MAGIC, sizeof(MAGIC)) != 0) {
+            error_ = "不是训练数据文件";
+            return false;
+        }
+        const quint32 version = qFromLittleEndian<quint32>(header.constData() + 4);
+        const quint32 sampleSize = qFromLittleEndian<quint32>(header.constData() + 8);
+        if (version == 0 || version > VERSION) {
+            error_ = QString("不支持的训练数据版本%1").arg(version);
+            return false;
+        }
+        if (sampleSize != sizeof(TrainingSample)) {
+            error_ = QString("样本大小%1与程序不符").arg(sampleSize);
+            return false;
+        }
+        headerRead_ = true;
+    }
+
+    const QByteArray header = device_->read(CHUNK_HEADER_SIZE);
+    if (header.isEmpty()) {
+        return false;
+    }
+    if (header.size() != CHUNK_HEADER_SIZE) {
+        truncated_ = true;
+        return false;
+    }
+    if (std::memcmp(header.constData(), CHUNK_MAGIC, sizeof(CHUNK_MAGIC)) != 0) {
+        error_ = "块头损坏";
+        return false;
+    }
+    const quint32 count = qFromLittleEndian<quint32>(header.constData() + 4);
+    const quint32 rawSize = qFromLittleEndian<quint32>(header.constData() + 8);
+    const quint32 compressedSize = qFromLittleEndian<quint32>(header.constData() + 12);
+    if (count > MAX_CHUNK_SAMPLES || rawSize != count * sizeof(TrainingSample)) {
+        error_ = "块头损坏";
+        return false;
+    }
+    const QByteArray compressed = device_->read(compressedSize);
+    if (compressed.size() != static_cast<int>(compressedSize)) {
+        truncated_ = true;
+        return false;
+    }
+    const QByteArray raw = qUncompress(compressed);
+    if (raw.size() != static_cast<int>(rawSize)) {
+        error_ = "块解压失败";
+        return false;
+    }
+    samples.resize(count);
+    std::memcpy(samples.data(), raw.constData(), rawSize);
+    return true;
+}
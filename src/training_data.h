@@ -0,0 +1,158 @@
+#ifndef TRAINING_DATA_H
+#define TRAINING_DATA_H
+
+#include <QByteArray>
+#include <QString>
+#include <cstdint>
+#include <vector>
+#include "batch_evaluator.h"
+
+class QIODevice;
+
+/**
+ * @brief 一个带标签的训练局面（72字节）
+ *
+ * 局面沿用PackedPosition的64字节布局，后面跟搜索给出的分数、最佳着法和对局最终结果，
+ * 都以局面中轮到的一方为视角。
+ */
+struct TrainingSample {
+    PackedPosition position;  ///< 局面和轮到的一方
+    int32_t score = 0;        ///< 搜索分数（±Searcher::WIN_SCORE附近为必胜/必败）
+    uint8_t bestMove = 0;     ///< 搜索给出的最佳着法（行 * 15 + 列）
+    uint8_t depth = 0;        ///< 完成的搜索深度
+    int8_t result = 0;        ///< 对局结果：1胜、0和、-1负
+    uint8_t reserved = 0;     ///< 保留，写0
+};
+
+static_assert(sizeof(TrainingSample) == 72, "TrainingSample must stay 72 bytes");
+
+/**
+ * @brief 训练数据文件格式（.gmsp）
+ *
+ * 文件头之后是任意多个独立压缩的块，可以边生成边追加，读取时逐块解压，
+ * 不需要把整个文件读进内存；末尾不完整的块（如生成被中断）被视为文件结束。
+ * 整数字段为小端序，样本按TrainingSample的内存布局原样存储：
+ * @code
+ * 文件头（16字节）
+ *   0   4   魔数 "GMSP"
+ *   4   4   版本号（当前为1）
+ *   8   4   每个样本的字节数（72）
+ *   12  4   保留，写0
+ * 块（重复）
+ *   0   4   魔数 "CHNK"
+ *   4   4   样本数n
+ *   8   4   解压后的字节数（n * 72）
+ *   12  4   压缩数据的字节数m
+ *   16  m   qCompress的输出：4字节大端序的解压后长度，接zlib数据流
+ * @endcode
+ * 同一局的样本总在同一块中，按着法顺序排列；块之间没有顺序约定。
+ */
+namespace TrainingDataFormat {
+
+constexpr char MAGIC[4] = {'G', 'M', 'S', 'P'};
+constexpr char CHUNK_MAGIC[4] = {'C', 'H', 'N', 'K'};
+constexpr uint32_t VERSION = 1;
+constexpr int HEADER_SIZE = 16;
+constexpr int CHUNK_HEADER_SIZE = 16;
+constexpr uint32_t MAX_CHUNK_SAMPLES = 1 << 20;  ///< 读取时拒绝更大的块（视为数据损坏）
+
+/**
+ * @brief 文件头
+ */
+QByteArray header();
+
+/**
+ * @brief 把一组样本编码为一个完整的块（块头加压缩数据）
+ */
+QByteArray encodeChunk(const TrainingSample* samples, size_t count);
+
+} // namespace TrainingDataFormat
+
+/**
+ * @brief 训练数据流式写入
+ *
+ * 样本先写入内部缓冲区，攒够chunkSamples个或调用flush()时压缩成一块写入设备。
+ * 已经在别处编码好的块（如生成线程各自压缩）可以用writeChunk直接写入。
+ * 设备由调用者打开和关闭，析构时自动flush。
+ */
+class TrainingDataWriter {
+public:
+    static constexpr size_t DEFAULT_CHUNK_SAMPLES = 4096;
+
+    /**
+     * @param device 输出设备
+     * @param writeHeader 是否先写文件头（向已有文件追加时为false）
+     */
+    explicit TrainingDataWriter(QIODevice* device, bool writeHeader = true,
+                                size_t chunkSamples = DEFAULT_CHUNK_SAMPLES);
+    ~TrainingDataWriter();
+
+    /**
+     * @brief 追加一个样本
+     */
+    bool write(const TrainingSample& sample);
+
+    /**
+     * @brief 写入encodeChunk编码好的块
+     * @param samples 块中的样本数（用于计数）
+     */
+    bool writeChunk(const QByteArray& chunk, size_t samples);
+
+    /**
+     * @brief 把缓冲区中的样本压缩成一块写入设备
+     */
+    bool flush();
+
+    /**
+     * @brief 已写入的样本数
+     */
+    qint64 count() const { return count_; }
+
+    /**
+     * @brief 已写入设备的字节数（不含文件头）
+     */
+    qint64 bytesWritten() const { return bytes_; }
+
+private:
+    QIODevice* device_;
+    std::vector<TrainingSample> pending_;
+    size_t chunkSamples_;
+    qint64 count_;
+    qint64 bytes_;
+    bool failed_;
+};
+
+/**
+ * @brief 训练数据流式读取，每次解压一块
+ */
+class TrainingDataReader {
+public:
+    explicit TrainingDataReader(QIODevice* device);
+
+    /**
+     * @brief 读取下一块
+     * @param samples 块中的样本（复用其容量）
+     * @return 读到末尾或格式错误时返回false，用hasError()区分
+     */
+    bool readChunk(std::vector<TrainingSample>& samples);
+
+    /**
+     * @brief 是否遇到格式错误（魔数、版本、样本大小或解压失败）
+     */
+    bool hasError() const { return !error_.isEmpty(); }
+
+    QString errorString() const { return error_; }
+
+    /**
+     * @brief 末尾是否有不完整的块
+     */
+    bool isTruncated() const { return truncated_; }
+
+private:
+    QIODevice* device_;
+    bool headerRead_;
+    bool truncated_;
+    QString error_;
+};
+
+#endif // TRAINING_DATA_H
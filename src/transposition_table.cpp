@@ -0,0 +1,67 @@
+#include "transposition_table.h"
+#include <algorithm>
+
+TranspositionTable::TranspositionTable(size_t megabytes)
+    : entries_(nullptr)
+    , mask_(0)
+    , age_(0)
+{
+    resize(megabytes);
+}
+
+void TranspositionTable::resize(size_t megabytes)
+{
+    block_ = MemoryBlock();
+    // 先按剩余额度取2的幂个条目再申请，不多占额度
+    const size_t bytes = std::max(MIN_BYTES, std::min(std::max<size_t>(1, megabytes) * 1024 * 1024,
+                                                      MemoryBudget::available(MemoryBudget::TRANSPOSITION_TABLES)));
+    size_t count = 1;
+    while (count * 2 <= bytes / sizeof(Entry)) {
+        count *= 2;
+    }
+    block_ = MemoryBlock(MemoryBudget::TRANSPOSITION_TABLES, count * sizeof(Entry), MIN_BYTES);
+    // 其他线程同时申请时得到的可能更少
+    while (count * sizeof(Entry) > block_.size()) {
+        count /= 2;
+    }
+    // 新映射的内存全为零，即全部为空条目
+    entries_ = static_cast<Entry*>(block_.data());
+    mask_ = count - 1;
+}
+
+void TranspositionTable::clear()
+{
+    block_.zero();
+    age_ = 0;
+}
+
+void TranspositionTable::store(uint64_t key, int depth, int score, Bound bound, int move)
+{
+    Entry& slot = entries_[key & mask_];
+    // 本次搜索写入的条目按深度保留；旧搜索的条目总是可以覆盖
+    if (slot.bound != BOUND_NONE && slot.age == age_) {
+        if (slot.key == key ? depth < slot.depth : depth + REPLACE_MARGIN < slot.depth) {
+            return;
+        }
+    }
+    // 同一局面的浅层结果没有着法时保留原来的最佳着法
+    if (move < 0 && slot.key == key) {
+        move = slot.move;
+    }
+    slot.key = key;
+    slot.score = score;
+    slot.move = move < 0 ? NO_MOVE : static_cast<uint8_t>(move);
+    slot.depth = static_cast<uint8_t>(std::min(depth, 255));
+    slot.bound = bound;
+    slot.age = age_;
+}
+
+int TranspositionTable::hashfull() const
+{
+    const size_t sample = std::min<size_t>(1000, size());
+    int used = 0;
+    for (size_t i = 0; i < sample; ++i) {
+        used += entries_[i].bound != BOUND_NONE && entries_[i].age == age_;
+    }
+    return static_cast<int>(used * 1000 / sample);
+}
@@ -0,0 +1,117 @@
+#ifndef TRANSPOSITION_TABLE_H
+#define TRANSPOSITION_TABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include "memory_budget.h"
+
+/**
+ * @brief 置换表
+ *
+ * 以局面的Zobrist哈希为键，保存搜索深度、分数、分数类型和最佳着法。
+ * 每个条目16字节，表长为2的幂，按哈希低位直接寻址。
+ *
+ * 表可以跨多次搜索（多步棋、多局）保留，每次搜索开始时调用newSearch()递增代数：
+ * 本次搜索写入的条目按深度优先保留，之前搜索留下的条目随时可被覆盖，不会长期占住位置。
+ * 评估函数的位置价值按每次搜索的根局面计算（见Evaluator::reset），不同搜索的分数不可比，
+ * 所以旧条目只提供最佳着法作排序提示，只有isCurrent()的条目才能用分数截断。只供一个搜索线程使用。
+ *
+ * 表的内存计入MemoryBudget的置换表额度：额度不足时表会比请求的小（至少64KB）。
+ * 全零的条目即空条目（bound为BOUND_NONE），清空时直接把内存清零。
+ */
+class TranspositionTable {
+public:
+    /**
+     * @brief 分数类型
+     */
+    enum Bound : uint8_t {
+        BOUND_NONE = 0,   ///< 空条目
+        BOUND_UPPER = 1,  ///< 上界（所有着法都没有超过alpha）
+        BOUND_LOWER = 2,  ///< 下界（发生了beta截断）
+        BOUND_EXACT = 3   ///< 精确值
+    };
+
+    static constexpr uint8_t NO_MOVE = 0xFF;  ///< 没有最佳着法
+
+    /**
+     * @brief 表项
+     */
+    struct Entry {
+        uint64_t key = 0;        ///< 完整哈希，用于校验
+        int32_t score = 0;       ///< 分数（胜负分数已换算为相对本局面的步数）
+        uint8_t move = NO_MOVE;  ///< 最佳着法（行 * 15 + 列）
+        uint8_t depth = 0;       ///< 搜索深度
+        uint8_t bound = BOUND_NONE;  ///< 分数类型
+        uint8_t age = 0;         ///< 写入时的搜索代数
+    };
+
+    /**
+     * @param megabytes 表的大小（MB），受内存预算限制，向下取为2的幂个条目
+     */
+    explicit TranspositionTable(size_t megabytes = 16);
+
+    /**
+     * @brief 重新分配并清空
+     */
+    void resize(size_t megabytes);
+
+    /**
+     * @brief 清空所有条目
+     */
+    void clear();
+
+    /**
+     * @brief 开始新的一次搜索：之前的条目变为可替换的旧条目
+     *
+     * 代数只有8位，回绕到0时清空整张表，否则256次搜索之前的条目会重新被当作本次搜索的条目。
+     */
+    void newSearch() {
+        if (++age_ == 0) {
+            clear();
+        }
+    }
+
+    /**
+     * @brief 查询
+     * @return 找到相同键的条目时返回true
+     */
+    bool probe(uint64_t key, Entry& entry) const {
+        const Entry& slot = entries_[key & mask_];
+        if (slot.bound == BOUND_NONE || slot.key != key) {
+            return false;
+        }
+        entry = slot;
+        return true;
+    }
+
+    /**
+     * @brief 条目是否由本次搜索写入（只有这样的条目的分数可以用于截断）
+     */
+    bool isCurrent(const Entry& entry) const { return entry.age == age_; }
+
+    /**
+     * @brief 写入搜索结果
+     */
+    void store(uint64_t key, int depth, int score, Bound bound, int move);
+
+    /**
+     * @brief 条目数
+     */
+    size_t size() const { return mask_ + 1; }
+
+    /**
+     * @brief 本次搜索写入的条目占用率（千分比，抽样前1000个条目）
+     */
+    int hashfull() const;
+
+private:
+    static constexpr size_t MIN_BYTES = 64 * 1024;  ///< 预算用完时表的最小大小
+    static constexpr int REPLACE_MARGIN = 2;  ///< 本次搜索的条目比新结果深这么多层以上时保留
+
+    MemoryBlock block_;                       ///< 条目的内存
+    Entry* entries_;
+    size_t mask_;
+    uint8_t age_;                             ///< 当前搜索代数（回绕时清空表，见newSearch）
+};
+
+#endif // TRANSPOSITION_TABLE_H
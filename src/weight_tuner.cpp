@@ -0,0 +1,427 @@
+#include "weight_tuner.h"
+#include "game_analyzer.h"
+#include "game_record.h"
+#include "pattern_evaluator.h"
+#include "position.h"
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <thread>
+
+namespace {
+
+// 有间断时单独计数的棋型，依次对应特征SHAPE_COUNT、SHAPE_COUNT + 1、SHAPE_COUNT + 2
+constexpr int GAPPED_SHAPES[WeightTuner::GAPPED_FEATURES] = {
+    PatternWeights::HALF_FOUR, PatternWeights::HALF_THREE, PatternWeights::HALF_TWO
+};
+
+// 位置价值只在一枚棋子四个方向的棋型分数之和低于此值时计入（同PatternEvaluator::evaluate）
+constexpr int POSITION_SCORE_LIMIT = 2000;
+
+constexpr int PARAMS = PatternWeights::SHAPE_COUNT + 1;  ///< 11个棋型分数和间断系数
+constexpr int GAP_PARAM = PatternWeights::SHAPE_COUNT;
+constexpr int GAP_DENOMINATOR = 1024;
+
+int gappedFeature(int shape)
+{
+    for (int i = 0; i < WeightTuner::GAPPED_FEATURES; ++i) {
+        if (GAPPED_SHAPES[i] == shape) {
+            return PatternWeights::SHAPE_COUNT + i;
+        }
+    }
+    return -1;
+}
+
+// 参数（棋型分数、间断系数）到与特征对应的有效权重
+void effectiveWeights(const double* params, float* effective)
+{
+    for (int shape = 0; shape < PatternWeights::SHAPE_COUNT; ++shape) {
+        effective[shape] = static_cast<float>(params[shape]);
+    }
+    for (int i = 0; i < WeightTuner::GAPPED_FEATURES; ++i) {
+        effective[PatternWeights::SHAPE_COUNT + i] = static_cast<float>(params[GAPPED_SHAPES[i]] * params[GAP_PARAM]);
+    }
+}
+
+void toParams(const PatternWeights& weights, double* params)
+{
+    for (int shape = 0; shape < PatternWeights::SHAPE_COUNT; ++shape) {
+        params[shape] = std::max(1, weights.values[shape]);
+    }
+    params[GAP_PARAM] = std::max(0.05, static_cast<double>(weights.gapNumerator) / weights.gapDenominator);
+}
+
+PatternWeights fromParams(const double* params)
+{
+    PatternWeights weights;
+    for (int shape = 0; shape < PatternWeights::SHAPE_COUNT; ++shape) {
+        weights.values[shape] = static_cast<int>(std::lround(params[shape]));
+    }
+    weights.gapNumerator = static_cast<int>(std::lround(params[GAP_PARAM] * GAP_DENOMINATOR));
+    weights.gapDenominator = GAP_DENOMINATOR;
+    return weights;
+}
+
+// 读取一个存档文件中的所有对局
+bool readGames(const QString& path, std::vector<std::vector<GameSave::Move>>& games)
+{
+    if (QFileInfo(path).suffix() == "gmkr") {
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly)) {
+            return false;
+        }
+        GameRecordReader reader(&file);
+        GameRecord record;
+        GameSave::SaveData data;
+        while (reader.readNext(record)) {
+            if (record.toSaveData(data)) {
+                games.push_back(data.history);
+            }
+        }
+        return !reader.hasError();
+    }
+    GameSave::SaveData data;
+    if (!GameSave::loadGame(path, data)) {
+        return false;
+    }
+    games.push_back(data.history);
+    return true;
+}
+
+} // namespace
+
+bool WeightTuner::extractFeatures(const Position& position, PieceType toMove,
+                                  const PatternWeights& weights, float* sample)
+{
+    const auto& board = position.getBoardState();
+    const int directions[4][2] = {{1, 0}, {0, 1}, {1, 1}, {1, -1}};
+    std::fill(sample, sample + STRIDE, 0.0f);
+
+    for (int row = 0; row < Position::SIZE; ++row) {
+        for (int col = 0; col < Position::SIZE; ++col) {
+            const PieceType piece = board[row][col];
+            if (piece == PieceType::NONE) {
+                // 有一方能直接连五的局面不是静态局面
+                if (position.makesFive(row, col, PieceType::BLACK) ||
+                    position.makesFive(row, col, PieceType::WHITE)) {
+                    return false;
+                }
+                continue;
+            }
+            const float sign = piece == toMove ? 1.0f : -1.0f;
+            int lineScoreSum = 0;
+            for (const auto& dir : directions) {
+                const auto line = PatternEvaluator::classifyLine(board, row, col, dir[0], dir[1], piece);
+                if (line.shape == PatternWeights::FIVE) {
+                    return false;
+                }
+                const int feature = line.gapped ? gappedFeature(line.shape) : line.shape;
+                sample[feature] += sign;
+                lineScoreSum += weights.score(line.shape, line.gapped);
+            }
+            if (lineScoreSum < POSITION_SCORE_LIMIT) {
+                sample[OFFSET] += sign * PatternEvaluator::calculatePositionScore(board, row, col, piece);
+            }
+        }
+    }
+    return true;
+}
+
+bool WeightTuner::extractGame(const Game& game, const PatternWeights& weights, std::vector<float>& samples) const
+{
+    // 先重放到终局确定胜负；未分胜负且未下满的对局（认输、超时、中途保存）没有可用的结果
+    Position position;
+    PieceType winner = PieceType::NONE;
+    size_t end = game.size();
+    for (size_t ply = 0; ply < game.size(); ++ply) {
+        const GameSave::Move& move = game[ply];
+        if (move.row < 0 || move.row >= Position::SIZE || move.col < 0 || move.col >= Position::SIZE ||
+            position.getPiece(move.row, move.col) != PieceType::NONE) {
+            return false;
+        }
+        if (position.placePiece(move.row, move.col, move.player)) {
+            winner = move.player;
+            end = ply + 1;
+            break;
+        }
+    }
+    if (winner == PieceType::NONE && !position.isFull()) {
+        return false;
+    }
+
+    position.clear();
+    float sample[STRIDE];
+    for (size_t ply = 0; ply < end; ++ply) {
+        const GameSave::Move& move = game[ply];
+        if (static_cast<int>(ply) >= options_.minPly && extractFeatures(position, move.player, weights, sample)) {
+            sample[RESULT] = winner == PieceType::NONE ? 0.5f : (winner == move.player ? 1.0f : 0.0f);
+            samples.insert(samples.end(), sample, sample + STRIDE);
+        }
+        position.placePiece(move.row, move.col, move.player);
+    }
+    return true;
+}
+
+double WeightTuner::evaluateLoss(const std::vector<float>& samples, const float* effective, double scale,
+                                 double* grad, int threads) const
+{
+    const size_t count = samples.size() / STRIDE;
+    if (count == 0) {
+        return 0.0;
+    }
+    threads = static_cast<int>(std::min<size_t>(threads, (count + 4095) / 4096));
+    threads = std::max(1, threads);
+
+    struct Partial {
+        double loss = 0.0;
+        double grad[FEATURES] = {};
+    };
+    std::vector<Partial> partials(threads);
+    const size_t batch = (count + threads - 1) / threads;
+    auto work = [&](int t) {
+        Partial& partial = partials[t];
+        const size_t begin = t * batch;
+        const size_t last = std::min(count, begin + batch);
+        for (size_t i = begin; i < last; ++i) {
+            const float* x = samples.data() + i * STRIDE;
+            float eval = x[OFFSET];
+            for (int j = 0; j < FEATURES; ++j) {
+                eval += effective[j] * x[j];
+            }
+            const double p = 1.0 / (1.0 + std::exp(-scale * eval));
+            const double error = p - x[RESULT];
+            partial.loss += error * error;
+            if (grad) {
+                const double d = 2.0 * error * p * (1.0 - p) * scale;
+                for (int j = 0; j < FEATURES; ++j) {
+                    partial.grad[j] += d * x[j];
+                }
+            }
+        }
+    };
+    std::vector<std::thread> workers;
+    for (int t = 1; t < threads; ++t) {
+        workers.emplace_back(work, t);
+    }
+    work(0);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    double loss = 0.0;
+    if (grad) {
+        std::fill(grad, grad + FEATURES, 0.0);
+    }
+    for (const Partial& partial : partials) {
+        loss += partial.loss;
+        if (grad) {
+            for (int j = 0; j < FEATURES; ++j) {
+                grad[j] += partial.grad[j] / count;
+            }
+        }
+    }
+    return loss / count;
+}
+
+bool WeightTuner::run(const PatternWeights& initial, PatternWeights& tuned, Report* report)
+{
+    Report localReport;
+    Report& r = report ? *report : localReport;
+    r = Report();
+    QElapsedTimer timer;
+    timer.start();
+
+    QStringList files;
+    for (const QString& path : paths_) {
+        if (!GameAnalyzer::expandPath(path, files)) {
+            error_ = QString("找不到 %1").arg(path);
+            return false;
+        }
+    }
+    r.files = files.size();
+
+    int threads = threadCount_ > 0 ? threadCount_ : static_cast<int>(std::thread::hardware_concurrency());
+    threads = std::max(1, threads);
+
+    // 按文件动态分配；每个文件的样本单独存放，合并后的顺序与线程数无关
+    struct FileResult {
+        bool ok = false;
+        int games = 0;
+        int unfinished = 0;
+        std::vector<float> train;
+        std::vector<float> validation;
+    };
+    std::vector<FileResult> results(files.size());
+    std::atomic<int> nextFile{0};
+    auto worker = [&]() {
+        for (int i = nextFile++; i < static_cast<int>(files.size()); i = nextFile++) {
+            std::vector<Game> games;
+            FileResult& result = results[i];
+            result.ok = readGames(files[i], games);
+            for (size_t g = 0; g < games.size(); ++g) {
+                const bool validation = options_.validationEvery > 0 &&
+                    (i + static_cast<int>(g)) % options_.validationEvery == 0;
+                if (extractGame(games[g], initial, validation ? result.validation : result.train)) {
+                    ++result.games;
+                } else {
+                    ++result.unfinished;
+                }
+            }
+        }
+    };
+    {
+        std::vector<std::thread> workers;
+        for (int t = 1; t < std::min(threads, static_cast<int>(files.size())); ++t) {
+            workers.emplace_back(worker);
+        }
+        worker();
+        for (auto& thread : workers) {
+            thread.join();
+        }
+    }
+
+    std::vector<float> train;
+    std::vector<float> validation;
+    for (FileResult& result : results) {
+        r.failedFiles += result.ok ? 0 : 1;
+        r.games += result.games;
+        r.unfinishedGames += result.unfinished;
+        train.insert(train.end(), result.train.begin(), result.train.end());
+        validation.insert(validation.end(), result.validation.begin(), result.validation.end());
+        result = FileResult();
+    }
+    r.trainPositions = static_cast<qint64>(train.size() / STRIDE);
+    r.validationPositions = static_cast<qint64>(validation.size() / STRIDE);
+    r.extractMs = timer.restart();
+    if (train.empty()) {
+        error_ = "没有可用的局面（需要分出胜负或下满的对局）";
+        return false;
+    }
+
+    double params[PARAMS];
+    float effective[FEATURES];
+    toParams(initial, params);
+    effectiveWeights(params, effective);
+
+    // 先按初始权重拟合K（黄金分割搜索log10 K），调参过程中K保持不变
+    double low = -7.0;
+    double high = -1.0;
+    const double ratio = (std::sqrt(5.0) - 1.0) / 2.0;
+    double a = high - ratio * (high - low);
+    double b = low + ratio * (high - low);
+    double lossA = evaluateLoss(train, effective, std::pow(10.0, a), nullptr, threads);
+    double lossB = evaluateLoss(train, effective, std::pow(10.0, b), nullptr, threads);
+    for (int i = 0; i < 40; ++i) {
+        if (lossA < lossB) {
+            high = b;
+            b = a;
+            lossB = lossA;
+            a = high - ratio * (high - low);
+            lossA = evaluateLoss(train, effective, std::pow(10.0, a), nullptr, threads);
+        } else {
+            low = a;
+            a = b;
+            lossA = lossB;
+            b = low + ratio * (high - low);
+            lossB = evaluateLoss(train, effective, std::pow(10.0, b), nullptr, threads);
+        }
+    }
+    const double scale = std::pow(10.0, (low + high) / 2.0);
+    r.scale = scale;
+    r.trainLossBefore = evaluateLoss(train, effective, scale, nullptr, threads);
+    r.validationLossBefore = evaluateLoss(validation, effective, scale, nullptr, threads);
+
+    // 训练集中从未出现的棋型没有梯度信息，保持原值（如有空位的冲四总能直接连五，已被跳过）
+    bool present[PARAMS] = {};
+    for (size_t i = 0; i < train.size(); i += STRIDE) {
+        for (int j = 0; j < FEATURES; ++j) {
+            if (train[i + j] != 0.0f) {
+                present[j < PatternWeights::SHAPE_COUNT ? j : GAPPED_SHAPES[j - PatternWeights::SHAPE_COUNT]] = true;
+                if (j >= PatternWeights::SHAPE_COUNT) {
+                    present[GAP_PARAM] = true;
+                }
+            }
+        }
+    }
+
+    // 对数空间中的Adam；保留误差最小的一组参数：有验证集时按更新后的验证误差，
+    // 否则按本轮更新前的训练误差（训练误差只在算梯度时顺带得到）
+    double first[PARAMS] = {};
+    double second[PARAMS] = {};
+    double best[PARAMS];
+    std::copy(params, params + PARAMS, best);
+    double bestLoss = validation.empty() ? r.trainLossBefore : r.validationLossBefore;
+    const double beta1 = 0.9;
+    const double beta2 = 0.999;
+    double grad[FEATURES];
+    for (int epoch = 1; epoch <= options_.epochs; ++epoch) {
+        effectiveWeights(params, effective);
+        const double trainLoss = evaluateLoss(train, effective, scale, grad, threads);
+        if (validation.empty() && trainLoss < bestLoss) {
+            bestLoss = trainLoss;
+            std::copy(params, params + PARAMS, best);
+        }
+
+        // 有效权重的梯度换算到棋型分数和间断系数
+        double paramGrad[PARAMS];
+        for (int shape = 0; shape < PatternWeights::SHAPE_COUNT; ++shape) {
+            paramGrad[shape] = grad[shape];
+        }
+        paramGrad[GAP_PARAM] = 0.0;
+        for (int i = 0; i < GAPPED_FEATURES; ++i) {
+            const int feature = PatternWeights::SHAPE_COUNT + i;
+            paramGrad[GAPPED_SHAPES[i]] += grad[feature] * params[GAP_PARAM];
+            paramGrad[GAP_PARAM] += grad[feature] * params[GAPPED_SHAPES[i]];
+        }
+
+        for (int i = 0; i < PARAMS; ++i) {
+            if (!present[i]) {
+                continue;
+            }
+            const double g = paramGrad[i] * params[i];  // 对log(参数)的梯度
+            first[i] = beta1 * first[i] + (1.0 - beta1) * g;
+            second[i] = beta2 * second[i] + (1.0 - beta2) * g * g;
+            const double m = first[i] / (1.0 - std::pow(beta1, epoch));
+            const double v = second[i] / (1.0 - std::pow(beta2, epoch));
+            params[i] *= std::exp(-options_.learningRate * m / (std::sqrt(v) + 1e-12));
+        }
+        for (int shape = 0; shape < PatternWeights::SHAPE_COUNT; ++shape) {
+            params[shape] = std::clamp(params[shape], 1.0, PatternWeights::MAX_SCORE - 1.0);
+        }
+        params[GAP_PARAM] = std::clamp(params[GAP_PARAM], 0.05, 1.0);
+
+        double validationLoss = trainLoss;
+        if (!validation.empty()) {
+            effectiveWeights(params, effective);
+            validationLoss = evaluateLoss(validation, effective, scale, nullptr, threads);
+            if (validationLoss < bestLoss) {
+                bestLoss = validationLoss;
+                std::copy(params, params + PARAMS, best);
+            }
+        }
+        if (progress_) {
+            progress_(epoch, trainLoss, validationLoss);
+        }
+    }
+
+    // 没有验证集时最后一轮更新后的参数还没有算过误差
+    if (validation.empty() && options_.epochs > 0) {
+        effectiveWeights(params, effective);
+        if (evaluateLoss(train, effective, scale, nullptr, threads) < bestLoss) {
+            std::copy(params, params + PARAMS, best);
+        }
+    }
+
+    tuned = fromParams(best);
+    toParams(tuned, params);
+    effectiveWeights(params, effective);
+    r.trainLossAfter = evaluateLoss(train, effective, scale, nullptr, threads);
+    r.validationLossAfter = evaluateLoss(validation, effective, scale, nullptr, threads);
+    r.tuneMs = timer.elapsed();
+    error_.clear();
+    return true;
+}
@@ -0,0 +1,118 @@
+#ifndef WEIGHT_TUNER_H
+#define WEIGHT_TUNER_H
+
+#include <QString>
+#include <QStringList>
+#include <functional>
+#include <vector>
+#include "gamesave.h"
+#include "pattern_weights.h"
+
+class Position;
+
+/**
+ * @brief 棋型权重调参（Texel方法）
+ *
+ * 从对局存档中取出每一步之前的局面和最终胜负，以逻辑函数把静态评估换算为胜率，
+ * 用梯度下降最小化预测胜率与实际结果的均方误差：
+ * @code
+ *   loss = mean((sigmoid(K * eval) - result)^2)，result为轮到一方的结果（胜1、和0.5、负0）
+ * @endcode
+ * 评估对每个棋型的分数是线性的：每个局面先按PatternEvaluator::classifyLine统计双方各棋型的个数之差
+ * （冲四、冲三、冲二有间断的单独计数），位置价值按初始权重算好作为常数项，
+ * 之后每轮只需对紧凑的特征矩阵做一次点积和一次梯度累加，按线程切分样本并行计算。
+ * 参数在对数空间里用Adam更新，保持为正且不同量级的分数以相同的相对步长变化。
+ * 局面中已有连五或有一方能直接连五时跳过（静态评估看不出这类局面的结果）。
+ */
+class WeightTuner {
+public:
+    /**
+     * @brief 调参参数
+     */
+    struct Options {
+        int epochs = 300;              ///< 梯度下降轮数
+        double learningRate = 0.05;    ///< 对数空间中的学习率
+        int minPly = 4;                ///< 跳过每局开始的步数
+        int validationEvery = 10;      ///< 每隔多少局取一局作验证集，0表示不留验证集
+    };
+
+    /**
+     * @brief 调参统计
+     */
+    struct Report {
+        int files = 0;                   ///< 找到的存档数
+        int failedFiles = 0;             ///< 无法读取的存档数
+        int games = 0;                   ///< 使用的对局数
+        int unfinishedGames = 0;         ///< 未分胜负（且未下满）或着法非法而跳过的对局数
+        qint64 trainPositions = 0;       ///< 训练局面数
+        qint64 validationPositions = 0;  ///< 验证局面数
+        double scale = 0.0;              ///< 拟合的K
+        double trainLossBefore = 0.0;    ///< 初始权重的训练误差
+        double trainLossAfter = 0.0;     ///< 调整后（取整）权重的训练误差
+        double validationLossBefore = 0.0;
+        double validationLossAfter = 0.0;
+        qint64 extractMs = 0;            ///< 读取存档和提取特征的用时
+        qint64 tuneMs = 0;               ///< 梯度下降的用时
+    };
+
+    /**
+     * @brief 每轮结束时的回调：轮次、训练误差、验证误差
+     */
+    using Progress = std::function<void(int epoch, double trainLoss, double validationLoss)>;
+
+    /**
+     * @brief 添加存档文件、目录或通配符（同GameAnalyzer::addPath）；.gmkr棋谱库读取其中的所有对局
+     */
+    void addPath(const QString& path) { paths_.append(path); }
+
+    /**
+     * @brief 线程数，0表示使用全部硬件线程
+     */
+    void setThreadCount(int threads) { threadCount_ = threads; }
+
+    void setOptions(const Options& options) { options_ = options; }
+
+    void setProgress(Progress progress) { progress_ = std::move(progress); }
+
+    /**
+     * @brief 读取存档并调整权重
+     * @param initial 初始权重（位置价值是否计入也按它判断）
+     * @param tuned 输出调整后的权重（分数取整，间断系数的分母为1024）
+     * @return 没有可用局面或路径不存在时返回false
+     */
+    bool run(const PatternWeights& initial, PatternWeights& tuned, Report* report = nullptr);
+
+    QString errorString() const { return error_; }
+
+    static constexpr int GAPPED_FEATURES = 3;                                       ///< 有间断的冲四、冲三、冲二
+    static constexpr int FEATURES = PatternWeights::SHAPE_COUNT + GAPPED_FEATURES;  ///< 每个局面的特征数
+    static constexpr int OFFSET = FEATURES;       ///< 样本中位置价值常数项的下标
+    static constexpr int RESULT = FEATURES + 1;   ///< 样本中结果的下标
+    static constexpr int STRIDE = 16;             ///< 每个样本占的float数（64字节）
+
+    /**
+     * @brief 提取一个局面的特征（轮到toMove一方的视角）
+     * @param sample 输出STRIDE个float，结果一项不填
+     * @return 局面已有连五或有一方能直接连五时返回false
+     */
+    static bool extractFeatures(const Position& position, PieceType toMove,
+                                const PatternWeights& weights, float* sample);
+
+private:
+    using Game = std::vector<GameSave::Move>;
+
+    // 从一局中提取样本，追加到训练集或验证集
+    bool extractGame(const Game& game, const PatternWeights& weights, std::vector<float>& samples) const;
+
+    // 并行计算误差（grad非空时同时累加梯度）
+    double evaluateLoss(const std::vector<float>& samples, const float* effective, double scale,
+                        double* grad, int threads) const;
+
+    QStringList paths_;
+    int threadCount_ = 0;
+    Options options_;
+    Progress progress_;
+    QString error_;
+};
+
+#endif // WEIGHT_TUNER_H
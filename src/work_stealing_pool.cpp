@@ -0,0 +1,100 @@
+#include "work_stealing_pool.h"
+#include <algorithm>
+
+namespace {
+
+// 当前线程所属的线程池和队列下标（不是工作线程时为空）
+thread_local const WorkStealingPool* currentPool = nullptr;
+thread_local int currentIndex = -1;
+
+} // namespace
+
+WorkStealingPool::WorkStealingPool(int threads)
+{
+    if (threads <= 0) {
+        threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    }
+    for (int i = 0; i < threads; ++i) {
+        queues_.push_back(std::make_unique<Queue>());
+    }
+    threads_.reserve(threads);
+    for (int i = 0; i < threads; ++i) {
+        threads_.emplace_back([this, i]() { run(i); });
+    }
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(idleMutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+}
+
+void WorkStealingPool::submit(Task task)
+{
+    const int index = currentPool == this
+        ? currentIndex
+        : static_cast<int>(nextQueue_.fetch_add(1, std::memory_order_relaxed) % queues_.size());
+    {
+        std::lock_guard<std::mutex> lock(queues_[index]->mutex);
+        queues_[index]->tasks.push_back(std::move(task));
+    }
+    // 先入队再计数：等待中的线程看到计数时一定能找到任务
+    {
+        std::lock_guard<std::mutex> lock(idleMutex_);
+        pending_.fetch_add(1, std::memory_order_relaxed);
+    }
+    wake_.notify_one();
+}
+
+bool WorkStealingPool::take(int index, Task& task)
+{
+    {
+        Queue& own = *queues_[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.front());
+            own.tasks.pop_front();
+            return true;
+        }
+    }
+    const int count = static_cast<int>(queues_.size());
+    for (int offset = 1; offset < count; ++offset) {
+        Queue& victim = *queues_[(index + offset) % count];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            stolen_.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::run(int index)
+{
+    currentPool = this;
+    currentIndex = index;
+    Task task;
+    for (;;) {
+        if (take(index, task)) {
+            pending_.fetch_sub(1, std::memory_order_relaxed);
+            task();
+            task = nullptr;
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(idleMutex_);
+        wake_.wait(lock, [this]() {
+            return stopping_ || pending_.load(std::memory_order_relaxed) > 0;
+        });
+        if (stopping_ && pending_.load(std::memory_order_relaxed) == 0) {
+            return;
+        }
+    }
+}
@@ -0,0 +1,77 @@
+#ifndef WORK_STEALING_POOL_H
+#define WORK_STEALING_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief 任务窃取线程池
+ *
+ * 每个工作线程有自己的任务队列：外部提交的任务轮流放入各队列尾部，
+ * 工作线程内部提交的任务放入自己的队列。线程从自己队列的头部取任务，
+ * 自己的队列空了再从其他线程队列的头部窃取。两处都先取等得最久的任务：
+ * 任务多为外部请求，后进先出会让早到的请求一直被新请求挤在后面，拉高尾延迟。
+ * 队列只在取放时短暂加锁，没有任务时线程在条件变量上等待。
+ * 析构时执行完所有已提交的任务再退出。
+ */
+class WorkStealingPool {
+public:
+    using Task = std::function<void()>;
+
+    /**
+     * @param threads 线程数，0表示使用硬件并发数
+     */
+    explicit WorkStealingPool(int threads = 0);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    /**
+     * @brief 提交任务（可在任意线程调用）
+     */
+    void submit(Task task);
+
+    int threadCount() const { return static_cast<int>(threads_.size()); }
+
+    /**
+     * @brief 排队中（尚未开始执行）的任务数
+     */
+    int pendingCount() const { return pending_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief 累计被其他线程窃取的任务数
+     */
+    long long stolenCount() const { return stolen_.load(std::memory_order_relaxed); }
+
+private:
+    /**
+     * @brief 一个工作线程的任务队列
+     */
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> threads_;
+    std::mutex idleMutex_;                  ///< 与wake_配合，避免提交和入睡之间丢失唤醒
+    std::condition_variable wake_;
+    std::atomic<int> pending_{0};
+    std::atomic<unsigned> nextQueue_{0};    ///< 外部提交时轮流选择的队列
+    std::atomic<long long> stolen_{0};
+    bool stopping_ = false;                 ///< 受idleMutex_保护
+
+    void run(int index);
+
+    // 从自己的队列头部取任务，没有时从其他队列头部窃取
+    bool take(int index, Task& task);
+};
+
+#endif // WORK_STEALING_POOL_H
@@ -0,0 +1,115 @@
+#include "zobrist.h"
+
+namespace {
+
+/**
+ * @brief 预先计算的哈希键和对称变换表
+ */
+struct Tables {
+    uint64_t keys[2][Zobrist::CELLS];
+    int16_t cellMap[Symmetry::COUNT][Zobrist::CELLS];
+    int8_t composeTable[Symmetry::COUNT][Symmetry::COUNT];
+
+    Tables() {
+        // splitmix64，种子固定，改动会使已保存的哈希失效
+        uint64_t state = 0x474D4B5A4F425249ULL;
+        for (auto& side : keys) {
+            for (auto& key : side) {
+                uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+                z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+                z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+                key = z ^ (z >> 31);
+            }
+        }
+
+        const int m = Zobrist::SIZE - 1;
+        for (int row = 0; row < Zobrist::SIZE; ++row) {
+            for (int col = 0; col < Zobrist::SIZE; ++col) {
+                const int targets[Symmetry::COUNT][2] = {
+                    {row, col},          // 恒等
+                    {col, m - row},      // 旋转90°
+                    {m - row, m - col},  // 旋转180°
+                    {m - col, row},      // 旋转270°
+                    {row, m - col},      // 左右翻转
+                    {m - row, col},      // 上下翻转
+                    {col, row},          // 主对角线
+                    {m - col, m - row}   // 副对角线
+                };
+                for (int sym = 0; sym < Symmetry::COUNT; ++sym) {
+                    cellMap[sym][row * Zobrist::SIZE + col] =
+                        static_cast<int16_t>(targets[sym][0] * Zobrist::SIZE + targets[sym][1]);
+                }
+            }
+        }
+
+        // 用两个不共线的格子确定复合变换
+        const int probeA = 1;
+        const int probeB = Zobrist::SIZE;
+        for (int first = 0; first < Symmetry::COUNT; ++first) {
+            for (int second = 0; second < Symmetry::COUNT; ++second) {
+                const int a = cellMap[second][cellMap[first][probeA]];
+                const int b = cellMap[second][cellMap[first][probeB]];
+                for (int sym = 0; sym < Symmetry::COUNT; ++sym) {
+                    if (cellMap[sym][probeA] == a && cellMap[sym][probeB] == b) {
+                        composeTable[first][second] = static_cast<int8_t>(sym);
+                        break;
+                    }
+                }
+            }
+        }
+    }
+};
+
+const Tables& tables()
+{
+    static const Tables instance;
+    return instance;
+}
+
+} // namespace
+
+uint64_t Zobrist::key(PieceType piece, int cell)
+{
+    return tables().keys[piece == PieceType::WHITE ? 1 : 0][cell];
+}
+
+int Symmetry::transform(int sym, int cell)
+{
+    return tables().cellMap[sym][cell];
+}
+
+int Symmetry::compose(int first, int second)
+{
+    return tables().composeTable[first][second];
+}
+
+void SymmetricHash::clear()
+{
+    for (auto& hash : hashes_) {
+        hash = 0;
+    }
+}
+
+void SymmetricHash::toggle(int row, int col, PieceType piece)
+{
+    const Tables& t = tables();
+    const int cell = row * Zobrist::SIZE + col;
+    const uint64_t* keys = t.keys[piece == PieceType::WHITE ? 1 : 0];
+    for (int sym = 0; sym < Symmetry::COUNT; ++sym) {
+        hashes_[sym] ^= keys[t.cellMap[sym][cell]];
+    }
+}
+
+uint64_t SymmetricHash::canonical(int* sym) const
+{
+    int best = 0;
+    for (int i = 1; i < Symmetry::COUNT; ++i) {
+        if (hashes_[i] < hashes_[best]) {
+            best = i;
+        }
+    }
+    if (sym) {
+        *sym = best;
+    }
+    return hashes_[best];
+}
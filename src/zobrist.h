@@ -0,0 +1,87 @@
+#ifndef ZOBRIST_H
+#define ZOBRIST_H
+
+#include <cstdint>
+#include "game_types.h"
+
+/**
+ * @brief Zobrist哈希键
+ *
+ * 键由固定种子的splitmix64序列生成，不随编译或运行变化，
+ * 因此哈希值可以写入文件（如棋谱数据库的索引）长期使用。
+ */
+namespace Zobrist {
+
+constexpr int SIZE = 15;               ///< 棋盘大小
+constexpr int CELLS = SIZE * SIZE;     ///< 格子数
+
+/**
+ * @brief piece落在格子cell（行 * 15 + 列）上的哈希键
+ */
+uint64_t key(PieceType piece, int cell);
+
+} // namespace Zobrist
+
+/**
+ * @brief 棋盘的8种对称变换（二面体群D4）
+ *
+ * 0 恒等，1 顺时针旋转90°，2 旋转180°，3 顺时针旋转270°，
+ * 4 左右翻转，5 上下翻转，6 沿主对角线翻转，7 沿副对角线翻转。
+ */
+namespace Symmetry {
+
+constexpr int COUNT = 8;  ///< 对称变换数
+
+/**
+ * @brief 格子cell经变换sym后的格子
+ */
+int transform(int sym, int cell);
+
+/**
+ * @brief 变换sym的逆变换
+ */
+inline int inverse(int sym) { return sym == 1 ? 3 : (sym == 3 ? 1 : sym); }
+
+/**
+ * @brief 先做变换first再做变换second，等价的单个变换
+ */
+int compose(int first, int second);
+
+} // namespace Symmetry
+
+/**
+ * @brief 同时维护8个对称局面的Zobrist哈希
+ *
+ * 落子和提子时对8个变换后的格子分别异或哈希键，取最小值作为规范哈希，
+ * 互为对称的局面得到相同的规范哈希。
+ */
+class SymmetricHash {
+public:
+    SymmetricHash() { clear(); }
+
+    /**
+     * @brief 清空为空棋盘
+     */
+    void clear();
+
+    /**
+     * @brief 在(row, col)放上或拿走piece（异或，两次调用相互抵消）
+     */
+    void toggle(int row, int col, PieceType piece);
+
+    /**
+     * @brief 经变换sym后局面的哈希
+     */
+    uint64_t hash(int sym) const { return hashes_[sym]; }
+
+    /**
+     * @brief 规范哈希（8个对称局面哈希的最小值）
+     * @param sym 输出取得最小值的变换，即把当前局面映射到规范局面的变换
+     */
+    uint64_t canonical(int* sym = nullptr) const;
+
+private:
+    uint64_t hashes_[Symmetry::COUNT];
+};
+
+#endif // ZOBRIST_H